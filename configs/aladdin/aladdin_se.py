@@ -261,6 +261,9 @@ if '--ruby' in sys.argv:
 
 (options, args) = parser.parse_args()
 
+if options.fork_jobs:
+    (options, args) = Simulation.forkJobs(parser, options)
+
 if args:
     print("Error: script doesn't take any positional arguments")
     sys.exit(1)
@@ -126,6 +126,9 @@ def config_cache(options, system):
                                    tag_latency=options.l2_hit_latency,
                                    response_latency=options.l2_hit_latency)
 
+        if options.l2_sampled_sets:
+            system.l2.tags.sampled_sets = options.l2_sampled_sets
+
         system.tol2bus = L2XBar(clk_domain = system.clk_domain)
         system.l2.cpu_side = system.tol2bus.master
         system.l2.mem_side = system.membus.slave
@@ -163,6 +166,13 @@ def config_cache(options, system):
                 iwalkcache = None
                 dwalkcache = None
 
+            # Let the L1s pass misses to the L2 when functionally
+            # warming the caches (atomic_warming memory mode)
+            if options.l2cache:
+                for cache in (icache, dcache, iwalkcache, dwalkcache):
+                    if cache:
+                        cache.warm_downstream = system.l2
+
             if options.memchecker:
                 dcache_mon = MemCheckerMonitor(warn_only=True)
                 dcache_real = dcache
@@ -142,6 +142,12 @@ def addNoISAOptions(parser):
     parser.add_option("--l1d_hit_latency", type="int", default="2")
     parser.add_option("--l1i_hit_latency", type="int", default="2")
     parser.add_option("--l2_hit_latency", type="int", default="20")
+    parser.add_option("--l2_sampled_sets", type="int", default=0,
+                      help="Only model this many L2 sets and estimate its "
+                      "miss rate from them (0 models all sets). Accesses "
+                      "to the other sets always miss, so this breaks "
+                      "system timing and only the estimated L2 miss rate "
+                      "is meaningful")
     parser.add_option("--cacheline_size", type="int", default=64)
     parser.add_option("--xbar_width", type="int", default=16)
     parser.add_option("--record-dram-traffic", action="store_true",
@@ -326,6 +332,13 @@ def addCommonOptions(parser):
         help="restore from checkpoint <N>")
     parser.add_option("--checkpoint-at-end", action="store_true",
                       help="take a checkpoint at end of run")
+    parser.add_option("--fork-jobs", action="store", type="string",
+        help="""Restore the checkpoint once and run every line of this file
+                as a separate forked simulation. Each line holds a job
+                name, which names its output directory, followed by
+                options that are appended to the command line.""")
+    parser.add_option("--fork-parallel", action="store", type="int",
+        default=1, help="number of forked jobs to run at the same time")
     parser.add_option("--work-begin-checkpoint-count", action="store", type="int",
                       help="checkpoint at specified work begin count")
     parser.add_option("--work-end-checkpoint-count", action="store", type="int",
@@ -359,6 +372,9 @@ def addCommonOptions(parser):
     parser.add_option("-F", "--fast-forward", action="store", type="string",
         default=None,
         help="Number of instructions to fast forward before switching")
+    parser.add_option("--warm-caches", action="store_true", default=False,
+        help="Functionally warm the caches while fast-forwarding or "
+        "restoring with the atomic CPU (atomic_warming memory mode)")
     parser.add_option("-S", "--simpoint", action="store_true", default=False,
         help="""Use workload simpoints as an instruction offset for
                 --checkpoint-restore or --take-checkpoint.""")
@@ -86,6 +86,14 @@ def setCPUClass(options):
         TmpClass = AtomicSimpleCPU
         test_mem_mode = 'atomic'
 
+    # Caches only track the accessed addresses while running on the
+    # atomic CPU, and get their data from memory when switching
+    if options.warm_caches:
+        if options.ruby or not options.caches:
+            fatal("--warm-caches requires classic caches (--caches)")
+        if test_mem_mode == 'atomic' and CPUClass:
+            test_mem_mode = 'atomic_warming'
+
     # Ruby only supports atomic accesses in noncaching mode
     if test_mem_mode == 'atomic' and options.ruby:
         warn("Memory mode will be changed to atomic_noncaching")
@@ -205,6 +213,54 @@ def findCptDir(options, cptdir, testsys):
 
     return cpt_starttick, checkpoint_dir
 
+def forkJobs(parser, options):
+    """Runs the jobs listed in options.fork_jobs in forked simulators.
+
+    The checkpoint selected by the options is loaded once and shared
+    by all jobs. This function only returns in the forked children,
+    with the options and arguments of their job.
+    """
+
+    import shlex
+
+    if options.checkpoint_restore == None:
+        fatal("--fork-jobs requires --checkpoint-restore")
+    if options.at_instruction or options.simpoint or \
+       options.restore_simpoint_checkpoint:
+        fatal("--fork-jobs only supports tick-based checkpoints")
+
+    if options.checkpoint_dir:
+        cptdir = options.checkpoint_dir
+    elif m5.options.outdir:
+        cptdir = m5.options.outdir
+    else:
+        cptdir = getcwd()
+    cpt_starttick, checkpoint_dir = findCptDir(options, cptdir, None)
+
+    jobs = []
+    with open(options.fork_jobs) as f:
+        for line in f:
+            fields = shlex.split(line, comments=True)
+            if fields:
+                jobs.append((fields[0], fields[1:]))
+    if not jobs:
+        fatal("No jobs found in %s", options.fork_jobs)
+    job_args = dict(jobs)
+    if len(job_args) != len(jobs):
+        fatal("Job names in %s are not unique", options.fork_jobs)
+
+    print("Preloading", checkpoint_dir, "for", len(jobs), "jobs")
+    m5.preloadCheckpoint(checkpoint_dir)
+
+    job = m5.forkJobs([ name for name, args in jobs ], options.fork_parallel)
+
+    # The children get their own output directory, so they have to be
+    # told where the preloaded checkpoint lives
+    (options, args) = parser.parse_args(sys.argv[1:] + job_args[job])
+    options.checkpoint_dir = cptdir
+    options.fork_jobs = None
+    return options, args
+
 def scriptCheckpoints(options, maxtick, cptdir):
     if options.at_instruction or options.simpoint:
         checkpoint_inst = int(options.take_checkpoints)
@@ -279,4 +279,6 @@ else:
     config_filesystem(system, options)
 
 root = Root(full_system = False, system = system)
+if options.ruby:
+    Ruby.partition_system(options, system, root)
 Simulation.run(options, root, system, FutureClass)
@@ -0,0 +1,178 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import csv
+import optparse
+import os
+import sys
+
+import m5
+from m5.objects import *
+from m5.util import convert, fatal
+
+# This script replays a packet trace, as recorded by the CommMonitor
+# or the MemTraceProbe, in a set of cache hierarchies without any CPU
+# model. The trace is read once and every access is sent to all the
+# hierarchies, which only differ in the size and associativity of
+# their first-level cache. An optional, fixed second-level cache can
+# be added behind each of them. The miss rates of all configurations
+# are written to miss_curve.csv in the output directory.
+
+parser = optparse.OptionParser()
+
+parser.add_option("--trace", type="string",
+                  help="Packet trace to replay")
+parser.add_option("--sizes", type="string",
+                  default="16kB,32kB,64kB,128kB,256kB,512kB,1MB,2MB",
+                  help="Comma separated sizes of the swept cache")
+parser.add_option("--assocs", type="string", default="8",
+                  help="Comma separated associativities of the swept cache")
+parser.add_option("--replacement-policy", type="string", default="LRURP",
+                  help="Replacement policy of the swept cache")
+parser.add_option("--l2-size", type="string", default=None,
+                  help="Size of a second-level cache behind each "
+                  "configuration")
+parser.add_option("--l2-assoc", type="int", default=16,
+                  help="Associativity of the second-level cache")
+parser.add_option("--cacheline-size", type="int", default=64)
+parser.add_option("--mem-size", type="string", default="4GB",
+                  help="Size of the address space of the trace")
+parser.add_option("--max-records", type="int", default=0,
+                  help="Stop after N records of the trace")
+parser.add_option("--read-ahead", type="int", default=4,
+                  help="Chunks of the trace decoded ahead of the replay")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print("Error: script doesn't take any positional arguments")
+    sys.exit(1)
+
+if not options.trace:
+    fatal("A trace must be given with --trace")
+
+configs = [ (size, int(assoc))
+            for size in options.sizes.split(",")
+            for assoc in options.assocs.split(",") ]
+
+system = System(cache_line_size = options.cacheline_size,
+                mem_mode = 'atomic')
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain = VoltageDomain())
+
+system.player = TracePlayer(trace_file = options.trace,
+                            max_records = options.max_records,
+                            read_ahead = options.read_ahead)
+
+def make_memory():
+    # the memories only terminate the hierarchies and are not part of
+    # the address map, as they all cover the same range
+    return SimpleMemory(range = AddrRange(options.mem_size), null = True,
+                        in_addr_map = False, conf_table_reported = False)
+
+hierarchies = []
+for i, (size, assoc) in enumerate(configs):
+    h = SubSystem()
+    setattr(system, "h%d" % i, h)
+    hierarchies.append(h)
+
+    h.l1 = Cache(size = size, assoc = assoc, tag_latency = 1,
+                 data_latency = 1, response_latency = 1, mshrs = 16,
+                 tgts_per_mshr = 8,
+                 replacement_policy = getattr(m5.objects,
+                                              options.replacement_policy)())
+    system.player.port = h.l1.cpu_side
+    h.mem = make_memory()
+
+    if options.l2_size:
+        h.l2 = Cache(size = options.l2_size, assoc = options.l2_assoc,
+                     tag_latency = 10, data_latency = 10,
+                     response_latency = 10, mshrs = 32, tgts_per_mshr = 8)
+        h.l1.writeback_clean = True
+        h.l1.mem_side = h.l2.cpu_side
+        h.l2.mem_side = h.mem.port
+    else:
+        h.l1.mem_side = h.mem.port
+
+# The system port is never used by the player, so merely connect it
+# to avoid problems
+system.sysmem = make_memory()
+system.system_port = system.sysmem.port
+
+root = Root(full_system = False, system = system)
+
+m5.instantiate()
+
+exit_event = m5.simulate()
+print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
+
+m5.stats.dump()
+
+# Collect the miss curve from the statistics that were just dumped
+stats = {}
+with open(os.path.join(m5.options.outdir, "stats.txt")) as f:
+    for line in f:
+        fields = line.split()
+        if len(fields) >= 2:
+            stats[fields[0]] = fields[1]
+
+def stat(cache, name):
+    # Statistics that are zero are not printed, so a missing statistic
+    # can only be told from a zero one by checking that they add up
+    return float(stats.get("%s.%s::total" % (cache.path(), name), 0))
+
+def cache_stats(cache, required):
+    # The hits and misses have to add up to the accesses, which fails
+    # if any of them is missing for another reason than being zero
+    accesses = int(stat(cache, "overall_accesses"))
+    if required and accesses == 0:
+        fatal("No accesses of %s in the statistics", cache.path())
+    hits = int(stat(cache, "overall_hits"))
+    misses = int(stat(cache, "overall_misses"))
+    if hits + misses != accesses:
+        fatal("The hits (%d) and misses (%d) of %s don't add up to its "
+              "accesses (%d) in the statistics", hits, misses, cache.path(),
+              accesses)
+    return [ accesses, misses, float(misses) / accesses if accesses else 0.0 ]
+
+with open(os.path.join(m5.options.outdir, "miss_curve.csv"), "w") as f:
+    writer = csv.writer(f)
+    header = [ "size", "assoc", "l1_accesses", "l1_misses", "l1_miss_rate" ]
+    if options.l2_size:
+        header += [ "l2_accesses", "l2_misses", "l2_miss_rate" ]
+    writer.writerow(header)
+
+    for (size, assoc), h in zip(configs, hierarchies):
+        row = [ convert.toMemorySize(size), assoc ]
+        # Every record of the trace goes through each first-level cache
+        row += cache_stats(h.l1, True)
+        if options.l2_size:
+            row += cache_stats(h.l2, False)
+        writer.writerow(row)
+        print("%8s %3d-way: miss rate %f" % (size, assoc, row[4]))
@@ -45,7 +45,7 @@ import math
 import m5
 from m5.objects import *
 from m5.defines import buildEnv
-from m5.util import addToPath, fatal
+from m5.util import addToPath, convert, fatal
 
 addToPath('../')
 
@@ -66,6 +66,15 @@ def define_options(parser):
 
     parser.add_option("--access-backing-store", action="store_true", default=False,
                       help="Should ruby maintain a second copy of memory")
+    parser.add_option("--ruby-cache-snapshot", action="store_true",
+                      default=False,
+                      help="Save and restore the Ruby caches in checkpoints "
+                           "as a snapshot of all entries instead of a trace")
+    parser.add_option("--ruby-hot-lines", action="store_true", default=False,
+                      help="Write the most missed and stalled on lines of "
+                           "every statistics window to ruby.hot_lines.txt")
+    parser.add_option("--ruby-hot-lines-entries", type="int", default=1024,
+                      help="Number of lines the hot line profiler tracks")
 
     # Options related to cache structure
     parser.add_option("--ports", action="store", type="int", default=4,
@@ -82,6 +91,15 @@ def define_options(parser):
     parser.add_option("--recycle-latency", type="int", default=10,
                       help="Recycle latency for ruby controller input buffers")
 
+    parser.add_option("--ruby-partitions", type="int", default=1,
+                      help="Number of event queues (threads) to spread the "
+                           "CPUs and Ruby controllers over")
+    parser.add_option("--ruby-quantum", type="string", default=None,
+                      help="Simulation quantum when using several Ruby "
+                           "partitions (default: one Ruby cycle). Every "
+                           "latency between partitions must be at least "
+                           "this long.")
+
     protocol = buildEnv['PROTOCOL']
     exec("from . import %s" % protocol)
     eval("%s.define_options(parser)" % protocol)
@@ -221,6 +239,9 @@ def create_system(options, full_system, system, piobus = None, dma_ports = [],
     ruby.number_of_virtual_networks = ruby.network.number_of_virtual_networks
     ruby._cpu_ports = cpu_sequencers
     ruby.num_of_sequencers = len(cpu_sequencers)
+    ruby.cache_snapshot = options.ruby_cache_snapshot
+    ruby.hot_lines = options.ruby_hot_lines
+    ruby.hot_lines_entries = options.ruby_hot_lines_entries
 
     # Create a backing copy of physical memory in case required
     if options.access_backing_store:
@@ -228,6 +249,40 @@ def create_system(options, full_system, system, piobus = None, dma_ports = [],
         ruby.phys_mem = SimpleMemory(range=system.mem_ranges[0],
                                      in_addr_map=False)
 
+def partition_system(options, system, root):
+    """Spread the CPUs and Ruby controllers over options.ruby_partitions
+    event queues. Each CPU shares an event queue with its sequencer and
+    the controller the sequencer belongs to, as they talk through ports.
+    Other cache controllers are spread by version. Directories, DMA
+    controllers, the network and everything else stay on event queue 0,
+    together with the memory controllers the directories talk to."""
+
+    partitions = options.ruby_partitions
+    if partitions <= 1:
+        return
+
+    ruby = system.ruby
+    cpu_cntrls = set()
+    for i, seq in enumerate(ruby._cpu_ports):
+        cntrl = seq.get_parent()
+        index = i % partitions
+        system.cpu[i].eventq_index = index
+        cntrl.eventq_index = index
+        seq.eventq_index = index
+        cpu_cntrls.add(cntrl)
+
+    for cntrl in ruby.descendants():
+        if not isinstance(cntrl, RubyController) or cntrl in cpu_cntrls:
+            continue
+        if cntrl.type.startswith(('Directory', 'DMA')):
+            cntrl.eventq_index = 0
+        else:
+            cntrl.eventq_index = int(cntrl.version) % partitions
+    ruby.network.eventq_index = 0
+
+    quantum = options.ruby_quantum or options.ruby_clock
+    root.sim_quantum = m5.ticks.fromSeconds(convert.anyToLatency(quantum))
+
 def create_directories(options, bootmem, ruby_system, system):
     dir_cntrl_nodes = []
     for i in range(options.num_dirs):
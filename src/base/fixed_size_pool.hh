@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_FIXED_SIZE_POOL_HH__
+#define __BASE_FIXED_SIZE_POOL_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/**
+ * @file base/fixed_size_pool.hh
+ *
+ * A per-thread free-list allocator for small objects of a fixed size.
+ */
+
+/**
+ * Hands out chunks of ChunkSize bytes carved from large slabs. Every
+ * host thread owns the slabs it carved and keeps the free chunks of
+ * those slabs on its own list, so neither allocation nor a release on
+ * the owning thread needs any synchronisation.
+ *
+ * A chunk released on a different thread than the one that owns its
+ * slab is pushed onto a lock-free stack of the owner, which the owner
+ * takes over in one go once its own list runs dry. Chunks therefore
+ * always return to the thread that allocates them, and a producer
+ * thread that hands its objects to a consumer thread keeps reusing
+ * the same slabs instead of carving new ones.
+ *
+ * Slabs are aligned to their size, so the owner of a chunk is found
+ * from a header at the start of its slab. The owners of threads that
+ * have exited are kept and handed to the next thread that uses the
+ * pool, along with their slabs and free chunks.
+ *
+ * Slabs are never handed back to the system. Objects allocated from
+ * the pool can be destroyed by static destructors or on other threads
+ * after the allocating thread is gone, so the slabs have to outlive
+ * every thread that might touch them.
+ *
+ * @tparam ChunkSize Size of the chunks in bytes.
+ * @tparam ChunksPerSlab Minimum number of chunks allocated at once when
+ *                       a free list runs dry.
+ */
+template <std::size_t ChunkSize, std::size_t ChunksPerSlab = 256>
+class FixedSizePool
+{
+  private:
+    union Chunk
+    {
+        Chunk *next;
+        alignas(alignof(std::max_align_t)) unsigned char storage[ChunkSize];
+    };
+
+    static_assert(ChunksPerSlab > 0, "Slabs need to hold at least a chunk");
+
+    /** The free chunks of the slabs carved by one thread. */
+    struct Owner
+    {
+        /** Free chunks, only touched by the owning thread. */
+        Chunk *head = nullptr;
+        /** Chunks released by other threads. */
+        std::atomic<Chunk *> remote{nullptr};
+    };
+
+    struct alignas(alignof(Chunk)) SlabHeader
+    {
+        Owner *owner;
+    };
+
+    static constexpr std::size_t
+    roundUpPow2(std::size_t n, std::size_t p = 1)
+    {
+        return p >= n ? p : roundUpPow2(n, p * 2);
+    }
+
+    /** Size and alignment of a slab. */
+    static constexpr std::size_t SlabSize =
+        roundUpPow2(sizeof(SlabHeader) + sizeof(Chunk) * ChunksPerSlab);
+    /** Number of chunks that fit in a slab after its header. */
+    static constexpr std::size_t SlabChunks =
+        (SlabSize - sizeof(SlabHeader)) / sizeof(Chunk);
+
+    /** Owners left behind by exited threads, waiting for adoption. */
+    static std::mutex &
+    orphanLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    static std::vector<Owner *> &
+    orphans()
+    {
+        static std::vector<Owner *> *list = new std::vector<Owner *>;
+        return *list;
+    }
+
+    /** The owner bound to the calling thread, if any. */
+    static Owner *&
+    threadOwner()
+    {
+        static thread_local Owner *owner = nullptr;
+        return owner;
+    }
+
+    /** Hands the owner of a thread on to the orphans when it exits. */
+    struct OwnerRelease
+    {
+        ~OwnerRelease()
+        {
+            std::lock_guard<std::mutex> guard(orphanLock());
+            orphans().push_back(threadOwner());
+            threadOwner() = nullptr;
+        }
+    };
+
+    static Owner &
+    localOwner()
+    {
+        Owner *&owner = threadOwner();
+        if (!owner) {
+            static thread_local OwnerRelease release;
+            std::lock_guard<std::mutex> guard(orphanLock());
+            if (orphans().empty()) {
+                owner = new Owner;
+            } else {
+                owner = orphans().back();
+                orphans().pop_back();
+            }
+        }
+        return *owner;
+    }
+
+    static Owner *
+    ownerOf(Chunk *chunk)
+    {
+        auto slab = reinterpret_cast<std::uintptr_t>(chunk) & ~(SlabSize - 1);
+        return reinterpret_cast<SlabHeader *>(slab)->owner;
+    }
+
+    /**
+     * Refill the free list of an owner, first with the chunks other
+     * threads gave back and failing that from a new slab.
+     */
+    static void
+    refill(Owner &owner)
+    {
+        owner.head = owner.remote.exchange(nullptr, std::memory_order_acquire);
+        if (owner.head)
+            return;
+
+        void *mem = nullptr;
+        if (posix_memalign(&mem, SlabSize, SlabSize) != 0)
+            throw std::bad_alloc();
+        static_cast<SlabHeader *>(mem)->owner = &owner;
+        Chunk *slab = reinterpret_cast<Chunk *>(
+            static_cast<SlabHeader *>(mem) + 1);
+        for (std::size_t i = 0; i < SlabChunks - 1; i++)
+            slab[i].next = &slab[i + 1];
+        slab[SlabChunks - 1].next = nullptr;
+        owner.head = slab;
+    }
+
+  public:
+    /** Size of the chunks handed out by this pool. */
+    static constexpr std::size_t chunkSize = ChunkSize;
+
+    /** Get a chunk of uninitialised memory of ChunkSize bytes. */
+    static void *
+    allocate()
+    {
+        Owner &owner = localOwner();
+        if (!owner.head)
+            refill(owner);
+        Chunk *chunk = owner.head;
+        owner.head = chunk->next;
+        return chunk;
+    }
+
+    /** Return a chunk obtained with allocate() to the pool. */
+    static void
+    deallocate(void *p)
+    {
+        if (!p)
+            return;
+        Chunk *chunk = static_cast<Chunk *>(p);
+        Owner *owner = ownerOf(chunk);
+        if (owner == threadOwner()) {
+            chunk->next = owner->head;
+            owner->head = chunk;
+            return;
+        }
+
+        Chunk *head = owner->remote.load(std::memory_order_relaxed);
+        do {
+            chunk->next = head;
+        } while (!owner->remote.compare_exchange_weak(
+                     head, chunk, std::memory_order_release,
+                     std::memory_order_relaxed));
+    }
+};
+
+/**
+ * Standard allocator that takes single objects from a FixedSizePool,
+ * e.g., for the nodes of node-based containers that would otherwise
+ * call malloc on every insertion. Arrays, such as the bucket arrays
+ * of hash tables, are still allocated with operator new.
+ */
+template <class T>
+class PoolAllocator
+{
+  private:
+    typedef FixedSizePool<sizeof(T)> Pool;
+
+    /** Whether single objects can be taken from the pool */
+    static constexpr bool pooled =
+        alignof(T) <= alignof(std::max_align_t);
+
+  public:
+    typedef T value_type;
+
+    PoolAllocator() = default;
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *
+    allocate(std::size_t n)
+    {
+        if (pooled && n == 1)
+            return static_cast<T *>(Pool::allocate());
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *p, std::size_t n)
+    {
+        if (pooled && n == 1)
+            Pool::deallocate(p);
+        else
+            ::operator delete(p);
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U> &) const { return true; }
+    template <class U>
+    bool operator!=(const PoolAllocator<U> &) const { return false; }
+};
+
+template <std::size_t ChunkSize, std::size_t ChunksPerSlab>
+constexpr std::size_t FixedSizePool<ChunkSize, ChunksPerSlab>::chunkSize;
+template <std::size_t ChunkSize, std::size_t ChunksPerSlab>
+constexpr std::size_t FixedSizePool<ChunkSize, ChunksPerSlab>::SlabSize;
+template <std::size_t ChunkSize, std::size_t ChunksPerSlab>
+constexpr std::size_t FixedSizePool<ChunkSize, ChunksPerSlab>::SlabChunks;
+
+#endif // __BASE_FIXED_SIZE_POOL_HH__
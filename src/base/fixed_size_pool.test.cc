@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "base/fixed_size_pool.hh"
+
+typedef FixedSizePool<64, 4> Pool;
+
+/** Chunks that are live at the same time never overlap. */
+TEST(FixedSizePoolTest, DistinctChunks)
+{
+    std::set<uintptr_t> chunks;
+    std::vector<void *> live;
+    for (int i = 0; i < 10; i++) {
+        void *p = Pool::allocate();
+        std::memset(p, i, Pool::chunkSize);
+        live.push_back(p);
+        chunks.insert(reinterpret_cast<uintptr_t>(p));
+    }
+    ASSERT_EQ(10U, chunks.size());
+
+    uintptr_t prev = 0;
+    for (auto addr : chunks) {
+        if (prev) {
+            ASSERT_GE(addr - prev, Pool::chunkSize);
+        }
+        prev = addr;
+    }
+
+    for (int i = 0; i < 10; i++) {
+        const uint8_t *p = static_cast<uint8_t *>(live[i]);
+        for (size_t j = 0; j < Pool::chunkSize; j++)
+            ASSERT_EQ(i, p[j]);
+        Pool::deallocate(live[i]);
+    }
+}
+
+/** A released chunk is the first to be handed out again. */
+TEST(FixedSizePoolTest, Recycle)
+{
+    void *a = Pool::allocate();
+    void *b = Pool::allocate();
+    Pool::deallocate(a);
+    EXPECT_EQ(a, Pool::allocate());
+    Pool::deallocate(b);
+    EXPECT_EQ(b, Pool::allocate());
+    Pool::deallocate(a);
+    Pool::deallocate(b);
+}
+
+/** Chunks are suitably aligned for any fundamental type. */
+TEST(FixedSizePoolTest, Alignment)
+{
+    typedef FixedSizePool<24, 3> OddPool;
+    for (int i = 0; i < 7; i++) {
+        void *p = OddPool::allocate();
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) %
+                  alignof(std::max_align_t));
+    }
+}
+
+/** Chunks released on another thread go back to the thread they came from. */
+TEST(FixedSizePoolTest, CrossThreadRelease)
+{
+    std::vector<void *> chunks;
+    std::thread producer([&chunks]() {
+        for (int i = 0; i < 9; i++)
+            chunks.push_back(Pool::allocate());
+    });
+    producer.join();
+
+    std::vector<void *> local;
+    for (int i = 0; i < 9; i++)
+        local.push_back(Pool::allocate());
+
+    for (auto p : chunks)
+        Pool::deallocate(p);
+
+    // The chunks aren't handed out on this thread, but a new thread
+    // takes over the owner of the exited producer and gets them back.
+    std::set<void *> reused;
+    for (int i = 0; i < 9; i++)
+        reused.insert(Pool::allocate());
+    for (auto p : chunks)
+        EXPECT_EQ(0U, reused.count(p));
+
+    std::set<void *> adopted;
+    std::thread consumer([&adopted]() {
+        for (int i = 0; i < 32; i++)
+            adopted.insert(Pool::allocate());
+    });
+    consumer.join();
+    for (auto p : chunks)
+        EXPECT_EQ(1U, adopted.count(p));
+
+    for (auto p : local)
+        Pool::deallocate(p);
+    for (auto p : reused)
+        Pool::deallocate(p);
+    for (auto p : adopted)
+        Pool::deallocate(p);
+}
+
+/**
+ * A thread that allocates while another one releases keeps reusing
+ * the same chunks instead of carving new slabs forever.
+ */
+TEST(FixedSizePoolTest, ProducerConsumerBounded)
+{
+    typedef FixedSizePool<32, 8> PCPool;
+    std::atomic<void *> slot{nullptr};
+    std::atomic<bool> done{false};
+    std::set<void *> seen;
+
+    std::thread consumer([&]() {
+        while (!done.load() || slot.load()) {
+            void *p = slot.exchange(nullptr);
+            if (p)
+                PCPool::deallocate(p);
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    for (int i = 0; i < 1000; i++) {
+        void *p = PCPool::allocate();
+        seen.insert(p);
+        while (slot.load())
+            std::this_thread::yield();
+        slot.store(p);
+    }
+    done.store(true);
+    consumer.join();
+
+    // At most a couple of slabs are live at any time.
+    EXPECT_LE(seen.size(), 64U);
+}
+
+/** Containers using the pool allocator recycle their nodes. */
+TEST(FixedSizePoolTest, AllocatorRecyclesNodes)
+{
+    std::list<uint64_t, PoolAllocator<uint64_t>> list;
+    list.push_back(1);
+    const uint64_t *first = &list.back();
+    list.pop_back();
+    list.push_back(2);
+    EXPECT_EQ(first, &list.back());
+
+    std::map<int, int, std::less<int>,
+             PoolAllocator<std::pair<const int, int>>> map;
+    for (int i = 0; i < 100; i++)
+        map[i] = i;
+    for (int i = 0; i < 100; i += 2)
+        map.erase(i);
+    EXPECT_EQ(50U, map.size());
+    EXPECT_EQ(99, map.rbegin()->second);
+
+    // Arrays don't come from the pool
+    PoolAllocator<uint64_t> alloc;
+    uint64_t *array = alloc.allocate(16);
+    for (int i = 0; i < 16; i++)
+        array[i] = i;
+    alloc.deallocate(array, 16);
+}
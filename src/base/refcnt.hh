@@ -43,6 +43,8 @@
 #ifndef __BASE_REFCNT_HH__
 #define __BASE_REFCNT_HH__
 
+#include <cstddef>
+#include <functional>
 #include <type_traits>
 
 /**
@@ -204,6 +206,15 @@ class RefCountingPtr
     template <bool B = TisConst>
     RefCountingPtr(const NonConstT &r) { copy(r.data); }
 
+    /// Create a new reference counting pointer to a base class of
+    /// the object pointed to by another one.  Adds a reference.
+    template <class U, typename std::enable_if<
+                  std::is_convertible<U *, T *>::value &&
+                  !std::is_same<typename std::remove_const<U>::type,
+                                typename std::remove_const<T>::type>::value,
+                  int>::type = 0>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -245,6 +256,9 @@ class RefCountingPtr
         return *this;
     }
 
+    /// Drop the reference, leaving the pointer empty
+    void reset() { del(); data = nullptr; }
+
     /// Check if the pointer is empty
     bool operator!() const { return data == 0; }
 
@@ -286,4 +300,38 @@ template<class T>
 inline bool operator!=(const T *l, const RefCountingPtr<T> &r)
 { return l != r.get(); }
 
+/// Check if a reference counting pointer is empty.
+template<class T>
+inline bool operator==(const RefCountingPtr<T> &l, std::nullptr_t)
+{ return !l; }
+
+/// Check if a reference counting pointer is empty.
+template<class T>
+inline bool operator==(std::nullptr_t, const RefCountingPtr<T> &r)
+{ return !r; }
+
+/// Check if a reference counting pointer is non-empty.
+template<class T>
+inline bool operator!=(const RefCountingPtr<T> &l, std::nullptr_t)
+{ return (bool)l; }
+
+/// Check if a reference counting pointer is non-empty.
+template<class T>
+inline bool operator!=(std::nullptr_t, const RefCountingPtr<T> &r)
+{ return (bool)r; }
+
+namespace std
+{
+/// Hash reference counting pointers by the object they point to.
+template<class T>
+struct hash<RefCountingPtr<T>>
+{
+    size_t
+    operator()(const RefCountingPtr<T> &p) const
+    {
+        return hash<T *>()(p.get());
+    }
+};
+}
+
 #endif // __BASE_REFCNT_HH__
@@ -72,6 +72,11 @@ class TestRC : public RefCounted
 };
 typedef RefCountingPtr<TestRC> Ptr;
 
+class DerivedTestRC : public TestRC
+{
+};
+typedef RefCountingPtr<DerivedTestRC> DerivedPtr;
+
 } // anonymous namespace
 
 TEST(RefcntTest, NullPointerCheck)
@@ -98,6 +103,21 @@ TEST(RefcntTest, ConstructionFromExistingPointer)
     EXPECT_EQ(1, liveListSize());
 }
 
+TEST(RefcntTest, ConstructionFromDerivedPointer)
+{
+    // Construct a Ptr from a Ptr to a derived class, both share the
+    // object.
+    DerivedPtr derived = new DerivedTestRC();
+    Ptr base = derived;
+    EXPECT_EQ(1, liveListSize());
+    EXPECT_EQ(derived.get(), base.get());
+
+    derived = NULL;
+    EXPECT_EQ(1, liveListSize());
+    base = NULL;
+    EXPECT_EQ(0, liveListSize());
+}
+
 TEST(RefcntTest, DestroyPointer)
 {
     // Test a Ptr being destroyed.
@@ -173,4 +193,28 @@ TEST(RefcntTest, EqualityOperators)
     EXPECT_TRUE(equalTestA != equalTestBPtr);
     EXPECT_TRUE(equalTestAPtr != equalTestB);
     EXPECT_TRUE(equalTestAPtr != equalTestBPtr);
-}
\ No newline at end of file
+}
+TEST(RefcntTest, ResetAndNullComparison)
+{
+    // Test reset() and comparisons against nullptr.
+    Ptr resetTest = new TestRC();
+    EXPECT_TRUE(resetTest != nullptr);
+    EXPECT_FALSE(nullptr == resetTest);
+    EXPECT_EQ(1, liveListSize());
+    resetTest.reset();
+    EXPECT_TRUE(resetTest == nullptr);
+    EXPECT_FALSE(nullptr != resetTest);
+    EXPECT_EQ(0, liveListSize());
+}
+
+TEST(RefcntTest, Hash)
+{
+    // Pointers to the same object hash the same, so they can be used
+    // as keys of unordered containers.
+    TestRC *hashTest = new TestRC();
+    Ptr hashTestPtr = hashTest;
+    Ptr hashTestPtr2 = hashTest;
+    std::hash<Ptr> hasher;
+    EXPECT_EQ(hasher(hashTestPtr), hasher(hashTestPtr2));
+    EXPECT_EQ(std::hash<TestRC *>()(hashTest), hasher(hashTestPtr));
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_SPACE_SAVING_HH__
+#define __BASE_SPACE_SAVING_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @file base/space_saving.hh
+ *
+ * A fixed-size heavy hitter sketch.
+ */
+
+/**
+ * Approximate per-key counter that uses a fixed amount of memory,
+ * based on the Space-Saving algorithm (Metwally et al., "Efficient
+ * Computation of Frequent and Top-k Elements in Data Streams", ICDT
+ * 2005).
+ *
+ * At most capacity keys are monitored at a time. When a new key is
+ * seen and the sketch is full, the key with the smallest count is
+ * replaced, and the new key inherits its count. The count of a key is
+ * thus never underestimated, and overestimated by at most the error
+ * stored with it. Any key whose real count is larger than the total
+ * weight divided by the capacity is guaranteed to be monitored.
+ *
+ * Every monitored key also holds a user-defined value, which is
+ * default-constructed when the key starts being monitored. It can be
+ * used to aggregate additional information about the key.
+ *
+ * @tparam Key Type of the keys.
+ * @tparam Value Type of the values attached to the keys.
+ * @tparam Hash Hash function of the keys.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SpaceSaving
+{
+  public:
+    /** A monitored key. */
+    struct Entry
+    {
+        /** The key. */
+        Key key;
+        /** Estimated count, never below the real count. */
+        uint64_t count;
+        /** Maximum overestimation of the count. */
+        uint64_t error;
+        /** Value attached to the key since it is being monitored. */
+        Value value;
+    };
+
+  private:
+    /** Maximum number of monitored keys. */
+    const std::size_t _capacity;
+
+    /** Sum of the weights of all the updates. */
+    uint64_t _total;
+
+    /** Monitored keys, as a min-heap on their counts. */
+    std::vector<Entry> heap;
+
+    /** Position of the monitored keys in the heap. */
+    std::unordered_map<Key, std::size_t, Hash> index;
+
+    /** Swap two heap entries, keeping the index up to date. */
+    void
+    swapEntries(std::size_t i, std::size_t j)
+    {
+        std::swap(heap[i], heap[j]);
+        index[heap[i].key] = i;
+        index[heap[j].key] = j;
+    }
+
+    /**
+     * Move an entry towards the leaves until the heap is restored.
+     *
+     * @return The final position of the entry.
+     */
+    std::size_t
+    siftDown(std::size_t i)
+    {
+        while (true) {
+            const std::size_t left = 2 * i + 1;
+            const std::size_t right = left + 1;
+            std::size_t smallest = i;
+            if (left < heap.size() && heap[left].count < heap[smallest].count)
+                smallest = left;
+            if (right < heap.size() &&
+                heap[right].count < heap[smallest].count) {
+                smallest = right;
+            }
+            if (smallest == i)
+                return i;
+            swapEntries(i, smallest);
+            i = smallest;
+        }
+    }
+
+    /**
+     * Move an entry towards the root until the heap is restored.
+     *
+     * @return The final position of the entry.
+     */
+    std::size_t
+    siftUp(std::size_t i)
+    {
+        while (i > 0) {
+            const std::size_t parent = (i - 1) / 2;
+            if (heap[parent].count <= heap[i].count)
+                break;
+            swapEntries(i, parent);
+            i = parent;
+        }
+        return i;
+    }
+
+  public:
+    /**
+     * @param capacity Maximum number of monitored keys.
+     */
+    explicit SpaceSaving(std::size_t capacity)
+        : _capacity(capacity), _total(0)
+    {
+        assert(capacity > 0);
+        heap.reserve(capacity);
+        index.reserve(capacity);
+    }
+
+    /**
+     * Account for an occurrence of a key.
+     *
+     * @param key The key.
+     * @param weight Weight of the occurrence.
+     * @return The value attached to the key.
+     */
+    Value &
+    add(const Key &key, uint64_t weight = 1)
+    {
+        _total += weight;
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            const std::size_t i = it->second;
+            heap[i].count += weight;
+            return heap[siftDown(i)].value;
+        }
+
+        if (heap.size() < _capacity) {
+            heap.push_back(Entry{key, weight, 0, Value()});
+            index[key] = heap.size() - 1;
+            return heap[siftUp(heap.size() - 1)].value;
+        }
+
+        // Replace the key with the smallest count
+        Entry &victim = heap.front();
+        index.erase(victim.key);
+        victim.key = key;
+        victim.error = victim.count;
+        victim.count += weight;
+        victim.value = Value();
+        index[key] = 0;
+        return heap[siftDown(0)].value;
+    }
+
+    /**
+     * Get a monitored key.
+     *
+     * @param key The key.
+     * @return The entry of the key, or nullptr if it is not monitored.
+     */
+    const Entry *
+    find(const Key &key) const
+    {
+        auto it = index.find(key);
+        return it != index.end() ? &heap[it->second] : nullptr;
+    }
+
+    /**
+     * Get the monitored keys with the largest counts.
+     *
+     * @param n Maximum number of keys to return.
+     * @return The entries, sorted by decreasing count.
+     */
+    std::vector<const Entry *>
+    top(std::size_t n) const
+    {
+        std::vector<const Entry *> entries;
+        entries.reserve(heap.size());
+        for (const auto &entry : heap)
+            entries.push_back(&entry);
+
+        n = std::min(n, entries.size());
+        std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+            [](const Entry *a, const Entry *b) {
+                return a->count > b->count;
+            });
+        entries.resize(n);
+        return entries;
+    }
+
+    /** Stop monitoring all keys. */
+    void
+    clear()
+    {
+        heap.clear();
+        index.clear();
+        _total = 0;
+    }
+
+    /** @return The number of monitored keys. */
+    std::size_t size() const { return heap.size(); }
+
+    /** @return The maximum number of monitored keys. */
+    std::size_t capacity() const { return _capacity; }
+
+    /** @return The sum of the weights of all the updates. */
+    uint64_t total() const { return _total; }
+};
+
+#endif // __BASE_SPACE_SAVING_HH__
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+#include "base/space_saving.hh"
+
+typedef SpaceSaving<int, int> Sketch;
+
+/** Keys are counted exactly while the sketch is not full. */
+TEST(SpaceSavingTest, ExactBelowCapacity)
+{
+    Sketch sketch(4);
+    sketch.add(1);
+    sketch.add(2, 3);
+    sketch.add(1);
+    sketch.add(3);
+
+    ASSERT_EQ(3U, sketch.size());
+    ASSERT_EQ(6U, sketch.total());
+    ASSERT_EQ(2U, sketch.find(1)->count);
+    ASSERT_EQ(3U, sketch.find(2)->count);
+    ASSERT_EQ(1U, sketch.find(3)->count);
+    ASSERT_EQ(0U, sketch.find(1)->error);
+    ASSERT_EQ(nullptr, sketch.find(4));
+}
+
+/** A new key replaces the smallest one and inherits its count. */
+TEST(SpaceSavingTest, Replacement)
+{
+    Sketch sketch(2);
+    sketch.add(1, 5);
+    sketch.add(2, 2);
+    sketch.add(3);
+
+    ASSERT_EQ(2U, sketch.size());
+    ASSERT_EQ(nullptr, sketch.find(2));
+    ASSERT_EQ(3U, sketch.find(3)->count);
+    ASSERT_EQ(2U, sketch.find(3)->error);
+    ASSERT_EQ(5U, sketch.find(1)->count);
+}
+
+/** Values are attached to keys and reset on replacement. */
+TEST(SpaceSavingTest, Values)
+{
+    Sketch sketch(1);
+    sketch.add(1) += 10;
+    sketch.add(1) += 5;
+    ASSERT_EQ(15, sketch.find(1)->value);
+
+    sketch.add(2) += 1;
+    ASSERT_EQ(nullptr, sketch.find(1));
+    ASSERT_EQ(1, sketch.find(2)->value);
+}
+
+/** The top keys are sorted by decreasing count. */
+TEST(SpaceSavingTest, Top)
+{
+    Sketch sketch(8);
+    for (int i = 1; i <= 6; i++)
+        sketch.add(i, i * 10);
+
+    auto top = sketch.top(3);
+    ASSERT_EQ(3U, top.size());
+    ASSERT_EQ(6, top[0]->key);
+    ASSERT_EQ(5, top[1]->key);
+    ASSERT_EQ(4, top[2]->key);
+
+    ASSERT_EQ(6U, sketch.top(100).size());
+
+    sketch.clear();
+    ASSERT_EQ(0U, sketch.size());
+    ASSERT_EQ(0U, sketch.total());
+    ASSERT_TRUE(sketch.top(3).empty());
+}
+
+/** Counts bound the real counts, and heavy hitters are always found. */
+TEST(SpaceSavingTest, Bounds)
+{
+    const std::size_t capacity = 16;
+    Sketch sketch(capacity);
+    std::map<int, uint64_t> real;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> noise(100, 10000);
+
+    for (int i = 0; i < 20000; i++) {
+        // A few frequent keys hidden among many infrequent ones
+        const int key = (i % 4 == 0) ? i % 3 : noise(rng);
+        sketch.add(key);
+        real[key]++;
+    }
+
+    for (const auto &entry : sketch.top(capacity)) {
+        ASSERT_GE(entry->count, real[entry->key]);
+        ASSERT_LE(entry->count - entry->error, real[entry->key]);
+    }
+
+    for (const auto &key_count : real) {
+        if (key_count.second > sketch.total() / capacity) {
+            ASSERT_NE(nullptr, sketch.find(key_count.first));
+        }
+    }
+}
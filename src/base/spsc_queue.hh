@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_SPSC_QUEUE_HH__
+#define __BASE_SPSC_QUEUE_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @file base/spsc_queue.hh
+ *
+ * An unbounded lock-free queue between one producer and one consumer
+ * thread.
+ */
+
+/**
+ * A FIFO queue that one thread pushes to while another thread pops
+ * from, without taking any locks. Elements are stored in linked
+ * chunks of ChunkSize elements. The producer appends to the last chunk
+ * and publishes each element with a release store of the chunk's fill
+ * level. The consumer frees a chunk once it has read all of it and the
+ * producer has moved on to the next one.
+ *
+ * The push side (push()) may only be used by the producer thread, and
+ * the pop side (front(), pop(), empty()) only by the consumer thread.
+ * forEach() may only be used while both of them are stopped.
+ *
+ * @tparam T Element type, which has to be default constructible.
+ * @tparam ChunkSize Number of elements per chunk.
+ */
+template <class T, std::size_t ChunkSize = 64>
+class SpscQueue
+{
+  private:
+    static_assert(ChunkSize > 0, "Chunks need to hold at least an element");
+
+    struct Chunk
+    {
+        T items[ChunkSize];
+        /** Number of items written by the producer. */
+        std::atomic<std::size_t> written;
+        /** The chunk after this one, set once this chunk is full. */
+        std::atomic<Chunk *> next;
+
+        Chunk() : written(0), next(nullptr) {}
+    };
+
+    // Consumer side
+    Chunk *head;
+    std::size_t readPos;
+
+    // Keep the two sides on different cache lines to avoid false
+    // sharing
+    char pad[64];
+
+    // Producer side
+    Chunk *tail;
+    std::size_t writePos;
+
+  public:
+    SpscQueue()
+        : head(new Chunk), readPos(0), tail(head), writePos(0)
+    {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    ~SpscQueue()
+    {
+        while (head) {
+            Chunk *next = head->next.load(std::memory_order_relaxed);
+            delete head;
+            head = next;
+        }
+    }
+
+    /** Append an element. Producer only. */
+    void
+    push(T item)
+    {
+        if (writePos == ChunkSize) {
+            Chunk *chunk = new Chunk;
+            tail->next.store(chunk, std::memory_order_release);
+            tail = chunk;
+            writePos = 0;
+        }
+        tail->items[writePos] = std::move(item);
+        tail->written.store(++writePos, std::memory_order_release);
+    }
+
+    /**
+     * Oldest element that hasn't been popped yet, or nullptr if the
+     * queue is empty. Consumer only.
+     */
+    T *
+    front()
+    {
+        if (readPos == ChunkSize) {
+            Chunk *next = head->next.load(std::memory_order_acquire);
+            if (!next)
+                return nullptr;
+            delete head;
+            head = next;
+            readPos = 0;
+        }
+        if (readPos == head->written.load(std::memory_order_acquire))
+            return nullptr;
+        return &head->items[readPos];
+    }
+
+    /** Remove the element returned by front(). Consumer only. */
+    void
+    pop()
+    {
+        head->items[readPos] = T();
+        readPos++;
+    }
+
+    /** Check if the queue is empty. Consumer only. */
+    bool empty() { return front() == nullptr; }
+
+    /**
+     * Call f on every element that hasn't been popped yet, oldest
+     * first. Neither the producer nor the consumer may use the queue
+     * meanwhile, e.g. because the threads simulating both sides are
+     * stopped.
+     */
+    template <class F>
+    void
+    forEach(F f)
+    {
+        std::size_t pos = readPos;
+        for (Chunk *chunk = head; chunk;
+             chunk = chunk->next.load(std::memory_order_acquire)) {
+            std::size_t written =
+                chunk->written.load(std::memory_order_acquire);
+            for (; pos < written; pos++)
+                f(chunk->items[pos]);
+            pos = 0;
+        }
+    }
+};
+
+#endif // __BASE_SPSC_QUEUE_HH__
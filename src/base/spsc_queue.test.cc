@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "base/spsc_queue.hh"
+
+/** Elements come out in the order they were pushed, across chunks. */
+TEST(SpscQueueTest, Fifo)
+{
+    SpscQueue<int, 4> queue;
+    ASSERT_TRUE(queue.empty());
+
+    for (int i = 0; i < 10; i++)
+        queue.push(i);
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_NE(nullptr, queue.front());
+        ASSERT_EQ(i, *queue.front());
+        queue.pop();
+    }
+    ASSERT_TRUE(queue.empty());
+}
+
+/** Popped elements are released straight away. */
+TEST(SpscQueueTest, PopReleasesElement)
+{
+    SpscQueue<std::shared_ptr<int>, 2> queue;
+    auto value = std::make_shared<int>(1);
+    queue.push(value);
+    ASSERT_EQ(2, value.use_count());
+    queue.pop();
+    ASSERT_EQ(1, value.use_count());
+}
+
+/** forEach() visits the elements that haven't been popped, in order. */
+TEST(SpscQueueTest, ForEach)
+{
+    SpscQueue<int, 2> queue;
+    for (int i = 0; i < 5; i++)
+        queue.push(i);
+    queue.pop();
+    queue.pop();
+
+    std::vector<int> seen;
+    queue.forEach([&seen](int &item) { seen.push_back(item); item *= 10; });
+    ASSERT_EQ(std::vector<int>({2, 3, 4}), seen);
+
+    for (int i = 2; i < 5; i++) {
+        ASSERT_EQ(i * 10, *queue.front());
+        queue.pop();
+    }
+    queue.forEach([](int &) { FAIL(); });
+}
+
+/** A consumer thread sees every element of a producer thread in order. */
+TEST(SpscQueueTest, Threaded)
+{
+    const int count = 100000;
+    SpscQueue<int, 16> queue;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < count; i++)
+            queue.push(i);
+    });
+
+    int expected = 0;
+    while (expected < count) {
+        int *item = queue.front();
+        if (!item)
+            continue;
+        ASSERT_EQ(expected, *item);
+        queue.pop();
+        expected++;
+    }
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}
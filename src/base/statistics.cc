@@ -47,6 +47,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/callback.hh"
 #include "base/cprintf.hh"
@@ -67,11 +67,13 @@
 #include <math.h>
 #endif
 #include <cmath>
+#include <cstdlib>
 #include <functional>
 #include <iosfwd>
 #include <list>
 #include <map>
 #include <memory>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -710,6 +712,8 @@ class ScalarBase : public DataWrap<Derived, ScalarInfoProxy>
         this->doInit();
     }
 
+    ~ScalarBase() { data()->~Storage(); }
+
   public:
     // Common operators for stats
     /**
@@ -1841,6 +1845,213 @@ class AvgSampleStor
     }
 };
 
+/**
+ * Shard of the sharded stats updated by the current host thread. The
+ * thread simulating main event queue i uses shard i.
+ */
+extern thread_local unsigned curShard;
+
+/**
+ * Interface used to resize the storage of sharded stats once the
+ * number of simulation threads is known.
+ */
+class ShardedStorBase
+{
+  public:
+    virtual ~ShardedStorBase() {}
+    virtual void resizeShards(unsigned shards) = 0;
+};
+
+/** Track sharded storage so that it can be resized later on. */
+void registerShardedStor(ShardedStorBase *stor);
+
+/** Stop tracking sharded storage that is being destroyed. */
+void unregisterShardedStor(ShardedStorBase *stor);
+
+/** Number of shards currently allocated per sharded stat. */
+unsigned numShards();
+
+/**
+ * Allocate one shard per simulation thread in every sharded stat. This
+ * must be called before the simulation threads start.
+ */
+void setNumShards(unsigned shards);
+
+/**
+ * Storage that keeps a private copy of the wrapped storage for every
+ * simulation thread. Updates only touch the shard of the calling
+ * thread, so they are plain non-atomic operations on memory that no
+ * other thread writes. The shards are merged whenever the stat is
+ * read, i.e., at dump time, and are all cleared on reset.
+ *
+ * Reads must only happen while the simulation threads are
+ * synchronised, which holds for stat dumps and resets since they are
+ * global events. Setting a sharded scalar is not atomic with respect
+ * to concurrent increments from other threads.
+ */
+template <class Stor>
+class ShardedStor : public ShardedStorBase
+{
+  public:
+    typedef typename Stor::Params Params;
+
+  private:
+    static const size_t CacheLine = 64;
+
+    /**
+     * Every shard starts on a cache line of its own and its size is
+     * rounded up to whole lines, so threads never share a line.
+     */
+    struct alignas(CacheLine) Shard
+    {
+        Stor stor;
+
+        Shard(Info *info) : stor(info) {}
+    };
+
+    /** std::allocator ignores alignments beyond max_align_t in C++14. */
+    template <class T>
+    struct ShardAllocator
+    {
+        typedef T value_type;
+
+        ShardAllocator() = default;
+        template <class U>
+        ShardAllocator(const ShardAllocator<U> &) {}
+
+        T *
+        allocate(size_t n)
+        {
+            void *p = nullptr;
+            if (posix_memalign(&p, CacheLine, n * sizeof(T)) != 0)
+                throw std::bad_alloc();
+            return static_cast<T *>(p);
+        }
+
+        void deallocate(T *p, size_t n) { free(p); }
+
+        template <class U>
+        bool operator==(const ShardAllocator<U> &) const { return true; }
+        template <class U>
+        bool operator!=(const ShardAllocator<U> &) const { return false; }
+    };
+
+    Info *info;
+    std::vector<Shard, ShardAllocator<Shard>> shards;
+
+    Stor &
+    local()
+    {
+        assert(curShard < shards.size());
+        return shards[curShard].stor;
+    }
+
+  public:
+    ShardedStor(Info *_info)
+        : info(_info)
+    {
+        resizeShards(numShards());
+        registerShardedStor(this);
+    }
+
+    ~ShardedStor() { unregisterShardedStor(this); }
+
+    ShardedStor(const ShardedStor &) = delete;
+    ShardedStor &operator=(const ShardedStor &) = delete;
+
+    void
+    resizeShards(unsigned count) override
+    {
+        shards.reserve(count);
+        while (shards.size() < count)
+            shards.emplace_back(info);
+    }
+
+    /**
+     * Set the merged value of the stat. The value is stored in the
+     * shard of the calling thread and all other shards are cleared.
+     */
+    void
+    set(Counter val)
+    {
+        for (auto &shard : shards)
+            shard.stor.reset(info);
+        local().set(val);
+    }
+    void inc(Counter val) { local().inc(val); }
+    void dec(Counter val) { local().dec(val); }
+    void sample(Counter val, int number) { local().sample(val, number); }
+
+    Counter
+    value() const
+    {
+        Counter total = Counter();
+        for (const auto &shard : shards)
+            total += shard.stor.value();
+        return total;
+    }
+
+    Result result() const { return (Result)value(); }
+
+    size_type size() const { return shards.front().stor.size(); }
+
+    bool
+    zero() const
+    {
+        for (const auto &shard : shards) {
+            if (!shard.stor.zero())
+                return false;
+        }
+        return true;
+    }
+
+    void
+    prepare(Info *info)
+    {
+        for (auto &shard : shards)
+            shard.stor.prepare(info);
+    }
+
+    /**
+     * Merge the distributions of all shards. Shards without samples
+     * are skipped as their min/max values are meaningless.
+     */
+    void
+    prepare(Info *info, DistData &data)
+    {
+        shards.front().stor.prepare(info, data);
+
+        DistData shard_data;
+        for (auto it = shards.begin() + 1; it != shards.end(); ++it) {
+            if (it->stor.zero())
+                continue;
+
+            it->stor.prepare(info, shard_data);
+            if (data.samples == Counter()) {
+                data.min_val = shard_data.min_val;
+                data.max_val = shard_data.max_val;
+            } else {
+                data.min_val = std::min(data.min_val, shard_data.min_val);
+                data.max_val = std::max(data.max_val, shard_data.max_val);
+            }
+            data.underflow += shard_data.underflow;
+            data.overflow += shard_data.overflow;
+            for (off_type i = 0; i < data.cvec.size(); ++i)
+                data.cvec[i] += shard_data.cvec[i];
+            data.sum += shard_data.sum;
+            data.squares += shard_data.squares;
+            data.samples += shard_data.samples;
+        }
+    }
+
+    void
+    reset(Info *info)
+    {
+        for (auto &shard : shards)
+            shard.stor.reset(info);
+    }
+};
+
 /**
  * Implementation of a distribution stat. The type of distribution is
  * determined by the Storage template. @sa ScalarBase
@@ -1891,6 +2102,12 @@ class DistBase : public DataWrap<Derived, DistInfoProxy>
     {
     }
 
+    ~DistBase()
+    {
+        if (this->info()->flags.isSet(Stats::init))
+            data()->~Storage();
+    }
+
     /**
      * Add a value to the distribtion n times. Calls sample on the storage
      * class.
@@ -2624,6 +2841,76 @@ class Distribution : public DistBase<Distribution, DistStor>
     }
 };
 
+/**
+ * A scalar stat that can be updated concurrently from several
+ * simulation threads, e.g., by objects on different event queues.
+ * @sa Scalar, ShardedStor
+ */
+class ShardedScalar : public ScalarBase<ShardedScalar, ShardedStor<StatStor>>
+{
+  public:
+    using ScalarBase<ShardedScalar, ShardedStor<StatStor>>::operator=;
+
+    ShardedScalar(Group *parent = nullptr, const char *name = nullptr,
+                  const char *desc = nullptr)
+        : ScalarBase<ShardedScalar, ShardedStor<StatStor>>(parent, name, desc)
+    {
+    }
+};
+
+/**
+ * A vector of scalar stats that can be updated concurrently from
+ * several simulation threads.
+ * @sa Vector, ShardedStor
+ */
+class ShardedVector : public VectorBase<ShardedVector, ShardedStor<StatStor>>
+{
+  public:
+    ShardedVector(Group *parent = nullptr, const char *name = nullptr,
+                  const char *desc = nullptr)
+        : VectorBase<ShardedVector, ShardedStor<StatStor>>(parent, name, desc)
+    {
+    }
+};
+
+/**
+ * A distribution that can be sampled concurrently from several
+ * simulation threads.
+ * @sa Distribution, ShardedStor
+ */
+class ShardedDistribution
+    : public DistBase<ShardedDistribution, ShardedStor<DistStor>>
+{
+  public:
+    ShardedDistribution(Group *parent = nullptr, const char *name = nullptr,
+                        const char *desc = nullptr)
+        : DistBase<ShardedDistribution, ShardedStor<DistStor>>(
+            parent, name, desc)
+    {
+    }
+
+    /**
+     * Set the parameters of this distribution. @sa Distribution::init
+     * @param min The minimum value of the distribution.
+     * @param max The maximum value of the distribution.
+     * @param bkt The number of values in each bucket.
+     * @return A reference to this distribution.
+     */
+    ShardedDistribution &
+    init(Counter min, Counter max, Counter bkt)
+    {
+        DistStor::Params *params = new DistStor::Params;
+        params->min = min;
+        params->max = max;
+        params->bucket_size = bkt;
+        assert(bkt > 0);
+        params->buckets = (size_type)ceil((max - min + 1.0) / bkt);
+        this->setParams(params);
+        this->doInit();
+        return this->self();
+    }
+};
+
 /**
  * A simple histogram stat.
  * @sa Stat, DistBase, HistStor
@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/delta.hh"
+
+#include <cstring>
+#include <ostream>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/statistics.hh"
+#include "base/stats/info.hh"
+
+namespace Stats {
+
+namespace {
+
+template <typename T>
+void
+writeRaw(std::ostream &os, const T &value)
+{
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+void
+appendRaw(std::vector<char> &buf, const T &value)
+{
+    const char *p = reinterpret_cast<const char *>(&value);
+    buf.insert(buf.end(), p, p + sizeof(value));
+}
+
+/** Labels of vector elements, falling back to their index. */
+std::vector<std::string>
+vectorLabels(const std::vector<std::string> &subnames, size_type size,
+             bool with_total = false)
+{
+    std::vector<std::string> labels(size);
+    for (off_type i = 0; i < size; ++i) {
+        if (i < subnames.size() && !subnames[i].empty())
+            labels[i] = subnames[i];
+        else
+            labels[i] = std::to_string(i);
+    }
+    if (with_total)
+        labels.push_back("total");
+    return labels;
+}
+
+} // anonymous namespace
+
+const uint32_t Delta::fileMagic;
+const uint32_t Delta::fileVersion;
+const uint32_t Delta::recordMagic;
+const uint32_t Delta::keyframeFlag;
+
+Delta::Delta(const std::string &file, unsigned keyframe_interval)
+    : fname(file), keyframeInterval(keyframe_interval),
+      dataFile(nullptr), indexFile(nullptr), namesFile(nullptr),
+      dumpCount(0), lastKeyframe(0), dataOffset(0),
+      keyframe(false), numEntries(0)
+{
+    dataFile = simout.create(fname, true, true);
+    indexFile = simout.create(fname + ".idx", true, true);
+    namesFile = simout.create(fname + ".names", false, true);
+    if (!valid())
+        fatal("Unable to open delta stat files '%s' for writing\n", fname);
+
+    std::ostream &data = *dataFile->stream();
+    writeRaw(data, fileMagic);
+    writeRaw(data, fileVersion);
+    dataOffset = 2 * sizeof(uint32_t);
+
+    std::ostream &index = *indexFile->stream();
+    writeRaw(index, fileMagic);
+    writeRaw(index, fileVersion);
+    writeRaw(index, static_cast<uint32_t>(keyframeInterval));
+    writeRaw(index, static_cast<uint32_t>(0));
+}
+
+Delta::~Delta()
+{
+    simout.close(dataFile);
+    simout.close(indexFile);
+    simout.close(namesFile);
+}
+
+void
+Delta::begin(std::string desc)
+{
+    // Without a keyframe interval, only the first dump is complete.
+    keyframe = dumpCount == 0 ||
+        (keyframeInterval && dumpCount % keyframeInterval == 0);
+    if (keyframe)
+        lastKeyframe = dumpCount;
+
+    dumpDesc = desc;
+    numEntries = 0;
+    entries.clear();
+}
+
+void
+Delta::end()
+{
+    assert(valid());
+
+    const uint32_t flags = keyframe ? keyframeFlag : 0;
+    const uint64_t tick = curTick();
+
+    std::ostream &data = *dataFile->stream();
+    const uint64_t record_offset = dataOffset;
+    writeRaw(data, recordMagic);
+    writeRaw(data, flags);
+    writeRaw(data, dumpCount);
+    writeRaw(data, tick);
+    writeRaw(data, static_cast<uint32_t>(dumpDesc.size()));
+    data.write(dumpDesc.data(), dumpDesc.size());
+    writeRaw(data, numEntries);
+    data.write(entries.data(), entries.size());
+    data.flush();
+    dataOffset += 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t) +
+        dumpDesc.size() + entries.size();
+
+    std::ostream &index = *indexFile->stream();
+    writeRaw(index, record_offset);
+    writeRaw(index, tick);
+    writeRaw(index, lastKeyframe);
+    writeRaw(index, numEntries);
+    writeRaw(index, flags);
+    index.flush();
+
+    namesFile->stream()->flush();
+
+    dumpCount++;
+}
+
+bool
+Delta::valid() const
+{
+    return dataFile && dataFile->stream()->good() &&
+        indexFile && indexFile->stream()->good() &&
+        namesFile && namesFile->stream()->good();
+}
+
+void
+Delta::beginGroup(const char *name)
+{
+    if (path.empty()) {
+        path.push(name);
+    } else {
+        path.push(csprintf("%s.%s", path.top(), name));
+    }
+}
+
+void
+Delta::endGroup()
+{
+    assert(!path.empty());
+    path.pop();
+}
+
+bool
+Delta::noOutput(const Info &info) const
+{
+    // Unlike the text output, prerequisites are ignored. A stat that
+    // disappeared from a dump would otherwise look unchanged to a
+    // reader replaying the deltas.
+    return !info.flags.isSet(display);
+}
+
+std::string
+Delta::statName(const std::string &name) const
+{
+    if (path.empty())
+        return name;
+    else
+        return csprintf("%s.%s", path.top(), name);
+}
+
+int
+Delta::lookup(const SeriesKey &key) const
+{
+    auto it = seriesIds.find(key);
+    return it != seriesIds.end() ? it->second : -1;
+}
+
+unsigned
+Delta::define(const SeriesKey &key, const char *kind,
+              const std::string &name,
+              const std::vector<std::string> &labels)
+{
+    const unsigned id = seriesData.size();
+    seriesIds.emplace(key, id);
+    seriesData.emplace_back();
+
+    std::ostream &names = *namesFile->stream();
+    ccprintf(names, "%d\t%s\t%s", id, kind, name);
+    for (const auto &label : labels)
+        ccprintf(names, "\t%s", label);
+    ccprintf(names, "\n");
+
+    return id;
+}
+
+void
+Delta::record(unsigned id, const std::vector<double> &vals)
+{
+    Series &s = seriesData[id];
+
+    // Compare the raw bits so that NaNs compare equal to themselves.
+    if (!keyframe && s.last.size() == vals.size() &&
+        (vals.empty() || std::memcmp(s.last.data(), vals.data(),
+                                     vals.size() * sizeof(double)) == 0)) {
+        return;
+    }
+
+    s.last = vals;
+
+    appendRaw(entries, static_cast<uint32_t>(id));
+    appendRaw(entries, static_cast<uint32_t>(vals.size()));
+    const char *p = reinterpret_cast<const char *>(vals.data());
+    entries.insert(entries.end(), p, p + vals.size() * sizeof(double));
+    numEntries++;
+}
+
+const std::vector<std::string> &
+Delta::distLabels()
+{
+    static const std::vector<std::string> labels = {
+        "samples", "min_value", "max_value", "underflows", "overflows",
+        "sum", "squares", "logs", "min", "max", "bucket_size",
+    };
+    return labels;
+}
+
+void
+Delta::flattenDist(const DistData &data, std::vector<double> &out)
+{
+    out.clear();
+    out.push_back(data.samples);
+    out.push_back(data.min_val);
+    out.push_back(data.max_val);
+    out.push_back(data.underflow);
+    out.push_back(data.overflow);
+    out.push_back(data.sum);
+    out.push_back(data.squares);
+    out.push_back(data.logs);
+    out.push_back(data.min);
+    out.push_back(data.max);
+    out.push_back(data.bucket_size);
+    // Buckets follow the fixed fields. Histograms may grow their
+    // bucket size, so the labels can't name individual buckets.
+    out.insert(out.end(), data.cvec.begin(), data.cvec.end());
+}
+
+void
+Delta::visit(const ScalarInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    const SeriesKey key(&info, 0);
+    int id = lookup(key);
+    if (id < 0)
+        id = define(key, "scalar", statName(info.name), {});
+
+    scratch.assign(1, info.result());
+    record(id, scratch);
+}
+
+void
+Delta::visit(const VectorInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    const VResult &vr = info.result();
+    const SeriesKey key(&info, 0);
+    int id = lookup(key);
+    if (id < 0) {
+        id = define(key, "vector", statName(info.name),
+                    vectorLabels(info.subnames, vr.size(), true));
+    }
+
+    scratch.assign(vr.begin(), vr.end());
+    scratch.push_back(info.total());
+    record(id, scratch);
+}
+
+void
+Delta::visit(const DistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    const SeriesKey key(&info, 0);
+    int id = lookup(key);
+    if (id < 0)
+        id = define(key, "dist", statName(info.name), distLabels());
+
+    flattenDist(info.data, scratch);
+    record(id, scratch);
+}
+
+void
+Delta::visit(const VectorDistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    // Every element is stored as its own distribution series.
+    for (off_type i = 0; i < info.data.size(); ++i) {
+        const SeriesKey key(&info, i);
+        int id = lookup(key);
+        if (id < 0) {
+            const std::string sub =
+                i < info.subnames.size() && !info.subnames[i].empty() ?
+                info.subnames[i] : std::to_string(i);
+            id = define(key, "dist",
+                        statName(info.name) + info.separatorString + sub,
+                        distLabels());
+        }
+
+        flattenDist(info.data[i], scratch);
+        record(id, scratch);
+    }
+}
+
+void
+Delta::visit(const Vector2dInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    const SeriesKey key(&info, 0);
+    int id = lookup(key);
+    if (id < 0) {
+        const auto x_labels = vectorLabels(info.subnames, info.x);
+        const auto y_labels = vectorLabels(info.y_subnames, info.y);
+        std::vector<std::string> labels;
+        labels.reserve(info.x * info.y);
+        for (const auto &x : x_labels) {
+            for (const auto &y : y_labels)
+                labels.push_back(x + info.separatorString + y);
+        }
+        id = define(key, "vector2d", statName(info.name), labels);
+    }
+
+    scratch.assign(info.cvec.begin(), info.cvec.end());
+    record(id, scratch);
+}
+
+void
+Delta::visit(const FormulaInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    const VResult &vr = info.result();
+    const SeriesKey key(&info, 0);
+    int id = lookup(key);
+    if (id < 0) {
+        id = define(key, "formula", statName(info.name),
+                    vectorLabels(info.subnames, vr.size(), true));
+    }
+
+    scratch.assign(vr.begin(), vr.end());
+    scratch.push_back(info.total());
+    record(id, scratch);
+}
+
+void
+Delta::visit(const SparseHistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    // Sparse histograms are stored as the sample count followed by
+    // (value, count) pairs, so their length varies between dumps.
+    const SeriesKey key(&info, 0);
+    int id = lookup(key);
+    if (id < 0)
+        id = define(key, "sparsehist", statName(info.name), { "samples" });
+
+    scratch.clear();
+    scratch.push_back(info.data.samples);
+    for (const auto &bucket : info.data.cmap) {
+        scratch.push_back(bucket.first);
+        scratch.push_back(bucket.second);
+    }
+    record(id, scratch);
+}
+
+std::unique_ptr<Output>
+initDelta(const std::string &filename, unsigned keyframe_interval)
+{
+    return std::unique_ptr<Output>(new Delta(filename, keyframe_interval));
+}
+
+} // namespace Stats
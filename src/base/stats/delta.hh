@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_DELTA_HH__
+#define __BASE_STATS_DELTA_HH__
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+
+namespace Stats {
+
+struct DistData;
+
+/**
+ * Append-only binary stat output that only records the stats whose
+ * values changed since the previous dump.
+ *
+ * Every stat is flattened into a series of doubles that is identified
+ * by a small integer id. A dump is stored as a record listing the
+ * (id, values) pairs that differ from the last dump. Every
+ * keyframeInterval dumps, a keyframe containing all series is written
+ * instead, which bounds the number of records a reader has to replay
+ * to reconstruct an arbitrary dump.
+ *
+ * Three files are produced for a base name of foo:
+ *   - foo: the dump records.
+ *   - foo.idx: a fixed-size index entry per dump pointing at its
+ *     record and at the keyframe it depends on.
+ *   - foo.names: one tab-separated line per series with its id, kind,
+ *     name and the labels of its values.
+ *
+ * util/delta_stats.py implements a reader for this format.
+ */
+class Delta : public Output
+{
+  public:
+    /** Magic number at the start of the data and index files. */
+    static const uint32_t fileMagic = 0x544c4453; // "SDLT"
+    static const uint32_t fileVersion = 1;
+    /** Magic number at the start of every dump record. */
+    static const uint32_t recordMagic = 0x504d5544; // "DUMP"
+
+    /** Record flag set on keyframes. */
+    static const uint32_t keyframeFlag = 0x1;
+
+    Delta(const std::string &file, unsigned keyframe_interval);
+    ~Delta();
+
+    Delta() = delete;
+    Delta(const Delta &other) = delete;
+
+  public: // Output interface
+    void begin(std::string desc="") override;
+    void end() override;
+    bool valid() const override;
+
+    void beginGroup(const char *name) override;
+    void endGroup() override;
+
+    void visit(const ScalarInfo &info) override;
+    void visit(const VectorInfo &info) override;
+    void visit(const DistInfo &info) override;
+    void visit(const VectorDistInfo &info) override;
+    void visit(const Vector2dInfo &info) override;
+    void visit(const FormulaInfo &info) override;
+    void visit(const SparseHistInfo &info) override;
+
+  protected:
+    /** Last values written for a series. */
+    struct Series
+    {
+        std::vector<double> last;
+    };
+
+    /** Series are keyed by the stat and the element within it. */
+    typedef std::pair<const Info *, size_type> SeriesKey;
+
+    struct SeriesKeyHash
+    {
+        size_t
+        operator()(const SeriesKey &key) const
+        {
+            return std::hash<const Info *>()(key.first) ^
+                (std::hash<size_type>()(key.second) << 1);
+        }
+    };
+
+    /** Skip stats that the text output would never print. */
+    bool noOutput(const Info &info) const;
+
+    /** Full name of a stat within the current group. */
+    std::string statName(const std::string &name) const;
+
+    /** Id of the series of a stat element, -1 if it is not known yet. */
+    int lookup(const SeriesKey &key) const;
+
+    /** Register a new series and describe it in the names file. */
+    unsigned define(const SeriesKey &key, const char *kind,
+                    const std::string &name,
+                    const std::vector<std::string> &labels);
+
+    /** Add the series to the current record if it changed. */
+    void record(unsigned id, const std::vector<double> &values);
+
+    /** Flatten a distribution in the order given by distLabels(). */
+    static void flattenDist(const DistData &data, std::vector<double> &out);
+    static const std::vector<std::string> &distLabels();
+
+  protected:
+    const std::string fname;
+    const unsigned keyframeInterval;
+
+    OutputStream *dataFile;
+    OutputStream *indexFile;
+    OutputStream *namesFile;
+
+    /** Object/group path */
+    std::stack<std::string> path;
+
+    std::unordered_map<SeriesKey, unsigned, SeriesKeyHash> seriesIds;
+    std::vector<Series> seriesData;
+
+    uint64_t dumpCount;
+    uint64_t lastKeyframe;
+    uint64_t dataOffset;
+
+    /** State of the dump being assembled. */
+    bool keyframe;
+    std::string dumpDesc;
+    uint32_t numEntries;
+    std::vector<char> entries;
+
+    /** Scratch space reused to flatten stats. */
+    std::vector<double> scratch;
+};
+
+std::unique_ptr<Output> initDelta(const std::string &filename,
+                                  unsigned keyframe_interval = 64);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_DELTA_HH__
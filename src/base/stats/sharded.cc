@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Bookkeeping of the per-thread shards of sharded stats.
+ */
+
+#include <cassert>
+#include <unordered_set>
+
+#include "base/statistics.hh"
+
+namespace Stats {
+
+thread_local unsigned curShard = 0;
+
+namespace {
+
+unsigned shardCount = 1;
+
+std::unordered_set<ShardedStorBase *> &
+shardedStorage()
+{
+    static std::unordered_set<ShardedStorBase *> the_set;
+    return the_set;
+}
+
+} // anonymous namespace
+
+void
+registerShardedStor(ShardedStorBase *stor)
+{
+    shardedStorage().insert(stor);
+}
+
+void
+unregisterShardedStor(ShardedStorBase *stor)
+{
+    shardedStorage().erase(stor);
+}
+
+unsigned
+numShards()
+{
+    return shardCount;
+}
+
+void
+setNumShards(unsigned shards)
+{
+    assert(shards > 0);
+    if (shards <= shardCount)
+        return;
+
+    shardCount = shards;
+    for (auto stor : shardedStorage())
+        stor->resizeShards(shards);
+}
+
+} // namespace Stats
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "base/statistics.hh"
+
+using namespace Stats;
+
+typedef ShardedStor<StatStor> ShardedCounter;
+
+namespace {
+
+const unsigned NumThreads = 4;
+
+/** Merge the shards of a distribution and return the result. */
+const DistData &
+prepared(ShardedDistribution &dist)
+{
+    dist.prepare();
+    const ShardedDistribution &const_dist = dist;
+    return const_dist.info()->data;
+}
+
+} // anonymous namespace
+
+/** Updates from several threads add up exactly when the stat is read. */
+TEST(ShardedStatsTest, ExactReduction)
+{
+    setNumShards(NumThreads);
+    ShardedCounter counter(nullptr);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < NumThreads; t++) {
+        threads.emplace_back([&counter, t]() {
+            curShard = t;
+            for (int i = 0; i < 100000; i++) {
+                counter.inc(3);
+                counter.dec(1);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(NumThreads * 100000 * 2, counter.value());
+    EXPECT_FALSE(counter.zero());
+}
+
+/** Adding shards later keeps the values counted so far. */
+TEST(ShardedStatsTest, Resize)
+{
+    ShardedCounter counter(nullptr);
+    curShard = 0;
+    counter.inc(5);
+
+    setNumShards(NumThreads * 2);
+    std::thread thread([&counter]() {
+        curShard = NumThreads * 2 - 1;
+        counter.inc(7);
+    });
+    thread.join();
+
+    EXPECT_EQ(12, counter.value());
+}
+
+/** Setting and resetting a stat affects every shard. */
+TEST(ShardedStatsTest, SetAndReset)
+{
+    ShardedCounter counter(nullptr);
+    std::thread thread([&counter]() {
+        curShard = 1;
+        counter.inc(10);
+    });
+    thread.join();
+
+    curShard = 0;
+    counter.set(4);
+    EXPECT_EQ(4, counter.value());
+
+    counter.inc(1);
+    counter.reset(nullptr);
+    EXPECT_TRUE(counter.zero());
+}
+
+/** Destroyed stats are not resized when more shards are added. */
+TEST(ShardedStatsTest, Unregister)
+{
+    {
+        ShardedCounter counter(nullptr);
+        counter.inc(1);
+    }
+    ShardedCounter live(nullptr);
+    setNumShards(numShards() + 1);
+    curShard = numShards() - 1;
+    live.inc(2);
+    curShard = 0;
+    EXPECT_EQ(2, live.value());
+}
+
+/**
+ * Merging the shards of a distribution keeps the smallest and largest
+ * sample of any shard and adds up the buckets and moments. Shards that
+ * were never sampled, including the first, don't affect the extremes.
+ */
+TEST(ShardedStatsTest, DistributionMerge)
+{
+    setNumShards(NumThreads);
+    ShardedDistribution dist;
+    dist.init(0, 9, 2);
+
+    curShard = 1;
+    dist.sample(3);
+    dist.sample(12);
+    curShard = 3;
+    dist.sample(-1, 2);
+    dist.sample(8);
+    curShard = 0;
+
+    const DistData &data = prepared(dist);
+    EXPECT_EQ(-1, data.min_val);
+    EXPECT_EQ(12, data.max_val);
+    EXPECT_EQ(2, data.underflow);
+    EXPECT_EQ(1, data.overflow);
+    ASSERT_EQ(5u, data.cvec.size());
+    EXPECT_EQ(0, data.cvec[0]);
+    EXPECT_EQ(1, data.cvec[1]);
+    EXPECT_EQ(0, data.cvec[2]);
+    EXPECT_EQ(0, data.cvec[3]);
+    EXPECT_EQ(1, data.cvec[4]);
+    EXPECT_EQ(3 + 12 - 2 + 8, data.sum);
+    EXPECT_EQ(9 + 144 + 2 + 64, data.squares);
+    EXPECT_EQ(5, data.samples);
+}
+
+/** A distribution sampled in the first shard only is reported as is. */
+TEST(ShardedStatsTest, DistributionFirstShard)
+{
+    ShardedDistribution dist;
+    dist.init(0, 9, 2);
+    curShard = 0;
+    dist.sample(4);
+
+    const DistData &data = prepared(dist);
+    EXPECT_EQ(4, data.min_val);
+    EXPECT_EQ(4, data.max_val);
+    EXPECT_EQ(1, data.cvec[2]);
+    EXPECT_EQ(1, data.samples);
+}
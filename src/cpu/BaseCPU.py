@@ -256,6 +256,9 @@ class BaseCPU(ClockedObject):
         self.connectCachedPorts(self.toL2Bus)
         self.l2cache = l2c
         self.toL2Bus.master = self.l2cache.cpu_side
+        for cache in (ic, dc, iwc, dwc):
+            if cache:
+                cache.warm_downstream = self.l2cache
         self._cached_ports = ['l2cache.mem_side']
 
     def createThreads(self):
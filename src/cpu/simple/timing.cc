@@ -432,7 +432,7 @@ TimingSimpleCPU::initiateMemRead(Addr addr, unsigned size,
     if (traceData)
         traceData->setMem(addr, size, flags);
 
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         asid, addr, size, flags, dataMasterId(), pc,
         thread->contextId());
     if (!byte_enable.empty()) {
@@ -518,7 +518,7 @@ TimingSimpleCPU::writeMem(uint8_t *data, unsigned size,
     if (traceData)
         traceData->setMem(addr, size, flags);
 
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         asid, addr, size, flags, dataMasterId(), pc,
         thread->contextId());
     if (!byte_enable.empty()) {
@@ -578,7 +578,7 @@ TimingSimpleCPU::initiateMemAMO(Addr addr, unsigned size,
     if (traceData)
         traceData->setMem(addr, size, flags);
 
-    RequestPtr req = make_shared<Request>(asid, addr, size, flags,
+    RequestPtr req = Request::create(asid, addr, size, flags,
                             dataMasterId(), pc, thread->contextId(),
                             std::move(amo_op));
 
@@ -676,7 +676,7 @@ TimingSimpleCPU::fetch()
 
     if (needToFetch) {
         _status = BaseSimpleCPU::Running;
-        RequestPtr ifetch_req = std::make_shared<Request>();
+        RequestPtr ifetch_req = Request::create();
         ifetch_req->taskId(taskId());
         ifetch_req->setContext(thread->contextId());
         setupFetchRequest(ifetch_req);
@@ -0,0 +1,51 @@
+#
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.proxy import *
+from m5.SimObject import SimObject
+
+class TracePlayer(SimObject):
+    type = 'TracePlayer'
+    cxx_header = "cpu/testers/trace_player/trace_player.hh"
+
+    # Packet trace in the format written by the CommMonitor and the
+    # MemTraceProbe. Every access is replayed in all the memory systems
+    # connected to the ports, so several cache configurations can be
+    # evaluated with a single pass over the trace.
+    trace_file = Param.String("Packet trace to replay")
+    port = VectorMasterPort("Ports to the memory systems to replay into")
+
+    # The trace is decoded by a separate host thread, which stays up to
+    # read_ahead chunks of records ahead of the replay.
+    chunk_size = Param.Unsigned(4096, "Records per chunk of the trace")
+    read_ahead = Param.Unsigned(4, "Chunks decoded ahead of the replay")
+
+    addr_offset = Param.Addr(0, "Offset added to the trace addresses")
+    max_records = Param.Counter(0, "Records to replay, 0 for all")
+
+    system = Param.System(Parent.any, "System this player is part of")
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/testers/trace_player/trace_player.hh"
+
+#include <algorithm>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/TracePlayer.hh"
+#include "mem/packet.hh"
+#include "proto/packet.pb.h"
+#include "sim/core.hh"
+#include "sim/sim_exit.hh"
+#include "sim/system.hh"
+
+TracePlayer::Reader::Reader(const std::string &filename, size_t chunk_size,
+                            size_t read_ahead)
+    : trace(filename), chunkSize(chunk_size), readAhead(read_ahead),
+      done(false), stop(false)
+{
+    fatal_if(chunkSize == 0 || readAhead == 0,
+             "Trace chunks and read-ahead must not be empty\n");
+
+    ProtoMessage::PacketHeader header_msg;
+    if (!trace.read(header_msg)) {
+        fatal("Failed to read packet header from trace %s\n", filename);
+    } else if (header_msg.tick_freq() != SimClock::Frequency) {
+        fatal("Trace %s was recorded with a different tick frequency %d\n",
+              filename, header_msg.tick_freq());
+    }
+}
+
+TracePlayer::Reader::~Reader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cond.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void
+TracePlayer::Reader::start()
+{
+    thread = std::thread(&Reader::run, this);
+}
+
+bool
+TracePlayer::Reader::next(Chunk &chunk)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return done || !chunks.empty(); });
+    if (chunks.empty())
+        return false;
+
+    chunk = std::move(chunks.front());
+    chunks.pop_front();
+    lock.unlock();
+
+    // let the decoding thread fill the free slot
+    cond.notify_all();
+    return true;
+}
+
+void
+TracePlayer::Reader::run()
+{
+    ProtoMessage::Packet pkt_msg;
+    bool eof = false;
+    while (!eof) {
+        Chunk chunk;
+        chunk.reserve(chunkSize);
+        while (chunk.size() < chunkSize) {
+            if (!trace.read(pkt_msg)) {
+                eof = true;
+                break;
+            }
+            chunk.push_back(Record{ MemCmd(pkt_msg.cmd()), pkt_msg.addr(),
+                                    pkt_msg.size(), pkt_msg.tick(),
+                                    pkt_msg.has_flags() ?
+                                    pkt_msg.flags() : 0 });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return stop || chunks.size() < readAhead; });
+        if (stop)
+            return;
+        if (!chunk.empty())
+            chunks.push_back(std::move(chunk));
+        done = eof;
+        lock.unlock();
+        cond.notify_all();
+    }
+}
+
+TracePlayer::TracePlayer(const Params *p)
+    : SimObject(p),
+      replayEvent([this]{ replay(); }, name()),
+      system(p->system),
+      reader(p->trace_file, p->chunk_size, p->read_ahead),
+      masterId(p->system->getMasterId(this)),
+      blockSize(p->system->cacheLineSize()),
+      addrOffset(p->addr_offset),
+      maxRecords(p->max_records),
+      tickOffset(0), firstTick(0), numRecords(0),
+      data(blockSize, 0)
+{
+    fatal_if(p->port_port_connection_count == 0,
+             "%s must be connected to at least one memory system\n", name());
+
+    for (int i = 0; i < p->port_port_connection_count; i++) {
+        ports.emplace_back(new PlayerPort(csprintf("%s.port[%d]", name(), i),
+                                          *this));
+    }
+}
+
+TracePlayer::~TracePlayer()
+{
+}
+
+Port &
+TracePlayer::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "port" && idx < ports.size())
+        return *ports[idx];
+    else
+        return SimObject::getPort(if_name, idx);
+}
+
+void
+TracePlayer::startup()
+{
+    // the caches would be bypassed in any other atomic mode, and
+    // timing requests would need their own flow control per port
+    fatal_if(system->getMemoryMode() != Enums::atomic,
+             "%s replays traces in atomic mode only\n", name());
+
+    reader.start();
+    if (!reader.next(chunk)) {
+        warn("%s: trace is empty\n", name());
+        exitSimLoop("end of trace reached");
+        return;
+    }
+
+    tickOffset = curTick();
+    firstTick = chunk.front().tick;
+    schedule(replayEvent, curTick());
+}
+
+void
+TracePlayer::replay()
+{
+    for (const auto &record : chunk) {
+        if (maxRecords && numRecords == maxRecords)
+            break;
+        replayRecord(record);
+        numRecords++;
+    }
+
+    if ((maxRecords && numRecords == maxRecords) || !reader.next(chunk)) {
+        DPRINTF(TracePlayer, "Replayed %d records\n", numRecords);
+        exitSimLoop("end of trace reached");
+        return;
+    }
+
+    // follow the timing of the trace at the granularity of a chunk,
+    // and only as far as the records are in order
+    const Tick tick = chunk.front().tick;
+    const Tick when = tick > firstTick ? tickOffset + tick - firstTick : 0;
+    schedule(replayEvent, std::max(when, curTick()));
+}
+
+void
+TracePlayer::replayRecord(const Record &record)
+{
+    MemCmd cmd;
+    if (record.cmd.toInt() >= MemCmd::NUM_MEM_CMDS) {
+        numSkipped++;
+        return;
+    } else if (record.cmd.isRead()) {
+        cmd = MemCmd::ReadReq;
+        numReads++;
+    } else if (record.cmd.isWrite()) {
+        cmd = MemCmd::WriteReq;
+        numWrites++;
+    } else {
+        numSkipped++;
+        return;
+    }
+
+    // only keep the flags that affect how the caches handle the access
+    const Request::FlagsType flags = record.flags &
+        (Request::UNCACHEABLE | Request::STRICT_ORDER | Request::SECURE);
+
+    const Addr start = record.addr + addrOffset;
+    const Addr end = start + std::max(record.size, 1U);
+    if (roundDown(start, blockSize) != roundDown(end - 1, blockSize))
+        numSplit++;
+
+    DPRINTF(TracePlayer, "%s %#x size %d\n", cmd.toString(), start,
+            record.size);
+
+    for (Addr addr = start; addr < end; ) {
+        const Addr next = std::min(roundDown(addr, blockSize) + blockSize,
+                                   end);
+        for (auto &port : ports) {
+            auto req = Request::create(addr, next - addr, flags,
+                                       masterId);
+            Packet pkt(req, cmd);
+            pkt.dataStatic(data.data());
+            port->sendAtomic(&pkt);
+        }
+        addr = next;
+    }
+}
+
+void
+TracePlayer::regStats()
+{
+    SimObject::regStats();
+
+    numReads
+        .name(name() + ".num_reads")
+        .desc("Number of reads replayed");
+
+    numWrites
+        .name(name() + ".num_writes")
+        .desc("Number of writes replayed");
+
+    numSkipped
+        .name(name() + ".num_skipped")
+        .desc("Number of records skipped as neither reads nor writes");
+
+    numSplit
+        .name(name() + ".num_split")
+        .desc("Number of records split as they span several lines");
+}
+
+TracePlayer *
+TracePlayerParams::create()
+{
+    return new TracePlayer(this);
+}
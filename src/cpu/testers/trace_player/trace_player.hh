@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_TESTERS_TRACE_PLAYER_TRACE_PLAYER_HH__
+#define __CPU_TESTERS_TRACE_PLAYER_TRACE_PLAYER_HH__
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "mem/port.hh"
+#include "mem/request.hh"
+#include "params/TracePlayer.hh"
+#include "proto/protoio.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+class System;
+
+/**
+ * The TracePlayer replays a packet trace, as written by the
+ * CommMonitor or the MemTraceProbe, in one or more memory systems
+ * without any CPU model. Each access of the trace is sent as an
+ * atomic request through every port, so a single pass over the trace
+ * exercises as many cache hierarchies as there are ports, and their
+ * statistics give the miss curve of the configurations.
+ *
+ * Decoding the trace is left to a host thread that runs ahead of the
+ * replay, and accesses spanning several cache lines are split in one
+ * request per line. Reads and writes are replayed, any other command
+ * in the trace (e.g., evictions recorded below a cache) is skipped.
+ */
+class TracePlayer : public SimObject
+{
+  public:
+
+    typedef TracePlayerParams Params;
+    TracePlayer(const Params *p);
+    ~TracePlayer();
+
+    void startup() override;
+
+    void regStats() override;
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+  protected:
+
+    /** An access of the trace. */
+    struct Record
+    {
+        MemCmd cmd;
+        Addr addr;
+        unsigned size;
+        Tick tick;
+        Request::FlagsType flags;
+    };
+
+    typedef std::vector<Record> Chunk;
+
+    /**
+     * Decodes the trace on a host thread, handing it over in chunks
+     * of records through a bounded queue.
+     */
+    class Reader
+    {
+      public:
+
+        Reader(const std::string &filename, size_t chunk_size,
+               size_t read_ahead);
+        ~Reader();
+
+        /** Start decoding the trace. */
+        void start();
+
+        /**
+         * Get the next chunk of the trace, waiting for it to be
+         * decoded if needed.
+         *
+         * @param chunk Chunk to fill with the next records.
+         * @return False if the end of the trace was reached.
+         */
+        bool next(Chunk &chunk);
+
+      private:
+
+        /** Body of the decoding thread. */
+        void run();
+
+        ProtoInputStream trace;
+        const size_t chunkSize;
+        const size_t readAhead;
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cond;
+        /** Decoded chunks, protected by the mutex. */
+        std::deque<Chunk> chunks;
+        /** Whether the whole trace was decoded. */
+        bool done;
+        /** Tell the decoding thread to stop early. */
+        bool stop;
+    };
+
+    class PlayerPort : public MasterPort
+    {
+      public:
+
+        PlayerPort(const std::string &_name, TracePlayer &_player)
+            : MasterPort(_name, &_player)
+        { }
+
+      protected:
+
+        bool recvTimingResp(PacketPtr pkt) override
+        {
+            panic("%s does not expect timing responses\n", name());
+        }
+
+        void recvReqRetry() override
+        {
+            panic("%s does not expect retries\n", name());
+        }
+
+        void recvTimingSnoopReq(PacketPtr pkt) override { }
+
+        void recvFunctionalSnoop(PacketPtr pkt) override { }
+
+        Tick recvAtomicSnoop(PacketPtr pkt) override { return 0; }
+    };
+
+    /** Replay the current chunk and schedule the next one. */
+    void replay();
+
+    /** Replay a single record through all the ports. */
+    void replayRecord(const Record &record);
+
+    EventFunctionWrapper replayEvent;
+
+    std::vector<std::unique_ptr<PlayerPort>> ports;
+
+    System *system;
+
+    Reader reader;
+
+    /** Chunk being replayed. */
+    Chunk chunk;
+
+    /** Request id for all replayed traffic */
+    MasterID masterId;
+
+    const unsigned blockSize;
+
+    const Addr addrOffset;
+
+    const Counter maxRecords;
+
+    /** Tick at which the replay started. */
+    Tick tickOffset;
+
+    /** Tick of the first record of the trace. */
+    Tick firstTick;
+
+    /** Records replayed so far. */
+    Counter numRecords;
+
+    /** Data of the requests, contents are irrelevant */
+    std::vector<uint8_t> data;
+
+    Stats::Scalar numReads;
+    Stats::Scalar numWrites;
+    Stats::Scalar numSkipped;
+    Stats::Scalar numSplit;
+};
+
+#endif // __CPU_TESTERS_TRACE_PLAYER_TRACE_PLAYER_HH__
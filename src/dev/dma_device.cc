@@ -340,7 +340,7 @@ RequestPtr DmaPort::queueDmaAction(DmaActionReq &dmaReq,
     MemCmd memcmd(dmaReq.cmd);
     for (ChunkGenerator gen(dmaReq.addr, dmaReq.size, sys->cacheLineSize());
          !gen.done(); gen.next()) {
-        req = std::make_shared<Request>(
+        req = Request::create(
             gen.addr(), gen.size(), dmaReq.flag, masterId);
 
         req->setStreamId(dmaReq.sid);
@@ -132,6 +132,18 @@ class SnoopFilter(SimObject):
     # Sanity check on max capacity to track, adjust if needed.
     max_capacity = Param.MemorySize('8MB', "Maximum capacity of snoop filter")
 
+    # By default the snoop filter tracks every line held above it. When
+    # given a number of entries, it is instead organised as a
+    # set-associative structure, and evicting an entry back-invalidates
+    # the line in all the caches that hold it. Dirty copies are written
+    # back past the crossbar on the way out. A bounded filter needs a
+    # replacement policy, e.g. LRURP(), and an unbounded one must not
+    # be given any.
+    entries = Param.Unsigned(0, "Number of lines tracked, 0 for unbounded")
+    assoc = Param.Unsigned(8, "Associativity of a bounded snoop filter")
+    replacement_policy = Param.BaseReplacementPolicy(NULL,
+        "Replacement policy of a bounded snoop filter")
+
 # We use a coherent crossbar to connect multiple masters to the L2
 # caches. Normally this crossbar would be part of the cache itself.
 class L2XBar(CoherentXBar):
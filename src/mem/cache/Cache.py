@@ -41,7 +41,7 @@
 
 from m5.params import *
 from m5.proxy import *
-from m5.SimObject import SimObject
+from m5.SimObject import SimObject, cxxMethod
 
 from m5.objects.ClockedObject import ClockedObject
 from m5.objects.Compressors import BaseCacheCompressor
@@ -144,6 +144,24 @@ class BaseCache(ClockedObject):
     # data cache.
     write_allocator = Param.WriteAllocator(NULL, "Write allocator")
 
+    # In the atomic_warming memory mode, caches are bypassed and the
+    # first-level caches update their state through a direct call
+    # path instead. Misses, upgrades and evictions are propagated to
+    # the cache set here, which should be the cache that the memory
+    # side of this cache is connected to, possibly through a
+    # crossbar. Caches that share the same downstream cache are kept
+    # coherent with each other.
+    warm_downstream = Param.BaseCache(NULL,
+        "Next level cache for functional warming")
+
+    @cxxMethod
+    def tagState(self):
+        """
+        Valid blocks of the cache and their coherence state, one per
+        line in address order.
+        """
+        pass
+
 class Cache(BaseCache):
     type = 'Cache'
     cxx_header = 'mem/cache/cache.hh'
@@ -48,6 +48,9 @@
 
 #include "mem/cache/base.hh"
 
+#include <map>
+#include <utility>
+
 #include "base/compiler.hh"
 #include "base/logging.hh"
 #include "debug/Cache.hh"
@@ -91,6 +94,8 @@ BaseCache::BaseCache(const BaseCacheParams *p, unsigned blk_size)
       writebackTempBlockAtomicEvent([this]{ writebackTempBlockAtomic(); },
                                     name(), false,
                                     EventBase::Delayed_Writeback_Pri),
+      warmDownstream(p->warm_downstream),
+      warmDataStale(false),
       blkSize(blk_size),
       lookupLatency(p->tag_latency),
       dataLatency(p->data_latency),
@@ -185,6 +190,30 @@ BaseCache::init()
         fatal("Cache ports on %s are not connected\n", name());
     cpuSidePort.sendRangeChange();
     forwardSnoops = cpuSidePort.isSnooping();
+
+    if (warmDownstream) {
+        fatal_if(warmDownstream == this,
+                 "%s can't be its own warming downstream cache\n", name());
+        fatal_if(warmDownstream->blkSize != blkSize,
+                 "Block size of %s does not match the one of its warming "
+                 "downstream cache %s\n", name(), warmDownstream->name());
+        warmDownstream->warmUpstream.push_back(this);
+    }
+
+    warmDataStale = system->isWarmingMode();
+}
+
+void
+BaseCache::drainResume()
+{
+    ClockedObject::drainResume();
+
+    // The memory mode can only change while the system is drained
+    if (system->isWarmingMode()) {
+        warmDataStale = true;
+    } else if (warmDataStale) {
+        refreshWarmedData();
+    }
 }
 
 Port &
@@ -453,6 +482,13 @@ BaseCache::recvTimingResp(PacketPtr pkt)
             .mshr_miss_latency[pkt->req->masterId()] += miss_latency;
     }
 
+    if (ppMissDone->hasListeners()) {
+        const RequestPtr &req = initial_tgt->pkt->req;
+        ppMissDone->notify(CacheMissInfo{mshr->blkAddr, req->hasPC(),
+            req->hasPC() ? req->getPC() : 0, req->masterId(), miss_latency,
+            mshrQueue.numAllocated()});
+    }
+
     PacketList writebacks;
 
     bool is_fill = !mshr->isForward &&
@@ -1493,7 +1529,7 @@ BaseCache::writebackBlk(CacheBlk *blk)
 
     stats.writebacks[Request::wbMasterId]++;
 
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         regenerateBlkAddr(blk), blkSize, 0, Request::wbMasterId);
 
     if (blk->isSecure())
@@ -1535,7 +1571,7 @@ BaseCache::writebackBlk(CacheBlk *blk)
 PacketPtr
 BaseCache::writecleanBlk(CacheBlk *blk, Request::Flags dest, PacketId id)
 {
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         regenerateBlkAddr(blk), blkSize, 0, Request::wbMasterId);
 
     if (blk->isSecure()) {
@@ -1581,6 +1617,11 @@ BaseCache::writecleanBlk(CacheBlk *blk, Request::Flags dest, PacketId id)
 void
 BaseCache::memWriteback()
 {
+    // Memory has the up-to-date copy of the data of blocks warmed
+    // while bypassing the cache, so don't write back stale data
+    if (warmDataStale)
+        refreshWarmedData();
+
     tags->forEachBlk([this](CacheBlk &blk) { writebackVisitor(blk); });
 }
 
@@ -1608,7 +1649,7 @@ BaseCache::writebackVisitor(CacheBlk &blk)
     if (blk.isDirty()) {
         assert(blk.isValid());
 
-        RequestPtr request = std::make_shared<Request>(
+        RequestPtr request = Request::create(
             regenerateBlkAddr(&blk), blkSize, 0, Request::funcMasterId);
 
         request->taskId(blk.task_id);
@@ -1638,6 +1679,263 @@ BaseCache::invalidateVisitor(CacheBlk &blk)
     }
 }
 
+/////////////////////////////////////////////////////
+//
+// Functional warming: packet-less access path used when the system
+// is in the atomic_warming memory mode
+//
+/////////////////////////////////////////////////////
+
+void
+BaseCache::warmAccess(Addr addr, bool is_secure, bool is_write,
+                      MasterID master_id)
+{
+    assert(!isReadOnly || !is_write);
+    addr &= ~Addr(blkSize - 1);
+
+    Cycles lat;
+    CacheBlk *blk = tags->accessBlock(addr, is_secure, lat);
+    if (blk && (!is_write || blk->isWritable())) {
+        if (is_write)
+            blk->status |= BlkDirty;
+        return;
+    }
+
+    // Miss or upgrade, ask the next level
+    const WarmFill fill = warmFetch(addr, is_secure, is_write, master_id);
+    if (!blk) {
+        blk = warmAllocate(addr, is_secure, master_id);
+        if (!blk)
+            return;
+    }
+
+    if (fill.writable)
+        blk->status |= BlkWritable;
+    if (fill.dirty || is_write) {
+        assert(blk->isWritable() || !is_write);
+        blk->status |= BlkDirty;
+    }
+
+    DPRINTF(CacheVerbose, "%s: %#llx (%s) %s warmed to %s\n", __func__, addr,
+            is_secure ? "s" : "ns", is_write ? "write" : "read",
+            blk->print());
+}
+
+void
+BaseCache::warm(const WarmAccess *accesses, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const WarmAccess &access = accesses[i];
+        warmAccess(access.addr, access.isSecure, access.isWrite,
+                   access.masterId);
+    }
+}
+
+std::string
+BaseCache::tagState()
+{
+    std::map<std::pair<Addr, bool>, std::string> blocks;
+    tags->forEachBlk([this, &blocks](CacheBlk &blk) {
+        if (blk.isValid()) {
+            blocks[std::make_pair(regenerateBlkAddr(&blk), blk.isSecure())] =
+                csprintf("%s%s", blk.isWritable() ? "W" : "-",
+                         blk.isDirty() ? "D" : "-");
+        }
+    });
+
+    std::string str;
+    for (const auto &blk : blocks) {
+        str += csprintf("%#x %s %s\n", blk.first.first,
+                        blk.first.second ? "s" : "ns", blk.second);
+    }
+    return str;
+}
+
+BaseCache::WarmFill
+BaseCache::warmFetch(Addr addr, bool is_secure, bool need_writable,
+                     MasterID master_id)
+{
+    if (warmDownstream) {
+        return warmDownstream->warmServe(this, addr, is_secure,
+                                         need_writable, master_id);
+    }
+
+    // Memory hands out exclusive copies
+    return WarmFill{true, false};
+}
+
+BaseCache::WarmFill
+BaseCache::warmServe(BaseCache *requester, Addr addr, bool is_secure,
+                     bool need_writable, MasterID master_id)
+{
+    // Snoop the other branches first, like the crossbar between the
+    // requester and this cache would. Dirty data of an invalidated
+    // copy is passed on to the requester.
+    bool has_sharers = false;
+    bool snoop_dirty = false;
+    for (auto cache : warmUpstream) {
+        if (cache != requester) {
+            has_sharers |= cache->warmSnoop(addr, is_secure, need_writable,
+                                            snoop_dirty);
+        }
+    }
+
+    Cycles lat;
+    CacheBlk *blk = tags->accessBlock(addr, is_secure, lat);
+    if (!blk || (need_writable && !blk->isWritable())) {
+        const WarmFill below = warmFetch(addr, is_secure, need_writable,
+                                         master_id);
+
+        // Mostly exclusive caches don't allocate on fills from an
+        // upstream cache
+        if (!blk && clusivity == Enums::mostly_incl)
+            blk = warmAllocate(addr, is_secure, master_id);
+
+        if (!blk) {
+            return WarmFill{below.writable && !has_sharers,
+                            below.dirty || snoop_dirty};
+        }
+
+        if (below.writable)
+            blk->status |= BlkWritable;
+        if (below.dirty)
+            blk->status |= BlkDirty;
+    }
+
+    // Read-only caches ask for clean copies, which are always shared
+    WarmFill fill{false, snoop_dirty};
+    if (need_writable ||
+        (blk->isWritable() && !has_sharers && !requester->isReadOnly)) {
+        // The requester gets the block exclusively, together with
+        // the ownership of our dirty data. As the block may only get
+        // dirty again through the requester, we keep it writable.
+        fill.writable = true;
+        fill.dirty |= blk->isDirty();
+        blk->status &= ~BlkDirty;
+    }
+
+    // Mostly exclusive caches drop clean blocks moved upwards
+    if (clusivity == Enums::mostly_excl && !blk->isDirty())
+        invalidateBlock(blk);
+
+    return fill;
+}
+
+bool
+BaseCache::warmSnoop(Addr addr, bool is_secure, bool invalidate, bool &dirty)
+{
+    bool found = false;
+    for (auto cache : warmUpstream)
+        found |= cache->warmSnoop(addr, is_secure, invalidate, dirty);
+
+    CacheBlk *blk = tags->findBlock(addr, is_secure);
+    if (blk) {
+        found = true;
+        if (invalidate) {
+            dirty |= blk->isDirty();
+            invalidateBlock(blk);
+        } else {
+            // A dirty block stays behind in the owned state
+            blk->status &= ~BlkWritable;
+        }
+    }
+
+    return found;
+}
+
+void
+BaseCache::warmWriteback(Addr addr, bool is_secure, bool writable,
+                         bool dirty, MasterID master_id)
+{
+    Cycles lat;
+    CacheBlk *blk = tags->accessBlock(addr, is_secure, lat);
+    if (!blk) {
+        blk = warmAllocate(addr, is_secure, master_id);
+        if (!blk) {
+            // Pass the writeback on if we can't allocate
+            if (warmDownstream && (dirty || writebackClean)) {
+                warmDownstream->warmWriteback(addr, is_secure, writable,
+                                              dirty, master_id);
+            }
+            return;
+        }
+    }
+
+    if (writable)
+        blk->status |= BlkWritable;
+    if (dirty)
+        blk->status |= BlkDirty;
+}
+
+CacheBlk*
+BaseCache::warmAllocate(Addr addr, bool is_secure, MasterID master_id)
+{
+    // Data is not tracked, so blocks are always inserted uncompressed
+    const std::size_t blk_size_bits = blkSize * 8;
+
+    warmEvictBlks.clear();
+    CacheBlk *victim = tags->findVictim(addr, is_secure, blk_size_bits,
+                                        warmEvictBlks);
+    if (!victim)
+        return nullptr;
+
+    for (auto blk : warmEvictBlks) {
+        if (!blk->isValid())
+            continue;
+
+        if (warmDownstream && (blk->isDirty() || writebackClean)) {
+            warmDownstream->warmWriteback(regenerateBlkAddr(blk),
+                                          blk->isSecure(),
+                                          blk->isWritable(),
+                                          blk->isDirty(),
+                                          blk->srcMasterId);
+        }
+        invalidateBlock(blk);
+    }
+
+    if (compressor)
+        compressor->setSizeBits(victim, blk_size_bits);
+
+    tags->insertBlock(addr, is_secure, master_id,
+                      ContextSwitchTaskId::Unknown, victim);
+    victim->status |= BlkReadable;
+
+    return victim;
+}
+
+void
+BaseCache::refreshWarmedData()
+{
+    DPRINTF(Cache, "Refreshing data of warmed blocks from memory\n");
+
+    PhysicalMemory &physmem = system->getPhysMem();
+    tags->forEachBlk([this, &physmem](CacheBlk &blk) {
+        if (!blk.isValid())
+            return;
+
+        const Addr addr = regenerateBlkAddr(&blk);
+        if (!system->isMemAddr(addr)) {
+            // Only memory is guaranteed to be up to date
+            assert(!blk.isDirty());
+            invalidateBlock(&blk);
+            return;
+        }
+
+        RequestPtr request = Request::create(
+            addr, blkSize, 0, Request::funcMasterId);
+        if (blk.isSecure()) {
+            request->setFlags(Request::SECURE);
+        }
+
+        Packet packet(request, MemCmd::ReadReq);
+        packet.dataStatic(blk.data);
+        physmem.functionalAccess(&packet);
+    });
+
+    // Keep refreshing until the system leaves the warming mode
+    warmDataStale = system->isWarmingMode();
+}
+
 Tick
 BaseCache::nextQueueReadyTime() const
 {
@@ -2278,6 +2576,8 @@ BaseCache::regProbePoints()
     ppHit = new ProbePointArg<PacketPtr>(this->getProbeManager(), "Hit");
     ppMiss = new ProbePointArg<PacketPtr>(this->getProbeManager(), "Miss");
     ppFill = new ProbePointArg<PacketPtr>(this->getProbeManager(), "Fill");
+    ppMissDone = new ProbePointArg<CacheMissInfo>(this->getProbeManager(),
+                                                  "MissDone");
 }
 
 ///////////////
@@ -2336,6 +2636,16 @@ Tick
 BaseCache::CpuSidePort::recvAtomic(PacketPtr pkt)
 {
     if (cache->system->bypassCaches()) {
+        // In warming mode, the first-level caches pass the address of
+        // every cacheable access through the hierarchy before the
+        // request skips it.
+        if (cache->system->isWarmingMode() && cache->warmUpstream.empty() &&
+            !pkt->req->isUncacheable() && (pkt->isRead() || pkt->isWrite())) {
+            cache->warmAccess(pkt->getBlockAddr(cache->blkSize),
+                              pkt->isSecure(), pkt->needsWritable(),
+                              pkt->req->masterId());
+        }
+
         // Forward the request if the system is in cache bypass mode.
         return cache->memSidePort.sendAtomic(pkt);
     } else {
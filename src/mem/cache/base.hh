@@ -87,6 +87,26 @@ class MasterPort;
 class QueueEntry;
 struct BaseCacheParams;
 
+/**
+ * Information about a serviced miss, as notified by the MissDone probe
+ * point of the caches.
+ */
+struct CacheMissInfo
+{
+    /** Block address of the miss. */
+    Addr addr;
+    /** Whether the access that caused the miss has a PC. */
+    bool hasPC;
+    /** PC of the access that caused the miss, if any. */
+    Addr pc;
+    /** Id of the master that caused the miss. */
+    MasterID masterId;
+    /** Ticks between the arrival of the miss and its response. */
+    Tick latency;
+    /** Number of MSHRs in use when the response arrived. */
+    int mshrOccupancy;
+};
+
 /**
  * A basic cache interface. Implements some common functions for speed.
  */
@@ -338,6 +358,9 @@ class BaseCache : public ClockedObject
     /** To probe when a cache fill occurs */
     ProbePointArg<PacketPtr> *ppFill;
 
+    /** To probe when the response to a miss is received */
+    ProbePointArg<CacheMissInfo> *ppMissDone;
+
     /**
      * The writeAllocator drive optimizations for streaming writes.
      * It first determines whether a WriteReq MSHR should be delayed,
@@ -657,6 +680,101 @@ class BaseCache : public ClockedObject
      */
     EventFunctionWrapper writebackTempBlockAtomicEvent;
 
+    /**
+     * @{
+     * @name Functional warming
+     *
+     * In the atomic_warming memory mode, packets bypass the caches
+     * and the first-level caches instead pass the address of every
+     * access down the hierarchy through direct calls. Only tags,
+     * replacement and coherence state are kept up to date; the data
+     * of the valid blocks is refreshed from memory when the system
+     * leaves the warming mode.
+     */
+
+    /** Coherence state handed to a cache by a warming fill. */
+    struct WarmFill
+    {
+        /** The block may be written without an upgrade. */
+        bool writable;
+        /** Ownership of dirty data is passed with the block. */
+        bool dirty;
+    };
+
+    /** Next level cache for functional warming, if any. */
+    BaseCache *warmDownstream;
+
+    /** Caches having this cache as their warming downstream cache. */
+    std::vector<BaseCache*> warmUpstream;
+
+    /**
+     * Whether the data of the blocks may be out of date since the
+     * cache was bypassed in warming mode.
+     */
+    bool warmDataStale;
+
+    /** Scratch list of the blocks evicted by a warming allocation. */
+    std::vector<CacheBlk*> warmEvictBlks;
+
+    /**
+     * Get a block from the next level for a warming miss or
+     * upgrade. Without a downstream cache, the block comes from
+     * memory and is always writable.
+     */
+    WarmFill warmFetch(Addr addr, bool is_secure, bool need_writable,
+                       MasterID master_id);
+
+    /**
+     * Serve a warming miss or upgrade of one of the upstream caches,
+     * snooping the other upstream caches first.
+     *
+     * @param requester The upstream cache missing on the block.
+     * @param addr Block address.
+     * @param is_secure Whether the block is in secure space or not.
+     * @param need_writable Whether the requester wants to write.
+     * @param master_id Master that caused the access.
+     * @return The state the requester gets the block in.
+     */
+    WarmFill warmServe(BaseCache *requester, Addr addr, bool is_secure,
+                       bool need_writable, MasterID master_id);
+
+    /**
+     * Snoop this cache and its upstream caches for a warming access
+     * of another branch of the hierarchy.
+     *
+     * @param addr Block address.
+     * @param is_secure Whether the block is in secure space or not.
+     * @param invalidate Invalidate the copies, otherwise only take
+     *                   away their write permission.
+     * @param dirty Set if an invalidated copy was dirty.
+     * @return True if a copy of the block was found.
+     */
+    bool warmSnoop(Addr addr, bool is_secure, bool invalidate, bool &dirty);
+
+    /**
+     * Handle a block evicted by a warming allocation of an upstream
+     * cache, mirroring what a writeback packet would do.
+     */
+    void warmWriteback(Addr addr, bool is_secure, bool writable, bool dirty,
+                       MasterID master_id);
+
+    /**
+     * Allocate a block for a warming fill. The evicted blocks are
+     * passed to the downstream cache if they would have been written
+     * back.
+     *
+     * @return The new block, readable but otherwise without
+     *         permissions, or nullptr if there is no victim.
+     */
+    CacheBlk *warmAllocate(Addr addr, bool is_secure, MasterID master_id);
+
+    /**
+     * Read the data of all valid blocks from memory, which is up to
+     * date after running in warming mode.
+     */
+    void refreshWarmedData();
+    /** @} */
+
     /**
      * When a block is overwriten, its compression information must be updated,
      * and it may need to be recompressed. If the compression size changes, the
@@ -1083,6 +1201,8 @@ class BaseCache : public ClockedObject
 
     void init() override;
 
+    void drainResume() override;
+
     Port &getPort(const std::string &if_name,
                   PortID idx=InvalidPortID) override;
 
@@ -1245,6 +1365,45 @@ class BaseCache : public ClockedObject
      */
     bool coalesce() const;
 
+    /** An access of an address stream used for functional warming. */
+    struct WarmAccess
+    {
+        Addr addr;
+        bool isSecure;
+        bool isWrite;
+        MasterID masterId;
+    };
+
+    /**
+     * Functionally warm the cache hierarchy with a single access,
+     * updating tags, replacement and coherence state of this cache
+     * and of the caches below without creating any packets.
+     *
+     * @param addr Address of the access.
+     * @param is_secure Whether the access is in secure space or not.
+     * @param is_write Whether the access needs write permission.
+     * @param master_id Master performing the access.
+     */
+    void warmAccess(Addr addr, bool is_secure, bool is_write,
+                    MasterID master_id);
+
+    /**
+     * Functionally warm the cache hierarchy with a batch of accesses,
+     * e.g., the address stream of a CPU that skips the memory system.
+     *
+     * @param accesses Accesses to perform in order.
+     * @param count Number of accesses.
+     */
+    void warm(const WarmAccess *accesses, size_t count);
+
+    /**
+     * Describe the valid blocks of the cache and their coherence
+     * state, one block per line in address order. This allows the
+     * state reached through different memory modes to be compared.
+     *
+     * @return Address, security and state of every valid block.
+     */
+    std::string tagState();
 
     /**
      * Cache block visitor that writes back dirty cache blocks using
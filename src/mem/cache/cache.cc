@@ -378,10 +378,10 @@ Cache::handleTimingReqMiss(PacketPtr pkt, CacheBlk *blk, Tick forward_time,
 
         if (!mshr) {
             // copy the request and create a new SoftPFReq packet
-            RequestPtr req = std::make_shared<Request>(pkt->req->getPaddr(),
-                                                       pkt->req->getSize(),
-                                                       pkt->req->getFlags(),
-                                                       pkt->req->masterId());
+            RequestPtr req = Request::create(pkt->req->getPaddr(),
+                                             pkt->req->getSize(),
+                                             pkt->req->getFlags(),
+                                             pkt->req->masterId());
             pf = new Packet(req, pkt->cmd);
             pf->allocate();
             assert(pf->matchAddr(pkt));
@@ -919,7 +919,7 @@ Cache::cleanEvictBlk(CacheBlk *blk)
     assert(blk && blk->isValid() && !blk->isDirty());
 
     // Creating a zero sized write, a message to the snoop filter
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         regenerateBlkAddr(blk), blkSize, 0, Request::wbMasterId);
 
     if (blk->isSecure())
@@ -1065,6 +1065,14 @@ Cache::handleSnoop(PacketPtr pkt, CacheBlk *blk, bool is_timing,
             DPRINTF(CacheVerbose, "%s: packet (snoop) %s found block: %s\n",
                     __func__, pkt->print(), blk->print());
             PacketPtr wb_pkt = writecleanBlk(blk, pkt->req->getDest(), pkt->id);
+            if (pkt->cmd == MemCmd::BackInvalidateReq &&
+                pkt->isExpressSnoop()) {
+                // The back-invalidation was forwarded by a cache below,
+                // which is losing its copy too. The data has to be
+                // written through it, as it would otherwise end up
+                // holding a dirty block the snoop filter doesn't track.
+                wb_pkt->setWriteThrough();
+            }
             PacketList writebacks;
             writebacks.push_back(wb_pkt);
 
@@ -1086,11 +1094,13 @@ Cache::handleSnoop(PacketPtr pkt, CacheBlk *blk, bool is_timing,
             // we no longer have the block, and will not respond, but a
             // packet was allocated in MSHR::handleSnoop and we have
             // to delete it
-            assert(pkt->needsResponse());
+            if (pkt->cmd != MemCmd::BackInvalidateReq) {
+                assert(pkt->needsResponse());
 
-            // we have passed the block to a cache upstream, that
-            // cache should be responding
-            assert(pkt->cacheResponding());
+                // we have passed the block to a cache upstream, that
+                // cache should be responding
+                assert(pkt->cacheResponding());
+            }
 
             delete pkt;
         }
@@ -1183,7 +1193,7 @@ Cache::handleSnoop(PacketPtr pkt, CacheBlk *blk, bool is_timing,
     }
 
     if (!respond && is_deferred) {
-        assert(pkt->needsResponse());
+        assert(pkt->needsResponse() || pkt->cmd == MemCmd::BackInvalidateReq);
         delete pkt;
     }
 
@@ -1295,7 +1305,24 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
                                    false, false);
         }
 
-        if (invalidate && wb_pkt->cmd != MemCmd::WriteClean) {
+        if (pkt->cmd == MemCmd::BackInvalidateReq) {
+            // A back-invalidation from the snoop filter directly below
+            // lets the writeback through, as the caches below it are
+            // not tracked by the filter. One forwarded by a cache
+            // below must get past that cache, which is losing its copy
+            // too, so dirty data is written through instead.
+            if (pkt->isExpressSnoop()) {
+                if (wb_pkt->cmd == MemCmd::WritebackDirty) {
+                    wb_pkt->cmd = MemCmd::WriteClean;
+                }
+                if (wb_pkt->cmd == MemCmd::WriteClean) {
+                    wb_pkt->setWriteThrough();
+                } else {
+                    markInService(wb_entry);
+                    delete wb_pkt;
+                }
+            }
+        } else if (invalidate && wb_pkt->cmd != MemCmd::WriteClean) {
             // Invalidation trumps our writeback... discard here
             // Note: markInService will remove entry from writeback buffer.
             markInService(wb_entry);
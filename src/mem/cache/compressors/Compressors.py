@@ -40,6 +40,14 @@ class BaseCacheCompressor(SimObject):
         "in bytes, in which a block must be compressed to. Otherwise it is "
         "stored in its uncompressed state")
 
+    # Lines are often filled with the same contents over and over (e.g.,
+    # zeroed pages). Their compression results can be kept in a small
+    # direct-mapped table so that they are not compressed again. Lines
+    # that hit in the table are not accounted for in the pattern and
+    # ranking stats of the compressors.
+    memo_size = Param.Unsigned(0, "Number of entries of the table of "
+        "recently compressed lines (0 disables it)")
+
 class BaseDictionaryCompressor(BaseCacheCompressor):
     type = 'BaseDictionaryCompressor'
     abstract = True
@@ -37,9 +37,11 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "debug/CacheComp.hh"
+#include "mem/cache/compressors/kernels.hh"
 #include "mem/cache/tags/super_blk.hh"
 #include "params/BaseCacheCompressor.hh"
 
@@ -75,35 +77,80 @@ BaseCacheCompressor::CompressionData::getSize() const
 
 BaseCacheCompressor::BaseCacheCompressor(const Params *p)
   : SimObject(p), blkSize(p->block_size), sizeThreshold(p->size_threshold),
+    memo(p->memo_size), memoData(p->memo_size * (p->block_size / 8)),
     stats(*this)
 {
     fatal_if(blkSize < sizeThreshold, "Compressed data must fit in a block");
+    fatal_if(blkSize % 8, "Block size must be a multiple of 8 bytes");
+}
+
+std::size_t
+BaseCacheCompressor::getCompressedSizeBits(const uint64_t* cache_line,
+    Cycles& comp_lat, Cycles& decomp_lat)
+{
+    return compress(cache_line, comp_lat, decomp_lat)->getSizeBits();
 }
 
 void
 BaseCacheCompressor::compress(const uint64_t* data, Cycles& comp_lat,
                               Cycles& decomp_lat, std::size_t& comp_size_bits)
 {
-    // Apply compression
-    std::unique_ptr<CompressionData> comp_data =
-        compress(data, comp_lat, decomp_lat);
+    const std::size_t num_qwords = blkSize / 8;
+
+    // Look for the line in the table of recently compressed lines
+    MemoEntry* memo_entry = nullptr;
+    uint64_t* memo_data = nullptr;
+    uint64_t hash = 0;
+    if (!memo.empty()) {
+        hash = CompressionKernels::hashLine(data, num_qwords);
+        const std::size_t index = hash % memo.size();
+        memo_entry = &memo[index];
+        memo_data = &memoData[index * num_qwords];
+    }
+
+    if (memo_entry && memo_entry->valid && (memo_entry->hash == hash) &&
+        (std::memcmp(memo_data, data, blkSize) == 0)) {
+        stats.memoHits++;
+        comp_size_bits = memo_entry->sizeBits;
+        comp_lat = memo_entry->compLat;
+        decomp_lat = memo_entry->decompLat;
+    } else {
+        // Apply compression
+        comp_size_bits = getCompressedSizeBits(data, comp_lat, decomp_lat);
+
+        if (memo_entry) {
+            memo_entry->valid = true;
+            memo_entry->hash = hash;
+            memo_entry->sizeBits = comp_size_bits;
+            memo_entry->compLat = comp_lat;
+            memo_entry->decompLat = decomp_lat;
+            std::memcpy(memo_data, data, blkSize);
+        }
+    }
 
     // If we are in debug mode apply decompression just after the compression.
     // If the results do not match, we've got an error
     #ifdef DEBUG_COMPRESSION
     uint64_t decomp_data[blkSize/8];
 
-    // Apply decompression
+    // Apply compression and decompression
+    Cycles full_comp_lat, full_decomp_lat;
+    std::unique_ptr<CompressionData> comp_data =
+        compress(data, full_comp_lat, full_decomp_lat);
     decompress(comp_data.get(), decomp_data);
 
     // Check if decompressed line matches original cache line
     fatal_if(std::memcmp(data, decomp_data, blkSize),
              "Decompressed line does not match original line.");
+
+    // Check that the results of the full compression are the same
+    fatal_if(comp_data->getSizeBits() != comp_size_bits ||
+             full_comp_lat != comp_lat || full_decomp_lat != decomp_lat,
+             "Compressed size does not match full compression.");
     #endif
 
     // Get compression size. If compressed size is greater than the size
     // threshold, the compression is seen as unsuccessful
-    comp_size_bits = comp_data->getSizeBits();
     if (comp_size_bits >= sizeThreshold * 8) {
         comp_size_bits = blkSize * 8;
     }
@@ -169,7 +216,10 @@ BaseCacheCompressor::BaseCacheCompressorStats::BaseCacheCompressorStats(
     avgCompressionSizeBits(this, "avg_compression_size_bits",
         "Average compression size, in bits"),
     decompressions(this, "total_decompressions",
-        "Total number of decompressions")
+        "Total number of decompressions"),
+    memoHits(this, "memo_hits",
+        "Number of compressions that reused the results of an identical "
+        "line")
 {
 }
 
@@ -188,5 +238,7 @@ BaseCacheCompressor::BaseCacheCompressorStats::regStats()
 
     avgCompressionSizeBits.flags(Stats::total | Stats::nozero | Stats::nonan);
     avgCompressionSizeBits = compressionSizeBits / compressions;
+
+    memoHits.flags(Stats::nozero);
 }
 
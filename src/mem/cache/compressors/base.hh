@@ -39,6 +39,7 @@
 #define __MEM_CACHE_COMPRESSORS_BASE_HH__
 
 #include <cstdint>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "base/types.hh"
@@ -77,6 +78,28 @@ class BaseCacheCompressor : public SimObject
      */
     const std::size_t sizeThreshold;
 
+    /**
+     * An entry of the table of recently compressed lines. Lines whose
+     * contents match an entry reuse its results instead of being
+     * compressed again.
+     */
+    struct MemoEntry
+    {
+        bool valid = false;
+        /** Hash of the contents of the line. */
+        uint64_t hash = 0;
+        /** Results of the compression of the line. */
+        std::size_t sizeBits = 0;
+        Cycles compLat;
+        Cycles decompLat;
+    };
+
+    /** Direct-mapped table of recently compressed lines. */
+    std::vector<MemoEntry> memo;
+
+    /** Contents of the lines in the memo table, blkSize bytes per entry. */
+    std::vector<uint64_t> memoData;
+
     struct BaseCacheCompressorStats : public Stats::Group
     {
         const BaseCacheCompressor& compressor;
@@ -99,6 +122,9 @@ class BaseCacheCompressor : public SimObject
 
         /** Number of decompressions performed. */
         Stats::Scalar decompressions;
+
+        /** Number of compressions whose results were memoized. */
+        Stats::Scalar memoHits;
     } stats;
 
     /**
@@ -125,6 +151,21 @@ class BaseCacheCompressor : public SimObject
     virtual void decompress(const CompressionData* comp_data,
                               uint64_t* cache_line) = 0;
 
+    /**
+     * Get the size of the cache line after compression, without building
+     * its compressed representation. Latencies and compressor specific
+     * stats must be the same as the ones of compress(). By default a full
+     * compression is performed; compressors that can derive the size
+     * faster should override it.
+     *
+     * @param cache_line The cache line to be compressed.
+     * @param comp_lat Compression latency in number of cycles.
+     * @param decomp_lat Decompression latency in number of cycles.
+     * @return Compressed data size, in bits.
+     */
+    virtual std::size_t getCompressedSizeBits(const uint64_t* cache_line,
+        Cycles& comp_lat, Cycles& decomp_lat);
+
   public:
     /** Convenience typedef. */
      typedef BaseCacheCompressorParams Params;
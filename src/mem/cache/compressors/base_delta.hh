@@ -119,6 +119,9 @@ class BaseDelta : public DictionaryCompressor<BaseType>
     compress(const uint64_t* data, Cycles& comp_lat,
         Cycles& decomp_lat) override;
 
+    std::size_t getCompressedSizeBits(const uint64_t* data, Cycles& comp_lat,
+        Cycles& decomp_lat) override;
+
   public:
     typedef BaseDictionaryCompressorParams Params;
     BaseDelta(const Params *p);
@@ -38,6 +38,7 @@
 #include "debug/CacheComp.hh"
 #include "mem/cache/compressors/base_delta.hh"
 #include "mem/cache/compressors/dictionary_compressor_impl.hh"
+#include "mem/cache/compressors/kernels.hh"
 
 template <class BaseType, std::size_t DeltaSizeBits>
 BaseDelta<BaseType, DeltaSizeBits>::BaseDelta(const Params *p)
@@ -100,4 +101,43 @@ BaseDelta<BaseType, DeltaSizeBits>::compress(const uint64_t* data,
     return comp_data;
 }
 
+template <class BaseType, std::size_t DeltaSizeBits>
+std::size_t
+BaseDelta<BaseType, DeltaSizeBits>::getCompressedSizeBits(
+    const uint64_t* data, Cycles& comp_lat, Cycles& decomp_lat)
+{
+    const std::size_t blk_size = DictionaryCompressor<BaseType>::blkSize;
+    const std::size_t num_values = blk_size / sizeof(BaseType);
+
+    // Every value that does not fit a delta of the existing bases is a
+    // no-match pattern, which becomes a new base
+    const std::size_t num_bases = CompressionKernels::countBases(
+        reinterpret_cast<const BaseType*>(data), num_values, DeltaSizeBits);
+    this->patternStats[X] += num_bases;
+    this->patternStats[M] += num_values - num_bases;
+
+    // A match costs the base index and the delta, and a no-match also
+    // stores the new base. Unused bases are accounted as if they were
+    // stored, so the size is the same with zero or one new bases
+    std::size_t size_bits;
+    if (num_bases + 1 > DEFAULT_MAX_NUM_BASES) {
+        size_bits = blk_size * 8;
+        DPRINTF(CacheComp, "Base%dDelta%d compression failed\n",
+            8 * sizeof(BaseType), DeltaSizeBits);
+    } else {
+        size_bits = num_values *
+            (std::ceil(std::log2(DEFAULT_MAX_NUM_BASES)) + DeltaSizeBits) +
+            8 * sizeof(BaseType) * (DEFAULT_MAX_NUM_BASES - 1);
+    }
+
+    // Set compression latency (Assumes 1 cycle per entry and 1 cycle for
+    // packing)
+    comp_lat = Cycles(1 + num_values);
+
+    // Set decompression latency
+    decomp_lat = Cycles(1);
+
+    return size_bits;
+}
+
 #endif //__MEM_CACHE_COMPRESSORS_BASE_DELTA_IMPL_HH__
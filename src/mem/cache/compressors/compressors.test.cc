@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/cache/compressors/base_delta_impl.hh"
+#include "mem/cache/compressors/repeated_qwords.hh"
+#include "mem/cache/compressors/zero.hh"
+#include "params/Base16Delta8.hh"
+#include "params/Base32Delta16.hh"
+#include "params/Base32Delta8.hh"
+#include "params/Base64Delta16.hh"
+#include "params/Base64Delta32.hh"
+#include "params/Base64Delta8.hh"
+#include "params/RepeatedQwordsCompressor.hh"
+#include "params/ZeroCompressor.hh"
+
+namespace {
+
+const std::size_t blkSize = 64;
+
+/** Give access to both compression paths and the pattern stats */
+template <class Compressor>
+class TestCompressor : public Compressor
+{
+  public:
+    using Compressor::Compressor;
+    using Compressor::compress;
+    using Compressor::getCompressedSizeBits;
+
+    Stats::VCounter
+    patterns() const
+    {
+        Stats::VCounter counts;
+        this->patternStats.value(counts);
+        return counts;
+    }
+};
+
+/**
+ * Create a compressor and register its stats. Registered stats can't
+ * be destroyed, so the compressor is never freed.
+ */
+template <class Compressor>
+TestCompressor<Compressor> *
+makeCompressor(const std::string &name)
+{
+    typename Compressor::Params p;
+    p.name = name;
+    p.eventq_index = 0;
+    p.block_size = blkSize;
+    p.size_threshold = blkSize;
+    p.memo_size = 0;
+    p.dictionary_size = blkSize;
+    auto compressor = new TestCompressor<Compressor>(&p);
+    compressor->regStats();
+    return compressor;
+}
+
+/**
+ * Lines that compress with each of the compressors, lines that only
+ * partly compress, and lines that don't compress at all.
+ */
+std::vector<std::vector<uint64_t>>
+fixtures()
+{
+    const std::size_t num_qwords = blkSize / 8;
+    std::vector<std::vector<uint64_t>> lines;
+
+    // All zero, a single set bit, and a repeated qword
+    lines.emplace_back(num_qwords, 0);
+    lines.emplace_back(num_qwords, 0);
+    lines.back()[5] = 1ULL << 40;
+    lines.emplace_back(num_qwords, 0xDEADBEEFCAFEF00DULL);
+    lines.emplace_back(num_qwords, 0xDEADBEEFCAFEF00DULL);
+    lines.back()[0] = 0;
+
+    // Pointers into the same region, small integers, and values
+    // around a few bases of every size
+    std::vector<uint64_t> pointers, integers, wide, narrow;
+    for (std::size_t i = 0; i < num_qwords; i++) {
+        pointers.push_back(0x7FFF12340000ULL + 24 * i);
+        integers.push_back(i * 3);
+        wide.push_back((i % 2 ? 0x100000000ULL : 0x900000000ULL) + i);
+        narrow.push_back(0x0102010301040105ULL + i * 0x0001000100010001ULL);
+    }
+    lines.push_back(pointers);
+    lines.push_back(integers);
+    lines.push_back(wide);
+    lines.push_back(narrow);
+
+    // Clusters of close values, as in kernels.test.cc, and noise
+    std::mt19937_64 rng(0xC0FFEE);
+    for (int i = 0; i < 200; i++) {
+        std::vector<uint64_t> line(num_qwords);
+        const uint64_t bases[] = { 0, rng(), rng() };
+        const unsigned noise = i % 5;
+        for (auto &qword : line) {
+            if (rng() % 8 < noise) {
+                qword = rng();
+            } else {
+                qword = bases[rng() % 3] + (rng() % 512) - 256;
+            }
+        }
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+/**
+ * Compress every fixture with the full compression of one compressor
+ * and with the size-only path of another one, and check that sizes,
+ * latencies and pattern stats match.
+ */
+template <class Compressor>
+void
+checkSizeOnly(const std::string &name, bool compresses = true)
+{
+    auto full = makeCompressor<Compressor>(name + ".full");
+    auto size_only = makeCompressor<Compressor>(name + ".size_only");
+
+    std::size_t compressed = 0;
+    for (const auto &line : fixtures()) {
+        Cycles full_comp_lat, full_decomp_lat;
+        const std::size_t full_size = full->compress(line.data(),
+            full_comp_lat, full_decomp_lat)->getSizeBits();
+
+        Cycles comp_lat, decomp_lat;
+        const std::size_t size = size_only->getCompressedSizeBits(
+            line.data(), comp_lat, decomp_lat);
+
+        EXPECT_EQ(full_size, size);
+        EXPECT_EQ(full_comp_lat, comp_lat);
+        EXPECT_EQ(full_decomp_lat, decomp_lat);
+        if (full_size < blkSize * 8)
+            compressed++;
+    }
+
+    // The fixtures exercise both outcomes
+    if (compresses) {
+        EXPECT_GT(compressed, 0U);
+    }
+    EXPECT_EQ(full->patterns(), size_only->patterns());
+}
+
+} // anonymous namespace
+
+TEST(CompressorSizeTest, Zero)
+{
+    checkSizeOnly<ZeroCompressor>("Zero");
+}
+
+TEST(CompressorSizeTest, RepeatedQwords)
+{
+    // Repeated qwords take a dictionary entry each, as do the other
+    // qwords, so the compression never succeeds. The size-only path
+    // must reproduce that too.
+    checkSizeOnly<RepeatedQwordsCompressor>("RepeatedQwords", false);
+}
+
+TEST(CompressorSizeTest, Base64Delta8)
+{
+    checkSizeOnly<Base64Delta8>("Base64Delta8");
+}
+
+TEST(CompressorSizeTest, Base64Delta16)
+{
+    checkSizeOnly<Base64Delta16>("Base64Delta16");
+}
+
+TEST(CompressorSizeTest, Base64Delta32)
+{
+    checkSizeOnly<Base64Delta32>("Base64Delta32");
+}
+
+TEST(CompressorSizeTest, Base32Delta8)
+{
+    checkSizeOnly<Base32Delta8>("Base32Delta8");
+}
+
+TEST(CompressorSizeTest, Base32Delta16)
+{
+    checkSizeOnly<Base32Delta16>("Base32Delta16");
+}
+
+TEST(CompressorSizeTest, Base16Delta8)
+{
+    checkSizeOnly<Base16Delta8>("Base16Delta8");
+}
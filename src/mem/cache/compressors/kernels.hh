@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * Data-parallel kernels used by the compressors to find the compressed
+ * size of a line without building its compressed representation.
+ *
+ * The kernels use the generic vector extensions of the compiler, which
+ * are lowered to the SIMD instructions of the host when there are any.
+ * Every kernel has a scalar reference implementation that follows the
+ * sequential algorithm of the dictionary compressors, which is used
+ * for lines that the vector code does not handle.
+ */
+
+#ifndef __MEM_CACHE_COMPRESSORS_KERNELS_HH__
+#define __MEM_CACHE_COMPRESSORS_KERNELS_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace CompressionKernels {
+
+/** Size, in bytes, of the vectors used by the kernels. */
+constexpr std::size_t VectorBytes = 16;
+
+/** Largest line, in bytes, handled by the vector kernels. */
+constexpr std::size_t MaxVectorLineBytes = 512;
+
+/** A vector of VectorBytes bytes worth of values of type T. */
+template <class T>
+struct Vector
+{
+    static_assert(std::is_unsigned<T>::value,
+                  "Vector kernels work on unsigned values");
+    typedef T type __attribute__((vector_size(VectorBytes)));
+
+    static constexpr std::size_t lanes = VectorBytes / sizeof(T);
+};
+
+/**
+ * Largest magnitude of a delta that fits in a signed container of the
+ * given number of bits.
+ */
+template <class T>
+constexpr T
+deltaLimit(std::size_t delta_bits)
+{
+    return delta_bits ? (T(1) << (delta_bits - 1)) - 1 : 0;
+}
+
+/**
+ * Check whether the delta between a value and a base fits in a signed
+ * container of the given size, in the same way as the delta pattern of
+ * the dictionary compressors.
+ */
+template <class T>
+bool
+isValidDelta(T value, T base, std::size_t delta_bits)
+{
+    typedef typename std::make_signed<T>::type SignedT;
+    const SignedT limit = deltaLimit<T>(delta_bits);
+    const SignedT delta = value - base;
+    return (delta >= -limit) && (delta <= limit);
+}
+
+/**
+ * Scalar reference of countBases(). The values are visited in order, and
+ * every value whose delta does not fit with respect to the zero base
+ * nor to any of the bases added so far becomes a new base.
+ *
+ * @param values The values of the line.
+ * @param num_values Number of values in the line.
+ * @param delta_bits Size of a delta, in bits.
+ * @return The number of bases added, besides the zero base.
+ */
+template <class T>
+std::size_t
+countBasesScalar(const T* values, std::size_t num_values,
+                 std::size_t delta_bits)
+{
+    std::vector<T> bases(1, 0);
+    for (std::size_t i = 0; i < num_values; i++) {
+        bool matched = false;
+        for (const T base : bases) {
+            if (isValidDelta(values[i], base, delta_bits)) {
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) {
+            bases.push_back(values[i]);
+        }
+    }
+    return bases.size() - 1;
+}
+
+/**
+ * Count the number of bases that a base-delta compression of the values
+ * needs, besides the implicit zero base.
+ *
+ * Instead of visiting the values in order, a pass over the whole line
+ * removes the values covered by the last base, and the first value that
+ * is still uncovered becomes the next base. A value is uncovered only if
+ * it is not close to any of the bases taken from the values before it,
+ * so the same bases as in the sequential algorithm are found.
+ *
+ * @param values The values of the line.
+ * @param num_values Number of values in the line.
+ * @param delta_bits Size of a delta, in bits.
+ * @return The number of bases added, besides the zero base.
+ */
+template <class T>
+std::size_t
+countBases(const T* values, std::size_t num_values, std::size_t delta_bits)
+{
+    typedef typename Vector<T>::type V;
+    constexpr std::size_t lanes = Vector<T>::lanes;
+
+    if ((num_values % lanes) ||
+        (num_values * sizeof(T) > MaxVectorLineBytes)) {
+        return countBasesScalar(values, num_values, delta_bits);
+    }
+
+    const std::size_t num_vectors = num_values / lanes;
+    V vals[MaxVectorLineBytes / VectorBytes];
+    V uncovered[MaxVectorLineBytes / VectorBytes];
+    std::memcpy(vals, values, num_values * sizeof(T));
+
+    // A value is covered by a base if its wrapped-around distance to
+    // the lower end of the base's delta range is within the range
+    const T limit = deltaLimit<T>(delta_bits);
+    const T range = 2 * limit;
+    for (std::size_t i = 0; i < num_vectors; i++) {
+        uncovered[i] = (V)((V)(vals[i] + limit) > range);
+    }
+
+    std::size_t num_bases = 0;
+    std::size_t next = 0;
+    while (true) {
+        // All values before next are covered
+        while ((next < num_values) && !uncovered[next / lanes][next % lanes]) {
+            next++;
+        }
+        if (next == num_values) {
+            break;
+        }
+
+        const T base = values[next];
+        num_bases++;
+        for (std::size_t i = next / lanes; i < num_vectors; i++) {
+            uncovered[i] &= (V)((V)(vals[i] - base + limit) > range);
+        }
+    }
+
+    return num_bases;
+}
+
+/**
+ * Scalar reference of countEqual().
+ *
+ * @param values The values to check.
+ * @param num_values Number of values.
+ * @param value The value to compare against.
+ * @return The number of values equal to the given value.
+ */
+inline std::size_t
+countEqualScalar(const uint64_t* values, std::size_t num_values,
+                 uint64_t value)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < num_values; i++) {
+        if (values[i] == value) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Count the number of qwords that are equal to a given value. This is
+ * used to detect zero and repeated-value lines.
+ *
+ * @param values The values to check.
+ * @param num_values Number of values.
+ * @param value The value to compare against.
+ * @return The number of values equal to the given value.
+ */
+inline std::size_t
+countEqual(const uint64_t* values, std::size_t num_values, uint64_t value)
+{
+    typedef Vector<uint64_t>::type V;
+    constexpr std::size_t lanes = Vector<uint64_t>::lanes;
+
+    const std::size_t num_vectors = num_values / lanes;
+    V matches = {};
+    for (std::size_t i = 0; i < num_vectors; i++) {
+        V vals;
+        std::memcpy(&vals, values + i * lanes, sizeof(V));
+        // Matching lanes are all ones, i.e., minus one
+        matches -= (V)(vals == value);
+    }
+
+    std::size_t count = 0;
+    for (std::size_t j = 0; j < lanes; j++) {
+        count += matches[j];
+    }
+    return count + countEqualScalar(values + num_vectors * lanes,
+                                    num_values % lanes, value);
+}
+
+/**
+ * Hash the contents of a line.
+ *
+ * @param values The qwords of the line.
+ * @param num_values Number of qwords in the line.
+ * @return The hash of the line.
+ */
+inline uint64_t
+hashLine(const uint64_t* values, std::size_t num_values)
+{
+    uint64_t hash = num_values;
+    for (std::size_t i = 0; i < num_values; i++) {
+        hash ^= values[i];
+        hash *= 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+} // namespace CompressionKernels
+
+#endif //__MEM_CACHE_COMPRESSORS_KERNELS_HH__
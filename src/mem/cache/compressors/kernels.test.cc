@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "mem/cache/compressors/kernels.hh"
+
+using namespace CompressionKernels;
+
+namespace {
+
+/**
+ * Generate a line of qwords made of a few clusters of close values, so
+ * that both successful and failed base-delta compressions are produced.
+ */
+std::vector<uint64_t>
+randomLine(std::mt19937_64 &rng, std::size_t num_qwords)
+{
+    std::vector<uint64_t> line(num_qwords);
+    const uint64_t bases[] = { 0, rng(), rng() };
+    for (auto &qword : line) {
+        switch (rng() % 4) {
+          case 0:
+            qword = 0;
+            break;
+          case 1:
+            qword = rng();
+            break;
+          default:
+            qword = bases[rng() % 3] + (rng() % 512) - 256;
+            break;
+        }
+    }
+    return line;
+}
+
+template <class T>
+void
+checkBases(const std::vector<uint64_t> &line)
+{
+    const T* values = reinterpret_cast<const T*>(line.data());
+    const std::size_t num_values = line.size() * sizeof(uint64_t) / sizeof(T);
+    for (std::size_t delta_bits : { 4, 8, 16, 32 }) {
+        if (delta_bits >= 8 * sizeof(T)) {
+            continue;
+        }
+        EXPECT_EQ(countBasesScalar(values, num_values, delta_bits),
+                  countBases(values, num_values, delta_bits));
+    }
+}
+
+} // anonymous namespace
+
+/** Deltas at the limits of the container */
+TEST(CompressionKernelsTest, ValidDelta)
+{
+    EXPECT_TRUE(isValidDelta<uint8_t>(127, 0, 8));
+    EXPECT_FALSE(isValidDelta<uint8_t>(128, 0, 8));
+    EXPECT_TRUE(isValidDelta<uint8_t>(0, 127, 8));
+    EXPECT_FALSE(isValidDelta<uint8_t>(0, 128, 8));
+    EXPECT_TRUE(isValidDelta<uint64_t>(0, 0xFFFFFFFFFFFFFF81ULL, 8));
+    EXPECT_FALSE(isValidDelta<uint64_t>(0, 0xFFFFFFFFFFFFFF80ULL, 8));
+    EXPECT_TRUE(isValidDelta<uint16_t>(0x8000, 0x7FFF, 4));
+    EXPECT_FALSE(isValidDelta<uint16_t>(0x8000, 0x7FF0, 4));
+}
+
+/** A zero line needs no base, whatever the delta size */
+TEST(CompressionKernelsTest, ZeroLineBases)
+{
+    const std::vector<uint64_t> line(8, 0);
+    EXPECT_EQ(0, countBases(line.data(), line.size(), 8));
+    EXPECT_EQ(0, countBases(reinterpret_cast<const uint16_t*>(line.data()),
+                            line.size() * 4, 8));
+}
+
+/** Bases are taken in order from the values that don't fit */
+TEST(CompressionKernelsTest, OrderedBases)
+{
+    const std::vector<uint64_t> line = {
+        1, 1000, 1001, 5, 2000, 999, 2001, 3000
+    };
+    EXPECT_EQ(3, countBasesScalar(line.data(), line.size(), 8));
+    EXPECT_EQ(3, countBases(line.data(), line.size(), 8));
+    EXPECT_EQ(0, countBases(line.data(), line.size(), 16));
+}
+
+/** The vector kernels match the scalar ones on random lines */
+TEST(CompressionKernelsTest, RandomBases)
+{
+    std::mt19937_64 rng(0x5eed);
+    for (std::size_t num_qwords : { 1, 2, 8, 16, 64, 128 }) {
+        for (int i = 0; i < 200; i++) {
+            const std::vector<uint64_t> line = randomLine(rng, num_qwords);
+            checkBases<uint64_t>(line);
+            checkBases<uint32_t>(line);
+            checkBases<uint16_t>(line);
+        }
+    }
+}
+
+TEST(CompressionKernelsTest, RandomEqual)
+{
+    std::mt19937_64 rng(0x5eed);
+    for (std::size_t num_qwords : { 1, 3, 8, 16 }) {
+        for (int i = 0; i < 200; i++) {
+            const std::vector<uint64_t> line = randomLine(rng, num_qwords);
+            EXPECT_EQ(countEqualScalar(line.data(), num_qwords, 0),
+                      countEqual(line.data(), num_qwords, 0));
+            EXPECT_EQ(countEqualScalar(line.data(), num_qwords, line[0]),
+                      countEqual(line.data(), num_qwords, line[0]));
+        }
+    }
+}
+
+/** Identical lines hash identically, and a single bit changes the hash */
+TEST(CompressionKernelsTest, HashLine)
+{
+    std::vector<uint64_t> line(8, 0x1234);
+    const std::vector<uint64_t> copy = line;
+    EXPECT_EQ(hashLine(line.data(), line.size()),
+              hashLine(copy.data(), copy.size()));
+    line[7] ^= 1;
+    EXPECT_NE(hashLine(line.data(), line.size()),
+              hashLine(copy.data(), copy.size()));
+}
@@ -68,24 +68,26 @@ MultiCompressor::~MultiCompressor()
     }
 }
 
-std::unique_ptr<BaseCacheCompressor::CompressionData>
-MultiCompressor::compress(const uint64_t* cache_line, Cycles& comp_lat,
-    Cycles& decomp_lat)
+unsigned
+MultiCompressor::rankCompressors(const uint64_t* cache_line, Cycles& comp_lat,
+    Cycles& decomp_lat, std::size_t& size_bits,
+    std::unique_ptr<CompressionData>* best_comp_data)
 {
     struct Results
     {
         unsigned index;
         std::unique_ptr<BaseCacheCompressor::CompressionData> compData;
+        std::size_t sizeBits;
         Cycles decompLat;
         uint8_t compressionFactor;
 
         Results(unsigned index,
             std::unique_ptr<BaseCacheCompressor::CompressionData> comp_data,
-            Cycles decomp_lat, std::size_t blk_size)
+            std::size_t size_bits, Cycles decomp_lat, std::size_t blk_size)
             : index(index), compData(std::move(comp_data)),
-              decompLat(decomp_lat)
+              sizeBits(size_bits), decompLat(decomp_lat)
         {
-            const std::size_t size = compData->getSize();
+            const std::size_t size = sizeBits / 8;
             // If the compressed size is worse than the uncompressed size,
             // we assume the size is the uncompressed size, and thus the
             // compression factor is 1
@@ -111,24 +113,34 @@ MultiCompressor::compress(const uint64_t* cache_line, Cycles& comp_lat,
         }
     };
 
-    // Find the ranking of the compressor outputs
+    // Find the ranking of the compressor outputs. When the compressed
+    // data is not needed, only the compressed sizes are computed
     std::priority_queue<std::shared_ptr<Results>,
         std::vector<std::shared_ptr<Results>>, ResultsComparator> results;
     Cycles max_comp_lat;
     for (unsigned i = 0; i < compressors.size(); i++) {
         Cycles temp_decomp_lat;
-        auto temp_comp_data =
-            compressors[i]->compress(cache_line, comp_lat, temp_decomp_lat);
+        std::unique_ptr<CompressionData> temp_comp_data;
+        std::size_t temp_size_bits;
+        if (best_comp_data) {
+            temp_comp_data = compressors[i]->compress(cache_line, comp_lat,
+                temp_decomp_lat);
+            temp_size_bits = temp_comp_data->getSizeBits();
+        } else {
+            temp_size_bits = compressors[i]->getCompressedSizeBits(
+                cache_line, comp_lat, temp_decomp_lat);
+        }
         results.push(std::make_shared<Results>(i, std::move(temp_comp_data),
-            temp_decomp_lat, blkSize));
+            temp_size_bits, temp_decomp_lat, blkSize));
         max_comp_lat = std::max(max_comp_lat, comp_lat);
     }
 
-    // Assign best compressor to compression data
+    // Get the results of the best compressor
     const unsigned best_index = results.top()->index;
-    std::unique_ptr<CompressionData> multi_comp_data =
-        std::unique_ptr<MultiCompData>(
-            new MultiCompData(best_index, std::move(results.top()->compData)));
+    if (best_comp_data) {
+        *best_comp_data = std::move(results.top()->compData);
+    }
+    size_bits = results.top()->sizeBits;
     DPRINTF(CacheComp, "Best compressor: %d\n", best_index);
 
     // Set decompression latency of the best compressor
@@ -144,7 +156,30 @@ MultiCompressor::compress(const uint64_t* cache_line, Cycles& comp_lat,
     // and 1 cycle to pack)
     comp_lat = Cycles(max_comp_lat + 1);
 
-    return multi_comp_data;
+    return best_index;
+}
+
+std::unique_ptr<BaseCacheCompressor::CompressionData>
+MultiCompressor::compress(const uint64_t* cache_line, Cycles& comp_lat,
+    Cycles& decomp_lat)
+{
+    std::unique_ptr<CompressionData> best_comp_data;
+    std::size_t size_bits;
+    const unsigned best_index = rankCompressors(cache_line, comp_lat,
+        decomp_lat, size_bits, &best_comp_data);
+
+    // Assign best compressor to compression data
+    return std::unique_ptr<MultiCompData>(
+        new MultiCompData(best_index, std::move(best_comp_data)));
+}
+
+std::size_t
+MultiCompressor::getCompressedSizeBits(const uint64_t* cache_line,
+    Cycles& comp_lat, Cycles& decomp_lat)
+{
+    std::size_t size_bits;
+    rankCompressors(cache_line, comp_lat, decomp_lat, size_bits, nullptr);
+    return size_bits;
 }
 
 void
@@ -69,6 +69,23 @@ class MultiCompressor : public BaseCacheCompressor
      * @}
      */
 
+    /**
+     * Compress the line with every sub-compressor, rank their results and
+     * update the ranking stats.
+     *
+     * @param data The cache line to be compressed.
+     * @param comp_lat Compression latency in number of cycles.
+     * @param decomp_lat Decompression latency of the best compressor.
+     * @param size_bits Compressed size of the best compressor, in bits.
+     * @param best_comp_data If not null, the sub-compressors build their
+     *                       compressed data, and the one of the best
+     *                       compressor is stored here.
+     * @return The index of the best compressor.
+     */
+    unsigned rankCompressors(const uint64_t* data, Cycles& comp_lat,
+        Cycles& decomp_lat, std::size_t& size_bits,
+        std::unique_ptr<CompressionData>* best_comp_data);
+
   public:
     /** Convenience typedef. */
      typedef MultiCompressorParams Params;
@@ -85,6 +102,9 @@ class MultiCompressor : public BaseCacheCompressor
         const uint64_t* data, Cycles& comp_lat, Cycles& decomp_lat) override;
 
     void decompress(const CompressionData* comp_data, uint64_t* data) override;
+
+    std::size_t getCompressedSizeBits(const uint64_t* data, Cycles& comp_lat,
+        Cycles& decomp_lat) override;
 };
 
 class MultiCompressor::MultiCompData : public CompressionData
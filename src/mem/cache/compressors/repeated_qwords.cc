@@ -37,6 +37,7 @@
 
 #include "debug/CacheComp.hh"
 #include "mem/cache/compressors/dictionary_compressor_impl.hh"
+#include "mem/cache/compressors/kernels.hh"
 #include "params/RepeatedQwordsCompressor.hh"
 
 RepeatedQwordsCompressor::RepeatedQwordsCompressor(const Params *p)
@@ -76,6 +77,36 @@ RepeatedQwordsCompressor::compress(const uint64_t* data, Cycles& comp_lat,
     return comp_data;
 }
 
+std::size_t
+RepeatedQwordsCompressor::getCompressedSizeBits(const uint64_t* data,
+    Cycles& comp_lat, Cycles& decomp_lat)
+{
+    // The first qword never matches, since the dictionary is empty, and
+    // every other qword matches if it repeats the first one
+    const std::size_t num_qwords = blkSize / 8;
+    const std::size_t num_repeated =
+        CompressionKernels::countEqual(data + 1, num_qwords - 1, data[0]);
+    patternStats[M] += num_repeated;
+    patternStats[X] += num_qwords - num_repeated;
+
+    // Both patterns allocate a dictionary entry, as in compress(), so
+    // there is an entry per qword. Matches take no space
+    const std::size_t num_entries = num_qwords;
+    std::size_t size_bits = (num_qwords - num_repeated) * 64;
+    if (num_entries > 1) {
+        size_bits = blkSize * 8;
+        DPRINTF(CacheComp, "Repeated qwords compression failed\n");
+    }
+
+    // Set compression latency
+    comp_lat = Cycles(1);
+
+    // Set decompression latency
+    decomp_lat = Cycles(1);
+
+    return size_bits;
+}
+
 RepeatedQwordsCompressor*
 RepeatedQwordsCompressorParams::create()
 {
@@ -37,6 +37,7 @@
 
 #include "debug/CacheComp.hh"
 #include "mem/cache/compressors/dictionary_compressor_impl.hh"
+#include "mem/cache/compressors/kernels.hh"
 #include "params/ZeroCompressor.hh"
 
 ZeroCompressor::ZeroCompressor(const Params *p)
@@ -74,6 +75,33 @@ ZeroCompressor::compress(const uint64_t* data, Cycles& comp_lat,
     return comp_data;
 }
 
+std::size_t
+ZeroCompressor::getCompressedSizeBits(const uint64_t* data, Cycles& comp_lat,
+    Cycles& decomp_lat)
+{
+    const std::size_t num_qwords = blkSize / 8;
+    const std::size_t num_zeros =
+        CompressionKernels::countEqual(data, num_qwords, 0);
+    patternStats[Z] += num_zeros;
+    patternStats[X] += num_qwords - num_zeros;
+
+    // Each zero qword is encoded with a single bit. If there is any
+    // non-zero entry, the compressor failed
+    std::size_t size_bits = num_qwords;
+    if (num_zeros != num_qwords) {
+        size_bits = blkSize * 8;
+        DPRINTF(CacheComp, "Zero compression failed\n");
+    }
+
+    // Set compression latency (Assumes full line zero comparison)
+    comp_lat = Cycles(1);
+
+    // Set decompression latency
+    decomp_lat = Cycles(1);
+
+    return size_bits;
+}
+
 ZeroCompressor*
 ZeroCompressorParams::create()
 {
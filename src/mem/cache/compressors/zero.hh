@@ -94,6 +94,9 @@ class ZeroCompressor : public DictionaryCompressor<uint64_t>
     std::unique_ptr<BaseCacheCompressor::CompressionData> compress(
         const uint64_t* data, Cycles& comp_lat, Cycles& decomp_lat) override;
 
+    std::size_t getCompressedSizeBits(const uint64_t* data, Cycles& comp_lat,
+        Cycles& decomp_lat) override;
+
   public:
     typedef ZeroCompressorParams Params;
     ZeroCompressor(const Params *p);
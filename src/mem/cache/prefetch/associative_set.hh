@@ -134,6 +134,8 @@ class AssociativeSet {
     BaseReplacementPolicy* const replacementPolicy;
     /** Vector containing the entries of the container */
     std::vector<Entry> entries;
+    /** Candidates of the current lookup, reused to avoid allocating */
+    mutable std::vector<ReplaceableEntry*> possibleEntries;
 
   public:
     /**
@@ -176,9 +178,11 @@ class AssociativeSet {
      * Find the set of entries that could be replaced given
      * that we want to add a new entry with the provided key
      * @param addr key to select the set of entries
-     * @result vector of candidates matching with the provided key
+     * @param entries Replaced by the candidates matching with the provided
+     *   key. Reusing it across calls avoids allocating.
      */
-    std::vector<Entry *> getPossibleEntries(const Addr addr) const;
+    void getPossibleEntries(const Addr addr,
+                            std::vector<Entry *> &entries) const;
 
     /**
      * Indicate that an entry has just been inserted
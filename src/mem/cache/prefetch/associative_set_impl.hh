@@ -57,10 +57,9 @@ Entry*
 AssociativeSet<Entry>::findEntry(Addr addr, bool is_secure) const
 {
     Addr tag = indexingPolicy->extractTag(addr);
-    const std::vector<ReplaceableEntry*> selected_entries =
-        indexingPolicy->getPossibleEntries(addr);
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
 
-    for (const auto& location : selected_entries) {
+    for (const auto& location : possibleEntries) {
         Entry* entry = static_cast<Entry *>(location);
         if ((entry->getTag() == tag) && entry->isValid() &&
             entry->isSecure() == is_secure) {
@@ -82,10 +81,9 @@ Entry*
 AssociativeSet<Entry>::findVictim(Addr addr)
 {
     // Get possible entries to be victimized
-    const std::vector<ReplaceableEntry*> selected_entries =
-        indexingPolicy->getPossibleEntries(addr);
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
     Entry* victim = static_cast<Entry*>(replacementPolicy->getVictim(
-                            selected_entries));
+                            possibleEntries));
     // There is only one eviction for this replacement
     invalidate(victim);
     return victim;
@@ -93,18 +91,17 @@ AssociativeSet<Entry>::findVictim(Addr addr)
 
 
 template<class Entry>
-std::vector<Entry *>
-AssociativeSet<Entry>::getPossibleEntries(const Addr addr) const
+void
+AssociativeSet<Entry>::getPossibleEntries(const Addr addr,
+                                          std::vector<Entry *> &entries) const
 {
-    std::vector<ReplaceableEntry *> selected_entries =
-        indexingPolicy->getPossibleEntries(addr);
-    std::vector<Entry *> entries(selected_entries.size(), nullptr);
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
+    entries.resize(possibleEntries.size());
 
     unsigned int idx = 0;
-    for (auto &entry : selected_entries) {
+    for (auto &entry : possibleEntries) {
         entries[idx++] = static_cast<Entry *>(entry);
     }
-    return entries;
 }
 
 template<class Entry>
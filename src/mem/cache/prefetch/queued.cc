@@ -49,24 +49,26 @@
 #include "mem/request.hh"
 #include "params/QueuedPrefetcher.hh"
 
-void
-QueuedPrefetcher::DeferredPacket::createPkt(Addr paddr, unsigned blk_size,
-                                            MasterID mid, bool tag_prefetch,
-                                            Tick t) {
+PacketPtr
+QueuedPrefetcher::DeferredPacket::createPkt(unsigned blk_size, MasterID mid,
+                                            bool tag_prefetch) const
+{
+    assert(paddr != MaxAddr);
+
     /* Create a prefetch memory request */
-    RequestPtr req = std::make_shared<Request>(paddr, blk_size, 0, mid);
+    RequestPtr req = Request::create(paddr, blk_size, 0, mid);
 
     if (pfInfo.isSecure()) {
         req->setFlags(Request::SECURE);
     }
     req->taskId(ContextSwitchTaskId::Prefetcher);
-    pkt = new Packet(req, MemCmd::HardPFReq);
+    PacketPtr pkt = new Packet(req, MemCmd::HardPFReq);
     pkt->allocate();
     if (tag_prefetch && pfInfo.hasPC()) {
         // Tag prefetch packet with  accessing pc
         pkt->req->setPC(pfInfo.getPC());
     }
-    tick = t;
+    return pkt;
 }
 
 void
@@ -90,11 +92,120 @@ QueuedPrefetcher::DeferredPacket::finish(const Fault &fault,
     owner->translationComplete(this, failed);
 }
 
+QueuedPrefetcher::PrefetchQueue::PrefetchQueue(unsigned max_size)
+    : maxSize(max_size)
+{
+    fatal_if(maxSize == 0, "Prefetch queues must have at least one entry");
+    addrIndex.reserve(maxSize);
+}
+
+QueuedPrefetcher::PrefetchQueue::iterator
+QueuedPrefetcher::PrefetchQueue::find(const PrefetchInfo &pfi)
+{
+    auto range = addrIndex.equal_range(pfi.getAddr());
+    for (auto idx = range.first; idx != range.second; ++idx) {
+        if (idx->second->pfInfo.sameAddr(pfi)) {
+            return idx->second;
+        }
+    }
+    return entries.end();
+}
+
+QueuedPrefetcher::PrefetchQueue::iterator
+QueuedPrefetcher::PrefetchQueue::find(const DeferredPacket *dp)
+{
+    auto range = addrIndex.equal_range(dp->pfInfo.getAddr());
+    for (auto idx = range.first; idx != range.second; ++idx) {
+        if (&(*idx->second) == dp) {
+            return idx->second;
+        }
+    }
+    return entries.end();
+}
+
+QueuedPrefetcher::PrefetchQueue::iterator
+QueuedPrefetcher::PrefetchQueue::insert(const DeferredPacket &dp)
+{
+    assert(!full());
+    iterator it = entries.insert(entries.end(), dp);
+    addrIndex.emplace(it->pfInfo.getAddr(), it);
+    link(it);
+    return it;
+}
+
+void
+QueuedPrefetcher::PrefetchQueue::setPriority(iterator it, int32_t priority)
+{
+    unlink(it);
+    it->priority = priority;
+    link(it);
+}
+
+QueuedPrefetcher::PrefetchQueue::iterator
+QueuedPrefetcher::PrefetchQueue::victim()
+{
+    assert(!empty());
+    // The lowest priority level is the last one in the queue, and its
+    // oldest entry is the first one of the level
+    return levels.begin()->second.first;
+}
+
+QueuedPrefetcher::PrefetchQueue::iterator
+QueuedPrefetcher::PrefetchQueue::erase(iterator it)
+{
+    auto range = addrIndex.equal_range(it->pfInfo.getAddr());
+    for (auto idx = range.first; idx != range.second; ++idx) {
+        if (idx->second == it) {
+            addrIndex.erase(idx);
+            break;
+        }
+    }
+    unlink(it);
+    return entries.erase(it);
+}
+
+void
+QueuedPrefetcher::PrefetchQueue::link(iterator it)
+{
+    // Entries are ordered by decreasing priority, so the new entry goes
+    // right after the last entry of the lowest level whose priority is
+    // not lower than its own, or at the head if there is no such level.
+    // Splicing keeps the entry itself in place in memory.
+    auto level = levels.lower_bound(it->priority);
+    if (level == levels.end()) {
+        entries.splice(entries.begin(), entries, it);
+    } else {
+        entries.splice(std::next(level->second.second), entries, it);
+    }
+
+    if (level != levels.end() && level->first == it->priority) {
+        level->second.second = it;
+    } else {
+        levels.emplace_hint(level, it->priority, std::make_pair(it, it));
+    }
+}
+
+void
+QueuedPrefetcher::PrefetchQueue::unlink(iterator it)
+{
+    auto level = levels.find(it->priority);
+    assert(level != levels.end());
+    auto &ends = level->second;
+    if (ends.first == it && ends.second == it) {
+        levels.erase(level);
+    } else if (ends.first == it) {
+        ends.first = std::next(it);
+    } else if (ends.second == it) {
+        ends.second = std::prev(it);
+    }
+}
+
 QueuedPrefetcher::QueuedPrefetcher(const QueuedPrefetcherParams *p)
-    : BasePrefetcher(p), queueSize(p->queue_size),
-      missingTranslationQueueSize(
+    : BasePrefetcher(p), pfq(p->queue_size),
+      pfqMissingTranslation(
         p->max_prefetch_requests_with_pending_translation),
-      latency(p->latency), queueSquash(p->queue_squash),
+      queueSize(p->queue_size), latency(p->latency),
+      queueSquash(p->queue_squash),
       queueFilter(p->queue_filter), cacheSnoop(p->cache_snoop),
       tagPrefetch(p->tag_prefetch),
       throttleControlPct(p->throttle_control_percentage)
@@ -103,10 +214,6 @@ QueuedPrefetcher::QueuedPrefetcher(const QueuedPrefetcherParams *p)
 
 QueuedPrefetcher::~QueuedPrefetcher()
 {
-    // Delete the queued prefetch packets
-    for (DeferredPacket &p : pfq) {
-        delete p.pkt;
-    }
 }
 
 size_t
@@ -143,20 +250,20 @@ void
 QueuedPrefetcher::notify(const PacketPtr &pkt, const PrefetchInfo &pfi)
 {
     Addr blk_addr = blockAddress(pfi.getAddr());
-    bool is_secure = pfi.isSecure();
-
-    // Squash queued prefetches if demand miss to same line
-    if (queueSquash) {
-        auto itr = pfq.begin();
-        while (itr != pfq.end()) {
-            if (itr->pfInfo.getAddr() == blk_addr &&
-                itr->pfInfo.isSecure() == is_secure) {
-                delete itr->pkt;
-                itr = pfq.erase(itr);
-            } else {
-                ++itr;
-            }
+
+    // A queued prefetch to the demanded line was issued too late, squash
+    // it if requested
+    PrefetchInfo demand_pfi(pfi, blk_addr);
+    for (iterator itr = pfq.find(demand_pfi); itr != pfq.end();
+         itr = pfq.find(demand_pfi)) {
+        pfLate++;
+        if (!queueSquash) {
+            break;
         }
+        DPRINTF(HWPrefetch, "Squashing queued prefetch addr: %#x\n",
+                blk_addr);
+        pfRemovedDemand++;
+        pfq.erase(itr);
     }
 
     // Calculate prefetches given this access
@@ -211,8 +318,8 @@ QueuedPrefetcher::getPacket()
         return nullptr;
     }
 
-    PacketPtr pkt = pfq.front().pkt;
-    pfq.pop_front();
+    PacketPtr pkt = pfq.front().createPkt(blkSize, masterId, tagPrefetch);
+    pfq.erase(pfq.begin());
 
     pfIssued++;
     issuedPrefetches += 1;
@@ -244,6 +351,18 @@ QueuedPrefetcher::regStats()
         .name(name() + ".pfRemovedFull")
         .desc("number of prefetches dropped due to prefetch queue size");
 
+    pfRemovedDemand
+        .name(name() + ".pfRemovedDemand")
+        .desc("number of queued prefetches squashed by a demand access");
+
+    pfLate
+        .name(name() + ".pfLate")
+        .desc("number of demand accesses to a line with a queued prefetch");
+
+    pfTranslationFail
+        .name(name() + ".pfTranslationFail")
+        .desc("number of prefetches dropped due to a failed translation");
+
     pfSpanPage
         .name(name() + ".pfSpanPage")
         .desc("number of prefetches that crossed the page");
@@ -268,13 +387,7 @@ QueuedPrefetcher::processMissingTranslations(unsigned max)
 void
 QueuedPrefetcher::translationComplete(DeferredPacket *dp, bool failed)
 {
-    auto it = pfqMissingTranslation.begin();
-    while (it != pfqMissingTranslation.end()) {
-        if (&(*it) == dp) {
-            break;
-        }
-        it++;
-    }
+    auto it = pfqMissingTranslation.find(dp);
     assert(it != pfqMissingTranslation.end());
     if (!failed) {
         DPRINTF(HWPrefetch, "%s Translation of vaddr %#x succeeded: "
@@ -290,11 +403,11 @@ QueuedPrefetcher::translationComplete(DeferredPacket *dp, bool failed)
                     "cache/MSHR prefetch addr:%#x\n", target_paddr);
         } else {
             Tick pf_time = curTick() + clockPeriod() * latency;
-            it->createPkt(it->translationRequest->getPaddr(), blkSize,
-                    masterId, tagPrefetch, pf_time);
+            it->setTarget(target_paddr, pf_time);
             addToQueue(pfq, *it);
         }
     } else {
+        pfTranslationFail++;
         DPRINTF(HWPrefetch, "%s Translation of vaddr %#x failed, dropping "
                 "prefetch request %#x \n", tlb->name(),
                 it->translationRequest->getVaddr());
@@ -303,30 +416,18 @@ QueuedPrefetcher::translationComplete(DeferredPacket *dp, bool failed)
 }
 
 bool
-QueuedPrefetcher::alreadyInQueue(std::list<DeferredPacket> &queue,
+QueuedPrefetcher::alreadyInQueue(PrefetchQueue &queue,
                                  const PrefetchInfo &pfi, int32_t priority)
 {
-    bool found = false;
-    iterator it;
-    for (it = queue.begin(); it != queue.end() && !found; it++) {
-        found = it->pfInfo.sameAddr(pfi);
-    }
+    iterator it = queue.find(pfi);
+    bool found = it != queue.end();
 
     /* If the address is already in the queue, update priority and leave */
-    if (it != queue.end()) {
+    if (found) {
         pfBufferHit++;
         if (it->priority < priority) {
             /* Update priority value and position in the queue */
-            it->priority = priority;
-            iterator prev = it;
-            while (prev != queue.begin()) {
-                prev--;
-                /* If the packet has higher priority, swap */
-                if (*it > *prev) {
-                    std::swap(*it, *prev);
-                    it = prev;
-                }
-            }
+            queue.setPriority(it, priority);
             DPRINTF(HWPrefetch, "Prefetch addr already in "
                 "prefetch queue, priority updated\n");
         } else {
@@ -341,7 +442,7 @@ RequestPtr
 QueuedPrefetcher::createPrefetchRequest(Addr addr, PrefetchInfo const &pfi,
                                         PacketPtr pkt)
 {
-    RequestPtr translation_req = std::make_shared<Request>(pkt->req->getAsid(),
+    RequestPtr translation_req = Request::create(pkt->req->getAsid(),
             addr, blkSize, pkt->req->getFlags(), masterId, pfi.getPC(),
             pkt->req->contextId());
     translation_req->setFlags(Request::PREFETCH);
@@ -427,11 +528,11 @@ QueuedPrefetcher::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi,
         return;
     }
 
-    /* Create the packet and find the spot to insert it */
+    /* Create the deferred packet and find the spot to insert it */
     DeferredPacket dpp(this, new_pfi, 0, priority);
     if (has_target_pa) {
         Tick pf_time = curTick() + clockPeriod() * latency;
-        dpp.createPkt(target_paddr, blkSize, masterId, tagPrefetch, pf_time);
+        dpp.setTarget(target_paddr, pf_time);
         DPRINTF(HWPrefetch, "Prefetch queued. "
                 "addr:%#x priority: %3d tick:%lld.\n",
                 new_pfi.getAddr(), priority, pf_time);
@@ -447,48 +548,17 @@ QueuedPrefetcher::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi,
 }
 
 void
-QueuedPrefetcher::addToQueue(std::list<DeferredPacket> &queue,
-                             DeferredPacket &dpp)
+QueuedPrefetcher::addToQueue(PrefetchQueue &queue, DeferredPacket &dpp)
 {
     /* Verify prefetch buffer space for request */
-    if (queue.size() == queueSize) {
+    if (queue.full()) {
         pfRemovedFull++;
-        /* Lowest priority packet */
-        iterator it = queue.end();
-        panic_if (it == queue.begin(),
-            "Prefetch queue is both full and empty!");
-        --it;
-        /* Look for oldest in that level of priority */
-        panic_if (it == queue.begin(),
-            "Prefetch queue is full with 1 element!");
-        iterator prev = it;
-        bool cont = true;
-        /* While not at the head of the queue */
-        while (cont && prev != queue.begin()) {
-            prev--;
-            /* While at the same level of priority */
-            cont = prev->priority == it->priority;
-            if (cont)
-                /* update pointer */
-                it = prev;
-        }
+        /* Lowest priority, oldest packet */
+        iterator it = queue.victim();
         DPRINTF(HWPrefetch, "Prefetch queue full, removing lowest priority "
                             "oldest packet, addr: %#x\n",it->pfInfo.getAddr());
-        delete it->pkt;
         queue.erase(it);
     }
 
-    if (queue.size() == 0) {
-        queue.emplace_back(dpp);
-    } else {
-        iterator it = queue.end();
-        do {
-            --it;
-        } while (it != queue.begin() && dpp > *it);
-        /* If we reach the head, we have to see if the new element is new head
-         * or not */
-        if (it == queue.begin() && dpp <= *it)
-            it++;
-        queue.insert(it, dpp);
-    }
+    queue.insert(dpp);
 }
@@ -41,9 +41,13 @@
 #define __MEM_CACHE_PREFETCH_QUEUED_HH__
 
 #include <cstdint>
+#include <functional>
 #include <list>
+#include <map>
+#include <unordered_map>
 #include <utility>
 
+#include "base/fixed_size_pool.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/prefetch/base.hh"
@@ -61,8 +65,8 @@ class QueuedPrefetcher : public BasePrefetcher
         PrefetchInfo pfInfo;
         /** Time when this prefetch becomes ready */
         Tick tick;
-        /** The memory packet generated by this prefetch */
-        PacketPtr pkt;
+        /** Physical address of the prefetch, valid once translated */
+        Addr paddr;
         /** The priority of this prefetch */
         int32_t priority;
         /** Request used when a translation is needed */
@@ -75,39 +79,39 @@ class QueuedPrefetcher : public BasePrefetcher
          * @param o QueuedPrefetcher in charge of this request
          * @param pfi PrefechInfo object associated to this packet
          * @param t Time when this prefetch becomes ready
-         * @param p PacketPtr with the memory request of the prefetch
          * @param prio This prefetch priority
          */
         DeferredPacket(QueuedPrefetcher *o, PrefetchInfo const &pfi, Tick t,
-            int32_t prio) : owner(o), pfInfo(pfi), tick(t), pkt(nullptr),
+            int32_t prio) : owner(o), pfInfo(pfi), tick(t), paddr(MaxAddr),
             priority(prio), translationRequest(), tc(nullptr),
             ongoingTranslation(false) {
         }
 
-        bool operator>(const DeferredPacket& that) const
-        {
-            return priority > that.priority;
-        }
-        bool operator<(const DeferredPacket& that) const
-        {
-            return priority < that.priority;
-        }
-        bool operator<=(const DeferredPacket& that) const
+        /**
+         * Set the physical address of this prefetch and the time at
+         * which it can be issued.
+         * @param pa physical address of this prefetch
+         * @param t time when the prefetch becomes ready
+         */
+        void setTarget(Addr pa, Tick t)
         {
-            return !(*this > that);
+            paddr = pa;
+            tick = t;
         }
 
         /**
-         * Create the associated memory packet
-         * @param paddr physical address of this packet
+         * Create the memory packet of this prefetch. Packets are only
+         * created when the prefetch is issued, so that prefetches
+         * which are squashed or dropped while queued never allocate
+         * one.
          * @param blk_size block size used by the prefetcher
          * @param mid Requester ID of the access that generated this prefetch
          * @param tag_prefetch flag to indicate if the packet needs to be
          *        tagged
-         * @param t time when the prefetch becomes ready
+         * @return the new packet
          */
-        void createPkt(Addr paddr, unsigned blk_size, MasterID mid,
-                       bool tag_prefetch, Tick t);
+        PacketPtr createPkt(unsigned blk_size, MasterID mid,
+                            bool tag_prefetch) const;
 
         /**
          * Sets the translation request needed to obtain the physical address
@@ -132,23 +136,102 @@ class QueuedPrefetcher : public BasePrefetcher
         void startTranslation(BaseTLB *tlb);
     };
 
-    std::list<DeferredPacket> pfq;
-    std::list<DeferredPacket> pfqMissingTranslation;
+    /**
+     * Bounded queue of deferred packets, ordered by decreasing priority
+     * and, within a priority level, by age. Entries live in a list so
+     * that they don't move while a translation is in flight. The
+     * entries of every prefetch address and the ends of every priority
+     * level are indexed, so lookups, insertions and evictions don't
+     * depend on the queue occupancy. The nodes of all containers come
+     * from pools, so queueing a prefetch doesn't call malloc.
+     */
+    class PrefetchQueue
+    {
+      private:
+        typedef std::list<DeferredPacket, PoolAllocator<DeferredPacket>>
+            EntryList;
+
+      public:
+        using iterator = EntryList::iterator;
+        using const_iterator = EntryList::const_iterator;
+
+        explicit PrefetchQueue(unsigned max_size);
+
+        bool empty() const { return entries.empty(); }
+        size_t size() const { return entries.size(); }
+        bool full() const { return entries.size() >= maxSize; }
+
+        iterator begin() { return entries.begin(); }
+        iterator end() { return entries.end(); }
+        const_iterator begin() const { return entries.begin(); }
+        const_iterator end() const { return entries.end(); }
+
+        const DeferredPacket &front() const { return entries.front(); }
+
+        /**
+         * Find an entry for the given prefetch address.
+         * @param pfi information of the prefetch to look for
+         * @return an entry with the same address, end() if there is none
+         */
+        iterator find(const PrefetchInfo &pfi);
+
+        /**
+         * Find the entry holding the given deferred packet.
+         * @param dp a deferred packet stored in this queue
+         * @return the entry of the packet, end() if it isn't queued
+         */
+        iterator find(const DeferredPacket *dp);
+
+        /**
+         * Insert a copy of a deferred packet as the youngest entry of
+         * its priority level. The queue must not be full.
+         */
+        iterator insert(const DeferredPacket &dp);
+
+        /**
+         * Change the priority of an entry, which becomes the youngest
+         * entry of its new priority level.
+         */
+        void setPriority(iterator it, int32_t priority);
+
+        /** Oldest entry of the lowest priority level. */
+        iterator victim();
+
+        iterator erase(iterator it);
+
+      private:
+        /** Move an entry that belongs to no priority level into place */
+        void link(iterator it);
+        /** Remove an entry from the bookkeeping of its priority level */
+        void unlink(iterator it);
+
+        /** Maximum number of entries */
+        const unsigned maxSize;
+
+        EntryList entries;
+
+        /** Entries indexed by their prefetch address */
+        std::unordered_multimap<Addr, iterator, std::hash<Addr>,
+            std::equal_to<Addr>,
+            PoolAllocator<std::pair<const Addr, iterator>>> addrIndex;
+
+        /** First and last entries of each priority level */
+        std::map<int32_t, std::pair<iterator, iterator>, std::less<int32_t>,
+            PoolAllocator<std::pair<const int32_t,
+                                    std::pair<iterator, iterator>>>> levels;
+    };
+
+    PrefetchQueue pfq;
+    PrefetchQueue pfqMissingTranslation;
 
-    using const_iterator = std::list<DeferredPacket>::const_iterator;
-    using iterator = std::list<DeferredPacket>::iterator;
+    using const_iterator = PrefetchQueue::const_iterator;
+    using iterator = PrefetchQueue::iterator;
 
     // PARAMETERS
 
     /** Maximum size of the prefetch queue */
     const unsigned queueSize;
 
-    /**
-     * Maximum size of the queue holding prefetch requests with missing
-     * address translations
-     */
-    const unsigned missingTranslationQueueSize;
-
     /** Cycles after generation when a prefetch can first be issued */
     const Cycles latency;
 
@@ -172,6 +255,9 @@ class QueuedPrefetcher : public BasePrefetcher
     Stats::Scalar pfBufferHit;
     Stats::Scalar pfInCache;
     Stats::Scalar pfRemovedFull;
+    Stats::Scalar pfRemovedDemand;
+    Stats::Scalar pfLate;
+    Stats::Scalar pfTranslationFail;
     Stats::Scalar pfSpanPage;
 
   public:
@@ -202,7 +288,7 @@ class QueuedPrefetcher : public BasePrefetcher
      * @param queue selected queue to use
      * @param dpp DeferredPacket to add
      */
-    void addToQueue(std::list<DeferredPacket> &queue, DeferredPacket &dpp);
+    void addToQueue(PrefetchQueue &queue, DeferredPacket &dpp);
 
     /**
      * Starts the translations of the queued prefetches with a
@@ -230,8 +316,8 @@ class QueuedPrefetcher : public BasePrefetcher
      * @param priority priority of the prefetch request to be added
      * @return True if the prefetch request was found in the queue
      */
-    bool alreadyInQueue(std::list<DeferredPacket> &queue,
-                        const PrefetchInfo &pfi, int32_t priority);
+    bool alreadyInQueue(PrefetchQueue &queue, const PrefetchInfo &pfi,
+                        int32_t priority);
 
     /**
      * Returns the maxmimum number of prefetch requests that are allowed
@@ -55,10 +55,10 @@ SignaturePathPrefetcherV2::handleSignatureTableMiss(stride_t current_block,
 
     // This should return all entries of the GHR, since it is a fully
     // associative table
-    std::vector<GlobalHistoryEntry *> all_ghr_entries =
-             globalHistoryRegister.getPossibleEntries(0 /* any value works */);
+    globalHistoryRegister.getPossibleEntries(0 /* any value works */,
+                                             ghrEntries);
 
-    for (auto gh_entry : all_ghr_entries) {
+    for (auto gh_entry : ghrEntries) {
         if (gh_entry->lastBlock + gh_entry->delta == current_block) {
             new_signature = gh_entry->signature;
             new_conf = gh_entry->confidence;
@@ -63,6 +63,8 @@ class SignaturePathPrefetcherV2 : public SignaturePathPrefetcher
     };
     /** Global History Register */
     AssociativeSet<GlobalHistoryEntry> globalHistoryRegister;
+    /** Entries of the GHR, reused by every signature table miss */
+    std::vector<GlobalHistoryEntry *> ghrEntries;
 
     double calculateLookaheadConfidence(PatternEntry const &sig,
             PatternStrideEntry const &lookahead) const override;
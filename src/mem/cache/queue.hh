@@ -49,10 +49,13 @@
 #ifndef __MEM_CACHE_QUEUE_HH__
 #define __MEM_CACHE_QUEUE_HH__
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <type_traits>
+#include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "base/types.hh"
@@ -101,6 +104,55 @@ class Queue : public Drainable
     /** Holds non allocated entries. */
     typename Entry::List freeList;
 
+    /**
+     * Index of the allocated entries by block address. Each bucket is
+     * an intrusive list of the entries hashing to it in allocation
+     * order, so lookups only visit entries that may match instead of
+     * the whole queue, and return the same entry a scan of the
+     * allocated list would.
+     */
+    const int indexBits;
+    std::vector<QueueEntry*> indexHeads;
+    std::vector<QueueEntry*> indexTails;
+
+    size_t indexBucket(Addr blk_addr) const
+    {
+        return (blk_addr * ULL(0x9e3779b97f4a7c15)) >> (64 - indexBits);
+    }
+
+    /**
+     * Add a newly allocated entry to the address index. Must be called
+     * after its address has been set.
+     */
+    void addToIndex(Entry* entry)
+    {
+        const size_t bucket = indexBucket(entry->blkAddr);
+        entry->indexPrev = indexTails[bucket];
+        entry->indexNext = nullptr;
+        if (indexTails[bucket]) {
+            indexTails[bucket]->indexNext = entry;
+        } else {
+            indexHeads[bucket] = entry;
+        }
+        indexTails[bucket] = entry;
+    }
+
+    void removeFromIndex(Entry* entry)
+    {
+        const size_t bucket = indexBucket(entry->blkAddr);
+        if (entry->indexPrev) {
+            entry->indexPrev->indexNext = entry->indexNext;
+        } else {
+            indexHeads[bucket] = entry->indexNext;
+        }
+        if (entry->indexNext) {
+            entry->indexNext->indexPrev = entry->indexPrev;
+        } else {
+            indexTails[bucket] = entry->indexPrev;
+        }
+        entry->indexPrev = entry->indexNext = nullptr;
+    }
+
     typename Entry::Iterator addToReadyList(Entry* entry)
     {
         if (readyList.empty() ||
@@ -132,7 +184,10 @@ class Queue : public Drainable
      */
     Queue(const std::string &_label, int num_entries, int reserve) :
         label(_label), numEntries(num_entries + reserve),
-        numReserve(reserve), entries(numEntries), _numInService(0),
+        numReserve(reserve), entries(numEntries),
+        indexBits(ceilLog2(std::max(2 * numEntries, 2))),
+        indexHeads(1 << indexBits, nullptr),
+        indexTails(1 << indexBits, nullptr), _numInService(0),
         allocated(0)
     {
         for (int i = 0; i < numEntries; ++i) {
@@ -155,6 +210,11 @@ class Queue : public Drainable
         return _numInService;
     }
 
+    int numAllocated() const
+    {
+        return allocated;
+    }
+
     /**
      * Find the first entry that matches the provided address.
      *
@@ -166,7 +226,9 @@ class Queue : public Drainable
     Entry* findMatch(Addr blk_addr, bool is_secure,
                      bool ignore_uncacheable = true) const
     {
-        for (const auto& entry : allocatedList) {
+        for (QueueEntry* e = indexHeads[indexBucket(blk_addr)]; e;
+             e = e->indexNext) {
+            Entry* entry = static_cast<Entry*>(e);
             // we ignore any entries allocated for uncacheable
             // accesses and simply ignore them when matching, in the
             // cache we never check for matches when adding new
@@ -204,12 +266,29 @@ class Queue : public Drainable
      */
     Entry* findPending(const QueueEntry* entry) const
     {
-        for (const auto& ready_entry : readyList) {
-            if (ready_entry->conflictAddr(entry)) {
-                return ready_entry;
+        // Entries that are not in service are the ones on the ready
+        // list
+        Entry* match = nullptr;
+        for (QueueEntry* e = indexHeads[indexBucket(entry->blkAddr)]; e;
+             e = e->indexNext) {
+            Entry* candidate = static_cast<Entry*>(e);
+            if (candidate->inService || !candidate->conflictAddr(entry)) {
+                continue;
             }
+
+            if (match) {
+                // Several candidates, the ready list decides which
+                // one is the earliest
+                for (const auto& ready_entry : readyList) {
+                    if (ready_entry->conflictAddr(entry)) {
+                        return ready_entry;
+                    }
+                }
+                panic("Pending entry missing from the ready list.");
+            }
+            match = candidate;
         }
-        return nullptr;
+        return match;
     }
 
     /**
@@ -238,6 +317,7 @@ class Queue : public Drainable
     void deallocate(Entry *entry)
     {
         allocatedList.erase(entry->allocIter);
+        removeFromIndex(entry);
         freeList.push_front(entry);
         allocated--;
         if (entry->inService) {
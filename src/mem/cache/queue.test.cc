@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <list>
+#include <random>
+
+#include "mem/cache/queue.hh"
+
+namespace {
+
+/**
+ * A queue entry without targets. Entries conflict when they are for the
+ * same block, as write queue entries do.
+ */
+class TestEntry : public QueueEntry
+{
+  public:
+    typedef std::list<TestEntry *> List;
+    typedef List::iterator Iterator;
+
+    Iterator readyIter;
+    Iterator allocIter;
+
+    void
+    allocate(Addr blk_addr, bool is_secure, bool uncacheable,
+             Tick ready_time)
+    {
+        blkAddr = blk_addr;
+        isSecure = is_secure;
+        _isUncacheable = uncacheable;
+        readyTime = ready_time;
+        inService = false;
+    }
+
+    void deallocate() {}
+
+    bool
+    matchBlockAddr(const Addr addr, const bool is_secure) const override
+    {
+        return blkAddr == addr && isSecure == is_secure;
+    }
+
+    bool matchBlockAddr(const PacketPtr pkt) const override { return false; }
+
+    bool
+    conflictAddr(const QueueEntry *entry) const override
+    {
+        return matchBlockAddr(entry->blkAddr, entry->isSecure);
+    }
+
+    bool sendPacket(BaseCache &cache) override { return false; }
+    Target *getTarget() override { return nullptr; }
+};
+
+/**
+ * A queue that allocates and services entries the way the MSHR queue
+ * does, and can look entries up with the scans of the allocated and
+ * ready lists that the address index replaced.
+ */
+class TestQueue : public Queue<TestEntry>
+{
+  public:
+    TestQueue(int num_entries) : Queue<TestEntry>("test", num_entries, 0) {}
+
+    TestEntry *
+    allocate(Addr blk_addr, bool is_secure, bool uncacheable,
+             Tick ready_time)
+    {
+        assert(!freeList.empty());
+        TestEntry *entry = freeList.front();
+        freeList.pop_front();
+
+        entry->allocate(blk_addr, is_secure, uncacheable, ready_time);
+        entry->allocIter = allocatedList.insert(allocatedList.end(), entry);
+        entry->readyIter = addToReadyList(entry);
+        addToIndex(entry);
+
+        allocated += 1;
+        return entry;
+    }
+
+    void
+    markInService(TestEntry *entry)
+    {
+        entry->inService = true;
+        readyList.erase(entry->readyIter);
+        _numInService += 1;
+    }
+
+    void
+    markPending(TestEntry *entry)
+    {
+        entry->inService = false;
+        --_numInService;
+        entry->readyIter = addToReadyList(entry);
+    }
+
+    const TestEntry::List &allocatedEntries() const { return allocatedList; }
+
+    TestEntry *
+    scanMatch(Addr blk_addr, bool is_secure, bool ignore_uncacheable) const
+    {
+        for (const auto &entry : allocatedList) {
+            if (!(ignore_uncacheable && entry->isUncacheable()) &&
+                entry->matchBlockAddr(blk_addr, is_secure)) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    TestEntry *
+    scanPending(const QueueEntry *entry) const
+    {
+        for (const auto &ready_entry : readyList) {
+            if (ready_entry->conflictAddr(entry))
+                return ready_entry;
+        }
+        return nullptr;
+    }
+};
+
+} // anonymous namespace
+
+TEST(QueueTest, FindMatch)
+{
+    TestQueue queue(4);
+    TestEntry *uncacheable = queue.allocate(0x40, false, true, 0);
+    TestEntry *secure = queue.allocate(0x40, true, false, 0);
+    TestEntry *first = queue.allocate(0x40, false, false, 0);
+    queue.allocate(0x40, false, false, 0);
+
+    EXPECT_EQ(first, queue.findMatch(0x40, false));
+    EXPECT_EQ(uncacheable, queue.findMatch(0x40, false, false));
+    EXPECT_EQ(secure, queue.findMatch(0x40, true));
+    EXPECT_EQ(nullptr, queue.findMatch(0x80, false));
+
+    queue.deallocate(first);
+    EXPECT_NE(nullptr, queue.findMatch(0x40, false));
+    EXPECT_NE(first, queue.findMatch(0x40, false));
+}
+
+/** The earliest ready entry is found, not the first allocated one. */
+TEST(QueueTest, FindPendingInReadyOrder)
+{
+    TestQueue queue(4);
+    TestEntry *late = queue.allocate(0x40, false, false, 20);
+    TestEntry *early = queue.allocate(0x40, false, false, 10);
+    TestEntry probe;
+    probe.allocate(0x40, false, false, 0);
+
+    EXPECT_EQ(early, queue.findPending(&probe));
+    queue.markInService(early);
+    EXPECT_EQ(late, queue.findPending(&probe));
+    queue.markInService(late);
+    EXPECT_EQ(nullptr, queue.findPending(&probe));
+}
+
+/** Random queue operations, checking the index against the list scans */
+TEST(QueueTest, MatchesListScans)
+{
+    const int numEntries = 16;
+    const Addr numBlocks = 24;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> op(0, 9);
+    std::uniform_int_distribution<Addr> block(0, numBlocks - 1);
+    std::uniform_int_distribution<Tick> ready(0, 100);
+    std::bernoulli_distribution coin(0.5), rare(0.1);
+
+    TestQueue queue(numEntries);
+    std::vector<TestEntry *> entries;
+    for (int i = 0; i < 20000; i++) {
+        int o = op(rng);
+        if (o < 4 && !queue.isFull()) {
+            entries.push_back(queue.allocate(block(rng) * 64, rare(rng),
+                                             rare(rng), ready(rng)));
+        } else if (o < 6 && !entries.empty()) {
+            size_t victim = rng() % entries.size();
+            queue.deallocate(entries[victim]);
+            entries.erase(entries.begin() + victim);
+        } else if (!entries.empty()) {
+            TestEntry *entry = entries[rng() % entries.size()];
+            if (entry->inService)
+                queue.markPending(entry);
+            else
+                queue.markInService(entry);
+        }
+
+        for (Addr b = 0; b < numBlocks; b++) {
+            for (bool secure : { false, true }) {
+                Addr addr = b * 64;
+                ASSERT_EQ(queue.scanMatch(addr, secure, true),
+                          queue.findMatch(addr, secure));
+                ASSERT_EQ(queue.scanMatch(addr, secure, false),
+                          queue.findMatch(addr, secure, false));
+
+                TestEntry probe;
+                probe.allocate(addr, secure, coin(rng), 0);
+                ASSERT_EQ(queue.scanPending(&probe),
+                          queue.findPending(&probe));
+            }
+        }
+    }
+}
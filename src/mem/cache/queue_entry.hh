@@ -75,6 +75,10 @@ class QueueEntry : public Packet::SenderState
     /** True if the entry is uncacheable */
     bool _isUncacheable;
 
+    /** Neighbours in the address index of the owning queue. */
+    QueueEntry *indexPrev;
+    QueueEntry *indexNext;
+
   public:
     /**
      * A queue entry is holding packets that will be serviced as soon as
@@ -121,7 +125,8 @@ class QueueEntry : public Packet::SenderState
 
     QueueEntry()
         : readyTime(0), _isUncacheable(false),
-          inService(false), order(0), blkAddr(0), blkSize(0), isSecure(false)
+          indexPrev(nullptr), indexNext(nullptr), inService(false),
+          order(0), blkAddr(0), blkSize(0), isSecure(false)
     {}
 
     bool isUncacheable() const { return _isUncacheable; }
@@ -96,6 +96,16 @@ class BaseReplacementPolicy : public SimObject
     virtual ReplaceableEntry* getVictim(
                            const ReplacementCandidates& candidates) const = 0;
 
+    /**
+     * Whether getVictim() can be called several times, on any subset of
+     * the candidates of a replacement, to rank them. This requires victim
+     * selection to neither modify the replacement data nor depend on the
+     * position of the candidates.
+     *
+     * @return True if the victims of candidate subsets can be queried.
+     */
+    virtual bool canRankCandidates() const { return true; }
+
     /**
      * Instantiate a replacement data entry.
      *
@@ -156,6 +156,14 @@ class BRRIPRP : public BaseReplacementPolicy
     ReplaceableEntry* getVictim(const ReplacementCandidates& candidates) const
                                                                      override;
 
+    /**
+     * Victim selection ages the candidates, so it cannot be queried more
+     * than once per replacement.
+     *
+     * @return False.
+     */
+    bool canRankCandidates() const override { return false; }
+
     /**
      * Instantiate a replacement data entry.
      *
@@ -124,6 +124,14 @@ class SecondChanceRP : public FIFORP
     ReplaceableEntry* getVictim(const ReplacementCandidates& candidates) const
                                                                      override;
 
+    /**
+     * Victim selection consumes second chances, so it cannot be queried
+     * more than once per replacement.
+     *
+     * @return False.
+     */
+    bool canRankCandidates() const override { return false; }
+
     /**
      * Instantiate a replacement data entry.
      *
@@ -201,6 +201,14 @@ class TreePLRURP : public BaseReplacementPolicy
     ReplaceableEntry* getVictim(const ReplacementCandidates& candidates) const
                                                                      override;
 
+    /**
+     * Victims are selected by their position in the tree, so subsets of
+     * the candidates cannot be ranked.
+     *
+     * @return False.
+     */
+    bool canRankCandidates() const override { return false; }
+
     /**
      * Instantiate a replacement data entry. Consecutive calls to this
      * function use the same tree up to numLeaves. When numLeaves replacement
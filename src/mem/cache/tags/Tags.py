@@ -73,6 +73,17 @@ class BaseTags(ClockedObject):
     entry_size = Param.Int(Parent.cache_line_size,
                            "Indexing entry size in bytes")
 
+    # Set sampling: only model a subset of the sets in detail, and
+    # estimate the miss rate of the cache from them. Accesses to the
+    # other sets always miss and are passed on to the next level. This
+    # breaks the timing of the whole system, so only the estimated miss
+    # rate of this cache is meaningful, not the performance or the
+    # stats of other components.
+    sampled_sets = Param.Unsigned(0,
+        "Number of evenly spaced sets to model (power of 2), 0 for all. "
+        "Accesses to the other sets always miss, which breaks system "
+        "timing; only the estimated miss rate is meaningful")
+
 class BaseSetAssoc(BaseTags):
     type = 'BaseSetAssoc'
     cxx_header = "mem/cache/tags/base_set_assoc.hh"
@@ -112,6 +123,13 @@ class CompressedTags(SectorTags):
     # We simulate superblock as sector blocks
     num_blocks_per_sector = Self.max_compression_ratio
 
+    # Number of the replacement policy's preferred superblocks considered
+    # on a replacement. The one holding the fewest valid blocks is evicted,
+    # so that well-compressed superblocks are kept longer. A single
+    # candidate uses the replacement policy's victim as is.
+    victim_candidates = Param.Unsigned(1,
+        "Number of superblocks considered for eviction on a replacement.")
+
     # We virtually increase the number of data blocks per tag by multiplying
     # the cache size by the compression ratio
     size = Parent.size * Self.max_compression_ratio
@@ -50,6 +50,7 @@
 
 #include <cassert>
 
+#include "base/intmath.hh"
 #include "base/types.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/cache/tags/indexing_policies/base.hh"
@@ -68,6 +69,16 @@ BaseTags::BaseTags(const Params *p)
       stats(*this)
 {
     registerExitCallback(new BaseTagsCallback(this));
+
+    if (p->sampled_sets) {
+        fatal_if(!indexingPolicy, "%s: Set sampling requires an indexing "
+                 "policy\n", name());
+        const uint32_t num_sets = indexingPolicy->getNumSets();
+        fatal_if(!isPowerOf2(p->sampled_sets) || p->sampled_sets > num_sets,
+                 "%s: The number of sampled sets must be a power of 2 not "
+                 "larger than the number of sets (%d)\n", name(), num_sets);
+        setSampler = SetSampler(num_sets, p->sampled_sets);
+    }
 }
 
 ReplaceableEntry*
@@ -83,11 +94,10 @@ BaseTags::findBlock(Addr addr, bool is_secure) const
     Addr tag = extractTag(addr);
 
     // Find possible entries that may contain the given address
-    const std::vector<ReplaceableEntry*> entries =
-        indexingPolicy->getPossibleEntries(addr);
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
 
     // Search for block
-    for (const auto& location : entries) {
+    for (const auto& location : possibleEntries) {
         CacheBlk* blk = static_cast<CacheBlk*>(location);
         if ((blk->tag == tag) && blk->isValid() &&
             (blk->isSecure() == is_secure)) {
@@ -100,7 +110,8 @@ BaseTags::findBlock(Addr addr, bool is_secure) const
 }
 
 void
-BaseTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
+BaseTags::insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                      uint32_t task_id, CacheBlk *blk)
 {
     assert(!blk->isValid());
 
@@ -108,13 +119,11 @@ BaseTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
     // to insert the new one
 
     // Deal with what we are bringing in
-    MasterID master_id = pkt->req->masterId();
     assert(master_id < system->maxMasters());
     stats.occupancies[master_id]++;
 
     // Insert block with tag, src master id and task id
-    blk->insert(extractTag(pkt->getAddr()), pkt->isSecure(), master_id,
-                pkt->req->taskId());
+    blk->insert(extractTag(addr), is_secure, master_id, task_id);
 
     // Check if cache warm up is done
     if (!warmedUp && stats.tagsInUse.value() >= warmupBound) {
@@ -127,6 +136,19 @@ BaseTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
     stats.dataAccesses += 1;
 }
 
+void
+BaseTags::recordSampledLookup(Addr addr, bool hit)
+{
+    if (!setSampler.record(indexingPolicy->getSetIndex(addr), hit)) {
+        stats.unsampledLookups++;
+        return;
+    }
+
+    stats.sampledLookups++;
+    if (!hit)
+        stats.sampledMisses++;
+}
+
 Addr
 BaseTags::extractTag(const Addr addr) const
 {
@@ -227,7 +249,23 @@ BaseTags::BaseTagStats::BaseTagStats(BaseTags &_tags)
     percentOccsTaskId(this, "occ_task_id_percent",
                       "Percentage of cache occupancy per task id"),
     tagAccesses(this, "tag_accesses", "Number of tag accesses"),
-    dataAccesses(this, "data_accesses", "Number of data accesses")
+    dataAccesses(this, "data_accesses", "Number of data accesses"),
+    estimated(this, "estimated",
+              "Whether the sampled stats are estimates (set sampling)"),
+    sampledSets(this, "sampled_sets", "Number of sets modeled"),
+    sampledLookups(this, "sampled_lookups",
+                   "Number of lookups in the modeled sets"),
+    sampledMisses(this, "sampled_misses",
+                  "Number of misses in the modeled sets"),
+    unsampledLookups(this, "unsampled_lookups",
+                     "Number of lookups in the sets that are not modeled"),
+    estMissRate(this, "est_miss_rate",
+                "Miss rate estimated from the modeled sets"),
+    estMissRateError(this, "est_miss_rate_error",
+                     "Half width of the 95% confidence interval of "
+                     "est_miss_rate"),
+    estMisses(this, "est_misses",
+              "Number of misses estimated from the modeled sets")
 {
 }
 
@@ -242,6 +280,27 @@ BaseTags::BaseTagStats::regStats()
 
     avgRefs = totalRefs / sampledRefs;
 
+    // Set sampling stats are only printed when set sampling is used
+    estimated
+        .method(&tags, &BaseTags::isSampling)
+        .flags(nozero)
+        ;
+    sampledSets
+        .method(&tags, &BaseTags::numSampledSets)
+        .flags(nozero)
+        ;
+    sampledLookups.flags(nozero);
+    sampledMisses.flags(nozero);
+    unsampledLookups.flags(nozero);
+    estMissRate.flags(nozero | nonan);
+    estMissRate = sampledMisses / sampledLookups;
+    estMissRateError
+        .method(&tags, &BaseTags::sampledMissRateError)
+        .flags(nozero)
+        ;
+    estMisses.flags(nozero | nonan);
+    estMisses = estMissRate * (sampledLookups + unsampledLookups);
+
     occupancies
         .init(system->maxMasters())
         .flags(nozero | nonan)
@@ -279,3 +338,11 @@ BaseTags::BaseTagStats::preDumpStats()
 
     tags.computeStats();
 }
+
+void
+BaseTags::BaseTagStats::resetStats()
+{
+    Stats::Group::resetStats();
+
+    tags.setSampler.reset();
+}
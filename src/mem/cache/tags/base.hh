@@ -53,12 +53,15 @@
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "base/callback.hh"
 #include "base/logging.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/cache_blk.hh"
+#include "mem/cache/tags/indexing_policies/base.hh"
+#include "mem/cache/tags/set_sampler.hh"
 #include "mem/packet.hh"
 #include "params/BaseTags.hh"
 #include "sim/clocked_object.hh"
@@ -88,6 +91,13 @@ class BaseTags : public ClockedObject
     /** Indexing policy */
     BaseIndexingPolicy *indexingPolicy;
 
+    /**
+     * Candidates of the current lookup or replacement, filled by the
+     * indexing policy. It is reused so that lookups don't allocate, and
+     * is only valid within the tags method that filled it.
+     */
+    mutable std::vector<ReplaceableEntry*> possibleEntries;
+
     /**
      * The number of tags that need to be touched to meet the warmup
      * percentage.
@@ -102,6 +112,71 @@ class BaseTags : public ClockedObject
     /** The data blocks, 1 per cache block. */
     std::unique_ptr<uint8_t[]> dataBlks;
 
+    /**
+     * @{
+     * @name Set sampling
+     *
+     * With set sampling, only every n-th set is modeled. Lookups in
+     * the other sets always miss and nothing is allocated in them, so
+     * that their accesses are passed on to the next level. The miss
+     * rate of the modeled sets is used to estimate the miss rate of
+     * the whole cache. As the next levels see every access to the sets
+     * that are not modeled, this breaks the timing of the system, and
+     * only the estimated miss rate is meaningful. All sets are still
+     * simulated by one host thread. Tags supporting set sampling check
+     * isSampled() before looking up or allocating blocks, and report
+     * their lookups through sampleLookup().
+     */
+
+    /** Selects the modeled sets and keeps their lookups and misses. */
+    SetSampler setSampler;
+
+    /**
+     * Check if the set of an address is modeled.
+     *
+     * @param addr The address to check.
+     * @return True if the set is modeled.
+     */
+    bool isSampled(Addr addr) const
+    {
+        return !setSampler.enabled() ||
+            setSampler.isSampled(indexingPolicy->getSetIndex(addr));
+    }
+
+    /**
+     * Account for a lookup when using set sampling.
+     *
+     * @param addr The address looked up.
+     * @param hit Whether a block was found.
+     */
+    void sampleLookup(Addr addr, bool hit)
+    {
+        if (isSampling())
+            recordSampledLookup(addr, hit);
+    }
+
+    /** Update the set sampling stats for a lookup. */
+    void recordSampledLookup(Addr addr, bool hit);
+
+    /** Whether only a subset of the sets is modeled. */
+    bool isSampling() const { return setSampler.enabled(); }
+
+    /** Number of modeled sets if only a subset is modeled, 0 otherwise. */
+    Counter numSampledSets() const
+    {
+        return isSampling() ? setSampler.numSampledSets() : 0;
+    }
+
+    /**
+     * Half width of the 95% confidence interval of the estimated miss
+     * rate, treating the modeled sets as a sample of all sets.
+     */
+    double sampledMissRateError() const
+    {
+        return setSampler.missRateError();
+    }
+    /** @} */
+
     /**
      * TODO: It would be good if these stats were acquired after warmup.
      */
@@ -111,6 +186,7 @@ class BaseTags : public ClockedObject
 
         void regStats() override;
         void preDumpStats() override;
+        void resetStats() override;
 
         BaseTags &tags;
 
@@ -155,6 +231,23 @@ class BaseTags : public ClockedObject
         Stats::Scalar tagAccesses;
         /** Number of data blocks consulted over all accesses. */
         Stats::Scalar dataAccesses;
+
+        /** Set if the set sampling stats below are estimates. */
+        Stats::Value estimated;
+        /** Number of sets modeled when using set sampling. */
+        Stats::Value sampledSets;
+        /** Lookups in the modeled sets. */
+        Stats::Scalar sampledLookups;
+        /** Misses in the modeled sets. */
+        Stats::Scalar sampledMisses;
+        /** Lookups in the sets that are not modeled. */
+        Stats::Scalar unsampledLookups;
+        /** Miss rate estimated from the modeled sets. */
+        Stats::Formula estMissRate;
+        /** Half width of the 95% confidence interval of estMissRate. */
+        Stats::Value estMissRateError;
+        /** Estimated number of misses over all lookups. */
+        Stats::Formula estMisses;
     } stats;
 
   public:
@@ -303,13 +396,29 @@ class BaseTags : public ClockedObject
      */
     virtual Addr extractTag(const Addr addr) const;
 
+    /**
+     * Insert the new block into the cache and update stats.
+     *
+     * @param addr Address of the new block.
+     * @param is_secure Whether the block is in secure space or not.
+     * @param master_id Id of the master that caused the insertion.
+     * @param task_id Id of the task that caused the insertion.
+     * @param blk The block to update.
+     */
+    virtual void insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                             uint32_t task_id, CacheBlk *blk);
+
     /**
      * Insert the new block into the cache and update stats.
      *
      * @param pkt Packet holding the address to update
      * @param blk The block to update.
      */
-    virtual void insertBlock(const PacketPtr pkt, CacheBlk *blk);
+    void insertBlock(const PacketPtr pkt, CacheBlk *blk)
+    {
+        insertBlock(pkt->getAddr(), pkt->isSecure(), pkt->req->masterId(),
+                    pkt->req->taskId(), blk);
+    }
 
     /**
      * Regenerate the block address.
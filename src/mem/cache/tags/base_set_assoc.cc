@@ -50,9 +50,12 @@
 #include <string>
 
 #include "base/intmath.hh"
+#include "mem/cache/tags/indexing_policies/set_associative.hh"
 
 BaseSetAssoc::BaseSetAssoc(const Params *p)
     :BaseTags(p), allocAssoc(p->assoc), blks(p->size / p->block_size),
+     setAssociative(dynamic_cast<SetAssociative*>(p->indexing_policy)),
+     packedTags(blks.size(), p->assoc),
      sequentialAccess(p->sequential_access),
      replacementPolicy(p->replacement_policy)
 {
@@ -85,6 +88,7 @@ void
 BaseSetAssoc::invalidate(CacheBlk *blk)
 {
     BaseTags::invalidate(blk);
+    packedTags.invalidate(blk - blks.data());
 
     // Decrease the number of tags in use
     stats.tagsInUse--;
@@ -93,6 +97,34 @@ BaseSetAssoc::invalidate(CacheBlk *blk)
     replacementPolicy->invalidate(blk->replacementData);
 }
 
+const std::vector<ReplaceableEntry*>&
+BaseSetAssoc::getCandidates(Addr addr) const
+{
+    if (setAssociative)
+        return setAssociative->getSet(addr);
+
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
+    return possibleEntries;
+}
+
+CacheBlk*
+BaseSetAssoc::findBlock(Addr addr, bool is_secure) const
+{
+    if (!setAssociative)
+        return BaseTags::findBlock(addr, is_secure);
+
+    const Addr tag = extractTag(addr);
+    const std::vector<ReplaceableEntry*>& set = setAssociative->getSet(addr);
+    const int way = packedTags.findWay(set[0]->getSet(), tag,
+        [&set, is_secure](unsigned way) {
+            // Different security spaces may hold the same tag
+            const CacheBlk* blk = static_cast<CacheBlk*>(set[way]);
+            return blk->isValid() && (blk->isSecure() == is_secure);
+        });
+
+    return way < 0 ? nullptr : static_cast<CacheBlk*>(set[way]);
+}
+
 BaseSetAssoc *
 BaseSetAssocParams::create()
 {
@@ -61,9 +61,12 @@
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/cache/tags/base.hh"
 #include "mem/cache/tags/indexing_policies/base.hh"
+#include "mem/cache/tags/packed_tags.hh"
 #include "mem/packet.hh"
 #include "params/BaseSetAssoc.hh"
 
+class SetAssociative;
+
 /**
  * A basic cache tag store.
  * @sa  \ref gem5MemorySystem "gem5 Memory System"
@@ -80,6 +83,23 @@ class BaseSetAssoc : public BaseTags
     /** The cache blocks. */
     std::vector<CacheBlk> blks;
 
+    /**
+     * The indexing policy if it is set associative, else nullptr. The
+     * entries of set s are then blocks s * assoc to (s + 1) * assoc - 1,
+     * so lookups can use packedTags and the sets of the policy directly.
+     */
+    const SetAssociative *setAssociative;
+
+    /** Copy of the tags of all blocks, used with setAssociative. */
+    PackedTags packedTags;
+
+    /**
+     * Get the entries an address may be in. The sets of set associative
+     * indexing are returned directly, the other policies fill
+     * possibleEntries.
+     */
+    const std::vector<ReplaceableEntry*>& getCandidates(Addr addr) const;
+
     /** Whether tags and data are accessed sequentially. */
     const bool sequentialAccess;
 
@@ -113,6 +133,16 @@ class BaseSetAssoc : public BaseTags
      */
     void invalidate(CacheBlk *blk) override;
 
+    /**
+     * Finds the given address in the cache without touching the
+     * replacement data.
+     *
+     * @param addr The address to find.
+     * @param is_secure True if the target memory space is secure.
+     * @return Pointer to the cache block if found.
+     */
+    CacheBlk* findBlock(Addr addr, bool is_secure) const override;
+
     /**
      * Access block and update replacement data. May not succeed, in which case
      * nullptr is returned. This has all the implications of a cache access and
@@ -126,7 +156,15 @@ class BaseSetAssoc : public BaseTags
      */
     CacheBlk* accessBlock(Addr addr, bool is_secure, Cycles &lat) override
     {
+        // Lookups in sets that are not modeled always miss
+        if (!isSampled(addr)) {
+            sampleLookup(addr, false);
+            lat = lookupLatency;
+            return nullptr;
+        }
+
         CacheBlk *blk = findBlock(addr, is_secure);
+        sampleLookup(addr, blk != nullptr);
 
         // Access all tags in parallel, hence one in each way.  The data side
         // either accesses all blocks in parallel, or one block sequentially on
@@ -169,13 +207,13 @@ class BaseSetAssoc : public BaseTags
                          const std::size_t size,
                          std::vector<CacheBlk*>& evict_blks) override
     {
-        // Get possible entries to be victimized
-        const std::vector<ReplaceableEntry*> entries =
-            indexingPolicy->getPossibleEntries(addr);
+        // Nothing is allocated in sets that are not modeled
+        if (!isSampled(addr))
+            return nullptr;
 
         // Choose replacement victim from replacement candidates
         CacheBlk* victim = static_cast<CacheBlk*>(replacementPolicy->getVictim(
-                                entries));
+                                getCandidates(addr)));
 
         // There is only one eviction for this replacement
         evict_blks.push_back(victim);
@@ -186,13 +224,18 @@ class BaseSetAssoc : public BaseTags
     /**
      * Insert the new block into the cache and update replacement data.
      *
-     * @param pkt Packet holding the address to update
+     * @param addr Address of the new block.
+     * @param is_secure Whether the block is in secure space or not.
+     * @param master_id Id of the master that caused the insertion.
+     * @param task_id Id of the task that caused the insertion.
      * @param blk The block to update.
      */
-    void insertBlock(const PacketPtr pkt, CacheBlk *blk) override
+    void insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                     uint32_t task_id, CacheBlk *blk) override
     {
         // Insert block
-        BaseTags::insertBlock(pkt, blk);
+        BaseTags::insertBlock(addr, is_secure, master_id, task_id, blk);
+        packedTags.insert(blk - blks.data(), blk->tag);
 
         // Increment tag counter
         stats.tagsInUse++;
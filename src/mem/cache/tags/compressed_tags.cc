@@ -35,6 +35,8 @@
 
 #include "mem/cache/tags/compressed_tags.hh"
 
+#include "base/bitfield.hh"
+#include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/CacheComp.hh"
 #include "mem/cache/replacement_policies/base.hh"
@@ -44,8 +46,13 @@
 #include "params/CompressedTags.hh"
 
 CompressedTags::CompressedTags(const Params *p)
-    : SectorTags(p)
+    : SectorTags(p), victimCandidates(p->victim_candidates)
 {
+    fatal_if(victimCandidates == 0,
+             "At least one victim candidate must be considered");
+    fatal_if((victimCandidates > 1) &&
+             !replacementPolicy->canRankCandidates(),
+             "The replacement policy cannot rank multiple victim candidates");
 }
 
 void
@@ -105,9 +112,14 @@ CompressedTags::findVictim(Addr addr, const bool is_secure,
                            const std::size_t compressed_size,
                            std::vector<CacheBlk*>& evict_blks)
 {
+    // Nothing is allocated in sets that are not modeled
+    if (!isSampled(addr))
+        return nullptr;
+
     // Get all possible locations of this superblock
-    const std::vector<ReplaceableEntry*> superblock_entries =
-        indexingPolicy->getPossibleEntries(addr);
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
+    const std::vector<ReplaceableEntry*>& superblock_entries =
+        possibleEntries;
 
     // Check if the superblock this address belongs to has been allocated. If
     // so, try co-allocating
@@ -119,7 +131,7 @@ CompressedTags::findVictim(Addr addr, const bool is_secure,
         SuperBlk* superblock = static_cast<SuperBlk*>(entry);
         if ((tag == superblock->getTag()) && superblock->isValid() &&
             (is_secure == superblock->isSecure()) &&
-            !superblock->blks[offset]->isValid() &&
+            !superblock->isSubBlkValid(offset) &&
             superblock->isCompressed() &&
             superblock->canCoAllocate(compressed_size))
         {
@@ -133,14 +145,13 @@ CompressedTags::findVictim(Addr addr, const bool is_secure,
     // superblock must be replaced
     if (victim_superblock == nullptr){
         // Choose replacement victim from replacement candidates
-        victim_superblock = static_cast<SuperBlk*>(
-            replacementPolicy->getVictim(superblock_entries));
+        victim_superblock = SuperBlk::findVictim(replacementPolicy,
+            victimCandidates, superblock_entries, rankedCandidates);
 
         // The whole superblock must be evicted to make room for the new one
-        for (const auto& blk : victim_superblock->blks){
-            if (blk->isValid()) {
-                evict_blks.push_back(blk);
-            }
+        for (uint64_t mask = victim_superblock->getValidMask(); mask != 0;
+             mask &= mask - 1) {
+            evict_blks.push_back(victim_superblock->blks[findLsbSet(mask)]);
         }
     }
 
@@ -168,7 +179,8 @@ CompressedTags::findVictim(Addr addr, const bool is_secure,
 }
 
 void
-CompressedTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
+CompressedTags::insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                           uint32_t task_id, CacheBlk *blk)
 {
     // We check if block can co-allocate before inserting, because this check
     // assumes the block is still invalid
@@ -179,7 +191,7 @@ CompressedTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
         superblock->canCoAllocate(compression_blk->getSizeBits());
 
     // Insert block
-    SectorTags::insertBlock(pkt, blk);
+    SectorTags::insertBlock(addr, is_secure, master_id, task_id, blk);
 
     // We always store compressed blocks when possible
     if (is_co_allocatable) {
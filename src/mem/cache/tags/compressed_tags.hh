@@ -78,6 +78,15 @@ class CompressedTags : public SectorTags
     /** The cache superblocks. */
     std::vector<SuperBlk> superBlks;
 
+    /**
+     * Number of the replacement policy's preferred superblocks from which
+     * the eviction victim is chosen.
+     */
+    const unsigned victimCandidates;
+
+    /** Scratch copy of the replacement candidates, to avoid allocations. */
+    std::vector<ReplaceableEntry*> rankedCandidates;
+
   public:
     /** Convenience typedef. */
      typedef CompressedTagsParams Params;
@@ -114,10 +123,14 @@ class CompressedTags : public SectorTags
     /**
      * Insert the new block into the cache and update replacement data.
      *
-     * @param pkt Packet holding the address to update
+     * @param addr Address of the new block.
+     * @param is_secure Whether the block is in secure space or not.
+     * @param master_id Id of the master that caused the insertion.
+     * @param task_id Id of the task that caused the insertion.
      * @param blk The block to update.
      */
-    void insertBlock(const PacketPtr pkt, CacheBlk *blk) override;
+    void insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                     uint32_t task_id, CacheBlk *blk) override;
 
     /**
      * Visit each sub-block in the tags and apply a visitor.
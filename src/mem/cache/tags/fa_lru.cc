@@ -209,7 +209,8 @@ FALRU::findVictim(Addr addr, const bool is_secure, const std::size_t size,
 }
 
 void
-FALRU::insertBlock(const PacketPtr pkt, CacheBlk *blk)
+FALRU::insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                  uint32_t task_id, CacheBlk *blk)
 {
     FALRUBlk* falruBlk = static_cast<FALRUBlk*>(blk);
 
@@ -217,7 +218,7 @@ FALRU::insertBlock(const PacketPtr pkt, CacheBlk *blk)
     assert(falruBlk->inCachesMask == 0);
 
     // Do common block insertion functionality
-    BaseTags::insertBlock(pkt, blk);
+    BaseTags::insertBlock(addr, is_secure, master_id, task_id, blk);
 
     // Increment tag counter
     stats.tagsInUse++;
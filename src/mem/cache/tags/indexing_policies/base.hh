@@ -130,6 +130,26 @@ class BaseIndexingPolicy : public SimObject
      */
     ReplaceableEntry* getEntry(const uint32_t set, const uint32_t way) const;
 
+    /**
+     * Get the number of sets.
+     *
+     * @return The number of sets.
+     */
+    uint32_t getNumSets() const { return numSets; }
+
+    /**
+     * Get the index an address has in a conventional set associative
+     * mapping, which is independent of the way for skewed policies.
+     * This can be used to partition the address space by set.
+     *
+     * @param addr The address.
+     * @return The set index of the address.
+     */
+    uint32_t getSetIndex(const Addr addr) const
+    {
+        return (addr >> setShift) & setMask;
+    }
+
     /**
      * Generate the tag from the given address.
      *
@@ -143,11 +163,14 @@ class BaseIndexingPolicy : public SimObject
      * Should be called immediately before ReplacementPolicy's findVictim()
      * not to break cache resizing.
      *
+     * The entries are written to a vector owned by the caller, which
+     * doesn't need to allocate once it is reused across lookups.
+     *
      * @param addr The addr to a find possible entries for.
-     * @return The possible entries.
+     * @param entries Replaced by the possible entries.
      */
-    virtual std::vector<ReplaceableEntry*> getPossibleEntries(const Addr addr)
-                                                                    const = 0;
+    virtual void getPossibleEntries(const Addr addr,
+        std::vector<ReplaceableEntry*>& entries) const = 0;
 
     /**
      * Regenerate an entry's address from its tag and assigned indexing bits.
@@ -69,10 +69,12 @@ SetAssociative::regenerateAddr(const Addr tag, const ReplaceableEntry* entry)
     return (tag << tagShift) | (entry->getSet() << setShift);
 }
 
-std::vector<ReplaceableEntry*>
-SetAssociative::getPossibleEntries(const Addr addr) const
+void
+SetAssociative::getPossibleEntries(const Addr addr,
+    std::vector<ReplaceableEntry*>& entries) const
 {
-    return sets[extractSet(addr)];
+    const std::vector<ReplaceableEntry*>& set = getSet(addr);
+    entries.assign(set.begin(), set.end());
 }
 
 SetAssociative*
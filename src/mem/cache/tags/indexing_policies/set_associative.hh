@@ -113,10 +113,23 @@ class SetAssociative : public BaseIndexingPolicy
      * Returns entries in all ways belonging to the set of the address.
      *
      * @param addr The addr to a find possible entries for.
-     * @return The possible entries.
+     * @param entries Replaced by the possible entries.
      */
-    std::vector<ReplaceableEntry*> getPossibleEntries(const Addr addr) const
-                                                                     override;
+    void getPossibleEntries(const Addr addr,
+        std::vector<ReplaceableEntry*>& entries) const override;
+
+    /**
+     * Get the entries of the set of an address in way order, without
+     * copying them as getPossibleEntries() does. The set lives as long
+     * as the policy.
+     *
+     * @param addr The addr to find the set of.
+     * @return The entries of the set.
+     */
+    const std::vector<ReplaceableEntry*>& getSet(const Addr addr) const
+    {
+        return sets[extractSet(addr)];
+    }
 
     /**
      * Regenerate an entry's address from its tag and assigned set and way.
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * Definition of a packed copy of the tags of a set associative tag store.
+ */
+
+#ifndef __MEM_CACHE_TAGS_PACKED_TAGS_HH__
+#define __MEM_CACHE_TAGS_PACKED_TAGS_HH__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "base/types.hh"
+
+/**
+ * A copy of the tags of the blocks of a set associative tag store, in
+ * block order, where set s holds blocks s * assoc to (s + 1) * assoc - 1.
+ * A lookup compares the tags of a set in this contiguous array instead
+ * of dereferencing every block of the set. An 8-way set's tags fit in
+ * one 64-byte host cache line.
+ */
+class PackedTags
+{
+  private:
+    const unsigned assoc;
+
+    /** The tags, with MaxAddr for invalid blocks. */
+    std::vector<Addr> tags;
+
+  public:
+    PackedTags(std::size_t num_blocks, unsigned _assoc)
+        : assoc(_assoc), tags(num_blocks, MaxAddr)
+    {}
+
+    /** Record the tag of a block that was inserted. */
+    void insert(std::size_t index, Addr tag) { tags[index] = tag; }
+
+    /** Forget the tag of a block that was invalidated. */
+    void invalidate(std::size_t index) { tags[index] = MaxAddr; }
+
+    /**
+     * Find the first way of a set holding the given tag that is
+     * accepted by a predicate, e.g., checking the security space of
+     * the block, as different spaces may hold the same tag.
+     *
+     * @param set The set to search.
+     * @param tag The tag to look for.
+     * @param accept Called with a way holding the tag, returns whether
+     *               it is the way looked for.
+     * @return The way found, or -1 if there is none.
+     */
+    template <class F>
+    int
+    findWay(uint32_t set, Addr tag, F accept) const
+    {
+        const Addr* set_tags = &tags[std::size_t(set) * assoc];
+
+        // Compare the tags of up to 64 ways at once. The comparison loop
+        // has no early exit so that the compiler can vectorize it.
+        for (unsigned first = 0; first < assoc; first += 64) {
+            const unsigned ways = std::min(assoc - first, 64U);
+            uint64_t matches = 0;
+            for (unsigned way = 0; way < ways; way++) {
+                matches |= uint64_t(set_tags[first + way] == tag) << way;
+            }
+
+            for (; matches; matches &= matches - 1) {
+                const unsigned way = first + ctz64(matches);
+                if (accept(way))
+                    return way;
+            }
+        }
+        return -1;
+    }
+};
+
+#endif // __MEM_CACHE_TAGS_PACKED_TAGS_HH__
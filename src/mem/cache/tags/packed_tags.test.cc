@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "mem/cache/tags/packed_tags.hh"
+
+namespace {
+
+/** The state of a block that the lookups look at */
+struct Blk
+{
+    bool valid = false;
+    bool secure = false;
+    Addr tag = 0;
+};
+
+/**
+ * A set associative tag store that keeps its blocks and the packed tags
+ * up to date as BaseSetAssoc does.
+ */
+class TestTags
+{
+  public:
+    const uint32_t numSets;
+    const unsigned assoc;
+    std::vector<Blk> blks;
+    PackedTags packed;
+
+    TestTags(uint32_t num_sets, unsigned _assoc)
+        : numSets(num_sets), assoc(_assoc), blks(num_sets * _assoc),
+          packed(num_sets * _assoc, _assoc)
+    {}
+
+    void
+    insert(uint32_t set, unsigned way, Addr tag, bool secure)
+    {
+        const std::size_t index = set * assoc + way;
+        blks[index] = Blk{true, secure, tag};
+        packed.insert(index, tag);
+    }
+
+    void
+    invalidate(uint32_t set, unsigned way)
+    {
+        const std::size_t index = set * assoc + way;
+        blks[index].valid = false;
+        packed.invalidate(index);
+    }
+
+    /** Look up through the packed tags, as BaseSetAssoc::findBlock() */
+    int
+    find(uint32_t set, Addr tag, bool secure) const
+    {
+        const Blk* set_blks = &blks[set * assoc];
+        return packed.findWay(set, tag, [set_blks, secure](unsigned way) {
+            return set_blks[way].valid && set_blks[way].secure == secure;
+        });
+    }
+
+    /** Look up by scanning the blocks, as BaseTags::findBlock() */
+    int
+    scan(uint32_t set, Addr tag, bool secure) const
+    {
+        for (unsigned way = 0; way < assoc; way++) {
+            const Blk &blk = blks[set * assoc + way];
+            if (blk.tag == tag && blk.valid && blk.secure == secure)
+                return way;
+        }
+        return -1;
+    }
+};
+
+/**
+ * Insert and invalidate blocks at random, with few enough tags that the
+ * same tag is often in several ways of a set, and check that every
+ * lookup finds the block the scan finds.
+ */
+void
+compareWithScan(uint32_t num_sets, unsigned assoc)
+{
+    std::mt19937 rng(assoc);
+    std::uniform_int_distribution<uint32_t> set_dist(0, num_sets - 1);
+    std::uniform_int_distribution<unsigned> way_dist(0, assoc - 1);
+    std::uniform_int_distribution<Addr> tag_dist(0, assoc);
+    std::uniform_int_distribution<int> op_dist(0, 3);
+
+    TestTags tags(num_sets, assoc);
+    unsigned hits = 0;
+    for (int i = 0; i < 20000; i++) {
+        const uint32_t set = set_dist(rng);
+        const Addr tag = tag_dist(rng);
+        const bool secure = op_dist(rng) == 0;
+        switch (op_dist(rng)) {
+          case 0:
+            tags.insert(set, way_dist(rng), tag, secure);
+            break;
+          case 1:
+            tags.invalidate(set, way_dist(rng));
+            break;
+          default:
+            const int way = tags.scan(set, tag, secure);
+            ASSERT_EQ(way, tags.find(set, tag, secure));
+            hits += way >= 0;
+        }
+    }
+
+    // Both outcomes have to be covered
+    EXPECT_GT(hits, 1000u);
+    EXPECT_LT(hits, 9000u);
+}
+
+} // anonymous namespace
+
+TEST(PackedTagsTest, HitsAndMisses)
+{
+    TestTags tags(4, 8);
+    tags.insert(1, 3, 0x10, false);
+    tags.insert(1, 5, 0x20, false);
+    tags.insert(2, 0, 0x10, false);
+
+    EXPECT_EQ(3, tags.find(1, 0x10, false));
+    EXPECT_EQ(5, tags.find(1, 0x20, false));
+    EXPECT_EQ(0, tags.find(2, 0x10, false));
+    EXPECT_EQ(-1, tags.find(0, 0x10, false));
+    EXPECT_EQ(-1, tags.find(1, 0x30, false));
+}
+
+TEST(PackedTagsTest, InvalidatedBlocksMiss)
+{
+    TestTags tags(4, 8);
+    tags.insert(1, 3, 0x10, false);
+    tags.invalidate(1, 3);
+    EXPECT_EQ(-1, tags.find(1, 0x10, false));
+
+    // A new block with the same tag is found again
+    tags.insert(1, 6, 0x10, false);
+    EXPECT_EQ(6, tags.find(1, 0x10, false));
+}
+
+TEST(PackedTagsTest, SecuritySpacesShareTags)
+{
+    TestTags tags(4, 8);
+    tags.insert(0, 2, 0x10, true);
+    EXPECT_EQ(-1, tags.find(0, 0x10, false));
+
+    tags.insert(0, 4, 0x10, false);
+    EXPECT_EQ(2, tags.find(0, 0x10, true));
+    EXPECT_EQ(4, tags.find(0, 0x10, false));
+}
+
+/** Sets of more than 64 ways are compared in several chunks */
+TEST(PackedTagsTest, WaysBeyondTheFirstChunk)
+{
+    TestTags tags(2, 80);
+    tags.insert(1, 70, 0x10, false);
+    tags.insert(1, 79, 0x20, true);
+    EXPECT_EQ(70, tags.find(1, 0x10, false));
+    EXPECT_EQ(79, tags.find(1, 0x20, true));
+    EXPECT_EQ(-1, tags.find(0, 0x10, false));
+}
+
+TEST(PackedTagsTest, MatchesBlockScan)
+{
+    compareWithScan(16, 8);
+    compareWithScan(4, 16);
+    compareWithScan(2, 80);
+}
@@ -75,7 +75,7 @@ void
 SectorSubBlk::setValid()
 {
     CacheBlk::setValid();
-    _sectorBlk->validateSubBlk();
+    _sectorBlk->validateSubBlk(_sectorOffset);
 }
 
 void
@@ -89,7 +89,7 @@ void
 SectorSubBlk::invalidate()
 {
     CacheBlk::invalidate();
-    _sectorBlk->invalidateSubBlk();
+    _sectorBlk->invalidateSubBlk(_sectorOffset);
 }
 
 void
@@ -116,23 +116,10 @@ SectorSubBlk::print() const
 }
 
 SectorBlk::SectorBlk()
-    : ReplaceableEntry(), _validCounter(0), _tag(MaxAddr), _secureBit(false)
+    : ReplaceableEntry(), _validMask(0), _tag(MaxAddr), _secureBit(false)
 {
 }
 
-bool
-SectorBlk::isValid() const
-{
-    // If any of the blocks in the sector is valid, so is the sector
-    return _validCounter > 0;
-}
-
-uint8_t
-SectorBlk::getNumValid() const
-{
-    return _validCounter;
-}
-
 bool
 SectorBlk::isSecure() const
 {
@@ -153,17 +140,21 @@ SectorBlk::getTag() const
 }
 
 void
-SectorBlk::validateSubBlk()
+SectorBlk::validateSubBlk(const int offset)
 {
-    _validCounter++;
+    assert(!isSubBlkValid(offset));
+    _validMask |= ULL(1) << offset;
 }
 
 void
-SectorBlk::invalidateSubBlk()
+SectorBlk::invalidateSubBlk(const int offset)
 {
+    assert(isSubBlkValid(offset));
+    _validMask &= ~(ULL(1) << offset);
+
     // If all sub-blocks have been invalidated, the sector becomes invalid,
     // so clear secure bit
-    if (--_validCounter == 0) {
+    if (_validMask == 0) {
         _secureBit = false;
     }
 }
@@ -36,8 +36,10 @@
 #ifndef __MEM_CACHE_TAGS_SECTOR_BLK_HH__
 #define __MEM_CACHE_TAGS_SECTOR_BLK_HH__
 
+#include <cstdint>
 #include <vector>
 
+#include "base/bitfield.hh"
 #include "mem/cache/cache_blk.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 
@@ -146,10 +148,11 @@ class SectorBlk : public ReplaceableEntry
 {
   private:
     /**
-     * Counter of the number of valid sub-blocks. The sector is valid if any
-     * of its sub-blocks is valid.
+     * Bitmask of the valid sub-blocks, indexed by sector offset. The sector
+     * is valid if any of its sub-blocks is valid. Keeping it in the sector
+     * allows lookups to check a sub-block without touching it.
      */
-    uint8_t _validCounter;
+    uint64_t _validMask;
 
   protected:
     /**
@@ -176,14 +179,33 @@ class SectorBlk : public ReplaceableEntry
      *
      * @return True if any of the blocks in the sector is valid.
      */
-    bool isValid() const;
+    bool isValid() const { return _validMask != 0; }
+
+    /**
+     * Checks whether the sub-block at the given offset is valid.
+     *
+     * @param offset The sector offset of the sub-block.
+     * @return True if the sub-block is valid.
+     */
+    bool
+    isSubBlkValid(const int offset) const
+    {
+        return (_validMask >> offset) & 1;
+    }
+
+    /**
+     * Get the bitmask of the valid sub-blocks.
+     *
+     * @return A mask with a bit set per valid sub-block offset.
+     */
+    uint64_t getValidMask() const { return _validMask; }
 
     /**
      * Get the number of sub-blocks that have been validated.
      *
      * @return The number of valid sub-blocks.
      */
-    uint8_t getNumValid() const;
+    uint8_t getNumValid() const { return popCount(_validMask); }
 
     /**
      * Checks that a sector block is secure. A single secure block suffices
@@ -209,14 +231,18 @@ class SectorBlk : public ReplaceableEntry
     Addr getTag() const;
 
     /**
-     * Increase the number of valid sub-blocks.
+     * Mark a sub-block as valid.
+     *
+     * @param offset The sector offset of the sub-block.
      */
-    void validateSubBlk();
+    void validateSubBlk(const int offset);
 
     /**
-     * Decrease the number of valid sub-blocks.
+     * Mark a sub-block as invalid.
+     *
+     * @param offset The sector offset of the sub-block.
      */
-    void invalidateSubBlk();
+    void invalidateSubBlk(const int offset);
 
     /**
      * Set secure bit.
@@ -39,6 +39,7 @@
 #include <memory>
 #include <string>
 
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/types.hh"
@@ -61,6 +62,8 @@ SectorTags::SectorTags(const SectorTagsParams *p)
              "Block size must be at least 4 and a power of 2");
     fatal_if(!isPowerOf2(numBlocksPerSector),
              "# of blocks per sector must be non-zero and a power of 2");
+    fatal_if(numBlocksPerSector > 64,
+             "# of blocks per sector must not exceed 64");
 }
 
 void
@@ -136,7 +139,15 @@ SectorTags::invalidate(CacheBlk *blk)
 CacheBlk*
 SectorTags::accessBlock(Addr addr, bool is_secure, Cycles &lat)
 {
+    // Lookups in sets that are not modeled always miss
+    if (!isSampled(addr)) {
+        sampleLookup(addr, false);
+        lat = lookupLatency;
+        return nullptr;
+    }
+
     CacheBlk *blk = findBlock(addr, is_secure);
+    sampleLookup(addr, blk != nullptr);
 
     // Access all tags in parallel, hence one in each way.  The data side
     // either accesses all blocks in parallel, or one block sequentially on
@@ -171,7 +182,8 @@ SectorTags::accessBlock(Addr addr, bool is_secure, Cycles &lat)
 }
 
 void
-SectorTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
+SectorTags::insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                       uint32_t task_id, CacheBlk *blk)
 {
     // Get block's sector
     SectorSubBlk* sub_blk = static_cast<SectorSubBlk*>(blk);
@@ -191,7 +203,7 @@ SectorTags::insertBlock(const PacketPtr pkt, CacheBlk *blk)
     }
 
     // Do common block insertion functionality
-    BaseTags::insertBlock(pkt, blk);
+    BaseTags::insertBlock(addr, is_secure, master_id, task_id, blk);
 }
 
 CacheBlk*
@@ -205,15 +217,15 @@ SectorTags::findBlock(Addr addr, bool is_secure) const
     const Addr offset = extractSectorOffset(addr);
 
     // Find all possible sector entries that may contain the given address
-    const std::vector<ReplaceableEntry*> entries =
-        indexingPolicy->getPossibleEntries(addr);
-
-    // Search for block
-    for (const auto& sector : entries) {
-        auto blk = static_cast<SectorBlk*>(sector)->blks[offset];
-        if (blk->getTag() == tag && blk->isValid() &&
-            blk->isSecure() == is_secure) {
-            return blk;
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
+
+    // Search for block. The sector holds the valid bits of its sub-blocks,
+    // so only the matching sub-block is ever touched
+    for (const auto& entry : possibleEntries) {
+        const SectorBlk* sector = static_cast<SectorBlk*>(entry);
+        if (sector->getTag() == tag && sector->isSubBlkValid(offset) &&
+            sector->isSecure() == is_secure) {
+            return sector->blks[offset];
         }
     }
 
@@ -225,9 +237,13 @@ CacheBlk*
 SectorTags::findVictim(Addr addr, const bool is_secure, const std::size_t size,
                        std::vector<CacheBlk*>& evict_blks)
 {
+    // Nothing is allocated in sets that are not modeled
+    if (!isSampled(addr))
+        return nullptr;
+
     // Get possible entries to be victimized
-    const std::vector<ReplaceableEntry*> sector_entries =
-        indexingPolicy->getPossibleEntries(addr);
+    indexingPolicy->getPossibleEntries(addr, possibleEntries);
+    const std::vector<ReplaceableEntry*>& sector_entries = possibleEntries;
 
     // Check if the sector this address belongs to has been allocated
     Addr tag = extractTag(addr);
@@ -260,10 +276,9 @@ SectorTags::findVictim(Addr addr, const bool is_secure, const std::size_t size,
         assert(!victim->isValid());
     } else {
         // The whole sector must be evicted to make room for the new sector
-        for (const auto& blk : victim_sector->blks){
-            if (blk->isValid()) {
-                evict_blks.push_back(blk);
-            }
+        for (uint64_t mask = victim_sector->getValidMask(); mask != 0;
+             mask &= mask - 1) {
+            evict_blks.push_back(victim_sector->blks[findLsbSet(mask)]);
         }
     }
 
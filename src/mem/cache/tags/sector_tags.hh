@@ -144,10 +144,14 @@ class SectorTags : public BaseTags
     /**
      * Insert the new block into the cache and update replacement data.
      *
-     * @param pkt Packet holding the address to update
+     * @param addr Address of the new block.
+     * @param is_secure Whether the block is in secure space or not.
+     * @param master_id Id of the master that caused the insertion.
+     * @param task_id Id of the task that caused the insertion.
      * @param blk The block to update.
      */
-    void insertBlock(const PacketPtr pkt, CacheBlk *blk) override;
+    void insertBlock(Addr addr, bool is_secure, MasterID master_id,
+                     uint32_t task_id, CacheBlk *blk) override;
 
     /**
      * Finds the given address in the cache, do not update replacement data.
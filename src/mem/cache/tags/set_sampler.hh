@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * Definition of the set selection and miss rate estimation of set
+ * sampling.
+ */
+
+#ifndef __MEM_CACHE_TAGS_SET_SAMPLER_HH__
+#define __MEM_CACHE_TAGS_SET_SAMPLER_HH__
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+/**
+ * Picks the sets that are modeled when only a subset of the sets of a
+ * cache is modeled, and estimates the miss rate of the whole cache from
+ * them. Every n-th set is modeled, and the modeled sets are treated as a
+ * random sample of all sets.
+ */
+class SetSampler
+{
+  private:
+    /** Number of sets of the cache. */
+    uint32_t numSets;
+
+    /** Set index bits that are zero for the modeled sets. */
+    uint32_t mask;
+
+    /** Shift from the set index of a modeled set to its sample. */
+    int shift;
+
+    /** Lookups and misses of a modeled set. */
+    struct SetSample
+    {
+        Counter lookups = 0;
+        Counter misses = 0;
+    };
+
+    /** Lookups and misses of each modeled set since the last reset. */
+    std::vector<SetSample> samples;
+
+  public:
+    /** A sampler modeling all sets. */
+    SetSampler() : numSets(0), mask(0), shift(0) {}
+
+    /**
+     * @param num_sets The number of sets of the cache.
+     * @param sampled_sets The number of sets to model, a power of 2 not
+     *                     larger than num_sets.
+     */
+    SetSampler(uint32_t num_sets, uint32_t sampled_sets)
+        : numSets(num_sets),
+          shift(floorLog2(num_sets / sampled_sets)),
+          samples(sampled_sets)
+    {
+        assert(isPowerOf2(sampled_sets) && sampled_sets <= num_sets);
+        mask = (1 << shift) - 1;
+    }
+
+    /** Whether only a subset of the sets is modeled. */
+    bool enabled() const { return mask; }
+
+    /** Number of modeled sets. */
+    std::size_t numSampledSets() const { return samples.size(); }
+
+    /** Check if a set is modeled. */
+    bool isSampled(uint32_t set) const { return (set & mask) == 0; }
+
+    /**
+     * Account for a lookup in a set.
+     *
+     * @param set The set looked up.
+     * @param hit Whether a block was found.
+     * @return True if the set is modeled.
+     */
+    bool record(uint32_t set, bool hit)
+    {
+        if (!isSampled(set))
+            return false;
+
+        SetSample &sample = samples[set >> shift];
+        sample.lookups++;
+        if (!hit)
+            sample.misses++;
+        return true;
+    }
+
+    /** Miss rate of the modeled sets, the estimate for the cache. */
+    double missRate() const
+    {
+        double lookups = 0;
+        double misses = 0;
+        for (const auto &sample : samples) {
+            lookups += sample.lookups;
+            misses += sample.misses;
+        }
+        return lookups ? misses / lookups : 0;
+    }
+
+    /**
+     * Half width of the 95% confidence interval of missRate(), from
+     * the variance of a ratio estimator over the modeled sets.
+     */
+    double missRateError() const
+    {
+        const double n = samples.size();
+        double lookups = 0;
+        for (const auto &sample : samples)
+            lookups += sample.lookups;
+        if (n < 2 || lookups == 0)
+            return 0;
+
+        const double rate = missRate();
+        double sq_dev = 0;
+        for (const auto &sample : samples) {
+            const double dev = sample.misses - rate * sample.lookups;
+            sq_dev += dev * dev;
+        }
+
+        // Apply the finite population correction, as sets are sampled
+        // without replacement
+        const double fpc = 1.0 - n / numSets;
+        const double mean_lookups = lookups / n;
+        return 1.96 * std::sqrt(fpc * sq_dev / (n - 1) / n) / mean_lookups;
+    }
+
+    /** Forget the lookups so far. */
+    void reset()
+    {
+        for (auto &sample : samples)
+            sample = SetSample();
+    }
+};
+
+#endif // __MEM_CACHE_TAGS_SET_SAMPLER_HH__
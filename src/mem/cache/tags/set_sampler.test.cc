@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mem/cache/tags/set_sampler.hh"
+
+TEST(SetSamplerTest, Disabled)
+{
+    SetSampler sampler;
+    EXPECT_FALSE(sampler.enabled());
+    EXPECT_TRUE(sampler.isSampled(1));
+
+    // Modeling all sets is the same as not sampling
+    SetSampler all(16, 16);
+    EXPECT_FALSE(all.enabled());
+    for (uint32_t set = 0; set < 16; set++)
+        EXPECT_TRUE(all.isSampled(set));
+}
+
+/** Every n-th set is modeled, starting with set 0 */
+TEST(SetSamplerTest, SetSelection)
+{
+    SetSampler sampler(64, 8);
+    EXPECT_TRUE(sampler.enabled());
+    EXPECT_EQ(8u, sampler.numSampledSets());
+
+    for (uint32_t set = 0; set < 64; set++) {
+        EXPECT_EQ(set % 8 == 0, sampler.isSampled(set));
+        EXPECT_EQ(set % 8 == 0, sampler.record(set, false));
+    }
+}
+
+/** Only the lookups of the modeled sets count towards the estimate */
+TEST(SetSamplerTest, MissRate)
+{
+    SetSampler sampler(64, 8);
+    EXPECT_EQ(0, sampler.missRate());
+    EXPECT_EQ(0, sampler.missRateError());
+
+    for (uint32_t set = 0; set < 64; set++) {
+        // Hits in the modeled sets, misses in the others
+        for (int i = 0; i < 4; i++)
+            sampler.record(set, set % 8 == 0 && i > 0);
+    }
+    EXPECT_DOUBLE_EQ(0.25, sampler.missRate());
+
+    // Sets with the same miss rate leave no uncertainty
+    EXPECT_DOUBLE_EQ(0, sampler.missRateError());
+
+    sampler.reset();
+    EXPECT_EQ(0, sampler.missRate());
+}
+
+/** Modeling every set gives the exact miss rate */
+TEST(SetSamplerTest, NoErrorWithAllSets)
+{
+    SetSampler sampler(16, 16);
+    for (uint32_t set = 0; set < 16; set++) {
+        for (uint32_t i = 0; i <= set; i++)
+            sampler.record(set, i % 2);
+    }
+    EXPECT_GT(sampler.missRate(), 0);
+    EXPECT_DOUBLE_EQ(0, sampler.missRateError());
+}
+
+/**
+ * Sets with different lookup counts and miss rates: the miss rate of
+ * the whole cache falls into the 95% confidence interval of the
+ * estimate in about 95% of the runs.
+ */
+TEST(SetSamplerTest, ExtrapolatedMissRate)
+{
+    const uint32_t numSets = 1024;
+    const int runs = 200;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> miss_prob(0.0, 0.5);
+    std::uniform_int_distribution<int> num_lookups(50, 150);
+
+    int covered = 0;
+    for (int r = 0; r < runs; r++) {
+        SetSampler sampler(numSets, 64);
+        double lookups = 0;
+        double misses = 0;
+        for (uint32_t set = 0; set < numSets; set++) {
+            std::bernoulli_distribution miss(miss_prob(rng));
+            int n = num_lookups(rng);
+            for (int i = 0; i < n; i++) {
+                bool hit = !miss(rng);
+                sampler.record(set, hit);
+                lookups++;
+                misses += !hit;
+            }
+        }
+
+        const double rate = misses / lookups;
+        const double error = sampler.missRateError();
+        EXPECT_GT(error, 0);
+        EXPECT_LT(error, 0.05);
+        if (std::fabs(sampler.missRate() - rate) <= error)
+            covered++;
+    }
+    EXPECT_GE(covered, runs * 85 / 100);
+}
@@ -36,7 +36,11 @@
 
 #include "mem/cache/tags/super_blk.hh"
 
+#include <algorithm>
+
+#include "base/bitfield.hh"
 #include "base/logging.hh"
+#include "mem/cache/replacement_policies/base.hh"
 
 CompressionBlk::CompressionBlk()
     : SectorSubBlk(), _size(0), _decompressionLatency(0)
@@ -53,12 +57,24 @@ void
 CompressionBlk::setCompressed()
 {
     status |= BlkCompressed;
+    static_cast<SuperBlk*>(_sectorBlk)->setCompressedSubBlk(
+        getSectorOffset(), true);
 }
 
 void
 CompressionBlk::setUncompressed()
 {
     status &= ~BlkCompressed;
+    static_cast<SuperBlk*>(_sectorBlk)->setCompressedSubBlk(
+        getSectorOffset(), false);
+}
+
+void
+CompressionBlk::invalidate()
+{
+    SectorSubBlk::invalidate();
+    static_cast<SuperBlk*>(_sectorBlk)->setCompressedSubBlk(
+        getSectorOffset(), false);
 }
 
 std::size_t
@@ -96,14 +112,18 @@ CompressionBlk::print() const
 bool
 SuperBlk::isCompressed(const CompressionBlk* ignored_blk) const
 {
-    for (const auto& blk : blks) {
-        if (blk->isValid() && (blk != ignored_blk)) {
-            return static_cast<CompressionBlk*>(blk)->isCompressed();
-        }
+    uint64_t valid_mask = getValidMask();
+    if (ignored_blk && (ignored_blk->getSectorBlock() == this)) {
+        valid_mask &= ~(ULL(1) << ignored_blk->getSectorOffset());
     }
 
     // An invalid block is seen as compressed
-    return true;
+    if (valid_mask == 0) {
+        return true;
+    }
+
+    // The first valid block determines the compression state
+    return (_compressedMask >> findLsbSet(valid_mask)) & 1;
 }
 
 bool
@@ -115,9 +135,50 @@ SuperBlk::canCoAllocate(const std::size_t compressed_size) const
     return (compressed_size <= (blkSize * 8) / blks.size());
 }
 
+void
+SuperBlk::setCompressedSubBlk(const int offset, const bool compressed)
+{
+    if (compressed) {
+        _compressedMask |= ULL(1) << offset;
+    } else {
+        _compressedMask &= ~(ULL(1) << offset);
+    }
+}
+
 void
 SuperBlk::setBlkSize(const std::size_t blk_size)
 {
     assert(blkSize == 0);
     blkSize = blk_size;
 }
+
+SuperBlk*
+SuperBlk::findVictim(BaseReplacementPolicy* rp, const unsigned num_candidates,
+                     const std::vector<ReplaceableEntry*>& entries,
+                     std::vector<ReplaceableEntry*>& ranked)
+{
+    SuperBlk* victim = static_cast<SuperBlk*>(rp->getVictim(entries));
+
+    // Nothing is evicted when replacing an invalid superblock
+    if ((num_candidates == 1) || !victim->isValid()) {
+        return victim;
+    }
+
+    // Successively remove the policy's victim from the candidates to get
+    // its next preferred superblocks
+    ranked.assign(entries.begin(), entries.end());
+    SuperBlk* candidate = victim;
+    for (unsigned i = 1; (i < num_candidates) && (ranked.size() > 1); i++) {
+        ranked.erase(std::find(ranked.begin(), ranked.end(), candidate));
+        candidate = static_cast<SuperBlk*>(rp->getVictim(ranked));
+
+        if (candidate->getNumValid() < victim->getNumValid()) {
+            victim = candidate;
+            if (!victim->isValid()) {
+                break;
+            }
+        }
+    }
+
+    return victim;
+}
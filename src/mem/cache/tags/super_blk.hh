@@ -37,8 +37,11 @@
 #ifndef __MEM_CACHE_TAGS_SUPER_BLK_HH__
 #define __MEM_CACHE_TAGS_SUPER_BLK_HH__
 
+#include <vector>
+
 #include "mem/cache/tags/sector_blk.hh"
 
+class BaseReplacementPolicy;
 class SuperBlk;
 
 /**
@@ -84,6 +87,11 @@ class CompressionBlk : public SectorSubBlk
      */
     void setUncompressed();
 
+    /**
+     * Invalidate the block and clear its compression bit in the superblock.
+     */
+    void invalidate() override;
+
     /*
      * Get size, in bits, of this compressed block's data.
      *
@@ -130,8 +138,14 @@ class SuperBlk : public SectorBlk
     /** Block size, in bytes. */
     std::size_t blkSize;
 
+    /**
+     * Bitmask of the sub-blocks holding compressed data, indexed by sector
+     * offset. Only the bits of valid sub-blocks are meaningful.
+     */
+    uint64_t _compressedMask;
+
   public:
-    SuperBlk() : SectorBlk(), blkSize(0) {}
+    SuperBlk() : SectorBlk(), blkSize(0), _compressedMask(0) {}
     SuperBlk(const SuperBlk&) = delete;
     SuperBlk& operator=(const SuperBlk&) = delete;
     ~SuperBlk() {};
@@ -153,12 +167,38 @@ class SuperBlk : public SectorBlk
      */
     bool canCoAllocate(const std::size_t compressed_size) const;
 
+    /**
+     * Update the compression bit of a sub-block. Called by the sub-blocks
+     * whenever their compression state changes.
+     *
+     * @param offset The sector offset of the sub-block.
+     * @param compressed Whether the sub-block holds compressed data.
+     */
+    void setCompressedSubBlk(const int offset, const bool compressed);
+
     /**
      * Set block size. Should be called only once, when initializing blocks.
      *
      * @param blk_size The uncompressed block size.
      */
     void setBlkSize(const std::size_t blk_size);
+
+    /**
+     * Choose the superblock to be evicted among the possible entries. The
+     * replacement policy is queried for its num_candidates preferred
+     * superblocks, and the one that holds the fewest valid blocks is
+     * chosen. Ties are broken in favour of the policy's preference.
+     *
+     * @param rp The replacement policy of the superblocks.
+     * @param num_candidates Number of preferred superblocks considered.
+     * @param entries The superblocks the address can be mapped to.
+     * @param ranked Scratch vector used to rank the candidates.
+     * @return The superblock to be evicted.
+     */
+    static SuperBlk* findVictim(BaseReplacementPolicy* rp,
+                                const unsigned num_candidates,
+                                const std::vector<ReplaceableEntry*>& entries,
+                                std::vector<ReplaceableEntry*>& ranked);
 };
 
 #endif //__MEM_CACHE_TAGS_SUPER_BLK_HH__
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "mem/cache/replacement_policies/lru_rp.hh"
+#include "mem/cache/tags/super_blk.hh"
+#include "params/LRURP.hh"
+#include "sim/eventq.hh"
+
+namespace {
+
+const std::size_t blkSize = 64;
+const unsigned numBlocksPerSector = 4;
+const Addr tag = 0x10;
+
+/** Set the current tick, which the blocks and LRU record on updates */
+void
+setTick(Tick tick)
+{
+    curEventQueue(getEventQueue(0));
+    curEventQueue()->setCurTick(tick);
+}
+
+/**
+ * The replacement policy of the superblocks. SimObjects can't be
+ * destroyed before the drain manager, so it is never freed.
+ */
+BaseReplacementPolicy *
+lru()
+{
+    static LRURP *rp = nullptr;
+    if (!rp) {
+        LRURPParams p;
+        p.name = "lru";
+        p.eventq_index = 0;
+        rp = new LRURP(&p);
+    }
+    return rp;
+}
+
+/** A superblock and its sub-blocks, linked as CompressedTags does */
+struct TestSuperBlk
+{
+    SuperBlk superblock;
+    std::vector<CompressionBlk> blks;
+
+    TestSuperBlk()
+        : blks(numBlocksPerSector)
+    {
+        superblock.setBlkSize(blkSize);
+        superblock.replacementData = lru()->instantiateEntry();
+        superblock.blks.resize(numBlocksPerSector, nullptr);
+        for (unsigned k = 0; k < numBlocksPerSector; k++) {
+            superblock.blks[k] = &blks[k];
+            blks[k].setSectorBlock(&superblock);
+            blks[k].replacementData = superblock.replacementData;
+            blks[k].setSectorOffset(k);
+        }
+    }
+
+    /**
+     * Insert a block of the given compressed size at the given offset,
+     * storing it compressed when it can be co-allocated, as
+     * CompressedTags::insertBlock() does.
+     */
+    CompressionBlk &
+    insert(int offset, std::size_t size_bits, bool is_secure = false)
+    {
+        CompressionBlk &blk = blks[offset];
+        const bool is_co_allocatable = superblock.isCompressed() &&
+            superblock.canCoAllocate(size_bits);
+        blk.setSizeBits(size_bits);
+        blk.insert(tag, is_secure, 0, 0);
+        if (is_co_allocatable) {
+            blk.setCompressed();
+        } else {
+            blk.setUncompressed();
+        }
+        return blk;
+    }
+
+    /** Validate the given number of blocks and touch the superblock */
+    void
+    fill(unsigned num_valid, Tick touch_tick)
+    {
+        setTick(touch_tick);
+        for (unsigned k = 0; k < num_valid; k++) {
+            insert(k, 32);
+        }
+        lru()->reset(superblock.replacementData);
+    }
+};
+
+/**
+ * Create superblocks touched in order, so that the first is the LRU
+ * victim, holding the given number of valid blocks each.
+ */
+std::vector<std::unique_ptr<TestSuperBlk>>
+makeSet(const std::vector<unsigned> &num_valid)
+{
+    std::vector<std::unique_ptr<TestSuperBlk>> set;
+    for (unsigned i = 0; i < num_valid.size(); i++) {
+        set.emplace_back(new TestSuperBlk());
+        set.back()->fill(num_valid[i], i + 1);
+    }
+    return set;
+}
+
+std::vector<ReplaceableEntry*>
+entriesOf(const std::vector<std::unique_ptr<TestSuperBlk>> &set)
+{
+    std::vector<ReplaceableEntry*> entries;
+    for (const auto &sb : set) {
+        entries.push_back(&sb->superblock);
+    }
+    return entries;
+}
+
+SuperBlk *
+findVictim(const std::vector<ReplaceableEntry*> &entries,
+           unsigned num_candidates)
+{
+    std::vector<ReplaceableEntry*> ranked;
+    return SuperBlk::findVictim(lru(), num_candidates, entries, ranked);
+}
+
+} // anonymous namespace
+
+TEST(SuperBlkTest, ValidMaskFollowsInsertAndEvict)
+{
+    setTick(1);
+    TestSuperBlk sb;
+    SuperBlk &superblock = sb.superblock;
+    EXPECT_FALSE(superblock.isValid());
+    EXPECT_EQ(0, superblock.getValidMask());
+
+    sb.insert(0, 32, true);
+    sb.insert(2, 32, true);
+    EXPECT_TRUE(superblock.isValid());
+    EXPECT_TRUE(superblock.isSecure());
+    EXPECT_EQ(0x5, superblock.getValidMask());
+    EXPECT_EQ(2, superblock.getNumValid());
+    EXPECT_TRUE(superblock.isSubBlkValid(0));
+    EXPECT_FALSE(superblock.isSubBlkValid(1));
+    EXPECT_TRUE(superblock.isSubBlkValid(2));
+    EXPECT_EQ(tag, superblock.getTag());
+
+    sb.blks[0].invalidate();
+    EXPECT_EQ(0x4, superblock.getValidMask());
+    EXPECT_EQ(1, superblock.getNumValid());
+    EXPECT_TRUE(superblock.isSecure());
+
+    // Evicting the last sub-block invalidates the sector
+    sb.blks[2].invalidate();
+    EXPECT_FALSE(superblock.isValid());
+    EXPECT_EQ(0, superblock.getValidMask());
+    EXPECT_FALSE(superblock.isSecure());
+}
+
+TEST(SuperBlkTest, CompressedMaskFollowsInsertAndEvict)
+{
+    setTick(1);
+    TestSuperBlk sb;
+    SuperBlk &superblock = sb.superblock;
+
+    // An empty superblock is seen as compressed, and blocks that fit in
+    // a quarter of the line are co-allocated
+    EXPECT_TRUE(superblock.isCompressed());
+    EXPECT_TRUE(sb.insert(0, 128).isCompressed());
+    EXPECT_TRUE(sb.insert(1, 100).isCompressed());
+    EXPECT_TRUE(superblock.isCompressed());
+
+    // Evicting the first block leaves the second one in charge
+    sb.blks[0].invalidate();
+    EXPECT_FALSE(sb.blks[0].isCompressed());
+    EXPECT_TRUE(superblock.isCompressed());
+    sb.blks[1].invalidate();
+    EXPECT_TRUE(superblock.isCompressed());
+
+    // The compression bit of an evicted block does not outlive it
+    EXPECT_FALSE(sb.insert(0, 200).isCompressed());
+    EXPECT_FALSE(superblock.isCompressed());
+    EXPECT_TRUE(superblock.isCompressed(&sb.blks[0]));
+    EXPECT_FALSE(superblock.canCoAllocate(200));
+
+    sb.blks[0].invalidate();
+    EXPECT_TRUE(superblock.isCompressed());
+    EXPECT_TRUE(sb.insert(3, 64).isCompressed());
+    EXPECT_EQ(0x8, superblock.getValidMask());
+}
+
+TEST(SuperBlkTest, SingleCandidateIsPolicyVictim)
+{
+    auto set = makeSet({3, 1, 2, 4});
+    const auto entries = entriesOf(set);
+    EXPECT_EQ(&set[0]->superblock, findVictim(entries, 1));
+}
+
+TEST(SuperBlkTest, FewestValidAmongCandidates)
+{
+    auto set = makeSet({3, 2, 1, 0});
+    const auto entries = entriesOf(set);
+
+    // Only the policy's num_candidates preferred superblocks compete
+    EXPECT_EQ(&set[1]->superblock, findVictim(entries, 2));
+    EXPECT_EQ(&set[2]->superblock, findVictim(entries, 3));
+    EXPECT_EQ(&set[3]->superblock, findVictim(entries, 4));
+    EXPECT_EQ(&set[3]->superblock, findVictim(entries, 8));
+
+    // The candidates given are left untouched
+    EXPECT_EQ(entriesOf(set), entries);
+}
+
+TEST(SuperBlkTest, TiesGoToPolicyPreference)
+{
+    auto set = makeSet({2, 2, 3, 2});
+    const auto entries = entriesOf(set);
+    EXPECT_EQ(&set[0]->superblock, findVictim(entries, 2));
+    EXPECT_EQ(&set[0]->superblock, findVictim(entries, 4));
+}
+
+TEST(SuperBlkTest, InvalidSuperblockIsChosen)
+{
+    // The policy's own victim is invalid
+    auto set = makeSet({0, 1, 2, 3});
+    EXPECT_EQ(&set[0]->superblock, findVictim(entriesOf(set), 4));
+
+    // An invalid superblock stops the search
+    set = makeSet({3, 0, 2, 1});
+    EXPECT_EQ(&set[1]->superblock, findVictim(entriesOf(set), 4));
+}
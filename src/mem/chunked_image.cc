@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/chunked_image.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+using namespace std;
+
+namespace ChunkedImage {
+
+namespace {
+
+/**
+ * Layout of chunked memory images. The header is followed by one index
+ * entry per block and then by the block data. Uncompressed blocks are
+ * page aligned in the file so that they can be mapped directly.
+ */
+const char chunkedMagic[8] = { 'M', '5', 'C', 'P', 'M', 'E', 'M', '\0' };
+const uint32_t chunkedVersion = 1;
+
+struct ChunkedHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t blockSize;
+    uint64_t rangeSize;
+};
+
+enum ChunkedBlockType : uint32_t
+{
+    BlockZero = 0,
+    BlockRaw = 1,
+    BlockDeflate = 2,
+};
+
+struct ChunkedIndexEntry
+{
+    uint64_t offset;
+    uint32_t size;
+    uint32_t type;
+};
+
+/**
+ * Run func(i) for all i in [begin, end) on the given number of host
+ * threads.
+ */
+void
+parallelFor(uint64_t begin, uint64_t end, unsigned threads,
+            const function<void(uint64_t)> &func)
+{
+    atomic<uint64_t> next(begin);
+    auto worker = [&next, end, &func]() {
+        for (uint64_t i = next++; i < end; i = next++)
+            func(i);
+    };
+
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+}
+
+bool
+allZero(const uint8_t *data, uint64_t len)
+{
+    const uint64_t *words = reinterpret_cast<const uint64_t *>(data);
+    for (uint64_t i = 0; i < len / sizeof(uint64_t); ++i) {
+        if (words[i])
+            return false;
+    }
+    for (uint64_t i = len & ~(sizeof(uint64_t) - 1); i < len; ++i) {
+        if (data[i])
+            return false;
+    }
+    return true;
+}
+
+void
+writeAt(int fd, const void *buf, uint64_t len, uint64_t offset,
+        const string &filename)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(buf);
+    while (len) {
+        ssize_t ret = pwrite(fd, p, min<uint64_t>(len, INT_MAX), offset);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            fatal("Write failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        }
+        p += ret;
+        len -= ret;
+        offset += ret;
+    }
+}
+
+} // anonymous namespace
+
+void
+write(const string &filepath, const uint8_t *pmem, uint64_t range_size,
+      uint64_t block_size, int compression, unsigned threads)
+{
+    const uint64_t num_blocks = divCeil(range_size, block_size);
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+
+    int fd = open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0)
+        fatal("Can't open physical memory checkpoint file '%s'\n", filepath);
+
+    ChunkedHeader header;
+    memcpy(header.magic, chunkedMagic, sizeof(header.magic));
+    header.version = chunkedVersion;
+    header.reserved = 0;
+    header.blockSize = block_size;
+    header.rangeSize = range_size;
+    writeAt(fd, &header, sizeof(header), 0, filepath);
+
+    vector<ChunkedIndexEntry> index(num_blocks);
+    uint64_t offset = sizeof(header) + num_blocks * sizeof(ChunkedIndexEntry);
+
+    // Compress a batch of blocks at a time to bound the amount of
+    // memory needed for the compressed data.
+    const uint64_t batch_size = 4 * threads;
+    vector<vector<uint8_t>> buffers(batch_size);
+
+    for (uint64_t first = 0; first < num_blocks; first += batch_size) {
+        const uint64_t last = min(first + batch_size, num_blocks);
+
+        parallelFor(first, last, threads, [&](uint64_t b) {
+            const uint8_t *src = pmem + b * block_size;
+            const uint64_t len = min(block_size, range_size - b * block_size);
+            ChunkedIndexEntry &entry = index[b];
+
+            entry.size = len;
+            if (allZero(src, len)) {
+                entry.type = BlockZero;
+                entry.size = 0;
+                return;
+            }
+
+            entry.type = BlockRaw;
+            if (compression == 0)
+                return;
+
+            vector<uint8_t> &buf = buffers[b - first];
+            uLongf dest_len = compressBound(len);
+            buf.resize(dest_len);
+            if (compress2(buf.data(), &dest_len, src, len,
+                          compression) != Z_OK) {
+                panic("Failed to compress physical memory block %d\n", b);
+            }
+
+            // Keep incompressible blocks as they are
+            if (dest_len < len) {
+                entry.type = BlockDeflate;
+                entry.size = dest_len;
+            }
+        });
+
+        for (uint64_t b = first; b < last; ++b) {
+            ChunkedIndexEntry &entry = index[b];
+            if (entry.type == BlockZero) {
+                entry.offset = 0;
+                continue;
+            }
+
+            if (entry.type == BlockRaw) {
+                offset = roundUp(offset, page_size);
+                writeAt(fd, pmem + b * block_size, entry.size, offset,
+                        filepath);
+            } else {
+                writeAt(fd, buffers[b - first].data(), entry.size, offset,
+                        filepath);
+            }
+            entry.offset = offset;
+            offset += entry.size;
+        }
+    }
+
+    writeAt(fd, index.data(), num_blocks * sizeof(ChunkedIndexEntry),
+            sizeof(header), filepath);
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+}
+
+uint64_t
+read(const string &filepath, uint8_t *pmem, uint64_t range_size,
+     unsigned threads, bool map_raw)
+{
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        fatal("Can't open physical memory checkpoint file '%s'\n", filepath);
+
+    struct stat st;
+    if (fstat(fd, &st))
+        fatal("Can't stat physical memory checkpoint file '%s'\n", filepath);
+    const uint64_t file_size = st.st_size;
+
+    const uint8_t *image = static_cast<const uint8_t *>(
+        mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0));
+    if (image == (const uint8_t *) MAP_FAILED) {
+        perror("mmap");
+        fatal("Could not mmap physical memory checkpoint file '%s'\n",
+              filepath);
+    }
+
+    ChunkedHeader header;
+    fatal_if(file_size < sizeof(header),
+             "Truncated physical memory checkpoint file '%s'\n", filepath);
+    memcpy(&header, image, sizeof(header));
+    fatal_if(memcmp(header.magic, chunkedMagic, sizeof(header.magic)) ||
+             header.version != chunkedVersion,
+             "'%s' is not a chunked physical memory checkpoint\n", filepath);
+    fatal_if(header.rangeSize != range_size,
+             "Memory range size has changed! Saw %lld, expected %lld\n",
+             header.rangeSize, range_size);
+
+    const uint64_t block_size = header.blockSize;
+    const uint64_t num_blocks = divCeil(header.rangeSize, block_size);
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    fatal_if(file_size < sizeof(header) +
+             num_blocks * sizeof(ChunkedIndexEntry),
+             "Truncated physical memory checkpoint file '%s'\n", filepath);
+
+    const ChunkedIndexEntry *index =
+        reinterpret_cast<const ChunkedIndexEntry *>(image + sizeof(header));
+
+    // Uncompressed blocks can be mapped straight from the image, which
+    // defers reading them until the guest touches them. This only
+    // works if the block is page aligned both in the image and in the
+    // backing store.
+    const bool can_map = map_raw && block_size % page_size == 0 &&
+        reinterpret_cast<uintptr_t>(pmem) % page_size == 0;
+
+    atomic<uint64_t> mapped(0);
+    parallelFor(0, num_blocks, threads, [&](uint64_t b) {
+        const ChunkedIndexEntry &entry = index[b];
+        uint8_t *dst = pmem + b * block_size;
+        const uint64_t len =
+            min(block_size, header.rangeSize - b * block_size);
+
+        // The backing store is freshly mapped and thus already zero
+        if (entry.type == BlockZero)
+            return;
+
+        fatal_if(entry.offset + entry.size > file_size,
+                 "Truncated physical memory checkpoint file '%s'\n",
+                 filepath);
+
+        if (entry.type == BlockRaw) {
+            fatal_if(entry.size != len, "Corrupt block %d in '%s'\n",
+                     b, filepath);
+            if (can_map && entry.offset % page_size == 0 &&
+                mmap(dst, roundUp(len, page_size), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_FIXED, fd, entry.offset) !=
+                MAP_FAILED) {
+                mapped++;
+            } else {
+                memcpy(dst, image + entry.offset, len);
+            }
+        } else if (entry.type == BlockDeflate) {
+            uLongf dest_len = len;
+            if (uncompress(dst, &dest_len, image + entry.offset,
+                           entry.size) != Z_OK || dest_len != len) {
+                fatal("Corrupt block %d in '%s'\n", b, filepath);
+            }
+        } else {
+            fatal("Unknown block type %d in '%s'\n", entry.type, filepath);
+        }
+    });
+
+    munmap(const_cast<uint8_t *>(image), file_size);
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+
+    return mapped;
+}
+
+} // namespace ChunkedImage
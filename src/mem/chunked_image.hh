@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Chunked memory images, the parallel checkpoint format of physical
+ * memory backing stores.
+ */
+
+#ifndef __MEM_CHUNKED_IMAGE_HH__
+#define __MEM_CHUNKED_IMAGE_HH__
+
+#include <cstdint>
+#include <string>
+
+/**
+ * A chunked memory image splits a backing store into fixed-size blocks
+ * that are compressed independently, so that they can be written and
+ * read by several host threads at once. The file starts with a header
+ * and an index with one entry per block, followed by the block data.
+ *
+ * All-zero blocks are not stored at all. Blocks are deflated with
+ * zlib, unless compression is disabled or a block doesn't compress,
+ * in which case it is stored as it is at a page-aligned offset.
+ */
+namespace ChunkedImage {
+
+/**
+ * Write a memory image.
+ *
+ * @param filepath File to write the image to
+ * @param data Memory to write
+ * @param size Size of the memory in bytes
+ * @param block_size Size of the blocks, a multiple of the page size
+ * @param compression zlib compression level, 0 to store blocks as they
+ *                    are so that they can be mapped on restore
+ * @param threads Number of host threads compressing blocks
+ */
+void write(const std::string &filepath, const uint8_t *data, uint64_t size,
+           uint64_t block_size, int compression, unsigned threads);
+
+/**
+ * Read a memory image into memory that is zero already, as a freshly
+ * mapped backing store is. Deflated blocks are always inflated right
+ * away. If map_raw is set, blocks stored as they are get mapped
+ * copy-on-write from the image instead of being copied, so that they
+ * are only read from the file when they are first touched. This
+ * requires data to be page aligned.
+ *
+ * @param filepath File to read the image from
+ * @param data Memory to restore
+ * @param size Size of the memory in bytes, which must match the image
+ * @param threads Number of host threads inflating blocks
+ * @param map_raw Map uncompressed blocks instead of copying them
+ * @return Number of blocks that were mapped
+ */
+uint64_t read(const std::string &filepath, uint8_t *data, uint64_t size,
+              unsigned threads, bool map_raw);
+
+} // namespace ChunkedImage
+
+#endif // __MEM_CHUNKED_IMAGE_HH__
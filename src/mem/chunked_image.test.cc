@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/chunked_image.hh"
+
+namespace {
+
+/** Zero-filled, page-aligned memory like a freshly mapped backing store */
+class Store
+{
+  public:
+    explicit Store(uint64_t size) : size(size)
+    {
+        data = static_cast<uint8_t *>(
+            mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_ANON | MAP_PRIVATE, -1, 0));
+        EXPECT_NE(data, MAP_FAILED);
+    }
+
+    ~Store() { munmap(data, size); }
+
+    uint8_t *data;
+    const uint64_t size;
+};
+
+class ChunkedImageTest : public testing::Test
+{
+  protected:
+    void
+    SetUp() override
+    {
+        char name[] = "/tmp/chunked_image.XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        filepath = name;
+    }
+
+    void TearDown() override { unlink(filepath.c_str()); }
+
+    /**
+     * Fill the blocks of a store with, in turn, zeros, random bytes
+     * that don't compress, and a repeating pattern that does.
+     */
+    static void
+    fill(Store &store, uint64_t block_size)
+    {
+        std::mt19937 rng(1);
+        for (uint64_t b = 0; b * block_size < store.size; ++b) {
+            uint8_t *block = store.data + b * block_size;
+            const uint64_t len =
+                std::min(block_size, store.size - b * block_size);
+            for (uint64_t i = 0; i < len; ++i) {
+                switch (b % 3) {
+                  case 0: block[i] = 0; break;
+                  case 1: block[i] = rng(); break;
+                  case 2: block[i] = i % 7; break;
+                }
+            }
+        }
+    }
+
+    std::string filepath;
+};
+
+} // anonymous namespace
+
+TEST_F(ChunkedImageTest, RoundTripCompressed)
+{
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t block_size = 4 * page;
+    // A partial block at the end
+    const uint64_t size = 10 * block_size + page / 2;
+
+    Store src(size);
+    fill(src, block_size);
+    ChunkedImage::write(filepath, src.data, size, block_size, 1, 3);
+
+    Store dst(size);
+    const uint64_t mapped =
+        ChunkedImage::read(filepath, dst.data, size, 3, true);
+    EXPECT_EQ(0, memcmp(src.data, dst.data, size));
+
+    // Only the random blocks, including the partial one at the end,
+    // don't compress, and they are the only ones that get mapped
+    EXPECT_EQ(4, mapped);
+}
+
+TEST_F(ChunkedImageTest, RoundTripUncompressed)
+{
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t block_size = 2 * page;
+    const uint64_t size = 9 * block_size;
+
+    Store src(size);
+    fill(src, block_size);
+    ChunkedImage::write(filepath, src.data, size, block_size, 0, 2);
+
+    Store dst(size);
+    const uint64_t mapped =
+        ChunkedImage::read(filepath, dst.data, size, 2, true);
+    EXPECT_EQ(0, memcmp(src.data, dst.data, size));
+    // All blocks that aren't zero are stored as they are
+    EXPECT_EQ(6, mapped);
+
+    // Mapped blocks are private to the store
+    memset(dst.data, 0xff, size);
+    Store again(size);
+    ChunkedImage::read(filepath, again.data, size, 1, true);
+    EXPECT_EQ(0, memcmp(src.data, again.data, size));
+}
+
+TEST_F(ChunkedImageTest, CopyInsteadOfMap)
+{
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t block_size = page;
+    const uint64_t size = 8 * block_size + 100;
+
+    Store src(size);
+    fill(src, block_size);
+    ChunkedImage::write(filepath, src.data, size, block_size, 0, 4);
+
+    // Memory that isn't page aligned can't be mapped either
+    std::vector<uint8_t> buf(size + 1, 0);
+    EXPECT_EQ(0, ChunkedImage::read(filepath, buf.data() + 1, size, 4,
+                                    true));
+    EXPECT_EQ(0, memcmp(src.data, buf.data() + 1, size));
+
+    Store dst(size);
+    EXPECT_EQ(0, ChunkedImage::read(filepath, dst.data, size, 1, false));
+    EXPECT_EQ(0, memcmp(src.data, dst.data, size));
+}
@@ -302,6 +302,9 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID slave_port_id)
     if (snoopFilter && snoop_caches) {
         // Let the snoop filter know about the success of the send operation
         snoopFilter->finishRequest(!success, addr, pkt->isSecure());
+        if (snoopFilter->hasBackInvalidations()) {
+            sendBackInvalidations(master_port_id, true);
+        }
     }
 
     // check if we were successful in sending the packet onwards
@@ -716,6 +719,40 @@ CoherentXBar::forwardTiming(PacketPtr pkt, PortID exclude_slave_port_id,
     snoopFanout.sample(fanout);
 }
 
+void
+CoherentXBar::sendBackInvalidations(PortID master_port_id, bool is_timing)
+{
+    for (const auto& inv : snoopFilter->takeBackInvalidations()) {
+        // the invalidation makes the request a cache maintenance
+        // operation, which the MSHRs of the caches expect for snoops
+        // that do not need writable
+        RequestPtr req = Request::create(
+            inv.addr, system->cacheLineSize(), Request::INVALIDATE,
+            Request::wbMasterId);
+        if (inv.isSecure) {
+            req->setFlags(Request::SECURE);
+        }
+        Packet pkt(req, MemCmd::BackInvalidateReq);
+
+        DPRINTF(CoherentXBar, "%s: %s to %d ports\n", __func__,
+                pkt.print(), inv.ports.size());
+
+        transDist[pkt.cmdToIndex()]++;
+        snoops++;
+
+        if (is_timing) {
+            // the caches can't refuse the snoops, and the filter no
+            // longer tracks the line, so they go out straight away
+            // and hold the snoop layer of the request that evicted
+            // the line for a cycle
+            forwardTiming(&pkt, InvalidPortID, inv.ports);
+            snoopLayers[master_port_id]->reserveTiming(Cycles(1));
+        } else {
+            forwardAtomic(&pkt, InvalidPortID, InvalidPortID, inv.ports);
+        }
+    }
+}
+
 void
 CoherentXBar::recvReqRetry(PortID master_port_id)
 {
@@ -763,6 +800,9 @@ CoherentXBar::recvAtomicBackdoor(PacketPtr pkt, PortID slave_port_id,
             // avoid situations where atomic upward snoops sneak in
             // between and change the filter state
             snoopFilter->finishRequest(false, pkt->getAddr(), pkt->isSecure());
+            if (snoopFilter->hasBackInvalidations()) {
+                sendBackInvalidations(InvalidPortID, false);
+            }
 
             if (pkt->isEviction()) {
                 // for block-evicting packets, i.e. writebacks and
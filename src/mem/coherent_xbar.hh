@@ -370,6 +370,19 @@ class CoherentXBar : public BaseXBar
                                           const std::vector<QueuedSlavePort*>&
                                           dests);
 
+    /**
+     * Invalidate the lines evicted from a bounded snoop filter in the
+     * caches that hold them. The back-invalidations do not expect a
+     * response, and dirty copies are written back as WriteCleans. In
+     * timing mode they occupy the snoop layer of the master port the
+     * evicting request was sent to.
+     *
+     * @param master_port_id Master port the evicting request went to,
+     *                       only used in timing mode
+     * @param is_timing Whether to send timing or atomic snoops
+     */
+    void sendBackInvalidations(PortID master_port_id, bool is_timing);
+
     /** Function called by the port when the crossbar is recieving a Functional
         transaction.*/
     void recvFunctional(PacketPtr pkt, PortID slave_port_id);
@@ -221,7 +221,13 @@ MemCmd::commandInfo[] =
       InvalidateResp, "InvalidateReq" },
     /* Invalidation Response */
     { SET2(IsInvalidate, IsResponse),
-      InvalidCmd, "InvalidateResp" }
+      InvalidCmd, "InvalidateResp" },
+    /* Back-invalidation Request -- Snooped by the caches above a
+       bounded snoop filter that evicted the block. Dirty copies are
+       written back and all copies are invalidated, no response is
+       expected. */
+    { SET3(IsRequest, IsInvalidate, IsClean),
+      InvalidCmd, "BackInvalidateReq" }
 };
 
 AddrRange
@@ -60,10 +60,12 @@
 #include "base/addr_range.hh"
 #include "base/cast.hh"
 #include "base/compiler.hh"
+#include "base/fixed_size_pool.hh"
 #include "base/flags.hh"
 #include "base/logging.hh"
 #include "base/printable.hh"
 #include "base/types.hh"
+#include "config/use_packet_pool.hh"
 #include "mem/request.hh"
 #include "sim/core.hh"
 
@@ -134,6 +136,7 @@ class MemCmd
         FlushReq,      //request for a cache flush
         InvalidateReq,   // request for address to be invalidated
         InvalidateResp,
+        BackInvalidateReq, // snoop filter eviction, cleans and invalidates
         NUM_MEM_CMDS
     };
 
@@ -303,6 +306,10 @@ class Packet : public Printable
         /// the packet is destroyed. The pointer is assumed to be pointing
         /// to an array, and delete [] is consequently called
         DYNAMIC_DATA           = 0x00002000,
+        /// The dynamic data was carved from the per-thread payload
+        /// pool rather than allocated with new [], and has to be
+        /// returned there when the packet is destroyed
+        POOLED_DATA            = 0x00004000,
 
         /// suppress the error if this packet encounters a functional
         /// access failure.
@@ -315,6 +322,17 @@ class Packet : public Printable
 
     Flags flags;
 
+#if USE_PACKET_POOL
+    /**
+     * Packets and small payloads are recycled through per-thread
+     * pools instead of going to the heap for every transaction.
+     * Payloads up to a cache line share a single size class, larger
+     * ones fall back to new [].
+     */
+    static const unsigned MaxPooledDataSize = 64;
+    typedef FixedSizePool<MaxPooledDataSize> DataPool;
+#endif
+
   public:
     typedef MemCmd::Command Command;
 
@@ -929,6 +947,21 @@ class Packet : public Printable
         deleteData();
     }
 
+#if USE_PACKET_POOL
+    static void *
+    operator new(size_t size)
+    {
+        assert(size == sizeof(Packet));
+        return FixedSizePool<sizeof(Packet)>::allocate();
+    }
+
+    static void
+    operator delete(void *p)
+    {
+        FixedSizePool<sizeof(Packet)>::deallocate(p);
+    }
+#endif
+
     /**
      * Take a request packet and modify it in place to be suitable for
      * returning as a response to that request.
@@ -1226,10 +1259,18 @@ class Packet : public Printable
     void
     deleteData()
     {
-        if (flags.isSet(DYNAMIC_DATA))
+        if (flags.isSet(DYNAMIC_DATA)) {
+#if USE_PACKET_POOL
+            if (flags.isSet(POOLED_DATA))
+                DataPool::deallocate(data);
+            else
+                delete [] data;
+#else
             delete [] data;
+#endif
+        }
 
-        flags.clear(STATIC_DATA|DYNAMIC_DATA);
+        flags.clear(STATIC_DATA|DYNAMIC_DATA|POOLED_DATA);
         data = NULL;
     }
 
@@ -1242,6 +1283,13 @@ class Packet : public Printable
         if (hasData() || hasRespData()) {
             assert(flags.noneSet(STATIC_DATA|DYNAMIC_DATA));
             flags.set(DYNAMIC_DATA);
+#if USE_PACKET_POOL
+            if (getSize() <= MaxPooledDataSize) {
+                flags.set(POOLED_DATA);
+                data = static_cast<PacketDataPtr>(DataPool::allocate());
+                return;
+            }
+#endif
             data = new uint8_t[getSize()];
         }
     }
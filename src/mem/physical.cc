@@ -46,16 +46,22 @@
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <string>
+#include <thread>
+#include <utility>
 
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
 #include "mem/abstract_mem.hh"
+#include "mem/chunked_image.hh"
 
 /**
  * On Linux, MAP_NORESERVE allow us to simulate a very large memory
@@ -71,14 +77,38 @@
 
 using namespace std;
 
+namespace {
+
+/** Memory images loaded by PhysicalMemory::preloadStores() */
+map<string, pair<uint8_t *, uint64_t>> preloadedStores;
+
+} // anonymous namespace
+
 PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
-                               bool mmap_using_noreserve) :
-    _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve)
+                               bool mmap_using_noreserve,
+                               bool chunked_checkpoint,
+                               uint64_t checkpoint_block_size,
+                               int checkpoint_compression,
+                               unsigned checkpoint_threads) :
+    _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
+    chunkedCheckpoint(chunked_checkpoint),
+    checkpointBlockSize(checkpoint_block_size),
+    checkpointCompression(checkpoint_compression),
+    checkpointThreads(checkpoint_threads ? checkpoint_threads :
+                      max(thread::hardware_concurrency(), 1U))
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
 
+    fatal_if(chunkedCheckpoint &&
+             (checkpointBlockSize == 0 ||
+              checkpointBlockSize % sysconf(_SC_PAGESIZE) != 0),
+             "Chunked checkpoint block size must be a multiple of the "
+             "host page size\n");
+    fatal_if(checkpointCompression < 0 || checkpointCompression > 9,
+             "Checkpoint compression level must be between 0 and 9\n");
+
     // add the memories from the system to the address map as
     // appropriate
     for (const auto& m : _memories) {
@@ -328,7 +358,8 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 {
     // we cannot use the address range for the name as the
     // memories that are not part of the address map can overlap
-    string filename = name() + ".store" + to_string(store_id) + ".pmem";
+    string filename = name() + ".store" + to_string(store_id) +
+        (chunkedCheckpoint ? ".cpmem" : ".pmem");
     long range_size = range.size();
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
@@ -338,8 +369,17 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
 
-    // write memory file
     string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+
+    if (chunkedCheckpoint) {
+        string format = "chunked";
+        SERIALIZE_SCALAR(format);
+        ChunkedImage::write(filepath, pmem, range_size, checkpointBlockSize,
+                            checkpointCompression, checkpointThreads);
+        return;
+    }
+
+    // write memory file
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
@@ -396,8 +436,6 @@ PhysicalMemory::unserialize(CheckpointIn &cp)
 void
 PhysicalMemory::unserializeStore(CheckpointIn &cp)
 {
-    const uint32_t chunk_size = 16384;
-
     unsigned int store_id;
     UNSERIALIZE_SCALAR(store_id);
 
@@ -405,10 +443,9 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     string filepath = cp.cptDir + "/" + filename;
 
-    // mmap memoryfile
-    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
-    if (compressed_mem == NULL)
-        fatal("Can't open physical memory checkpoint file '%s'", filename);
+    // checkpoints without a format predate the chunked images
+    string format = "gzip";
+    UNSERIALIZE_OPT_SCALAR(format);
 
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].pmem;
@@ -424,11 +461,42 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    if (adoptPreloadedStore(filepath, range_size, pmem)) {
+        DPRINTF(Checkpoint, "Using preloaded physical memory %s\n",
+                filename);
+        return;
+    }
+
+    if (format == "chunked") {
+        // Only blocks stored uncompressed are mapped lazily, deflated
+        // blocks are inflated while restoring
+        M5_VAR_USED uint64_t mapped =
+            ChunkedImage::read(filepath, pmem, range_size,
+                               checkpointThreads, true);
+        DPRINTF(Checkpoint, "Mapped %d blocks of %s\n", mapped, filename);
+    } else if (format == "gzip") {
+        unserializeStoreGzip(filepath, range_size, pmem);
+    } else {
+        fatal("Unknown physical memory checkpoint format '%s'\n", format);
+    }
+}
+
+void
+PhysicalMemory::unserializeStoreGzip(const string &filepath,
+                                     uint64_t range_size, uint8_t* pmem)
+{
+    const uint32_t chunk_size = 16384;
+
+    // mmap memoryfile
+    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", filepath);
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
     uint32_t bytes_read;
-    while (curr_size < range.size()) {
+    while (curr_size < range_size) {
         bytes_read = gzread(compressed_mem, temp_page, chunk_size);
         if (bytes_read == 0)
             break;
@@ -450,5 +518,86 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
 
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
+}
+
+void
+PhysicalMemory::preloadStores(CheckpointIn &cp)
+{
+    const unsigned threads = max(thread::hardware_concurrency(), 1U);
+
+    vector<string> sections;
+    cp.getSectionNames(sections);
+    for (const auto &section : sections) {
+        // Backing store sections are the only ones describing a
+        // memory image
+        string filename, range_size_str;
+        if (!cp.find(section, "filename", filename) ||
+            !cp.find(section, "range_size", range_size_str) ||
+            !cp.entryExists(section, "store_id")) {
+            continue;
+        }
+
+        uint64_t range_size;
+        if (!to_number(range_size_str, range_size))
+            fatal("Bad range_size '%s' in section %s\n", range_size_str,
+                  section);
+
+        string format = "gzip";
+        cp.find(section, "format", format);
+
+        string filepath = cp.cptDir + "/" + filename;
+        if (preloadedStores.count(filepath))
+            continue;
+
+        DPRINTFR(Checkpoint, "Preloading physical memory %s with size %d\n",
+                 filename, range_size);
+
+        uint8_t* pmem = (uint8_t*) mmap(NULL, range_size,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_ANON | MAP_PRIVATE, -1, 0);
+        if (pmem == (uint8_t*) MAP_FAILED) {
+            perror("mmap");
+            fatal("Could not mmap %d bytes to preload %s\n", range_size,
+                  filename);
+        }
+
+        if (format == "chunked") {
+            // Mapped blocks would split the image into several
+            // mappings that can't be moved into a backing store at once
+            ChunkedImage::read(filepath, pmem, range_size, threads, false);
+        } else if (format == "gzip") {
+            unserializeStoreGzip(filepath, range_size, pmem);
+        } else {
+            fatal("Unknown physical memory checkpoint format '%s'\n",
+                  format);
+        }
+
+        preloadedStores[filepath] = make_pair(pmem, range_size);
+    }
+}
+
+bool
+PhysicalMemory::adoptPreloadedStore(const string &filepath,
+                                    uint64_t range_size, uint8_t* pmem)
+{
+    auto it = preloadedStores.find(filepath);
+    if (it == preloadedStores.end() || it->second.second != range_size)
+        return false;
+
+    uint8_t* image = it->second.first;
+    preloadedStores.erase(it);
+
+#ifdef MREMAP_FIXED
+    // Moving the mapping keeps the pages shared with the process that
+    // preloaded them until either side writes to them
+    if (mremap(image, range_size, range_size, MREMAP_MAYMOVE | MREMAP_FIXED,
+               pmem) != MAP_FAILED) {
+        return true;
+    }
+#endif
+
+    memcpy(pmem, image, range_size);
+    munmap(image, range_size);
+    return true;
 }
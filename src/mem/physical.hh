@@ -129,6 +129,20 @@ class PhysicalMemory : public Serializable
     // Let the user choose if we reserve swap space when calling mmap
     const bool mmapUsingNoReserve;
 
+    // Write checkpoints of the backing store as independently
+    // compressed blocks rather than as a single gzip stream
+    const bool chunkedCheckpoint;
+
+    // Size of the blocks of chunked checkpoints
+    const uint64_t checkpointBlockSize;
+
+    // zlib compression level of chunked checkpoints, 0 stores the
+    // blocks uncompressed so that they can be mapped on restore
+    const int checkpointCompression;
+
+    // Host threads used to (de)compress chunked checkpoints
+    const unsigned checkpointThreads;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -160,7 +174,11 @@ class PhysicalMemory : public Serializable
      */
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
-                   bool mmap_using_noreserve);
+                   bool mmap_using_noreserve,
+                   bool chunked_checkpoint = false,
+                   uint64_t checkpoint_block_size = 1 << 20,
+                   int checkpoint_compression = 1,
+                   unsigned checkpoint_threads = 0);
 
     /**
      * Unmap all the backing store we have used.
@@ -265,6 +283,32 @@ class PhysicalMemory : public Serializable
      */
     void unserializeStore(CheckpointIn &cp);
 
+    /**
+     * Load all memory images of a checkpoint into host memory ahead
+     * of restoring it. A later unserializeStore() of the same image
+     * adopts the loaded copy rather than reading the file again.
+     * Processes forked after this call share the loaded images
+     * copy-on-write.
+     *
+     * @param cp Checkpoint to load the memory images of
+     */
+    static void preloadStores(CheckpointIn &cp);
+
+  private:
+
+    /**
+     * Move a memory image loaded by preloadStores() into a backing
+     * store.
+     *
+     * @return true if a matching image was preloaded
+     */
+    static bool adoptPreloadedStore(const std::string &filepath,
+                                    uint64_t range_size, uint8_t* pmem);
+
+    /** Read a gzip compressed memory image into a backing store. */
+    static void unserializeStoreGzip(const std::string &filepath,
+                                     uint64_t range_size, uint8_t* pmem);
+
 };
 
 #endif //__MEM_PHYSICAL_HH__
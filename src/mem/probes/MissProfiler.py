@@ -0,0 +1,51 @@
+#
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.proxy import *
+from m5.SimObject import SimObject
+
+class MissProfiler(SimObject):
+    type = 'MissProfiler'
+    cxx_header = "mem/probes/miss_profiler.hh"
+
+    manager = VectorParam.SimObject(Parent.any, "Cache(s) to profile")
+    probe_name = Param.String("MissDone", "Serviced miss probe to use")
+
+    system = Param.System(Parent.any, "System the profiled masters belong to")
+
+    # The misses are counted per PC, master and address region in
+    # sketches of a fixed size, so that the profiler's memory and
+    # overhead do not grow with the footprint of the workload. Keys
+    # missing more often than 1/table_size of the time are always
+    # accounted for.
+    table_size = Param.Unsigned(256, "Number of keys tracked per table")
+    top_k = Param.Unsigned(16, "Number of keys printed per table")
+    region_size = Param.MemorySize("4kB", "Size of the address regions")
+
+    output = Param.String("",
+        "File the tables are written to on stat dumps (<name>.txt if empty)")
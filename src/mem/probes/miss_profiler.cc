@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/probes/miss_profiler.hh"
+
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "params/MissProfiler.hh"
+#include "sim/core.hh"
+#include "sim/system.hh"
+
+MissProfiler::MissProfiler(const MissProfilerParams *p)
+    : SimObject(p), system(p->system), topK(p->top_k),
+      regionShift(floorLog2(p->region_size)),
+      pcTable(p->table_size), masterTable(p->table_size),
+      regionTable(p->table_size), output(nullptr), dumpCount(0)
+{
+    fatal_if(p->table_size == 0, "%s: table_size must be non-zero", name());
+    fatal_if(!isPowerOf2(p->region_size),
+             "%s: region_size must be a power of 2", name());
+
+    output = simout.create(p->output.empty() ? name() + ".txt" : p->output);
+}
+
+MissProfiler::~MissProfiler()
+{
+    simout.close(output);
+}
+
+void
+MissProfiler::regStats()
+{
+    SimObject::regStats();
+
+    using namespace Stats;
+
+    misses.name(name() + ".misses")
+        .desc("Number of profiled misses");
+    missesWithPC.name(name() + ".misses_with_pc")
+        .desc("Number of profiled misses of accesses with a PC");
+    missLatency.name(name() + ".miss_latency")
+        .desc("Total latency of the profiled misses (Tick)");
+    avgMissLatency.name(name() + ".avg_miss_latency")
+        .desc("Average latency of the profiled misses (Tick)")
+        .flags(nonan);
+    avgMissLatency = missLatency / misses;
+
+    registerDumpCallback(
+        new MakeCallback<MissProfiler, &MissProfiler::dumpTables>(this));
+    registerResetCallback(
+        new MakeCallback<MissProfiler, &MissProfiler::resetTables>(this));
+}
+
+void
+MissProfiler::regProbeListeners()
+{
+    const MissProfilerParams *p(
+        dynamic_cast<const MissProfilerParams *>(params()));
+    assert(p);
+
+    listeners.resize(p->manager.size());
+    for (int i = 0; i < p->manager.size(); i++) {
+        ProbeManager *const mgr(p->manager[i]->getProbeManager());
+        listeners[i].reset(new MissListener(*this, mgr, p->probe_name));
+    }
+}
+
+void
+MissProfiler::handleMiss(const CacheMissInfo &info)
+{
+    misses++;
+    missLatency += info.latency;
+
+    if (info.hasPC) {
+        missesWithPC++;
+        pcTable.add(info.pc).sample(info);
+    }
+    masterTable.add(info.masterId).sample(info);
+    regionTable.add(info.addr >> regionShift).sample(info);
+}
+
+template <typename Table, typename KeyName>
+void
+MissProfiler::printTable(std::ostream &os, const char *title,
+                         const Table &table, KeyName key_name) const
+{
+    ccprintf(os, "%s (%d misses, %d of %d keys tracked)\n", title,
+             table.total(), table.size(), table.capacity());
+    ccprintf(os, "%-4s %-40s %12s %12s %12s %10s\n", "rank", "key",
+             "misses", "error", "avg_latency", "avg_mshrs");
+
+    unsigned rank = 0;
+    for (const auto *entry : table.top(topK)) {
+        // The averages only cover the misses seen while the key has been
+        // tracked, which are never overestimated
+        const MissStats &stats = entry->value;
+        const double samples = stats.samples ? stats.samples : 1;
+        ccprintf(os, "%-4d %-40s %12d %12d %12.1f %10.2f\n", rank++,
+                 key_name(entry->key), entry->count, entry->error,
+                 stats.latency / samples, stats.mshrOccupancy / samples);
+    }
+    ccprintf(os, "\n");
+}
+
+void
+MissProfiler::dumpTables()
+{
+    std::ostream &os = *output->stream();
+
+    ccprintf(os, "---------- Begin Miss Profile %d (tick %d) ----------\n\n",
+             dumpCount, curTick());
+
+    printTable(os, "PCs", pcTable,
+               [](Addr pc) { return csprintf("%#x", pc); });
+    printTable(os, "Masters", masterTable,
+               [this](MasterID id) { return system->getMasterName(id); });
+    printTable(os, "Regions", regionTable,
+               [this](Addr region) {
+                   return csprintf("%#x", region << regionShift);
+               });
+
+    ccprintf(os, "---------- End Miss Profile %d ----------\n\n", dumpCount);
+    os.flush();
+
+    dumpCount++;
+}
+
+void
+MissProfiler::resetTables()
+{
+    pcTable.clear();
+    masterTable.clear();
+    regionTable.clear();
+}
+
+MissProfiler *
+MissProfilerParams::create()
+{
+    return new MissProfiler(this);
+}
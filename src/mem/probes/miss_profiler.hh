@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_PROBES_MISS_PROFILER_HH__
+#define __MEM_PROBES_MISS_PROFILER_HH__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/space_saving.hh"
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "mem/cache/base.hh"
+#include "sim/probe/probe.hh"
+#include "sim/sim_object.hh"
+
+struct MissProfilerParams;
+class System;
+
+/**
+ * Profiler of the misses of one or more caches.
+ *
+ * The profiler listens to the MissDone probe point of the caches and
+ * finds the PCs, masters and address regions that miss the most,
+ * together with their average miss latency and the average number of
+ * MSHRs in use when their misses were serviced. Keys are tracked in
+ * fixed-size SpaceSaving sketches, so the overhead of the profiler is
+ * independent of the number of distinct PCs or addresses.
+ *
+ * The top keys of every table are written to a text file whenever the
+ * stats are dumped, and the tables are cleared when the stats are reset.
+ */
+class MissProfiler : public SimObject
+{
+  public:
+    MissProfiler(const MissProfilerParams *p);
+    ~MissProfiler();
+
+    void regStats() override;
+    void regProbeListeners() override;
+
+    /** Write the top keys of every table to the output file. */
+    void dumpTables();
+
+    /** Clear the tables on a stats reset. */
+    void resetTables();
+
+  protected:
+    /** Aggregated information of the misses of a key. */
+    struct MissStats
+    {
+        /** Number of misses since the key is being tracked. */
+        uint64_t samples = 0;
+        /** Sum of the latencies of those misses. */
+        Tick latency = 0;
+        /** Sum of the MSHR occupancies seen by those misses. */
+        uint64_t mshrOccupancy = 0;
+
+        void
+        sample(const CacheMissInfo &info)
+        {
+            samples++;
+            latency += info.latency;
+            mshrOccupancy += info.mshrOccupancy;
+        }
+    };
+
+    typedef SpaceSaving<Addr, MissStats> AddrTable;
+    typedef SpaceSaving<MasterID, MissStats> MasterTable;
+
+    /**
+     * Callback to account for a serviced miss.
+     */
+    void handleMiss(const CacheMissInfo &info);
+
+    /**
+     * Print the top keys of a table.
+     *
+     * @param os Stream to print to.
+     * @param title Title of the table.
+     * @param table The table.
+     * @param key_name Function giving the printed name of a key.
+     */
+    template <typename Table, typename KeyName>
+    void printTable(std::ostream &os, const char *title, const Table &table,
+                    KeyName key_name) const;
+
+    /** System the masters belong to, used to name them. */
+    System *system;
+
+    /** Number of keys printed per table. */
+    const unsigned topK;
+
+    /** Log2 of the size of the address regions. */
+    const unsigned regionShift;
+
+    /** Misses per PC, only for accesses with a PC. */
+    AddrTable pcTable;
+    /** Misses per master. */
+    MasterTable masterTable;
+    /** Misses per address region. */
+    AddrTable regionTable;
+
+    /** File the tables are written to. */
+    OutputStream *output;
+
+    /** Number of the next table dump. */
+    unsigned dumpCount;
+
+    /** Number of profiled misses. */
+    Stats::Scalar misses;
+    /** Number of profiled misses of accesses that have a PC. */
+    Stats::Scalar missesWithPC;
+    /** Total latency of the profiled misses. */
+    Stats::Scalar missLatency;
+    /** Average latency of the profiled misses. */
+    Stats::Formula avgMissLatency;
+
+  private:
+    class MissListener : public ProbeListenerArgBase<CacheMissInfo>
+    {
+      public:
+        MissListener(MissProfiler &_parent,
+                     ProbeManager *pm, const std::string &name)
+            : ProbeListenerArgBase(pm, name),
+              parent(_parent) {}
+
+        void notify(const CacheMissInfo &info) override {
+            parent.handleMiss(info);
+        }
+
+      protected:
+        MissProfiler &parent;
+    };
+
+    std::vector<std::unique_ptr<MissListener>> listeners;
+};
+
+#endif // __MEM_PROBES_MISS_PROFILER_HH__
@@ -54,11 +54,15 @@
 
 #include <cassert>
 #include <climits>
+#include <utility>
 
 #include "base/amo.hh"
+#include "base/fixed_size_pool.hh"
 #include "base/flags.hh"
 #include "base/logging.hh"
+#include "base/refcnt.hh"
 #include "base/types.hh"
+#include "config/use_packet_pool.hh"
 #include "cpu/inst_seq.hh"
 #include "sim/core.hh"
 
@@ -82,7 +86,14 @@ namespace ContextSwitchTaskId {
 
 class Request;
 
-typedef std::shared_ptr<Request> RequestPtr;
+/**
+ * Requests are reference counted intrusively. The count is not atomic:
+ * a request stays on the event queue of the CPU or device that created
+ * it. Partitioned Ruby systems keep each sequencer with its CPU and
+ * only pass protocol messages, which don't carry requests, between
+ * event queues.
+ */
+typedef RefCountingPtr<Request> RequestPtr;
 typedef uint16_t MasterID;
 
 class Request
@@ -392,6 +403,12 @@ class Request
     /** A pointer to an atomic operation */
     AtomicOpFunctorPtr atomicOpFunctor;
 
+    /**
+     * Number of RequestPtrs referring to this request. It isn't copied
+     * along with the request, a copy starts out unreferenced.
+     */
+    mutable int _refCount = 0;
+
   public:
 
     /**
@@ -498,6 +515,39 @@ class Request
 
     ~Request() {}
 
+    /**
+     * Create a new request and take the first reference to it. This
+     * takes the place of std::make_shared for requests.
+     */
+    template <typename... Args>
+    static RequestPtr
+    create(Args&&... args)
+    {
+        return RequestPtr(new Request(std::forward<Args>(args)...));
+    }
+
+    /** Add a reference, called by RequestPtr. */
+    void incref() const { ++_refCount; }
+
+    /** Drop a reference and delete the request if it was the last one. */
+    void decref() const { if (--_refCount <= 0) delete this; }
+
+#if USE_PACKET_POOL
+    /** Requests are recycled through a per-thread pool like packets. */
+    static void *
+    operator new(size_t size)
+    {
+        assert(size == sizeof(Request));
+        return FixedSizePool<sizeof(Request)>::allocate();
+    }
+
+    static void
+    operator delete(void *p)
+    {
+        FixedSizePool<sizeof(Request)>::deallocate(p);
+    }
+#endif
+
     /**
      * Set up Context numbers.
      */
@@ -574,8 +624,8 @@ class Request
         assert(privateFlags.isSet(VALID_VADDR));
         assert(privateFlags.noneSet(VALID_PADDR));
         assert(split_addr > _vaddr && split_addr < _vaddr + _size);
-        req1 = std::make_shared<Request>(*this);
-        req2 = std::make_shared<Request>(*this);
+        req1 = create(*this);
+        req2 = create(*this);
         req1->_size = split_addr - _vaddr;
         req2->_vaddr = split_addr;
         req2->_size = _size - req1->_size;
@@ -35,6 +35,7 @@
 #ifndef __MEM_RUBY_COMMON_CONSUMER_HH__
 #define __MEM_RUBY_COMMON_CONSUMER_HH__
 
+#include <cstdint>
 #include <iostream>
 #include <set>
 
@@ -44,7 +45,7 @@ class Consumer
 {
   public:
     Consumer(ClockedObject *_em)
-        : em(_em)
+        : m_pending_buffers(0), em(_em)
     {
     }
 
@@ -70,9 +71,22 @@ class Consumer
 
     void scheduleEventAbsolute(Tick timeAbs);
 
+    /** Event queue the wakeups of this consumer are scheduled on. */
+    EventQueue *wakeupEventQueue() const { return em->eventQueue(); }
+
+    /**
+     * Note that the input buffer in the given slot holds messages. The
+     * bit stays set until the consumer finds the buffer empty, so the
+     * consumer only needs to look at buffers whose bit is set.
+     */
+    void markBufferPending(int slot) { m_pending_buffers |= 1ULL << slot; }
+
   protected:
     void scheduleEvent(Cycles timeDelta);
 
+    //! One bit per input buffer slot that may hold messages
+    uint64_t m_pending_buffers;
+
   private:
     std::set<Tick> m_scheduled_wakeups;
     ClockedObject *em;
@@ -28,27 +28,63 @@
 
 #include "mem/ruby/common/DataBlock.hh"
 
+#include <new>
+
 #include "mem/ruby/common/WriteMask.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
 DataBlock::DataBlock(const DataBlock &cp)
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
-    m_alloc = true;
+    if (cp.m_alloc) {
+        m_data = cp.m_data;
+        m_alloc = true;
+        refs().fetch_add(1, std::memory_order_relaxed);
+    } else {
+        alloc();
+        memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+    }
 }
 
 void
 DataBlock::alloc()
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
+    uint8_t *buf = new uint8_t[DataOffset + RubySystem::getBlockSizeBytes()];
+    m_data = buf + DataOffset;
+    m_alloc = true;
+    new (buf) std::atomic<unsigned>(1);
+    memset(m_data, 0, RubySystem::getBlockSizeBytes());
+}
+
+void
+DataBlock::release()
+{
+    if (m_alloc && refs().fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        refs().~atomic();
+        delete [] (m_data - DataOffset);
+    }
+    m_alloc = false;
+}
+
+void
+DataBlock::unshare()
+{
+    uint8_t *shared = m_data;
+    alloc();
+    uint8_t *copy = m_data;
+    memcpy(copy, shared, RubySystem::getBlockSizeBytes());
+
+    // Only drop the reference to the shared payload once it is copied,
+    // as the other owners may write to it as soon as they are alone.
+    m_data = shared;
+    release();
+    m_data = copy;
     m_alloc = true;
-    clear();
 }
 
 void
 DataBlock::clear()
 {
+    makeWritable();
     memset(m_data, 0, RubySystem::getBlockSizeBytes());
 }
 
@@ -61,6 +97,7 @@ DataBlock::equal(const DataBlock& obj) const
 void
 DataBlock::copyPartial(const DataBlock &dblk, const WriteMask &mask)
 {
+    makeWritable();
     for (int i = 0; i < RubySystem::getBlockSizeBytes(); i++) {
         if (mask.getMask(i, 1)) {
             m_data[i] = dblk.m_data[i];
@@ -71,6 +108,7 @@ DataBlock::copyPartial(const DataBlock &dblk, const WriteMask &mask)
 void
 DataBlock::atomicPartial(const DataBlock &dblk, const WriteMask &mask)
 {
+    makeWritable();
     for (int i = 0; i < RubySystem::getBlockSizeBytes(); i++) {
         m_data[i] = dblk.m_data[i];
     }
@@ -101,6 +139,7 @@ DataBlock::getData(int offset, int len) const
 uint8_t*
 DataBlock::getDataMod(int offset)
 {
+    makeWritable();
     return &m_data[offset];
 }
 
@@ -108,12 +147,25 @@ void
 DataBlock::setData(const uint8_t *data, int offset, int len)
 {
     assert(offset + len <= RubySystem::getBlockSizeBytes());
+    makeWritable();
     memcpy(&m_data[offset], data, len);
 }
 
 DataBlock &
 DataBlock::operator=(const DataBlock & obj)
 {
-    memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    if (m_data == obj.m_data)
+        return *this;
+
+    if (m_alloc && obj.m_alloc) {
+        obj.refs().fetch_add(1, std::memory_order_relaxed);
+        release();
+        m_data = obj.m_data;
+        m_alloc = true;
+    } else {
+        // Blocks wrapping external storage are updated in place.
+        makeWritable();
+        memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    }
     return *this;
 }
@@ -31,12 +31,21 @@
 
 #include <inttypes.h>
 
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <iomanip>
 #include <iostream>
 
 class WriteMask;
 
+/**
+ * A cache-block sized payload. Copies of a block allocated here share
+ * one reference-counted buffer and only duplicate it on the first
+ * write, so forwarding the same data through several messages and
+ * controllers costs a pointer copy instead of a block copy. Blocks
+ * that wrap external storage (see assign()) are never shared.
+ */
 class DataBlock
 {
   public:
@@ -49,8 +58,7 @@ class DataBlock
 
     ~DataBlock()
     {
-        if (m_alloc)
-            delete [] m_data;
+        release();
     }
 
     DataBlock& operator=(const DataBlock& obj);
@@ -70,7 +78,32 @@ class DataBlock
     void print(std::ostream& out) const;
 
   private:
+    /** Offset of the payload from the start of an owned buffer. */
+    static constexpr size_t DataOffset = alignof(std::max_align_t);
+
+    /**
+     * Reference count stored in front of an owned payload. It is
+     * atomic, as copies of a block may end up in messages handled by
+     * other threads when Ruby runs on several event queues.
+     */
+    std::atomic<unsigned> &refs() const
+    {
+        assert(m_alloc);
+        return *reinterpret_cast<std::atomic<unsigned> *>(
+            m_data - DataOffset);
+    }
+
     void alloc();
+    void release();
+
+    /** Make sure this block is the sole user of its payload. */
+    void makeWritable()
+    {
+        if (m_alloc && refs().load(std::memory_order_acquire) > 1)
+            unshare();
+    }
+    void unshare();
+
     uint8_t *m_data;
     bool m_alloc;
 };
@@ -79,9 +112,7 @@ inline void
 DataBlock::assign(uint8_t *data)
 {
     assert(data != NULL);
-    if (m_alloc) {
-        delete [] m_data;
-    }
+    release();
     m_data = data;
     m_alloc = false;
 }
@@ -95,6 +126,7 @@ DataBlock::getByte(int whichByte) const
 inline void
 DataBlock::setByte(int whichByte, uint8_t data)
 {
+    makeWritable();
     m_data[whichByte] = data;
 }
 
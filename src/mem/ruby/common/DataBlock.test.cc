@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "mem/ruby/common/DataBlock.hh"
+#include "mem/ruby/common/WriteMask.hh"
+#include "mem/ruby/system/RubySystem.hh"
+
+// The block size is set by the RubySystem, which isn't linked in
+uint32_t RubySystem::m_block_size_bytes = 64;
+uint32_t RubySystem::m_block_size_bits = 6;
+
+namespace {
+
+const int blkSize = 64;
+
+/** A block filled with the given byte */
+DataBlock
+filled(uint8_t value)
+{
+    DataBlock blk;
+    std::vector<uint8_t> data(blkSize, value);
+    blk.setData(data.data(), 0, blkSize);
+    return blk;
+}
+
+bool
+allBytes(const DataBlock &blk, uint8_t value)
+{
+    for (int i = 0; i < blkSize; i++) {
+        if (blk.getByte(i) != value)
+            return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+TEST(DataBlockTest, CopiesShareUntilWritten)
+{
+    DataBlock original = filled(1);
+    DataBlock copy(original);
+    EXPECT_EQ(original.getData(0, blkSize), copy.getData(0, blkSize));
+
+    copy.setByte(3, 2);
+    EXPECT_NE(original.getData(0, blkSize), copy.getData(0, blkSize));
+    EXPECT_TRUE(allBytes(original, 1));
+    EXPECT_EQ(2, copy.getByte(3));
+    EXPECT_EQ(1, copy.getByte(4));
+}
+
+TEST(DataBlockTest, WritesThroughCopyLeaveOriginal)
+{
+    const DataBlock original = filled(1);
+    const uint8_t bytes[] = { 7, 8, 9 };
+    WriteMask mask;
+    mask.setMask(8, 8);
+
+    // Every kind of write unshares the payload first
+    DataBlock a(original), b(original), c(original), d(original),
+              e(original);
+    a.setData(bytes, 0, sizeof(bytes));
+    *b.getDataMod(10) = 7;
+    c.clear();
+    d.copyPartial(filled(5), 16, 4);
+    e.copyPartial(filled(6), mask);
+
+    EXPECT_TRUE(allBytes(original, 1));
+    EXPECT_EQ(9, a.getByte(2));
+    EXPECT_EQ(7, b.getByte(10));
+    EXPECT_TRUE(allBytes(c, 0));
+    EXPECT_EQ(5, d.getByte(19));
+    EXPECT_EQ(1, d.getByte(20));
+    EXPECT_EQ(6, e.getByte(15));
+    EXPECT_EQ(1, e.getByte(16));
+}
+
+TEST(DataBlockTest, WritesToOriginalLeaveCopies)
+{
+    DataBlock original = filled(1);
+    DataBlock copy1(original);
+    DataBlock copy2(original);
+
+    original.setByte(0, 3);
+    EXPECT_TRUE(allBytes(copy1, 1));
+    EXPECT_TRUE(allBytes(copy2, 1));
+
+    // The two remaining copies still share, until one of them writes
+    EXPECT_EQ(copy1.getData(0, blkSize), copy2.getData(0, blkSize));
+    copy2.setByte(0, 4);
+    EXPECT_TRUE(allBytes(copy1, 1));
+    EXPECT_EQ(4, copy2.getByte(0));
+    EXPECT_EQ(3, original.getByte(0));
+}
+
+TEST(DataBlockTest, AssignmentShares)
+{
+    DataBlock original = filled(1);
+    DataBlock copy = filled(2);
+    copy = original;
+    EXPECT_EQ(original.getData(0, blkSize), copy.getData(0, blkSize));
+    EXPECT_TRUE(allBytes(copy, 1));
+
+    const DataBlock &self = copy;
+    copy = self;
+    copy.setByte(0, 3);
+    EXPECT_TRUE(allBytes(original, 1));
+    EXPECT_EQ(3, copy.getByte(0));
+
+    // Assigning to a shared block drops only its own reference
+    DataBlock other(original);
+    other = filled(4);
+    EXPECT_TRUE(allBytes(original, 1));
+    EXPECT_TRUE(allBytes(other, 4));
+}
+
+TEST(DataBlockTest, ExternalStorageIsNeverShared)
+{
+    std::vector<uint8_t> storage(blkSize, 1);
+    DataBlock external;
+    external.assign(storage.data());
+
+    // Copies of external storage own their payload
+    DataBlock copy(external);
+    EXPECT_NE(storage.data(), copy.getData(0, blkSize));
+    copy.setByte(0, 2);
+    EXPECT_EQ(1, storage[0]);
+
+    // Assignments to external storage write through to it
+    external = filled(3);
+    EXPECT_EQ(storage.data(), external.getData(0, blkSize));
+    EXPECT_EQ(3, storage[5]);
+
+    // and assignments from it copy the data out
+    DataBlock owned = filled(4);
+    DataBlock shared(owned);
+    owned = external;
+    EXPECT_NE(storage.data(), owned.getData(0, blkSize));
+    EXPECT_TRUE(allBytes(owned, 3));
+    EXPECT_TRUE(allBytes(shared, 4));
+    storage[0] = 5;
+    EXPECT_EQ(3, owned.getByte(0));
+}
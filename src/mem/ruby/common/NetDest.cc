@@ -60,6 +60,14 @@ NetDest::setNetDest(MachineType machine, const Set& set)
     m_bits[MachineType_base_level(machine)] = set;
 }
 
+const Set&
+NetDest::getNetDest(MachineType machine) const
+{
+    assert(MachineType_base_level((MachineType)(machine + 1)) -
+           MachineType_base_level(machine) == 1);
+    return m_bits[MachineType_base_level(machine)];
+}
+
 void
 NetDest::remove(MachineID oldElement)
 {
@@ -108,11 +116,9 @@ NetDest::getAllDest()
     std::vector<NodeID> dest;
     dest.clear();
     for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                int id = MachineType_base_number((MachineType)i) + j;
-                dest.push_back((NodeID)id);
-            }
+        for (NodeID j : m_bits[i]) {
+            int id = MachineType_base_number((MachineType)i) + j;
+            dest.push_back((NodeID)id);
         }
     }
     return dest;
@@ -139,11 +145,10 @@ NetDest::smallestElement() const
 {
     assert(count() > 0);
     for (int i = 0; i < m_bits.size(); i++) {
-        for (NodeID j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                MachineID mach = {MachineType_from_base_level(i), j};
-                return mach;
-            }
+        if (!m_bits[i].isEmpty()) {
+            MachineID mach = {MachineType_from_base_level(i),
+                              m_bits[i].smallestElement()};
+            return mach;
         }
     }
     panic("No smallest element of an empty set.");
@@ -152,12 +157,10 @@ NetDest::smallestElement() const
 MachineID
 NetDest::smallestElement(MachineType machine) const
 {
-    int size = m_bits[MachineType_base_level(machine)].getSize();
-    for (NodeID j = 0; j < size; j++) {
-        if (m_bits[MachineType_base_level(machine)].isElement(j)) {
-            MachineID mach = {machine, j};
-            return mach;
-        }
+    const Set &bits = m_bits[MachineType_base_level(machine)];
+    if (!bits.isEmpty()) {
+        MachineID mach = {machine, bits.smallestElement()};
+        return mach;
     }
 
     panic("No smallest element of given MachineType.");
@@ -52,6 +52,7 @@ class NetDest
     void add(MachineID newElement);
     void addNetDest(const NetDest& netDest);
     void setNetDest(MachineType machine, const Set& set);
+    const Set& getNetDest(MachineType machine) const;
     void remove(MachineID oldElement);
     void removeNetDest(const NetDest& netDest);
     void clear();
@@ -26,52 +26,224 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-// modified by Dan Gibson on 05/20/05 to accomidate FASTER
-// >32 set lengths, using an array of ints w/ 32 bits/int
-
 #ifndef __MEM_RUBY_COMMON_SET_HH__
 #define __MEM_RUBY_COMMON_SET_HH__
 
-#include <bitset>
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 
+#include "base/bitfield.hh"
 #include "base/logging.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 
+/**
+ * A set of node IDs stored as a bit vector of any size. Sets of up to
+ * InlineBits elements, which covers most systems, are stored in the
+ * object itself; larger sets keep their words on the heap. Operations
+ * on two sets work a word at a time.
+ */
 class Set
 {
+  public:
+    typedef uint64_t Word;
+
+    static constexpr int BitsPerWord = 64;
+    static constexpr int InlineWords = 1;
+    static constexpr int InlineBits = InlineWords * BitsPerWord;
+
   private:
     // Number of bits in use in this set.
-    // can be defined in build_opts file (default=64).
     int m_nSize;
-    std::bitset<NUMBER_BITS_PER_SET> bits;
+    // Number of words allocated for the set.
+    int m_nWords;
+    // The words of the set, either m_inline or a heap array.
+    Word *m_words;
+    Word m_inline[InlineWords];
+
+    static int
+    wordsFor(int size)
+    {
+        return (size + BitsPerWord - 1) / BitsPerWord;
+    }
+
+    bool onHeap() const { return m_words != m_inline; }
+
+    /**
+     * Reallocate the storage for num_words words. The first
+     * min(m_nWords, num_words) words are kept and the rest are
+     * cleared.
+     */
+    void
+    reallocate(int num_words)
+    {
+        if (num_words == m_nWords)
+            return;
+
+        Word *words = num_words > InlineWords ?
+            new Word[num_words] : m_inline;
+        if (words != m_words) {
+            std::memcpy(words, m_words,
+                        std::min(m_nWords, num_words) * sizeof(Word));
+            if (onHeap())
+                delete [] m_words;
+        }
+        for (int i = m_nWords; i < num_words; ++i)
+            words[i] = 0;
+
+        m_words = words;
+        m_nWords = num_words;
+    }
+
+    /** Mask of the bits in use in the last word of the set. */
+    Word
+    lastWordMask() const
+    {
+        int used = m_nSize % BitsPerWord;
+        return used ? (Word(1) << used) - 1 : ~Word(0);
+    }
 
   public:
-    Set() : m_nSize(0) {}
+    /** Iterates over the elements of a set in ascending order. */
+    class const_iterator
+    {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef NodeID value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const NodeID *pointer;
+        typedef NodeID reference;
+
+      private:
+        const Set *set;
+        int word;
+        Word pending;
+
+        void
+        skipEmpty()
+        {
+            while (!pending && ++word < set->m_nWords)
+                pending = set->m_words[word];
+            if (!pending)
+                word = set->m_nWords;
+        }
+
+      public:
+        const_iterator(const Set *s, int w)
+            : set(s), word(w), pending(w < s->m_nWords ? s->m_words[w] : 0)
+        {
+            skipEmpty();
+        }
+
+        NodeID
+        operator*() const
+        {
+            return word * BitsPerWord + ctz64(pending);
+        }
+
+        const_iterator &
+        operator++()
+        {
+            // Clear the lowest set bit
+            pending &= pending - 1;
+            skipEmpty();
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            const_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        bool
+        operator==(const const_iterator &other) const
+        {
+            return word == other.word && pending == other.pending;
+        }
 
-    Set(int size) : m_nSize(size)
+        bool
+        operator!=(const const_iterator &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    Set() : m_nSize(0), m_nWords(0), m_words(m_inline) {}
+
+    Set(int size) : Set()
     {
-        if (size > NUMBER_BITS_PER_SET)
-            fatal("Number of bits(%d) < size specified(%d). "
-                  "Increase the number of bits and recompile.\n",
-                  NUMBER_BITS_PER_SET, size);
+        setSize(size);
     }
 
-    Set(const Set& obj) : m_nSize(obj.m_nSize), bits(obj.bits) {}
-    ~Set() {}
+    Set(const Set& obj) : Set()
+    {
+        *this = obj;
+    }
+
+    Set(Set&& obj) : Set()
+    {
+        *this = std::move(obj);
+    }
+
+    ~Set()
+    {
+        if (onHeap())
+            delete [] m_words;
+    }
 
     Set& operator=(const Set& obj)
     {
+        if (this == &obj)
+            return *this;
+        if (m_nWords != obj.m_nWords) {
+            if (onHeap())
+                delete [] m_words;
+            m_words = obj.m_nWords > InlineWords ?
+                new Word[obj.m_nWords] : m_inline;
+            m_nWords = obj.m_nWords;
+        }
+        m_nSize = obj.m_nSize;
+        std::memcpy(m_words, obj.m_words, m_nWords * sizeof(Word));
+        return *this;
+    }
+
+    Set& operator=(Set&& obj)
+    {
+        if (!obj.onHeap()) {
+            return *this = static_cast<const Set &>(obj);
+        }
+        if (onHeap())
+            delete [] m_words;
         m_nSize = obj.m_nSize;
-        bits = obj.bits;
+        m_nWords = obj.m_nWords;
+        m_words = obj.m_words;
+        obj.m_nSize = 0;
+        obj.m_nWords = 0;
+        obj.m_words = obj.m_inline;
         return *this;
     }
 
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_nWords); }
+
+    /*
+     * Adds an element to the set, growing the set if the element is
+     * beyond its current size.
+     */
     void
     add(NodeID index)
     {
-        bits.set(index);
+        if (index >= (NodeID)m_nSize) {
+            reallocate(wordsFor(index + 1));
+            m_nSize = index + 1;
+        }
+        m_words[index / BitsPerWord] |= Word(1) << (index % BitsPerWord);
     }
 
     /*
@@ -82,7 +254,8 @@ class Set
     addSet(const Set& obj)
     {
         assert(m_nSize == obj.m_nSize);
-        bits |= obj.bits;
+        for (int i = 0; i < m_nWords; ++i)
+            m_words[i] |= obj.m_words[i];
     }
 
     /*
@@ -91,7 +264,10 @@ class Set
     void
     remove(NodeID index)
     {
-        bits.reset(index);
+        if (index < (NodeID)m_nSize) {
+            m_words[index / BitsPerWord] &=
+                ~(Word(1) << (index % BitsPerWord));
+        }
     }
 
     /*
@@ -101,26 +277,38 @@ class Set
     removeSet(const Set& obj)
     {
         assert(m_nSize == obj.m_nSize);
-        bits &= (~obj.bits);
+        for (int i = 0; i < m_nWords; ++i)
+            m_words[i] &= ~obj.m_words[i];
     }
 
-    void clear() { bits.reset(); }
+    void
+    clear()
+    {
+        std::memset(m_words, 0, m_nWords * sizeof(Word));
+    }
 
     /*
      * this function sets all bits in the set
      */
     void broadcast()
     {
-        bits.set();
-        for (int j = m_nSize; j < NUMBER_BITS_PER_SET; ++j) {
-            bits.reset(j);
-        }
+        if (!m_nWords)
+            return;
+        std::memset(m_words, 0xff, m_nWords * sizeof(Word));
+        m_words[m_nWords - 1] &= lastWordMask();
     }
 
     /*
      * This function returns the population count of 1's in the set
      */
-    int count() const { return bits.count(); }
+    int
+    count() const
+    {
+        int counter = 0;
+        for (int i = 0; i < m_nWords; ++i)
+            counter += popCount(m_words[i]);
+        return counter;
+    }
 
     /*
      * This function checks for set equality
@@ -129,16 +317,15 @@ class Set
     isEqual(const Set& obj) const
     {
         assert(m_nSize == obj.m_nSize);
-        return bits == obj.bits;
+        return !std::memcmp(m_words, obj.m_words, m_nWords * sizeof(Word));
     }
 
     // return the logical OR of this set and orSet
     Set
     OR(const Set& obj) const
     {
-        assert(m_nSize == obj.m_nSize);
-        Set r(m_nSize);
-        r.bits = bits | obj.bits;
+        Set r(*this);
+        r.addSet(obj);
         return r;
     };
 
@@ -147,8 +334,9 @@ class Set
     AND(const Set& obj) const
     {
         assert(m_nSize == obj.m_nSize);
-        Set r(m_nSize);
-        r.bits = bits & obj.bits;
+        Set r(*this);
+        for (int i = 0; i < m_nWords; ++i)
+            r.m_words[i] &= obj.m_words[i];
         return r;
     }
 
@@ -156,8 +344,12 @@ class Set
     bool
     intersectionIsEmpty(const Set& obj) const
     {
-        std::bitset<NUMBER_BITS_PER_SET> r = bits & obj.bits;
-        return r.none();
+        int num_words = std::min(m_nWords, obj.m_nWords);
+        for (int i = 0; i < num_words; ++i) {
+            if (m_words[i] & obj.m_words[i])
+                return false;
+        }
+        return true;
     }
 
     /*
@@ -168,13 +360,21 @@ class Set
     isSuperset(const Set& test) const
     {
         assert(m_nSize == test.m_nSize);
-        std::bitset<NUMBER_BITS_PER_SET> r = bits | test.bits;
-        return (r == bits);
+        for (int i = 0; i < m_nWords; ++i) {
+            if (test.m_words[i] & ~m_words[i])
+                return false;
+        }
+        return true;
     }
 
     bool isSubset(const Set& test) const { return test.isSuperset(*this); }
 
-    bool isElement(NodeID element) const { return bits.test(element); }
+    bool
+    isElement(NodeID element) const
+    {
+        return element < (NodeID)m_nSize &&
+            (m_words[element / BitsPerWord] >> (element % BitsPerWord)) & 1;
+    }
 
     /*
      * this function returns true iff all bits in use are set
@@ -182,39 +382,45 @@ class Set
     bool
     isBroadcast() const
     {
-        return (bits.count() == m_nSize);
+        return count() == m_nSize;
     }
 
-    bool isEmpty() const { return bits.none(); }
+    bool
+    isEmpty() const
+    {
+        for (int i = 0; i < m_nWords; ++i) {
+            if (m_words[i])
+                return false;
+        }
+        return true;
+    }
 
     NodeID smallestElement() const
     {
-        for (int i = 0; i < m_nSize; ++i) {
-            if (bits.test(i)) {
-                return i;
-            }
-        }
-        panic("No smallest element of an empty set.");
+        const_iterator it = begin();
+        if (it == end())
+            panic("No smallest element of an empty set.");
+        return *it;
     }
 
-    bool elementAt(int index) const { return bits[index]; }
+    bool elementAt(int index) const { return isElement(index); }
 
     int getSize() const { return m_nSize; }
 
     void
     setSize(int size)
     {
-        if (size > NUMBER_BITS_PER_SET)
-            fatal("Number of bits(%d) < size specified(%d). "
-                  "Increase the number of bits and recompile.\n",
-                  NUMBER_BITS_PER_SET, size);
+        reallocate(wordsFor(size));
         m_nSize = size;
-        bits.reset();
+        clear();
     }
 
     void print(std::ostream& out) const
     {
-        out << "[Set (" << m_nSize << "): " << bits << "]";
+        out << "[Set (" << m_nSize << "): ";
+        for (int i = m_nSize - 1; i >= 0; --i)
+            out << (isElement(i) ? '1' : '0');
+        out << "]";
     }
 };
 
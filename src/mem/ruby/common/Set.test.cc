@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/ruby/common/Set.hh"
+
+/** Small sets keep their bits inline and behave like the old bitset. */
+TEST(SetTest, SmallSetOperations)
+{
+    Set a(8), b(8);
+    a.add(1);
+    a.add(5);
+    b.add(5);
+    b.add(7);
+
+    ASSERT_EQ(2, a.count());
+    ASSERT_TRUE(a.isElement(5));
+    ASSERT_FALSE(a.isElement(7));
+    ASSERT_FALSE(a.intersectionIsEmpty(b));
+    ASSERT_EQ(1, a.AND(b).count());
+    ASSERT_EQ(3, a.OR(b).count());
+    ASSERT_EQ(1, a.smallestElement());
+
+    a.removeSet(b);
+    ASSERT_EQ(1, a.count());
+    ASSERT_TRUE(a.intersectionIsEmpty(b));
+
+    a.broadcast();
+    ASSERT_EQ(8, a.count());
+    ASSERT_TRUE(a.isBroadcast());
+    ASSERT_TRUE(a.isSuperset(b));
+    ASSERT_TRUE(b.isSubset(a));
+}
+
+/** Sets larger than the inline storage work the same way. */
+TEST(SetTest, LargeSetOperations)
+{
+    const int size = 1000;
+    Set a(size), b(size);
+    for (int i = 0; i < size; i += 3)
+        a.add(i);
+    for (int i = 0; i < size; i += 5)
+        b.add(i);
+
+    ASSERT_EQ(334, a.count());
+    ASSERT_EQ(67, a.AND(b).count());
+    ASSERT_EQ(334 + 200 - 67, a.OR(b).count());
+
+    Set c(a);
+    ASSERT_TRUE(c.isEqual(a));
+    c.remove(999);
+    ASSERT_FALSE(c.isElement(999));
+    ASSERT_TRUE(a.isElement(999));
+
+    a.broadcast();
+    ASSERT_EQ(size, a.count());
+    ASSERT_TRUE(a.isBroadcast());
+    a.clear();
+    ASSERT_TRUE(a.isEmpty());
+}
+
+/** The iterator visits every element once, in ascending order. */
+TEST(SetTest, Iteration)
+{
+    Set s(300);
+    std::vector<NodeID> expected = {0, 63, 64, 130, 299};
+    for (auto i : expected)
+        s.add(i);
+
+    std::vector<NodeID> visited(s.begin(), s.end());
+    ASSERT_EQ(expected, visited);
+
+    Set empty(300);
+    ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+/** Adding an element beyond the size of a set grows it. */
+TEST(SetTest, GrowOnAdd)
+{
+    Set s;
+    s.add(3);
+    s.add(200);
+    ASSERT_EQ(201, s.getSize());
+    ASSERT_EQ(2, s.count());
+    ASSERT_TRUE(s.isElement(3));
+    ASSERT_TRUE(s.isElement(200));
+}
+
+/** Copies and moves between inline and heap-backed sets. */
+TEST(SetTest, CopyAndMove)
+{
+    Set small(16), large(512);
+    small.add(2);
+    large.add(400);
+
+    Set s(small);
+    s = large;
+    ASSERT_EQ(512, s.getSize());
+    ASSERT_TRUE(s.isElement(400));
+    s = small;
+    ASSERT_EQ(16, s.getSize());
+    ASSERT_TRUE(s.isElement(2));
+    ASSERT_FALSE(s.isElement(400));
+
+    Set moved(std::move(large));
+    ASSERT_TRUE(moved.isElement(400));
+    ASSERT_EQ(0, large.getSize());
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_COMMON_TIMINGWHEEL_HH__
+#define __MEM_RUBY_COMMON_TIMINGWHEEL_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * A priority queue of items that become due at a tick, for queues in
+ * which most items are due within a few cycles of each other. Items
+ * due at the same tick share a bucket, and the buckets of up to
+ * NumBuckets distinct ticks form a ring in tick order. Adding an item
+ * that is due no earlier than the others and taking the first item
+ * therefore take constant time. An item that finds no bucket because
+ * all of them hold other ticks goes to an overflow heap instead.
+ *
+ * Items come out in the order given by Greater, which has to order
+ * items by their tick first, just as if they were kept in one heap.
+ * TickOf returns the tick of an item.
+ */
+template <class T, class Greater, class TickOf, size_t NumBuckets = 16>
+class TimingWheel
+{
+    static_assert((NumBuckets & (NumBuckets - 1)) == 0,
+                  "The number of buckets must be a power of two");
+
+  public:
+    TimingWheel()
+        : m_buckets(NumBuckets), m_first(0), m_used(0), m_size(0)
+    {
+    }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    /** The first item. The queue must not be empty. */
+    const T &
+    front() const
+    {
+        assert(!empty());
+        return frontInOverflow() ? m_overflow.front() : bucket(0).front();
+    }
+
+    void
+    push(const T &item)
+    {
+        Tick when = TickOf()(item);
+        ++m_size;
+
+        // Most items are due no earlier than all others, so look for
+        // the bucket of the item starting from the last one.
+        size_t i = m_used;
+        while (i > 0 && bucket(i - 1).when > when)
+            --i;
+
+        if (i > 0 && bucket(i - 1).when == when) {
+            bucket(i - 1).insert(item);
+            return;
+        }
+
+        if (m_used == NumBuckets) {
+            m_overflow.push_back(item);
+            std::push_heap(m_overflow.begin(), m_overflow.end(), Greater());
+            return;
+        }
+
+        // Open a bucket at position i, either in front of the others or
+        // by moving the later ones back by one.
+        if (i == 0) {
+            m_first = (m_first + NumBuckets - 1) & Mask;
+        } else {
+            for (size_t j = m_used; j > i; --j)
+                std::swap(bucket(j), bucket(j - 1));
+        }
+        ++m_used;
+
+        Bucket &b = bucket(i);
+        assert(b.empty());
+        b.when = when;
+        b.items.push_back(item);
+    }
+
+    /** Remove the first item. The queue must not be empty. */
+    void
+    pop()
+    {
+        assert(!empty());
+        --m_size;
+
+        if (frontInOverflow()) {
+            std::pop_heap(m_overflow.begin(), m_overflow.end(), Greater());
+            m_overflow.pop_back();
+            return;
+        }
+
+        Bucket &b = bucket(0);
+        // Drop the reference now rather than when the bucket is reused
+        b.items[b.head++] = T();
+        if (b.empty()) {
+            // Keep the storage of the bucket for the next tick
+            b.items.clear();
+            b.head = 0;
+            m_first = (m_first + 1) & Mask;
+            --m_used;
+        }
+    }
+
+    void
+    clear()
+    {
+        for (Bucket &b : m_buckets) {
+            b.items.clear();
+            b.head = 0;
+        }
+        m_overflow.clear();
+        m_first = 0;
+        m_used = 0;
+        m_size = 0;
+    }
+
+    /** Call f on every item, in no particular order. */
+    template <class F>
+    void
+    forEach(F f) const
+    {
+        for (size_t i = 0; i < m_used; ++i) {
+            const Bucket &b = bucket(i);
+            for (size_t j = b.head; j < b.items.size(); ++j)
+                f(b.items[j]);
+        }
+        for (const T &item : m_overflow)
+            f(item);
+    }
+
+  private:
+    static const size_t Mask = NumBuckets - 1;
+
+    /** The items due at one tick, in order from items[head] on. */
+    struct Bucket
+    {
+        Tick when;
+        std::vector<T> items;
+        size_t head;
+
+        Bucket() : when(0), head(0) {}
+
+        bool empty() const { return head == items.size(); }
+        const T &front() const { return items[head]; }
+
+        void
+        insert(const T &item)
+        {
+            // Items of the same tick usually arrive in order
+            if (empty() || !Greater()(items.back(), item)) {
+                items.push_back(item);
+                return;
+            }
+            auto pos = std::upper_bound(items.begin() + head, items.end(),
+                item, [](const T &a, const T &b) { return Greater()(b, a); });
+            items.insert(pos, item);
+        }
+    };
+
+    Bucket &bucket(size_t i) { return m_buckets[(m_first + i) & Mask]; }
+    const Bucket &
+    bucket(size_t i) const
+    {
+        return m_buckets[(m_first + i) & Mask];
+    }
+
+    bool
+    frontInOverflow() const
+    {
+        if (m_overflow.empty())
+            return false;
+        return m_used == 0 || Greater()(bucket(0).front(), m_overflow.front());
+    }
+
+    //! Ring of buckets, m_used of them from m_first on are in use and
+    //! none of those is empty.
+    std::vector<Bucket> m_buckets;
+    size_t m_first;
+    size_t m_used;
+
+    //! Heap of the items that found no bucket
+    std::vector<T> m_overflow;
+
+    size_t m_size;
+};
+
+#endif // __MEM_RUBY_COMMON_TIMINGWHEEL_HH__
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "mem/ruby/common/TimingWheel.hh"
+
+namespace {
+
+/** An item due at a tick, ordered by the tick and then the sequence. */
+struct Item
+{
+    Tick when;
+    int seq;
+
+    bool
+    operator>(const Item &other) const
+    {
+        if (when == other.when)
+            return seq > other.seq;
+        return when > other.when;
+    }
+};
+
+struct ItemTick
+{
+    Tick operator()(const Item &item) const { return item.when; }
+};
+
+typedef TimingWheel<Item, std::greater<Item>, ItemTick, 4> Wheel;
+
+} // anonymous namespace
+
+/** Items of the same tick come out in sequence order. */
+TEST(TimingWheelTest, SameTickInOrder)
+{
+    Wheel wheel;
+    wheel.push({10, 2});
+    wheel.push({10, 0});
+    wheel.push({10, 1});
+    wheel.push({5, 3});
+
+    ASSERT_EQ(4u, wheel.size());
+    for (int seq : {3, 0, 1, 2}) {
+        ASSERT_FALSE(wheel.empty());
+        EXPECT_EQ(seq, wheel.front().seq);
+        wheel.pop();
+    }
+    EXPECT_TRUE(wheel.empty());
+}
+
+/** Ticks beyond the buckets go to the overflow heap but keep the order. */
+TEST(TimingWheelTest, Overflow)
+{
+    Wheel wheel;
+    for (int i = 0; i < 8; ++i)
+        wheel.push({Tick(100 - 10 * i), i});
+
+    int count = 0;
+    wheel.forEach([&count](const Item &) { ++count; });
+    EXPECT_EQ(8, count);
+
+    for (int i = 7; i >= 0; --i) {
+        EXPECT_EQ(Tick(100 - 10 * i), wheel.front().when);
+        wheel.pop();
+    }
+    EXPECT_TRUE(wheel.empty());
+}
+
+/** A random mix of pushes and pops matches a plain priority queue. */
+TEST(TimingWheelTest, MatchesPriorityQueue)
+{
+    std::mt19937 rng(7);
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> ref;
+    Wheel wheel;
+    Tick now = 0;
+    int seq = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        if (rng() % 3 != 0) {
+            // Mostly near future ticks, some far ahead and some in the
+            // past like reanalyzed messages
+            Tick when = now + rng() % 4;
+            if (rng() % 16 == 0)
+                when = now + 100 + rng() % 100;
+            else if (rng() % 16 == 0 && now > 10)
+                when = now - rng() % 10;
+            Item item{when, seq++};
+            ref.push(item);
+            wheel.push(item);
+        } else if (!ref.empty()) {
+            ASSERT_EQ(ref.top().when, wheel.front().when);
+            ASSERT_EQ(ref.top().seq, wheel.front().seq);
+            now = std::max(now, ref.top().when);
+            ref.pop();
+            wheel.pop();
+        }
+        ASSERT_EQ(ref.size(), wheel.size());
+    }
+
+    while (!ref.empty()) {
+        ASSERT_EQ(ref.top().seq, wheel.front().seq);
+        ref.pop();
+        wheel.pop();
+    }
+    EXPECT_TRUE(wheel.empty());
+
+    wheel.push({1, 0});
+    wheel.clear();
+    EXPECT_TRUE(wheel.empty());
+}
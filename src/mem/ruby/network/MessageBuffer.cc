@@ -40,6 +40,31 @@
 using namespace std;
 using m5::stl_helpers::operator<<;
 
+/**
+ * Priority of the events draining remote lanes. They run after the
+ * quantum barrier (see GlobalSyncEvent), so that all messages sent in
+ * the previous quantum are visible.
+ */
+static const EventBase::Priority RemoteDrainPri =
+    EventBase::Progress_Event_Pri + 1;
+
+/** Index of the calling thread's event queue in mainEventQueue. */
+static int
+curEventQueueIndex()
+{
+    static thread_local EventQueue *last_queue = nullptr;
+    static thread_local int last_index = -1;
+
+    EventQueue *q = curEventQueue();
+    if (q != last_queue) {
+        auto it = find(mainEventQueue.begin(), mainEventQueue.end(), q);
+        assert(it != mainEventQueue.end());
+        last_queue = q;
+        last_index = it - mainEventQueue.begin();
+    }
+    return last_index;
+}
+
 MessageBuffer::MessageBuffer(const Params *p)
     : SimObject(p), m_stall_map_size(0),
     m_max_size(p->buffer_size), m_time_last_time_size_checked(0),
@@ -49,6 +74,7 @@ MessageBuffer::MessageBuffer(const Params *p)
 {
     m_msg_counter = 0;
     m_consumer = NULL;
+    m_consumer_slot = -1;
     m_size_last_time_size_checked = 0;
     m_size_at_cycle_start = 0;
     m_stalled_at_cycle_start = 0;
@@ -65,12 +91,23 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_dequeue_callback = nullptr;
 }
 
+void
+MessageBuffer::init()
+{
+    SimObject::init();
+
+    if (numMainEventQueues > 1) {
+        for (uint32_t i = 0; i < numMainEventQueues; ++i)
+            m_remote_lanes.emplace_back(new RemoteLane);
+    }
+}
+
 unsigned int
 MessageBuffer::getSize(Tick curTime)
 {
     if (m_time_last_time_size_checked != curTime) {
         m_time_last_time_size_checked = curTime;
-        m_size_last_time_size_checked = m_prio_heap.size();
+        m_size_last_time_size_checked = m_prio_queue.size();
     }
 
     return m_size_last_time_size_checked;
@@ -93,8 +130,8 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     unsigned int current_stall_size = 0;
 
     if (m_time_last_time_pop < current_time) {
-        // no pops this cycle - heap and stall queue size is correct
-        current_size = m_prio_heap.size();
+        // no pops this cycle - queue and stall queue size is correct
+        current_size = m_prio_queue.size();
         current_stall_size = m_stall_map_size;
     } else {
         if (m_time_last_time_enqueue < current_time) {
@@ -114,10 +151,10 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     if (current_size + current_stall_size + n <= m_max_size) {
         return true;
     } else {
-        DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
+        DPRINTF(RubyQueue, "n: %d, current_size: %d, queue size: %d, "
                 "m_max_size: %d\n",
                 n, current_size + current_stall_size,
-                m_prio_heap.size(), m_max_size);
+                m_prio_queue.size(), m_max_size);
         m_not_avail_count++;
         return false;
     }
@@ -127,7 +164,7 @@ const Message*
 MessageBuffer::peek() const
 {
     DPRINTF(RubyQueue, "Peeking at head of queue.\n");
-    const Message* msg_ptr = m_prio_heap.front().get();
+    const Message* msg_ptr = m_prio_queue.front().get();
     assert(msg_ptr);
 
     DPRINTF(RubyQueue, "Message: %s\n", (*msg_ptr));
@@ -149,13 +186,18 @@ random_time()
 void
 MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
 {
+    assert(m_consumer != NULL);
+    if (inParallelMode && curEventQueue() != m_consumer->wakeupEventQueue()) {
+        enqueueRemote(message, current_time, delta);
+        return;
+    }
+
     // record current time incase we have a pop that also adjusts my size
     if (m_time_last_time_enqueue < current_time) {
         m_msgs_this_cycle = 0;  // first msg this cycle
         m_time_last_time_enqueue = current_time;
     }
 
-    m_msg_counter++;
     m_msgs_this_cycle++;
 
     // Calculate the arrival time of the message, that is, the first
@@ -205,11 +247,20 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
 
     msg_ptr->updateDelayedTicks(current_time);
     msg_ptr->setLastEnqueueTime(arrival_time);
-    msg_ptr->setMsgCounter(m_msg_counter);
 
-    // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    insertMessage(message);
+}
+
+void
+MessageBuffer::insertMessage(MsgPtr message)
+{
+    Tick arrival_time = message->getLastEnqueueTime();
+
+    m_msg_counter++;
+    message->setMsgCounter(m_msg_counter);
+
+    // Insert the message into the priority queue
+    m_prio_queue.push(message);
     // Increment the number of messages statistic
     m_buf_msgs++;
 
@@ -217,11 +268,92 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
             arrival_time, *(message.get()));
 
     // Schedule the wakeup
-    assert(m_consumer != NULL);
+    if (m_consumer_slot >= 0)
+        m_consumer->markBufferPending(m_consumer_slot);
     m_consumer->scheduleEventAbsolute(arrival_time);
     m_consumer->storeEventInfo(m_vnet_id);
 }
 
+void
+MessageBuffer::enqueueRemote(MsgPtr message, Tick current_time, Tick delta)
+{
+    // The sender can't see the occupancy of the buffer, and random
+    // delays would depend on the order in which the threads run.
+    fatal_if(m_max_size != 0, "%s: Finite message buffers can't connect "
+             "objects on different event queues.\n", name());
+    fatal_if(RubySystem::getRandomization() || m_randomization,
+             "%s: Randomization isn't supported across event queues.\n",
+             name());
+    fatal_if(delta < simQuantum, "%s: Latency of %d ticks between event "
+             "queues is below the simulation quantum of %d ticks.\n",
+             name(), delta, simQuantum);
+
+    Message* msg_ptr = message.get();
+    assert(msg_ptr != NULL);
+    assert(current_time >= msg_ptr->getLastEnqueueTime() &&
+           "ensure we aren't dequeued early");
+
+    msg_ptr->updateDelayedTicks(current_time);
+    msg_ptr->setLastEnqueueTime(current_time + delta);
+
+    DPRINTF(RubyQueue, "Remote enqueue arrival_time: %lld, Message: %s\n",
+            current_time + delta, *msg_ptr);
+
+    int lane_index = curEventQueueIndex();
+    RemoteLane &lane = *m_remote_lanes[lane_index];
+    lane.queue.push(RemoteMsg{std::move(message), curTick()});
+
+    // The first message since the last drain schedules the next one.
+    // Every later message is due no earlier than this one.
+    if (!lane.drainScheduled.exchange(true))
+        scheduleRemoteDrain(lane_index, curTick() + simQuantum);
+}
+
+void
+MessageBuffer::scheduleRemoteDrain(int lane_index, Tick when)
+{
+    // Scheduling on the queue of the consumer from another thread
+    // turns this into an asynchronous insertion, which the consumer
+    // picks up at the next quantum barrier at the latest.
+    auto *evt = new EventFunctionWrapper(
+        [this, lane_index]{ drainRemote(lane_index); },
+        name() + ".remoteDrain", true, RemoteDrainPri);
+    m_consumer->wakeupEventQueue()->schedule(evt, when);
+}
+
+void
+MessageBuffer::drainRemote(int lane_index)
+{
+    Tick now = curTick();
+
+    // Drain all lanes in a fixed order, so that the order of the
+    // messages in the queue doesn't depend on the order in which the
+    // drain events were inserted.
+    for (auto &lane : m_remote_lanes) {
+        while (RemoteMsg *remote = lane->queue.front()) {
+            if (remote->sendTick + simQuantum > now)
+                break;
+            MsgPtr message = std::move(remote->msg);
+            lane->queue.pop();
+            insertMessage(message);
+        }
+    }
+
+    RemoteLane &lane = *m_remote_lanes[lane_index];
+    while (true) {
+        if (RemoteMsg *remote = lane.queue.front()) {
+            scheduleRemoteDrain(lane_index, remote->sendTick + simQuantum);
+            return;
+        }
+
+        // Hand the next drain back to the sender. A message that was
+        // pushed before the flag was cleared has to be picked up here.
+        lane.drainScheduled.exchange(false);
+        if (lane.queue.empty() || lane.drainScheduled.exchange(true))
+            return;
+    }
+}
+
 Tick
 MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
 {
@@ -229,7 +361,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     assert(isReady(current_time));
 
     // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = m_prio_queue.front();
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -240,13 +372,12 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     // record previous size and time so the current buffer size isn't
     // adjusted until schd cycle
     if (m_time_last_time_pop < current_time) {
-        m_size_at_cycle_start = m_prio_heap.size();
+        m_size_at_cycle_start = m_prio_queue.size();
         m_stalled_at_cycle_start = m_stall_map_size;
         m_time_last_time_pop = current_time;
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    m_prio_queue.pop();
     if (decrement_messages) {
         // If the message will be removed from the queue, decrement the
         // number of message in the queue.
@@ -276,7 +407,7 @@ MessageBuffer::unregisterDequeueCallback()
 void
 MessageBuffer::clear()
 {
-    m_prio_heap.clear();
+    m_prio_queue.clear();
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = 0;
@@ -291,53 +422,51 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
-    MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    MsgPtr node = m_prio_queue.front();
+    m_prio_queue.pop();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    m_prio_queue.push(node);
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
 void
-MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
+MessageBuffer::reanalyzeList(vector<MsgPtr> &lt, Tick schdTick)
 {
-    while (!lt.empty()) {
-        MsgPtr m = lt.front();
+    for (const MsgPtr &m : lt) {
         assert(m->getLastEnqueueTime() <= schdTick);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+        m_prio_queue.push(m);
 
+        if (m_consumer_slot >= 0)
+            m_consumer->markBufferPending(m_consumer_slot);
         m_consumer->scheduleEventAbsolute(schdTick);
 
         DPRINTF(RubyQueue, "Requeue arrival_time: %lld, Message: %s\n",
             schdTick, *(m.get()));
-
-        lt.pop_front();
     }
+    lt.clear();
 }
 
 void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
+    auto it = m_stall_msg_map.find(addr);
+    assert(it != m_stall_msg_map.end());
 
     //
     // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
+    // prio queue.  The reanalyzeList call will make sure the consumer is
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle
     //
-    m_stall_map_size -= m_stall_msg_map[addr].size();
+    m_stall_map_size -= it->second.size();
     assert(m_stall_map_size >= 0);
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    reanalyzeList(it->second, current_time);
+    m_stall_msg_map.erase(it);
 }
 
 void
@@ -347,7 +476,7 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
 
     //
     // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
+    // prio queue.  The reanalyzeList call will make sure the consumer is
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle.
     //
@@ -366,7 +495,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     DPRINTF(RubyQueue, "Stalling due to %#x\n", addr);
     assert(isReady(current_time));
     assert(getOffset(addr) == 0);
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = m_prio_queue.front();
 
     // Since the message will just be moved to stall map, indicate that the
     // buffer should not decrement the m_buf_msgs statistic
@@ -390,16 +519,17 @@ MessageBuffer::print(ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    vector<MsgPtr> copy(m_prio_heap);
-    sort_heap(copy.begin(), copy.end(), greater<MsgPtr>());
+    vector<MsgPtr> copy;
+    m_prio_queue.forEach([&copy](const MsgPtr &msg) { copy.push_back(msg); });
+    sort(copy.begin(), copy.end(), greater<MsgPtr>());
     ccprintf(out, "%s] %s", copy, name());
 }
 
 bool
 MessageBuffer::isReady(Tick current_time) const
 {
-    return ((m_prio_heap.size() > 0) &&
-        (m_prio_heap.front()->getLastEnqueueTime() <= current_time));
+    return (!m_prio_queue.empty() &&
+        (m_prio_queue.front()->getLastEnqueueTime() <= current_time));
 }
 
 void
@@ -442,14 +572,13 @@ MessageBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    // Check the priority heap and write any messages that may
+    // Check the priority queue and write any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
+    m_prio_queue.forEach([pkt, &num_functional_writes](const MsgPtr &msg) {
         if (msg->functionalWrite(pkt)) {
             num_functional_writes++;
         }
-    }
+    });
 
     // Check the stall queue and write any messages that may
     // correspond to the address in the packet.
@@ -457,7 +586,7 @@ MessageBuffer::functionalWrite(Packet *pkt)
          map_iter != m_stall_msg_map.end();
          ++map_iter) {
 
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
+        for (std::vector<MsgPtr>::iterator it = (map_iter->second).begin();
             it != (map_iter->second).end(); ++it) {
 
             Message *msg = (*it).get();
@@ -467,6 +596,18 @@ MessageBuffer::functionalWrite(Packet *pkt)
         }
     }
 
+    // Messages from other event queues that haven't been drained yet.
+    // The functional access runs with all event queues stopped, so the
+    // lanes can't change meanwhile.
+    for (auto &lane : m_remote_lanes) {
+        lane->queue.forEach(
+            [pkt, &num_functional_writes](RemoteMsg &remote) {
+                if (remote.msg->functionalWrite(pkt)) {
+                    num_functional_writes++;
+                }
+            });
+    }
+
     return num_functional_writes;
 }
 
@@ -35,21 +35,27 @@
 #define __MEM_RUBY_NETWORK_MESSAGEBUFFER_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "base/spsc_queue.hh"
 #include "base/trace.hh"
 #include "debug/RubyQueue.hh"
 #include "mem/packet.hh"
 #include "mem/port.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/common/TimingWheel.hh"
 #include "mem/ruby/network/dummy_port.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/MessageBuffer.hh"
+#include "sim/eventq.hh"
 #include "sim/sim_object.hh"
 
 class MessageBuffer : public SimObject
@@ -58,6 +64,8 @@ class MessageBuffer : public SimObject
     typedef MessageBufferParams Params;
     MessageBuffer(const Params *p);
 
+    void init() override;
+
     void reanalyzeMessages(Addr addr, Tick current_time);
     void reanalyzeAllMessages(Tick current_time);
     void stallMessage(Addr addr, Tick current_time);
@@ -68,17 +76,20 @@ class MessageBuffer : public SimObject
     void
     delayHead(Tick current_time, Tick delta)
     {
-        MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
+        MsgPtr m = m_prio_queue.front();
+        m_prio_queue.pop();
         enqueue(m, current_time, delta);
     }
 
     bool areNSlotsAvailable(unsigned int n, Tick curTime);
     int getPriority() { return m_priority_rank; }
     void setPriority(int rank) { m_priority_rank = rank; }
-    void setConsumer(Consumer* consumer)
+    /**
+     * Connect the consumer that is woken up when messages arrive. A
+     * non-negative slot below 64 additionally marks the slot pending in
+     * the consumer whenever a message is put into this buffer.
+     */
+    void setConsumer(Consumer* consumer, int slot = -1)
     {
         DPRINTF(RubyQueue, "Setting consumer: %s\n", *consumer);
         if (m_consumer != NULL) {
@@ -86,7 +97,9 @@ class MessageBuffer : public SimObject
                   \n%s already connected. Check the cntrl_id's.\n",
                   *consumer, *this, *m_consumer);
         }
+        assert(slot < 64);
         m_consumer = consumer;
+        m_consumer_slot = slot;
     }
 
     Consumer* getConsumer() { return m_consumer; }
@@ -97,7 +110,7 @@ class MessageBuffer : public SimObject
     //! message queue.  The function assumes that the queue is nonempty.
     const Message* peek() const;
 
-    const MsgPtr &peekMsgPtr() const { return m_prio_heap.front(); }
+    const MsgPtr &peekMsgPtr() const { return m_prio_queue.front(); }
 
     void enqueue(MsgPtr message, Tick curTime, Tick delta);
 
@@ -109,7 +122,7 @@ class MessageBuffer : public SimObject
     void unregisterDequeueCallback();
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
+    bool isEmpty() const { return m_prio_queue.empty(); }
     bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
     unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
 
@@ -137,32 +150,99 @@ class MessageBuffer : public SimObject
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    void reanalyzeList(std::list<MsgPtr> &, Tick);
+    void reanalyzeList(std::vector<MsgPtr> &, Tick);
+
+    /** Put a message whose arrival time is set into the queue. */
+    void insertMessage(MsgPtr message);
+
+    /**
+     * Enqueue a message from a thread simulating another event queue
+     * than the consumer of this buffer. The message is passed to the
+     * consumer through the lane of the sending event queue and only
+     * reaches the queue when the consumer drains the lane, one
+     * simulation quantum after it was sent. The latency of such
+     * messages must therefore be at least one quantum.
+     */
+    void enqueueRemote(MsgPtr message, Tick current_time, Tick delta);
+
+    /**
+     * Move all messages that were sent at least one quantum ago from
+     * the remote lanes to the queue and make sure the given lane is
+     * drained again when its next message is due. Runs on the thread
+     * of the consumer.
+     */
+    void drainRemote(int lane_index);
+
+    /** Schedule a drain of a lane on the event queue of the consumer. */
+    void scheduleRemoteDrain(int lane_index, Tick when);
+
+    /** A message sent from another event queue. */
+    struct RemoteMsg
+    {
+        MsgPtr msg;
+        Tick sendTick;
+    };
+
+    /**
+     * Messages sent by the thread simulating one event queue. Each
+     * lane has a single producer and is only drained by the thread of
+     * the consumer.
+     */
+    struct RemoteLane
+    {
+        SpscQueue<RemoteMsg> queue;
+        //! Set while a drain of the lane is pending.
+        std::atomic<bool> drainScheduled;
+
+        RemoteLane() : drainScheduled(false) {}
+    };
+
+    //! Lanes indexed by the event queue of the sender. Only used if
+    //! there is more than one event queue.
+    std::vector<std::unique_ptr<RemoteLane>> m_remote_lanes;
 
   private:
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
-    std::vector<MsgPtr> m_prio_heap;
+    //! Slot of this buffer in the consumer's pending mask, or -1
+    int m_consumer_slot;
+
+    //! Arrival time of a message, by which it is ordered in the queue
+    struct MsgArrival
+    {
+        Tick
+        operator()(const MsgPtr &msg) const
+        {
+            return msg->getLastEnqueueTime();
+        }
+    };
+
+    /**
+     * The messages in the order of their arrival time and, for equal
+     * times, their message counter. Nearly all messages arrive within a
+     * few cycles, which the buckets of the timing wheel cover.
+     */
+    TimingWheel<MsgPtr, std::greater<MsgPtr>, MsgArrival> m_prio_queue;
 
     std::function<void()> m_dequeue_callback;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
+    // The order in which the lines are visited doesn't matter, as the
+    // reanalyzed messages keep their arrival time and counter
+    typedef std::unordered_map<Addr, std::vector<MsgPtr> > StallMsgMapType;
 
     /**
      * A map from line addresses to lists of stalled messages for that line.
      * If this buffer allows the receiver to stall messages, on a stall
-     * request, the stalled message is removed from the m_prio_heap and placed
-     * in the m_stall_msg_map. Messages are held there until the receiver
-     * requests they be reanalyzed, at which point they are moved back to
-     * m_prio_heap.
+     * request, the stalled message is removed from the m_prio_queue and
+     * placed in the m_stall_msg_map. Messages are held there until the
+     * receiver requests they be reanalyzed, at which point they are moved
+     * back to m_prio_queue.
      *
      * NOTE: The stall map holds messages in the order in which they were
      * initially received, and when a line is unblocked, the messages are
-     * moved back to the m_prio_heap in the same order. This prevents starving
-     * older requests with younger ones.
+     * moved back to the m_prio_queue in the same order. This prevents
+     * starving older requests with younger ones.
      */
     StallMsgMapType m_stall_msg_map;
 
@@ -170,7 +250,7 @@ class MessageBuffer : public SimObject
      * Current size of the stall map.
      * Track the number of messages held in stall map lists. This is used to
      * ensure that if the buffer is finite-sized, it blocks further requests
-     * when the m_prio_heap and m_stall_msg_map contain m_max_size messages.
+     * when the m_prio_queue and m_stall_msg_map contain m_max_size messages.
      */
     int m_stall_map_size;
 
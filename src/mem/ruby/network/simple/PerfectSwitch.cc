@@ -95,6 +95,7 @@ PerfectSwitch::addOutPort(const vector<MessageBuffer*>& out,
     // Add to routing table
     m_out.push_back(out);
     m_routing_table.push_back(routing_table_entry);
+    m_static_routes.addLink(l.m_link, routing_table_entry);
 }
 
 PerfectSwitch::~PerfectSwitch()
@@ -157,7 +158,7 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
 
         output_links.clear();
         output_link_destinations.clear();
-        NetDest msg_dsts = net_msg_ptr->getDestination();
+        const NetDest &msg_dsts = net_msg_ptr->getDestination();
 
         // Unfortunately, the token-protocol sends some
         // zero-destination messages, so this assert isn't valid
@@ -166,57 +167,30 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
         assert(m_link_order.size() == m_routing_table.size());
         assert(m_link_order.size() == m_out.size());
 
-        if (m_network_ptr->getAdaptiveRouting()) {
-            if (m_network_ptr->isVNetOrdered(vnet)) {
-                // Don't adaptively route
-                for (int out = 0; out < m_out.size(); out++) {
-                    m_link_order[out].m_link = out;
-                    m_link_order[out].m_value = 0;
+        if (m_network_ptr->getAdaptiveRouting() &&
+            !m_network_ptr->isVNetOrdered(vnet)) {
+            // Find how clogged each link is
+            for (int out = 0; out < m_out.size(); out++) {
+                int out_queue_length = 0;
+                for (int v = 0; v < m_virtual_networks; v++) {
+                    out_queue_length += m_out[out][v]->getSize(current_time);
                 }
-            } else {
-                // Find how clogged each link is
-                for (int out = 0; out < m_out.size(); out++) {
-                    int out_queue_length = 0;
-                    for (int v = 0; v < m_virtual_networks; v++) {
-                        out_queue_length += m_out[out][v]->getSize(current_time);
-                    }
-                    int value =
-                        (out_queue_length << 8) |
-                        random_mt.random(0, 0xff);
-                    m_link_order[out].m_link = out;
-                    m_link_order[out].m_value = value;
-                }
-
-                // Look at the most empty link first
-                sort(m_link_order.begin(), m_link_order.end());
+                int value =
+                    (out_queue_length << 8) |
+                    random_mt.random(0, 0xff);
+                m_link_order[out].m_link = out;
+                m_link_order[out].m_value = value;
             }
-        }
-
-        for (int i = 0; i < m_routing_table.size(); i++) {
-            // pick the next link to look at
-            int link = m_link_order[i].m_link;
-            NetDest dst = m_routing_table[link];
-            DPRINTF(RubyNetwork, "dst: %s\n", dst);
-
-            if (!msg_dsts.intersectionIsNotEmpty(dst))
-                continue;
-
-            // Remember what link we're using
-            output_links.push_back(link);
 
-            // Need to remember which destinations need this message in
-            // another vector.  This Set is the intersection of the
-            // routing_table entry and the current destination set.  The
-            // intersection must not be empty, since we are inside "if"
-            output_link_destinations.push_back(msg_dsts.AND(dst));
+            // Look at the most empty link first
+            sort(m_link_order.begin(), m_link_order.end());
 
-            // Next, we update the msg_destination not to include
-            // those nodes that were already handled by this link
-            msg_dsts.removeNetDest(dst);
+            routeOrdered(msg_dsts, output_links, output_link_destinations);
+        } else {
+            m_static_routes.route(msg_dsts, output_links,
+                                  output_link_destinations);
         }
 
-        assert(msg_dsts.count() == 0);
-
         // Check for resources - for all outgoing queues
         bool enough = true;
         for (int i = 0; i < output_links.size(); i++) {
@@ -281,6 +255,37 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
     }
 }
 
+void
+PerfectSwitch::routeOrdered(NetDest msg_dsts,
+                            vector<LinkID> &output_links,
+                            vector<NetDest> &output_link_destinations)
+{
+    for (int i = 0; i < m_routing_table.size(); i++) {
+        // pick the next link to look at
+        int link = m_link_order[i].m_link;
+        const NetDest &dst = m_routing_table[link];
+        DPRINTF(RubyNetwork, "dst: %s\n", dst);
+
+        if (!msg_dsts.intersectionIsNotEmpty(dst))
+            continue;
+
+        // Remember what link we're using
+        output_links.push_back(link);
+
+        // Need to remember which destinations need this message in
+        // another vector.  This Set is the intersection of the
+        // routing_table entry and the current destination set.  The
+        // intersection must not be empty, since we are inside "if"
+        output_link_destinations.push_back(msg_dsts.AND(dst));
+
+        // Next, we update the msg_destination not to include
+        // those nodes that were already handled by this link
+        msg_dsts.removeNetDest(dst);
+    }
+
+    assert(msg_dsts.count() == 0);
+}
+
 void
 PerfectSwitch::wakeup()
 {
@@ -41,10 +41,12 @@
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/common/MachineID.hh"
+#include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/common/TypeDefines.hh"
+#include "mem/ruby/network/simple/StaticRoutes.hh"
 
 class MessageBuffer;
-class NetDest;
 class SimpleNetwork;
 class Switch;
 
@@ -88,6 +90,11 @@ class PerfectSwitch : public Consumer
     void operateVnet(int vnet);
     void operateMessageBuffer(MessageBuffer *b, int incoming, int vnet);
 
+    /** Route a message through the links in the current m_link_order. */
+    void routeOrdered(NetDest msg_dsts,
+                      std::vector<LinkID> &output_links,
+                      std::vector<NetDest> &output_link_destinations);
+
     const SwitchID m_switch_id;
     Switch * const m_switch;
 
@@ -98,6 +105,9 @@ class PerfectSwitch : public Consumer
     std::vector<NetDest> m_routing_table;
     std::vector<LinkOrder> m_link_order;
 
+    // Routes for the link order of the routing table
+    StaticRoutes m_static_routes;
+
     uint32_t m_virtual_networks;
     int m_round_robin_start;
     int m_wakeups_wo_switch;
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 1999-2008 Mark D. Hill and David A. Wood
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/simple/StaticRoutes.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+void
+StaticRoutes::addLink(LinkID link, const NetDest &reach)
+{
+    if (m_link_slot.size() <= link)
+        m_link_slot.resize(link + 1, -1);
+
+    // Destinations that no earlier link reaches leave through this one
+    m_dest_link.resize(MachineType_NUM);
+    for (int i = 0; i < MachineType_NUM; i++) {
+        MachineType type = MachineType_from_base_level(i);
+        m_dest_link[i].resize(MachineType_base_count(type), -1);
+        for (NodeID j : reach.getNetDest(type)) {
+            if (m_dest_link[i][j] < 0)
+                m_dest_link[i][j] = link;
+        }
+    }
+}
+
+void
+StaticRoutes::route(const NetDest &msg_dsts,
+                    vector<LinkID> &output_links,
+                    vector<NetDest> &output_link_destinations)
+{
+    int num_dsts = msg_dsts.count();
+    if (num_dsts == 0)
+        return;
+
+    if (num_dsts == 1) {
+        output_links.push_back(destLink(msg_dsts.smallestElement()));
+        output_link_destinations.push_back(msg_dsts);
+        return;
+    }
+
+    // Fan the destinations out to the links that reach them, only
+    // visiting the machines that are set in the message
+    for (int i = 0; i < m_dest_link.size() && num_dsts > 0; i++) {
+        MachineType type = MachineType_from_base_level(i);
+        for (NodeID j : msg_dsts.getNetDest(type)) {
+            int link = m_dest_link[i][j];
+            assert(link >= 0);
+            if (m_link_slot[link] < 0) {
+                m_link_slot[link] = output_links.size();
+                output_links.push_back(link);
+                output_link_destinations.push_back(NetDest());
+            }
+            output_link_destinations[m_link_slot[link]].add({type, j});
+            num_dsts--;
+        }
+    }
+
+    // Hand the links out in routing table order, like the adaptive walk
+    // over the routing table does
+    if (!is_sorted(output_links.begin(), output_links.end())) {
+        vector<NetDest> dsts;
+        dsts.reserve(output_links.size());
+        sort(output_links.begin(), output_links.end());
+        for (auto link : output_links)
+            dsts.push_back(move(output_link_destinations[m_link_slot[link]]));
+        output_link_destinations.swap(dsts);
+    }
+
+    for (auto link : output_links)
+        m_link_slot[link] = -1;
+}
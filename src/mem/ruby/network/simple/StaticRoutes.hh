@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 1999-2008 Mark D. Hill and David A. Wood
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_SIMPLE_STATICROUTES_HH__
+#define __MEM_RUBY_NETWORK_SIMPLE_STATICROUTES_HH__
+
+#include <vector>
+
+#include "mem/ruby/common/MachineID.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/common/TypeDefines.hh"
+
+/**
+ * Routes of a switch when the links are tried in the order of its
+ * routing table, i.e. every destination leaves through the first link
+ * that reaches it. The link of each destination is computed once when
+ * the links are added, so routing a message only costs a walk over its
+ * destinations.
+ */
+class StaticRoutes
+{
+  public:
+    /**
+     * Add the next link of the routing table. The link takes the
+     * destinations of reach that no earlier link reaches.
+     */
+    void addLink(LinkID link, const NetDest &reach);
+
+    /** Output link of a destination. */
+    LinkID
+    destLink(MachineID dest) const
+    {
+        int link = m_dest_link[MachineType_base_level(dest.type)][dest.num];
+        assert(link >= 0);
+        return link;
+    }
+
+    /**
+     * Split the destinations of a message over the links that reach
+     * them. The links are returned in routing table order, each with
+     * the destinations it is responsible for.
+     */
+    void route(const NetDest &msg_dsts,
+               std::vector<LinkID> &output_links,
+               std::vector<NetDest> &output_link_destinations);
+
+  private:
+    // Output link of each destination, indexed by machine type base
+    // level and machine number; -1 if no link reaches it.
+    std::vector<std::vector<int>> m_dest_link;
+    // Scratch space for multicast routing: the slot of each link in
+    // the output vectors, or -1 if the link is not used.
+    std::vector<int> m_link_slot;
+};
+
+#endif // __MEM_RUBY_NETWORK_SIMPLE_STATICROUTES_HH__
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "mem/ruby/network/simple/StaticRoutes.hh"
+
+// The machine layout is generated with the protocol, which isn't linked
+// in. Every machine type gets the same number of machines instead.
+namespace {
+const int machinesPerType = 10;
+}
+
+int
+MachineType_base_level(const MachineType &obj)
+{
+    return obj;
+}
+
+MachineType
+MachineType_from_base_level(int level)
+{
+    return MachineType(level);
+}
+
+int
+MachineType_base_number(const MachineType &obj)
+{
+    return obj * machinesPerType;
+}
+
+int
+MachineType_base_count(const MachineType &obj)
+{
+    return machinesPerType;
+}
+
+MachineType &
+operator++(MachineType &e)
+{
+    return e = MachineType(e + 1);
+}
+
+namespace {
+
+/**
+ * Route a message by walking the routing table in order and
+ * intersecting every link with the destinations that are left, as the
+ * switch did before the routes were precomputed.
+ */
+void
+walkRoutes(const std::vector<NetDest> &table, NetDest msg_dsts,
+           std::vector<LinkID> &output_links,
+           std::vector<NetDest> &output_link_destinations)
+{
+    for (LinkID link = 0; link < table.size(); link++) {
+        if (!msg_dsts.intersectionIsNotEmpty(table[link]))
+            continue;
+        output_links.push_back(link);
+        output_link_destinations.push_back(msg_dsts.AND(table[link]));
+        msg_dsts.removeNetDest(table[link]);
+    }
+}
+
+/** A random subset of all machines, each machine with probability p. */
+NetDest
+randomDests(std::mt19937 &rng, double p)
+{
+    std::bernoulli_distribution pick(p);
+    NetDest dsts;
+    for (int i = 0; i < MachineType_NUM; i++) {
+        for (NodeID j = 0; j < machinesPerType; j++) {
+            if (pick(rng))
+                dsts.add({MachineType(i), j});
+        }
+    }
+    return dsts;
+}
+
+} // anonymous namespace
+
+TEST(StaticRoutesTest, FirstLinkThatReaches)
+{
+    MachineID a = {MachineType(0), 3};
+    MachineID b = {MachineType(1), 3};
+
+    NetDest first, second;
+    first.add(a);
+    second.add(a);
+    second.add(b);
+
+    StaticRoutes routes;
+    routes.addLink(0, first);
+    routes.addLink(1, second);
+    EXPECT_EQ(0u, routes.destLink(a));
+    EXPECT_EQ(1u, routes.destLink(b));
+}
+
+TEST(StaticRoutesTest, Unicast)
+{
+    NetDest all;
+    all.broadcast();
+    StaticRoutes routes;
+    routes.addLink(0, all);
+
+    MachineID dest = {MachineType(1), 7};
+    NetDest msg_dsts;
+    msg_dsts.add(dest);
+
+    std::vector<LinkID> links;
+    std::vector<NetDest> dsts;
+    routes.route(msg_dsts, links, dsts);
+    ASSERT_EQ(1u, links.size());
+    ASSERT_EQ(1u, dsts.size());
+    EXPECT_EQ(0u, links[0]);
+    EXPECT_TRUE(dsts[0].isEqual(msg_dsts));
+
+    links.clear();
+    dsts.clear();
+    routes.route(NetDest(), links, dsts);
+    EXPECT_TRUE(links.empty());
+    EXPECT_TRUE(dsts.empty());
+}
+
+/**
+ * The links of a multicast come out in routing table order, even when
+ * the first destination of the message leaves through a later link.
+ */
+TEST(StaticRoutesTest, MulticastInLinkOrder)
+{
+    MachineID low = {MachineType(0), 0};
+    MachineID high = {MachineType(2), 5};
+
+    NetDest first, second;
+    first.add(high);
+    second.add(low);
+
+    StaticRoutes routes;
+    routes.addLink(0, first);
+    routes.addLink(1, second);
+
+    NetDest msg_dsts;
+    msg_dsts.add(low);
+    msg_dsts.add(high);
+
+    std::vector<LinkID> links;
+    std::vector<NetDest> dsts;
+    routes.route(msg_dsts, links, dsts);
+    ASSERT_EQ(2u, links.size());
+    EXPECT_EQ(0u, links[0]);
+    EXPECT_EQ(1u, links[1]);
+    EXPECT_TRUE(dsts[0].isElement(high));
+    EXPECT_FALSE(dsts[0].isElement(low));
+    EXPECT_TRUE(dsts[1].isElement(low));
+    EXPECT_FALSE(dsts[1].isElement(high));
+}
+
+/** Random routing tables and messages against the routing table walk */
+TEST(StaticRoutesTest, MatchesRoutingTableWalk)
+{
+    std::mt19937 rng(7);
+    for (int t = 0; t < 20; t++) {
+        // Overlapping links, the last of which reaches everyone
+        std::vector<NetDest> table;
+        int num_links = 1 + t % 8;
+        for (int l = 0; l < num_links - 1; l++)
+            table.push_back(randomDests(rng, 0.3));
+        table.push_back(NetDest());
+        table.back().broadcast();
+
+        StaticRoutes routes;
+        for (LinkID l = 0; l < table.size(); l++)
+            routes.addLink(l, table[l]);
+
+        for (int m = 0; m < 50; m++) {
+            NetDest msg_dsts = randomDests(rng, m % 2 ? 0.05 : 0.5);
+
+            std::vector<LinkID> links, expected_links;
+            std::vector<NetDest> dsts, expected_dsts;
+            routes.route(msg_dsts, links, dsts);
+            walkRoutes(table, msg_dsts, expected_links, expected_dsts);
+
+            ASSERT_EQ(expected_links, links);
+            ASSERT_EQ(expected_dsts.size(), dsts.size());
+            for (size_t i = 0; i < dsts.size(); i++)
+                EXPECT_TRUE(expected_dsts[i].isEqual(dsts[i]));
+        }
+    }
+}
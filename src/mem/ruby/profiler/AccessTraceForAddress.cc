@@ -28,16 +28,6 @@
 
 #include "mem/ruby/profiler/AccessTraceForAddress.hh"
 
-#include "mem/ruby/common/Histogram.hh"
-
-AccessTraceForAddress::~AccessTraceForAddress()
-{
-    if (m_histogram_ptr) {
-        delete m_histogram_ptr;
-        m_histogram_ptr = NULL;
-    }
-}
-
 void
 AccessTraceForAddress::print(std::ostream& out) const
 {
@@ -51,7 +41,17 @@ AccessTraceForAddress::print(std::ostream& out) const
         out << " | " << m_user;
         out << " " << m_total-m_user;
         out << " | " << m_sharing;
-        out << " | " << m_touched_by.count();
+        out << " | " << m_touched_by.count() << " (";
+        // List the nodes, to tell apart CPUs and accelerators
+        const char *sep = "";
+        for (int i = 0; i < m_touched_by.getSize(); i++) {
+            if (m_touched_by.isElement(i)) {
+                out << sep << i;
+                sep = " ";
+            }
+        }
+        out << ")";
+        out << " | " << m_stalls;
     } else {
         assert(m_total == 0);
         out << " " << (*m_histogram_ptr);
@@ -99,7 +99,14 @@ AccessTraceForAddress::addSample(int value)
 {
     assert(m_total == 0);
     if (m_histogram_ptr == NULL) {
-        m_histogram_ptr = new Histogram;
+        m_histogram_ptr.reset(new Histogram);
     }
     m_histogram_ptr->add(value);
 }
+
+void
+AccessTraceForAddress::addStall(NodeID node)
+{
+    m_touched_by.add(node);
+    m_stalls++;
+}
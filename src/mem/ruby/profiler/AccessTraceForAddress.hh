@@ -30,22 +30,21 @@
 #define __MEM_RUBY_PROFILER_ACCESSTRACEFORADDRESS_HH__
 
 #include <iostream>
+#include <memory>
 
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/Histogram.hh"
 #include "mem/ruby/common/Set.hh"
 #include "mem/ruby/protocol/RubyAccessMode.hh"
 #include "mem/ruby/protocol/RubyRequestType.hh"
 
-class Histogram;
-
 class AccessTraceForAddress
 {
   public:
     AccessTraceForAddress()
-        : m_loads(0), m_stores(0), m_atomics(0), m_total(0), m_user(0),
-          m_sharing(0), m_histogram_ptr(NULL)
+        : m_addr(0), m_loads(0), m_stores(0), m_atomics(0), m_total(0),
+          m_user(0), m_sharing(0), m_stalls(0)
     { }
-    ~AccessTraceForAddress();
 
     void setAddress(Addr addr) { m_addr = addr; }
     void update(RubyRequestType type, RubyAccessMode access_mode, NodeID cpu,
@@ -55,6 +54,9 @@ class AccessTraceForAddress
     int getTouchedBy() const { return m_touched_by.count(); }
     Addr getAddress() const { return m_addr; }
     void addSample(int value);
+    //! A controller stalled a request to the address
+    void addStall(NodeID node);
+    uint64_t getStalls() const { return m_stalls; }
 
     void print(std::ostream& out) const;
 
@@ -73,8 +75,9 @@ class AccessTraceForAddress
     uint64_t m_total;
     uint64_t m_user;
     uint64_t m_sharing;
+    uint64_t m_stalls;
     Set m_touched_by;
-    Histogram* m_histogram_ptr;
+    std::unique_ptr<Histogram> m_histogram_ptr;
 };
 
 inline std::ostream&
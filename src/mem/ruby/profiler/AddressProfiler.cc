@@ -31,9 +31,12 @@
 #include <vector>
 
 #include "base/bitfield.hh"
+#include "base/output.hh"
 #include "base/stl_helpers.hh"
 #include "mem/ruby/profiler/Profiler.hh"
 #include "mem/ruby/protocol/RubyRequest.hh"
+#include "mem/ruby/system/RubySystem.hh"
+#include "sim/core.hh"
 
 using namespace std;
 typedef AddressProfiler::AddressMap AddressMap;
@@ -42,24 +45,12 @@ using m5::stl_helpers::operator<<;
 
 // Helper functions
 AccessTraceForAddress&
-lookupTraceForAddress(Addr addr, AddressMap& record_map)
+lookupTraceForAddress(Addr addr, AddressMap& record_map, uint64_t weight)
 {
-    // we create a static default object here that is used to insert
-    // since the insertion will create a copy of the object in the
-    // process.  Perhaps this is optimizing early, but it doesn't seem
-    // like it could hurt.
-    static const AccessTraceForAddress dflt;
-
-    pair<AddressMap::iterator, bool> r =
-        record_map.insert(make_pair(addr, dflt));
-    AddressMap::iterator i = r.first;
-    AccessTraceForAddress &access_trace = i->second;
-    if (r.second) {
-        // there was nothing there and the insert succeed, so we need
-        // to actually set the address.
-        access_trace.setAddress(addr);
-    }
-
+    // An address that is new to the sketch may take the place of the
+    // least frequent one, so its trace starts out blank
+    AccessTraceForAddress &access_trace = record_map.add(addr, weight);
+    access_trace.setAddress(addr);
     return access_trace;
 }
 
@@ -69,27 +60,19 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
 {
     const int records_printed = 100;
 
-    uint64_t misses = 0;
-    std::vector<const AccessTraceForAddress *> sorted;
-
-    AddressMap::const_iterator i = record_map.begin();
-    AddressMap::const_iterator end = record_map.end();
-    for (; i != end; ++i) {
-        const AccessTraceForAddress* record = &i->second;
-        misses += record->getTotal();
-        sorted.push_back(record);
-    }
-    sort(sorted.begin(), sorted.end(), AccessTraceForAddress::less_equal);
+    uint64_t misses = record_map.total();
+    std::vector<const AddressMap::Entry *> sorted =
+        record_map.top(record_map.size());
 
     out << "Total_entries_" << description << ": " << record_map.size()
-        << endl;
+        << " (at most " << record_map.capacity() << ")" << endl;
     if (profiler->getAllInstructions())
         out << "Total_Instructions_" << description << ": " << misses << endl;
     else
         out << "Total_data_misses_" << description << ": " << misses << endl;
 
-    out << "total | load store atomic | user supervisor | sharing | touched-by"
-        << endl;
+    out << "count error | address total | load store atomic | "
+        << "user supervisor | sharing | touched-by | stalls" << endl;
 
     Histogram remaining_records(1, 100);
     Histogram all_records(1, 100);
@@ -108,25 +91,30 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
 
     int counter = 0;
     int max = sorted.size();
-    while (counter < max && counter < records_printed) {
-        const AccessTraceForAddress* record = sorted[counter];
-        double percent = 100.0 * (record->getTotal() / double(misses));
-        out << description << " | " << percent << " % " << *record << endl;
-        all_records.add(record->getTotal());
-        all_records_log.add(record->getTotal());
+    while (counter < max) {
+        const AddressMap::Entry* entry = sorted[counter];
+        const AccessTraceForAddress* record = &entry->value;
+        if (counter < records_printed) {
+            double percent = 100.0 * (entry->count / double(misses));
+            out << description << " | " << percent << " % "
+                << entry->count << " " << entry->error << " | "
+                << *record << endl;
+        } else {
+            remaining_records.add(entry->count);
+            remaining_records_log.add(entry->count);
+        }
+        all_records.add(entry->count);
+        all_records_log.add(entry->count);
         counter++;
-        m_touched_vec[record->getTouchedBy()]++;
-        m_touched_weighted_vec[record->getTouchedBy()] += record->getTotal();
-    }
 
-    while (counter < max) {
-        const AccessTraceForAddress* record = sorted[counter];
-        all_records.add(record->getTotal());
-        remaining_records.add(record->getTotal());
-        all_records_log.add(record->getTotal());
-        remaining_records_log.add(record->getTotal());
-        m_touched_vec[record->getTouchedBy()]++;
-        m_touched_weighted_vec[record->getTouchedBy()] += record->getTotal();
+        // Stalls may come from controllers without a sequencer
+        int touched_by = record->getTouchedBy();
+        if (touched_by >= m_touched_vec.size()) {
+            m_touched_vec.resize(touched_by + 1, 0);
+            m_touched_weighted_vec.resize(touched_by + 1, 0);
+        }
+        m_touched_vec[touched_by]++;
+        m_touched_weighted_vec[touched_by] += entry->count;
     }
     out << endl;
     out << "all_records_" << description << ": "
@@ -144,8 +132,13 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
         << endl;
 }
 
-AddressProfiler::AddressProfiler(int num_of_sequencers, Profiler *profiler)
-    : m_profiler(profiler)
+AddressProfiler::AddressProfiler(int num_of_sequencers, Profiler *profiler,
+                                 int max_entries)
+    : m_dataAccessTrace(max_entries), m_macroBlockAccessTrace(max_entries),
+      m_programCounterAccessTrace(max_entries),
+      m_retryProfileMap(max_entries), m_stallTrace(max_entries),
+      m_profiler(profiler), m_hot_lines(false), m_all_instructions(false),
+      m_window_stream(nullptr), m_window_count(0)
 {
     m_num_of_sequencers = num_of_sequencers;
     clearStats();
@@ -153,6 +146,8 @@ AddressProfiler::AddressProfiler(int num_of_sequencers, Profiler *profiler)
 
 AddressProfiler::~AddressProfiler()
 {
+    if (m_window_stream)
+        simout.close(m_window_stream);
 }
 
 void
@@ -199,6 +194,12 @@ AddressProfiler::printStats(ostream& out) const
         out << endl;
         printSorted(out, m_num_of_sequencers, m_programCounterAccessTrace,
                     "pc_address", m_profiler);
+
+        out << "Contended Data Blocks" << endl;
+        out << "---------------------" << endl;
+        out << endl;
+        printSorted(out, m_num_of_sequencers, m_stallTrace,
+                    "stall_address", m_profiler);
     }
 
     if (m_all_instructions) {
@@ -238,11 +239,36 @@ AddressProfiler::clearStats()
     m_macroBlockAccessTrace.clear();
     m_programCounterAccessTrace.clear();
     m_retryProfileMap.clear();
+    m_stallTrace.clear();
     m_retryProfileHisto.clear();
     m_retryProfileHistoRead.clear();
     m_retryProfileHistoWrite.clear();
     m_getx_sharing_histogram.clear();
     m_gets_sharing_histogram.clear();
+    m_window_start = curTick();
+}
+
+void
+AddressProfiler::dumpWindow()
+{
+    if (!m_hot_lines)
+        return;
+
+    if (!m_window_stream) {
+        m_window_stream = simout.create(
+            m_profiler->m_ruby_system->name() + ".hot_lines.txt");
+    }
+
+    ostream &out = *m_window_stream->stream();
+    out << "---------- Begin Hot Lines " << m_window_count << " (ticks "
+        << m_window_start << " to " << curTick() << ") ----------" << endl;
+    printStats(out);
+    out << "---------- End Hot Lines " << m_window_count << " ----------"
+        << endl << endl;
+    out.flush();
+
+    m_window_count++;
+    clearStats();
 }
 
 void
@@ -286,7 +312,7 @@ AddressProfiler::addTraceSample(Addr data_addr, Addr pc_addr,
                                 RubyAccessMode access_mode, NodeID id,
                                 bool sharing_miss)
 {
-    if (m_all_instructions) {
+    if (m_hot_lines) {
         if (sharing_miss) {
             m_sharing_miss_counter++;
         }
@@ -306,12 +332,10 @@ AddressProfiler::addTraceSample(Addr data_addr, Addr pc_addr,
         // record program counter address trace info
         lookupTraceForAddress(pc_addr, m_programCounterAccessTrace).
             update(type, access_mode, id, sharing_miss);
-    }
-
-    if (m_all_instructions) {
+    } else if (m_all_instructions) {
         // This code is used if the address profiler is an
         // all-instructions profiler record program counter address
-        // trace info
+        // trace info. With hot lines, the PC was recorded above.
         lookupTraceForAddress(pc_addr, m_programCounterAccessTrace).
             update(type, access_mode, id, sharing_miss);
     }
@@ -327,6 +351,15 @@ AddressProfiler::profileRetry(Addr data_addr, AccessType type, int count)
         m_retryProfileHistoWrite.add(count);
     }
     if (count > 1) {
-        lookupTraceForAddress(data_addr, m_retryProfileMap).addSample(count);
+        lookupTraceForAddress(data_addr, m_retryProfileMap, count).
+            addSample(count);
+    }
+}
+
+void
+AddressProfiler::profileStall(Addr line_addr, NodeID node)
+{
+    if (m_hot_lines) {
+        lookupTraceForAddress(line_addr, m_stallTrace).addStall(node);
     }
 }
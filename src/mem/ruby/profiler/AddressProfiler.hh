@@ -30,8 +30,8 @@
 #define __MEM_RUBY_PROFILER_ADDRESSPROFILER_HH__
 
 #include <iostream>
-#include <unordered_map>
 
+#include "base/space_saving.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Histogram.hh"
 #include "mem/ruby/profiler/AccessTraceForAddress.hh"
@@ -39,24 +39,40 @@
 #include "mem/ruby/protocol/AccessType.hh"
 #include "mem/ruby/protocol/RubyRequest.hh"
 
+class OutputStream;
 class Set;
 
+/**
+ * Profiles the addresses that are accessed, missed or stalled on the
+ * most. Each table keeps track of a bounded number of addresses in a
+ * heavy hitters sketch, so that the memory used doesn't grow with the
+ * footprint of the workload. With hot lines enabled, the hot lines of
+ * every window between two statistics dumps are written to
+ * <ruby system>.hot_lines.txt.
+ */
 class AddressProfiler
 {
   public:
-    typedef std::unordered_map<Addr, AccessTraceForAddress> AddressMap;
+    typedef SpaceSaving<Addr, AccessTraceForAddress> AddressMap;
 
   public:
-    AddressProfiler(int num_of_sequencers, Profiler *profiler);
+    AddressProfiler(int num_of_sequencers, Profiler *profiler,
+                    int max_entries);
     ~AddressProfiler();
 
     void printStats(std::ostream& out) const;
     void clearStats();
 
+    /** Write the hot lines of the current window and start a new one. */
+    void dumpWindow();
+
     void addTraceSample(Addr data_addr, Addr pc_addr,
                         RubyRequestType type, RubyAccessMode access_mode,
                         NodeID id, bool sharing_miss);
     void profileRetry(Addr data_addr, AccessType type, int count);
+    //! A controller stalled a request to the line, e.g., because
+    //! another controller's request to the line was in progress.
+    void profileStall(Addr line_addr, NodeID node);
     void profileGetX(Addr datablock, Addr PC,
                      const Set& owner, const Set& sharers, NodeID requestor);
     void profileGetS(Addr datablock, Addr PC,
@@ -81,6 +97,7 @@ class AddressProfiler
     AddressMap m_macroBlockAccessTrace;
     AddressMap m_programCounterAccessTrace;
     AddressMap m_retryProfileMap;
+    AddressMap m_stallTrace;
     Histogram m_retryProfileHisto;
     Histogram m_retryProfileHistoWrite;
     Histogram m_retryProfileHistoRead;
@@ -94,11 +111,17 @@ class AddressProfiler
     bool m_all_instructions;
 
     int m_num_of_sequencers;
+
+    //! Output of the windowed dumps and their number
+    OutputStream *m_window_stream;
+    int m_window_count;
+    Tick m_window_start;
 };
 
 AccessTraceForAddress& lookupTraceForAddress(Addr addr,
                                              AddressProfiler::AddressMap&
-                                             record_map);
+                                             record_map,
+                                             uint64_t weight = 1);
 
 void printSorted(std::ostream& out, int num_of_sequencers,
                  const AddressProfiler::AddressMap &record_map,
@@ -85,12 +85,14 @@ Profiler::Profiler(const RubySystemParams *p, RubySystem *rs)
       m_all_instructions(p->all_instructions),
       m_num_vnets(p->number_of_virtual_networks)
 {
-    m_address_profiler_ptr = new AddressProfiler(p->num_of_sequencers, this);
+    m_address_profiler_ptr = new AddressProfiler(p->num_of_sequencers, this,
+                                                 p->hot_lines_entries);
     m_address_profiler_ptr->setHotLines(m_hot_lines);
     m_address_profiler_ptr->setAllInstructions(m_all_instructions);
 
     if (m_all_instructions) {
-        m_inst_profiler_ptr = new AddressProfiler(p->num_of_sequencers, this);
+        m_inst_profiler_ptr = new AddressProfiler(p->num_of_sequencers, this,
+                                                  p->hot_lines_entries);
         m_inst_profiler_ptr->setHotLines(m_hot_lines);
         m_inst_profiler_ptr->setAllInstructions(m_all_instructions);
     }
@@ -111,6 +113,16 @@ Profiler::regStats(const std::string &pName)
         m_inst_profiler_ptr->regStats(pName);
     }
 
+    if (m_hot_lines) {
+        // Every statistics dump ends a window of the hot lines
+        Stats::registerDumpCallback(
+            new MakeCallback<AddressProfiler, &AddressProfiler::dumpWindow>(
+                m_address_profiler_ptr));
+        Stats::registerResetCallback(
+            new MakeCallback<AddressProfiler, &AddressProfiler::clearStats>(
+                m_address_profiler_ptr));
+    }
+
     delayHistogram
         .init(10)
         .name(pName + ".delayHist")
@@ -504,3 +516,23 @@ Profiler::addAddressTraceSample(const RubyRequest& msg, NodeID id)
                            msg.getType(), msg.getAccessMode(), id, false);
     }
 }
+
+void
+Profiler::profileHotLineMiss(const MachineID &requestor, Addr line_addr,
+                             Addr pc, RubyRequestType type,
+                             MachineType responder)
+{
+    NodeID node = MachineType_base_number(requestor.getType()) +
+        requestor.getNum();
+    m_address_profiler_ptr->addTraceSample(line_addr, pc, type,
+                                           RubyAccessMode_Supervisor, node,
+                                           responder == requestor.getType());
+}
+
+void
+Profiler::profileHotLineStall(const MachineID &machine, Addr line_addr)
+{
+    NodeID node = MachineType_base_number(machine.getType()) +
+        machine.getNum();
+    m_address_profiler_ptr->profileStall(line_addr, node);
+}
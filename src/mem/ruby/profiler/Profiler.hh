@@ -78,6 +78,15 @@ class Profiler
 
     void addAddressTraceSample(const RubyRequest& msg, NodeID id);
 
+    //! Profile a miss of the sequencer of a controller for the hot
+    //! lines. It is a sharing miss if a cache of the same type as the
+    //! requestor supplied the data.
+    void profileHotLineMiss(const MachineID &requestor, Addr line_addr,
+                            Addr pc, RubyRequestType type,
+                            MachineType responder);
+    //! Profile a request to a line that a controller stalled on
+    void profileHotLineStall(const MachineID &machine, Addr line_addr);
+
     // added by SS
     bool getHotLines() const { return m_hot_lines; }
     bool getAllInstructions() const { return m_all_instructions; }
@@ -42,6 +42,7 @@
 
 #include "debug/RubyQueue.hh"
 #include "mem/ruby/network/Network.hh"
+#include "mem/ruby/profiler/Profiler.hh"
 #include "mem/ruby/protocol/MemoryMsg.hh"
 #include "mem/ruby/system/GPUCoalescer.hh"
 #include "mem/ruby/system/RubySystem.hh"
@@ -54,6 +55,9 @@ AbstractController::AbstractController(const Params *p)
       m_masterId(p->system->getMasterId(this)), m_is_blocking(false),
       m_number_of_TBEs(p->number_of_TBEs),
       m_transitions_per_cycle(p->transitions_per_cycle),
+      m_transition_sample_period(
+          p->ruby_system->getTransitionSamplePeriod()),
+      m_transitions_to_sample(m_transition_sample_period),
       m_buffer_size(p->buffer_size), m_recycle_latency(p->recycle_latency),
       m_mandatory_queue_latency(p->mandatory_queue_latency),
       m_write_through(p->write_through),
@@ -120,6 +124,10 @@ AbstractController::stallBuffer(MessageBuffer* buf, Addr addr)
             addr);
     assert(m_in_ports > m_cur_in_port);
     (*(m_waiting_buffers[addr]))[m_cur_in_port] = buf;
+
+    Profiler *profiler = params()->ruby_system->getProfiler();
+    if (profiler->getHotLines())
+        profiler->profileHotLineStall(m_machineID, addr);
 }
 
 void
@@ -243,7 +251,7 @@ void
 AbstractController::queueMemoryRead(const MachineID &id, Addr addr,
                                     Cycles latency)
 {
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         addr, RubySystem::getBlockSizeBytes(), 0, m_masterId);
 
     PacketPtr pkt = Packet::createRead(req);
@@ -267,7 +275,7 @@ void
 AbstractController::queueMemoryWrite(const MachineID &id, Addr addr,
                                      Cycles latency, const DataBlock &block)
 {
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = Request::create(
         addr, RubySystem::getBlockSizeBytes(), 0, m_masterId);
 
     PacketPtr pkt = Packet::createWrite(req);
@@ -293,7 +301,7 @@ AbstractController::queueMemoryWritePartial(const MachineID &id, Addr addr,
                                             Cycles latency,
                                             const DataBlock &block, int size)
 {
-    RequestPtr req = std::make_shared<Request>(addr, size, 0, m_masterId);
+    RequestPtr req = Request::create(addr, size, 0, m_masterId);
 
     PacketPtr pkt = Packet::createWrite(req);
     pkt->allocate();
@@ -333,7 +341,7 @@ AbstractController::recvTimingResp(PacketPtr pkt)
     assert(getMemoryQueue());
     assert(pkt->isResponse());
 
-    std::shared_ptr<MemoryMsg> msg = std::make_shared<MemoryMsg>(clockEdge());
+    RefCountingPtr<MemoryMsg> msg = new MemoryMsg(clockEdge());
     (*msg).m_addr = pkt->getAddr();
     (*msg).m_Sender = m_machineID;
 
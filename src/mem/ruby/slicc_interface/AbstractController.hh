@@ -57,9 +57,11 @@
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/protocol/AccessPermission.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
+#include "mem/ruby/system/CacheSnapshot.hh"
 #include "params/RubyController.hh"
 #include "sim/clocked_object.hh"
 
+class AbstractCacheEntry;
 class Network;
 class GPUCoalescer;
 
@@ -101,6 +103,25 @@ class AbstractController : public ClockedObject, public Consumer
     virtual void regStats();
 
     virtual void recordCacheTrace(int cntrl, CacheRecorder* tr) = 0;
+
+    // Append every entry of the cache and directory memories of this
+    // controller to snap. Returns false if the entry types have fields
+    // that cannot be captured, in which case warmup falls back to
+    // replaying the cache trace.
+    virtual bool snapshotCacheState(int cntrl, CacheSnapshot &snap) = 0;
+
+    // Install the entry of the current snapshot record directly into
+    // the given cache, or the directory if store is
+    // CacheSnapshot::DirectoryStore, without going through the
+    // protocol. Returns the installed entry.
+    virtual AbstractCacheEntry *installCacheEntry(int store, Addr addr,
+                                                  CacheSnapshot &snap) = 0;
+
+    // The geometry of the caches snapshotCacheState() saves, in store
+    // order. A snapshot is only restored into caches of the same
+    // geometry.
+    virtual std::vector<CacheSnapshot::CacheGeometry>
+    snapshotCacheGeometry() const = 0;
     virtual Sequencer* getCPUSequencer() const = 0;
     virtual GPUCoalescer* getGPUCoalescer() const = 0;
 
@@ -181,6 +202,17 @@ class AbstractController : public ClockedObject, public Consumer
     void wakeUpAllBuffers(Addr addr);
     void wakeUpAllBuffers();
 
+    //! Whether the host time of the upcoming transition is measured,
+    //! which is the case for one in every m_transition_sample_period.
+    bool
+    sampleTransition()
+    {
+        if (m_transition_sample_period == 0 || --m_transitions_to_sample > 0)
+            return false;
+        m_transitions_to_sample = m_transition_sample_period;
+        return true;
+    }
+
   protected:
     const NodeID m_version;
     MachineID m_machineID;
@@ -202,6 +234,10 @@ class AbstractController : public ClockedObject, public Consumer
     unsigned int m_cur_in_port;
     const int m_number_of_TBEs;
     const int m_transitions_per_cycle;
+    //! Every this many transitions one is timed on the host, 0 for none.
+    //! Set by the RubySystem, so it is the same for all controllers.
+    const unsigned int m_transition_sample_period;
+    unsigned int m_transitions_to_sample;
     const unsigned int m_buffer_size;
     Cycles m_recycle_latency;
     const bool m_write_through;
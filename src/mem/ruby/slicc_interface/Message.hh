@@ -29,28 +29,72 @@
 #ifndef __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
+#include <atomic>
+#include <cstddef>
 #include <iostream>
-#include <memory>
+#include <new>
 #include <stack>
 
+#include "base/fixed_size_pool.hh"
+#include "base/refcnt.hh"
+#include "config/use_packet_pool.hh"
 #include "mem/packet.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/protocol/MessageSizeType.hh"
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
+
+/**
+ * Messages are reference counted intrusively. The count is atomic, as
+ * a message may be handed to a controller on another event queue, and
+ * its sender may still drop its own references while it is handled.
+ */
+typedef RefCountingPtr<Message> MsgPtr;
+
+/**
+ * Allocator for the messages of type T, which the message types use
+ * for their operator new and delete. Messages are recycled through a
+ * per-thread pool of chunks of the size of T, while objects of
+ * classes derived from T fall back to the heap.
+ */
+template <class T>
+struct MessagePool
+{
+    static void *
+    allocate(std::size_t size)
+    {
+#if USE_PACKET_POOL
+        if (size == sizeof(T))
+            return FixedSizePool<sizeof(T)>::allocate();
+#endif
+        return ::operator new(size);
+    }
+
+    static void
+    deallocate(void *p, std::size_t size)
+    {
+#if USE_PACKET_POOL
+        if (size == sizeof(T)) {
+            FixedSizePool<sizeof(T)>::deallocate(p);
+            return;
+        }
+#endif
+        ::operator delete(p);
+    }
+};
 
 class Message
 {
   public:
     Message(Tick curTime)
-        : m_time(curTime),
+        : m_refs(0), m_time(curTime),
           m_LastEnqueueTime(curTime),
           m_DelayedTicks(0), m_msg_counter(0)
     { }
 
+    // A copy is a new message, so it doesn't take over any reference
     Message(const Message &other)
-        : m_time(other.m_time),
+        : m_refs(0), m_time(other.m_time),
           m_LastEnqueueTime(other.m_LastEnqueueTime),
           m_DelayedTicks(other.m_DelayedTicks),
           m_msg_counter(other.m_msg_counter)
@@ -58,6 +102,15 @@ class Message
 
     virtual ~Message() { }
 
+    //! Reference counting, as used by MsgPtr
+    void incref() const { m_refs.fetch_add(1, std::memory_order_relaxed); }
+    void
+    decref() const
+    {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) <= 1)
+            delete this;
+    }
+
     virtual MsgPtr clone() const = 0;
     virtual void print(std::ostream& out) const = 0;
 
@@ -104,6 +157,7 @@ class Message
     void setVnet(int net) { vnet = net; }
 
   private:
+    mutable std::atomic<int> m_refs;
     const Tick m_time;
     Tick m_LastEnqueueTime; // my last enqueue time
     Tick m_DelayedTicks; // my delayed cycles
@@ -41,6 +41,17 @@
 
 using namespace std;
 
+namespace {
+
+// Whether a way holds an entry that may be replaced by a new one
+bool
+isNotPresent(const AbstractCacheEntry *entry)
+{
+    return entry->m_Permission == AccessPermission_NotPresent;
+}
+
+} // anonymous namespace
+
 ostream&
 operator<<(ostream& out, const CacheMemory& obj)
 {
@@ -84,16 +95,11 @@ CacheMemory::init()
     m_cache_num_set_bits = floorLog2(m_cache_num_sets);
     assert(m_cache_num_set_bits > 0);
 
-    m_cache.resize(m_cache_num_sets,
-                    std::vector<AbstractCacheEntry*>(m_cache_assoc, nullptr));
-    replacement_data.resize(m_cache_num_sets,
-                               std::vector<ReplData>(m_cache_assoc, nullptr));
+    m_cache.resize(m_cache_num_sets, m_cache_assoc);
+    replacement_data.resize(m_cache_num_sets * m_cache_assoc, nullptr);
     // instantiate all the replacement_data here
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for ( int j = 0; j < m_cache_assoc; j++) {
-            replacement_data[i][j] =
-                                m_replacementPolicy_ptr->instantiateEntry();
-        }
+    for (auto &data : replacement_data) {
+        data = m_replacementPolicy_ptr->instantiateEntry();
     }
 }
 
@@ -101,10 +107,8 @@ CacheMemory::~CacheMemory()
 {
     if (m_replacementPolicy_ptr)
         delete m_replacementPolicy_ptr;
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            delete m_cache[i][j];
-        }
+    for (AbstractCacheEntry *entry : m_cache) {
+        delete entry;
     }
 }
 
@@ -123,12 +127,10 @@ int
 CacheMemory::findTagInSet(int64_t cacheSet, Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
+    int loc = findTagInSetIgnorePermissions(cacheSet, tag);
+    if (loc != -1 && m_cache[m_cache.index(cacheSet, loc)]->m_Permission !=
+        AccessPermission_NotPresent)
+        return loc;
     return -1; // Not found
 }
 
@@ -139,11 +141,7 @@ CacheMemory::findTagInSetIgnorePermissions(int64_t cacheSet,
                                            Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
-    return -1; // Not found
+    return m_cache.findWay(cacheSet, tag);
 }
 
 // Given an unique cache block identifier (idx): return the valid address
@@ -154,13 +152,9 @@ CacheMemory::getAddressAtIdx(int idx) const
 {
     Addr tmp(0);
 
-    int set = idx / m_cache_assoc;
-    assert(set < m_cache_num_sets);
-
-    int way = idx - set * m_cache_assoc;
-    assert (way < m_cache_assoc);
+    assert(idx < m_cache.size());
 
-    AbstractCacheEntry* entry = m_cache[set][way];
+    AbstractCacheEntry* entry = m_cache[idx];
     if (entry == NULL ||
         entry->m_Permission == AccessPermission_Invalid ||
         entry->m_Permission == AccessPermission_NotPresent) {
@@ -179,9 +173,10 @@ CacheMemory::tryCacheAccess(Addr address, RubyRequestType type,
     int loc = findTagInSet(cacheSet, address);
     if (loc != -1) {
         // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
-        m_replacementPolicy_ptr->touch(replacement_data[cacheSet][loc]);
-        m_cache[cacheSet][loc]->setLastAccess(curTick());
+        int64_t idx = m_cache.index(cacheSet, loc);
+        AbstractCacheEntry* entry = m_cache[idx];
+        m_replacementPolicy_ptr->touch(replacement_data[idx]);
+        entry->setLastAccess(curTick());
         data_ptr = &(entry->getDataBlk());
 
         if (entry->m_Permission == AccessPermission_Read_Write) {
@@ -208,13 +203,13 @@ CacheMemory::testCacheAccess(Addr address, RubyRequestType type,
 
     if (loc != -1) {
         // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
-        m_replacementPolicy_ptr->touch(replacement_data[cacheSet][loc]);
-        m_cache[cacheSet][loc]->setLastAccess(curTick());
+        int64_t idx = m_cache.index(cacheSet, loc);
+        AbstractCacheEntry* entry = m_cache[idx];
+        m_replacementPolicy_ptr->touch(replacement_data[idx]);
+        entry->setLastAccess(curTick());
         data_ptr = &(entry->getDataBlk());
 
-        return m_cache[cacheSet][loc]->m_Permission !=
-            AccessPermission_NotPresent;
+        return entry->m_Permission != AccessPermission_NotPresent;
     }
 
     data_ptr = NULL;
@@ -248,19 +243,9 @@ CacheMemory::cacheAvail(Addr address) const
 
     int64_t cacheSet = addressToCacheSet(address);
 
-    for (int i = 0; i < m_cache_assoc; i++) {
-        AbstractCacheEntry* entry = m_cache[cacheSet][i];
-        if (entry != NULL) {
-            if (entry->m_Address == address ||
-                entry->m_Permission == AccessPermission_NotPresent) {
-                // Already in the cache or we found an empty entry
-                return true;
-            }
-        } else {
-            return true;
-        }
-    }
-    return false;
+    // Already in the cache or we found an empty entry
+    return m_cache.findWay(cacheSet, address) != -1 ||
+        m_cache.findFreeWay(cacheSet, isNotPresent) != -1;
 }
 
 AbstractCacheEntry*
@@ -273,32 +258,29 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry)
 
     // Find the first open slot
     int64_t cacheSet = addressToCacheSet(address);
-    std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
-    for (int i = 0; i < m_cache_assoc; i++) {
-        if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
-            if (set[i] && (set[i] != entry)) {
-                warn_once("This protocol contains a cache entry handling bug: "
-                    "Entries in the cache should never be NotPresent! If\n"
-                    "this entry (%#x) is not tracked elsewhere, it will memory "
-                    "leak here. Fix your protocol to eliminate these!",
-                    address);
-            }
-            set[i] = entry;  // Init entry
-            set[i]->m_Address = address;
-            set[i]->m_Permission = AccessPermission_Invalid;
-            DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
-                    address);
-            set[i]->m_locked = -1;
-            m_tag_index[address] = i;
-            set[i]->setPosition(cacheSet, i);
-            // Call reset function here to set initial value for different
-            // replacement policies.
-            m_replacementPolicy_ptr->reset(replacement_data[cacheSet][i]);
-            set[i]->setLastAccess(curTick());
-            return entry;
-        }
+    int loc = m_cache.findFreeWay(cacheSet, isNotPresent);
+    panic_if(loc == -1, "Allocate didn't find an available entry");
+
+    int64_t idx = m_cache.index(cacheSet, loc);
+    if (m_cache[idx] && (m_cache[idx] != entry)) {
+        warn_once("This protocol contains a cache entry handling bug: "
+            "Entries in the cache should never be NotPresent! If\n"
+            "this entry (%#x) is not tracked elsewhere, it will memory "
+            "leak here. Fix your protocol to eliminate these!",
+            address);
     }
-    panic("Allocate didn't find an available entry");
+    m_cache.insert(cacheSet, loc, address, entry);  // Init entry
+    entry->m_Address = address;
+    entry->m_Permission = AccessPermission_Invalid;
+    DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
+            address);
+    entry->m_locked = -1;
+    entry->setPosition(cacheSet, loc);
+    // Call reset function here to set initial value for different
+    // replacement policies.
+    m_replacementPolicy_ptr->reset(replacement_data[idx]);
+    entry->setLastAccess(curTick());
+    return entry;
 }
 
 void
@@ -310,10 +292,9 @@ CacheMemory::deallocate(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc != -1) {
-        m_replacementPolicy_ptr->invalidate(replacement_data[cacheSet][loc]);
-        delete m_cache[cacheSet][loc];
-        m_cache[cacheSet][loc] = NULL;
-        m_tag_index.erase(address);
+        int64_t idx = m_cache.index(cacheSet, loc);
+        m_replacementPolicy_ptr->invalidate(replacement_data[idx]);
+        delete m_cache.erase(cacheSet, loc);
     }
 }
 
@@ -329,12 +310,12 @@ CacheMemory::cacheProbe(Addr address) const
     for (int i = 0; i < m_cache_assoc; i++) {
         // Pass the value of replacement_data to the cache entry so that we
         // can use it in the getVictim() function.
-        m_cache[cacheSet][i]->replacementData = replacement_data[cacheSet][i];
-        candidates.push_back(static_cast<ReplaceableEntry*>(
-                                                       m_cache[cacheSet][i]));
+        int64_t idx = m_cache.index(cacheSet, i);
+        m_cache[idx]->replacementData = replacement_data[idx];
+        candidates.push_back(static_cast<ReplaceableEntry*>(m_cache[idx]));
     }
-    return m_cache[cacheSet][m_replacementPolicy_ptr->
-                        getVictim(candidates)->getWay()]->m_Address;
+    return m_cache[m_cache.index(cacheSet, m_replacementPolicy_ptr->
+                        getVictim(candidates)->getWay())]->m_Address;
 }
 
 // looks an address up in the cache
@@ -345,7 +326,7 @@ CacheMemory::lookup(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return m_cache[m_cache.index(cacheSet, loc)];
 }
 
 // looks an address up in the cache
@@ -356,7 +337,7 @@ CacheMemory::lookup(Addr address) const
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return m_cache[m_cache.index(cacheSet, loc)];
 }
 
 // Sets the most recently used bit for a cache block
@@ -367,8 +348,9 @@ CacheMemory::setMRU(Addr address)
     int loc = findTagInSet(cacheSet, address);
 
     if (loc != -1) {
-        m_replacementPolicy_ptr->touch(replacement_data[cacheSet][loc]);
-        m_cache[cacheSet][loc]->setLastAccess(curTick());
+        int64_t idx = m_cache.index(cacheSet, loc);
+        m_replacementPolicy_ptr->touch(replacement_data[idx]);
+        m_cache[idx]->setLastAccess(curTick());
     }
 }
 
@@ -377,8 +359,9 @@ CacheMemory::setMRU(const AbstractCacheEntry *e)
 {
     uint32_t cacheSet = e->getSet();
     uint32_t loc = e->getWay();
-    m_replacementPolicy_ptr->touch(replacement_data[cacheSet][loc]);
-    m_cache[cacheSet][loc]->setLastAccess(curTick());
+    int64_t idx = m_cache.index(cacheSet, loc);
+    m_replacementPolicy_ptr->touch(replacement_data[idx]);
+    m_cache[idx]->setLastAccess(curTick());
 }
 
 void
@@ -388,17 +371,18 @@ CacheMemory::setMRU(Addr address, int occupancy)
     int loc = findTagInSet(cacheSet, address);
 
     if (loc != -1) {
+        int64_t idx = m_cache.index(cacheSet, loc);
         // m_use_occupancy can decide whether we are using WeightedLRU
         // replacement policy. Depending on different replacement policies,
         // use different touch() function.
         if (m_use_occupancy) {
             static_cast<WeightedLRUPolicy*>(m_replacementPolicy_ptr)->touch(
-                replacement_data[cacheSet][loc], occupancy);
+                replacement_data[idx], occupancy);
         } else {
             m_replacementPolicy_ptr->
-                touch(replacement_data[cacheSet][loc]);
+                touch(replacement_data[idx]);
         }
-        m_cache[cacheSet][loc]->setLastAccess(curTick());
+        m_cache[idx]->setLastAccess(curTick());
     }
 }
 
@@ -408,8 +392,9 @@ CacheMemory::getReplacementWeight(int64_t set, int64_t loc)
     assert(set < m_cache_num_sets);
     assert(loc < m_cache_assoc);
     int ret = 0;
-    if (m_cache[set][loc] != NULL) {
-        ret = m_cache[set][loc]->getNumValidBlocks();
+    AbstractCacheEntry *entry = m_cache[m_cache.index(set, loc)];
+    if (entry != NULL) {
+        ret = entry->getNumValidBlocks();
         assert(ret >= 0);
     }
 
@@ -423,29 +408,27 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
     uint64_t totalBlocks M5_VAR_USED = (uint64_t)m_cache_num_sets *
                                        (uint64_t)m_cache_assoc;
 
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
-                AccessPermission perm = m_cache[i][j]->m_Permission;
-                RubyRequestType request_type = RubyRequestType_NULL;
-                if (perm == AccessPermission_Read_Only) {
-                    if (m_is_instruction_only_cache) {
-                        request_type = RubyRequestType_IFETCH;
-                    } else {
-                        request_type = RubyRequestType_LD;
-                    }
-                } else if (perm == AccessPermission_Read_Write) {
-                    request_type = RubyRequestType_ST;
+    for (AbstractCacheEntry *entry : m_cache) {
+        if (entry != NULL) {
+            AccessPermission perm = entry->m_Permission;
+            RubyRequestType request_type = RubyRequestType_NULL;
+            if (perm == AccessPermission_Read_Only) {
+                if (m_is_instruction_only_cache) {
+                    request_type = RubyRequestType_IFETCH;
+                } else {
+                    request_type = RubyRequestType_LD;
                 }
+            } else if (perm == AccessPermission_Read_Write) {
+                request_type = RubyRequestType_ST;
+            }
 
-                if (request_type != RubyRequestType_NULL) {
-                    Tick lastAccessTick;
-                    lastAccessTick = m_cache[i][j]->getLastAccess();
-                    tr->addRecord(cntrl, m_cache[i][j]->m_Address,
-                                  0, request_type, lastAccessTick,
-                                  m_cache[i][j]->getDataBlk());
-                    warmedUpBlocks++;
-                }
+            if (request_type != RubyRequestType_NULL) {
+                Tick lastAccessTick;
+                lastAccessTick = entry->getLastAccess();
+                tr->addRecord(cntrl, entry->m_Address,
+                              0, request_type, lastAccessTick,
+                              entry->getDataBlk());
+                warmedUpBlocks++;
             }
         }
     }
@@ -461,10 +444,11 @@ CacheMemory::print(ostream& out) const
     out << "Cache dump: " << name() << endl;
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
+            AbstractCacheEntry *entry = m_cache[m_cache.index(i, j)];
+            if (entry != NULL) {
                 out << "  Index: " << i
                     << " way: " << j
-                    << " entry: " << *m_cache[i][j] << endl;
+                    << " entry: " << *entry << endl;
             } else {
                 out << "  Index: " << i
                     << " way: " << j
@@ -488,7 +472,7 @@ CacheMemory::setLocked(Addr address, int context)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
-    m_cache[cacheSet][loc]->setLocked(context);
+    m_cache[m_cache.index(cacheSet, loc)]->setLocked(context);
 }
 
 void
@@ -499,7 +483,7 @@ CacheMemory::clearLocked(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
-    m_cache[cacheSet][loc]->clearLocked();
+    m_cache[m_cache.index(cacheSet, loc)]->clearLocked();
 }
 
 bool
@@ -510,8 +494,8 @@ CacheMemory::isLocked(Addr address, int context)
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
     DPRINTF(RubyCache, "Testing Lock for addr: %#llx cur %d con %d\n",
-            address, m_cache[cacheSet][loc]->m_locked, context);
-    return m_cache[cacheSet][loc]->isLocked(context);
+            address, m_cache[m_cache.index(cacheSet, loc)]->m_locked, context);
+    return m_cache[m_cache.index(cacheSet, loc)]->isLocked(context);
 }
 
 void
@@ -706,11 +690,13 @@ CacheMemory::checkResourceAvailable(CacheResourceType res, Addr addr)
 bool
 CacheMemory::isBlockInvalid(int64_t cache_set, int64_t loc)
 {
-  return (m_cache[cache_set][loc]->m_Permission == AccessPermission_Invalid);
+  return (m_cache[m_cache.index(cache_set, loc)]->m_Permission ==
+          AccessPermission_Invalid);
 }
 
 bool
 CacheMemory::isBlockNotBusy(int64_t cache_set, int64_t loc)
 {
-  return (m_cache[cache_set][loc]->m_Permission != AccessPermission_Busy);
+  return (m_cache[m_cache.index(cache_set, loc)]->m_Permission !=
+          AccessPermission_Busy);
 }
@@ -31,7 +31,6 @@
 #define __MEM_RUBY_STRUCTURES_CACHEMEMORY_HH__
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "base/statistics.hh"
@@ -44,6 +43,7 @@
 #include "mem/ruby/slicc_interface/AbstractCacheEntry.hh"
 #include "mem/ruby/slicc_interface/RubySlicc_ComponentMapping.hh"
 #include "mem/ruby/structures/BankedArray.hh"
+#include "mem/ruby/structures/CacheSets.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
 #include "params/RubyCache.hh"
 #include "sim/sim_object.hh"
@@ -101,6 +101,17 @@ class CacheMemory : public SimObject
     // Hook for checkpointing the contents of the cache
     void recordCacheContents(int cntrl, CacheRecorder* tr) const;
 
+    // Call f on every allocated entry, in set and way order
+    template <typename F>
+    void
+    forEachEntry(F f) const
+    {
+        for (AbstractCacheEntry *entry : m_cache) {
+            if (entry != NULL)
+                f(entry);
+        }
+    }
+
     // Set this address to most recently used
     void setMRU(Addr address);
     void setMRU(Addr addr, int occupancy);
@@ -154,6 +165,8 @@ class CacheMemory : public SimObject
     int getCacheSize() const { return m_cache_size; }
     int getCacheAssoc() const { return m_cache_assoc; }
     int getNumBlocks() const { return m_cache_num_sets * m_cache_assoc; }
+    int getNumSets() const { return m_cache_num_sets; }
+    int getStartIndexBit() const { return m_start_index_bit; }
     Addr getAddressAtIdx(int idx) const;
 
   private:
@@ -173,10 +186,7 @@ class CacheMemory : public SimObject
     // Data Members (m_prefix)
     bool m_is_instruction_only_cache;
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    CacheSets<AbstractCacheEntry> m_cache;
 
     /**
      * We use BaseReplacementPolicy from Classic system here, hence we can use
@@ -196,14 +206,15 @@ class CacheMemory : public SimObject
     int m_block_size;
 
     /**
-     * We store all the ReplacementData in a 2-dimensional array. By doing
-     * this, we can use all replacement policies from Classic system. Ruby
-     * cache will deallocate cache entry every time we evict the cache block
-     * so we cannot store the ReplacementData inside the cache entry.
+     * We store all the ReplacementData in an array laid out like m_cache.
+     * By doing this, we can use all replacement policies from Classic
+     * system. Ruby cache will deallocate cache entry every time we evict
+     * the cache block so we cannot store the ReplacementData inside the
+     * cache entry.
      * Instantiate ReplacementData for multiple times will break replacement
      * policy like TreePLRU.
      */
-    std::vector<std::vector<ReplData> > replacement_data;
+    std::vector<ReplData> replacement_data;
 
     /**
      * Set to true when using WeightedLRU replacement policy, otherwise, set to
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_STRUCTURES_CACHESETS_HH__
+#define __MEM_RUBY_STRUCTURES_CACHESETS_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * The entries of all sets of a cache, stored set after set so that the
+ * ways of a set are adjacent. A parallel array holds the line address
+ * of each entry in the same order, or MaxAddr for an empty way, so a
+ * lookup only scans the tags of one set and touches a single entry on a
+ * hit. Index i of the array is way i % assoc of set i / assoc.
+ */
+template <class Entry>
+class CacheSets
+{
+  public:
+    typedef typename std::vector<Entry*>::const_iterator const_iterator;
+
+    CacheSets() : m_assoc(0) {}
+
+    void
+    resize(int64_t num_sets, int assoc)
+    {
+        m_assoc = assoc;
+        m_entries.resize(num_sets * assoc, nullptr);
+        m_tags.resize(num_sets * assoc, MaxAddr);
+    }
+
+    int64_t size() const { return m_entries.size(); }
+
+    // Position of a way of a set in the array
+    int64_t index(int64_t set, int way) const { return set * m_assoc + way; }
+
+    // The entry at an index, or NULL for an empty way
+    Entry* operator[](int64_t idx) const { return m_entries[idx]; }
+
+    // Visit the ways of all sets, empty ones included
+    const_iterator begin() const { return m_entries.begin(); }
+    const_iterator end() const { return m_entries.end(); }
+
+    // Returns the way of a set holding the line, or -1 if there is none
+    int
+    findWay(int64_t set, Addr line) const
+    {
+        const Addr *tags = &m_tags[index(set, 0)];
+        for (int i = 0; i < m_assoc; i++) {
+            if (tags[i] == line)
+                return i;
+        }
+        return -1;
+    }
+
+    // Returns the first way of a set that is empty or whose entry may be
+    // replaced according to reusable, or -1 if there is none
+    template <typename F>
+    int
+    findFreeWay(int64_t set, F reusable) const
+    {
+        Entry *const *entries = &m_entries[index(set, 0)];
+        for (int i = 0; i < m_assoc; i++) {
+            if (!entries[i] || reusable(entries[i]))
+                return i;
+        }
+        return -1;
+    }
+
+    // Put an entry for the line in a way, replacing what was there
+    void
+    insert(int64_t set, int way, Addr line, Entry *entry)
+    {
+        assert(line != MaxAddr);
+        const int64_t idx = index(set, way);
+        m_entries[idx] = entry;
+        m_tags[idx] = line;
+    }
+
+    // Empty a way, returning the entry it held
+    Entry*
+    erase(int64_t set, int way)
+    {
+        const int64_t idx = index(set, way);
+        Entry *entry = m_entries[idx];
+        m_entries[idx] = nullptr;
+        m_tags[idx] = MaxAddr;
+        return entry;
+    }
+
+  private:
+    int m_assoc;
+    std::vector<Entry*> m_entries;
+    std::vector<Addr> m_tags;
+};
+
+#endif // __MEM_RUBY_STRUCTURES_CACHESETS_HH__
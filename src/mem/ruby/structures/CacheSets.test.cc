@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "mem/ruby/structures/CacheSets.hh"
+
+namespace {
+
+/** The parts of an AbstractCacheEntry that CacheMemory looks at. */
+struct Entry
+{
+    Addr line;
+    bool notPresent;
+};
+
+bool
+isNotPresent(const Entry *entry)
+{
+    return entry->notPresent;
+}
+
+const int numSets = 4;
+const int assoc = 4;
+
+/**
+ * Allocate an entry for a line in the first free way of a set, as
+ * CacheMemory::allocate() does, returning the way or -1.
+ */
+int
+allocate(CacheSets<Entry> &sets, int64_t set, Entry *entry)
+{
+    int way = sets.findFreeWay(set, isNotPresent);
+    if (way != -1)
+        sets.insert(set, way, entry->line, entry);
+    return way;
+}
+
+} // anonymous namespace
+
+/** Lines are found in the way of the set they were allocated in. */
+TEST(CacheSetsTest, Lookup)
+{
+    CacheSets<Entry> sets;
+    sets.resize(numSets, assoc);
+    ASSERT_EQ(numSets * assoc, sets.size());
+
+    Entry a{0x1000, false}, b{0x2000, false};
+    EXPECT_EQ(0, allocate(sets, 1, &a));
+    EXPECT_EQ(1, allocate(sets, 1, &b));
+
+    EXPECT_EQ(0, sets.findWay(1, 0x1000));
+    EXPECT_EQ(1, sets.findWay(1, 0x2000));
+    EXPECT_EQ(&a, sets[sets.index(1, 0)]);
+    EXPECT_EQ(&b, sets[sets.index(1, 1)]);
+
+    // Other sets and other lines miss
+    EXPECT_EQ(-1, sets.findWay(0, 0x1000));
+    EXPECT_EQ(-1, sets.findWay(2, 0x1000));
+    EXPECT_EQ(-1, sets.findWay(1, 0x3000));
+}
+
+/** The ways of a set are adjacent, set after set. */
+TEST(CacheSetsTest, SetMajorLayout)
+{
+    CacheSets<Entry> sets;
+    sets.resize(numSets, assoc);
+    std::vector<Entry> entries(numSets * assoc);
+    for (int set = 0; set < numSets; set++) {
+        for (int way = 0; way < assoc; way++) {
+            Entry &entry = entries[set * assoc + way];
+            entry = Entry{Addr(set * assoc + way + 1) << 6, false};
+            ASSERT_EQ(way, allocate(sets, set, &entry));
+            EXPECT_EQ(set * assoc + way, sets.index(set, way));
+        }
+        // The set is full now
+        Entry extra{0x100000, false};
+        EXPECT_EQ(-1, allocate(sets, set, &extra));
+    }
+
+    int idx = 0;
+    for (Entry *entry : sets) {
+        EXPECT_EQ(&entries[idx], entry);
+        idx++;
+    }
+    EXPECT_EQ(numSets * assoc, idx);
+}
+
+/** Deallocating empties a way, which the next allocation fills. */
+TEST(CacheSetsTest, Deallocate)
+{
+    CacheSets<Entry> sets;
+    sets.resize(numSets, assoc);
+    std::vector<Entry> entries;
+    for (int way = 0; way < assoc; way++)
+        entries.push_back(Entry{Addr(way + 1) << 6, false});
+    for (Entry &entry : entries)
+        allocate(sets, 2, &entry);
+
+    EXPECT_EQ(&entries[1], sets.erase(2, 1));
+    EXPECT_EQ(nullptr, sets[sets.index(2, 1)]);
+    EXPECT_EQ(-1, sets.findWay(2, entries[1].line));
+    EXPECT_EQ(2, sets.findWay(2, entries[2].line));
+
+    Entry c{0x4000, false};
+    EXPECT_EQ(1, allocate(sets, 2, &c));
+    EXPECT_EQ(1, sets.findWay(2, 0x4000));
+}
+
+/** A NotPresent entry may be replaced, and its line no longer matches. */
+TEST(CacheSetsTest, ReplaceNotPresent)
+{
+    CacheSets<Entry> sets;
+    sets.resize(numSets, assoc);
+    std::vector<Entry> entries;
+    for (int way = 0; way < assoc; way++)
+        entries.push_back(Entry{Addr(way + 1) << 6, false});
+    for (Entry &entry : entries)
+        allocate(sets, 0, &entry);
+
+    entries[2].notPresent = true;
+    Entry c{0x4000, false};
+    EXPECT_EQ(2, allocate(sets, 0, &c));
+    EXPECT_EQ(2, sets.findWay(0, 0x4000));
+    EXPECT_EQ(-1, sets.findWay(0, entries[2].line));
+}
+
+/** Random allocations and deallocations match a map of the lines. */
+TEST(CacheSetsTest, MatchesMap)
+{
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> line_dist(0, 63);
+    CacheSets<Entry> sets;
+    sets.resize(numSets, assoc);
+    std::map<Addr, Entry*> ref;
+
+    for (int i = 0; i < 10000; i++) {
+        const Addr line = Addr(line_dist(rng)) << 6;
+        const int64_t set = (line >> 6) % numSets;
+        auto it = ref.find(line);
+        if (it != ref.end()) {
+            const int way = sets.findWay(set, line);
+            ASSERT_NE(-1, way);
+            ASSERT_EQ(it->second, sets[sets.index(set, way)]);
+            delete sets.erase(set, way);
+            ref.erase(it);
+        } else {
+            ASSERT_EQ(-1, sets.findWay(set, line));
+            Entry *entry = new Entry{line, false};
+            if (allocate(sets, set, entry) == -1) {
+                delete entry;
+            } else {
+                ref[line] = entry;
+            }
+        }
+    }
+
+    for (auto &line_entry : ref) {
+        const int64_t set = (line_entry.first >> 6) % numSets;
+        const int way = sets.findWay(set, line_entry.first);
+        ASSERT_NE(-1, way);
+        delete sets.erase(set, way);
+    }
+    for (Entry *entry : sets)
+        EXPECT_EQ(nullptr, entry);
+}
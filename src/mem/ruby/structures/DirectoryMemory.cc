@@ -54,8 +54,14 @@
 using namespace std;
 
 DirectoryMemory::DirectoryMemory(const Params *p)
-    : SimObject(p), addrRanges(p->addr_ranges.begin(), p->addr_ranges.end())
+    : SimObject(p), m_page_entries(p->entries_per_page),
+      m_page_bits(floorLog2(p->entries_per_page)),
+      m_num_used_entries(0), m_num_used_pages(0),
+      addrRanges(p->addr_ranges.begin(), p->addr_ranges.end())
 {
+    fatal_if(!isPowerOf2(m_page_entries),
+             "%s: entries_per_page must be a power of 2\n", name());
+
     m_size_bytes = 0;
     for (const auto &r: addrRanges) {
         m_size_bytes += r.size();
@@ -68,20 +74,19 @@ void
 DirectoryMemory::init()
 {
     m_num_entries = m_size_bytes / RubySystem::getBlockSizeBytes();
-    m_entries = new AbstractCacheEntry*[m_num_entries];
-    for (int i = 0; i < m_num_entries; i++)
-        m_entries[i] = NULL;
+    m_pages.resize(divCeil(m_num_entries, m_page_entries));
 }
 
 DirectoryMemory::~DirectoryMemory()
 {
     // free up all the directory entries
-    for (uint64_t i = 0; i < m_num_entries; i++) {
-        if (m_entries[i] != NULL) {
-            delete m_entries[i];
+    for (const auto &page : m_pages) {
+        if (!page)
+            continue;
+        for (auto entry : page->entries) {
+            delete entry;
         }
     }
-    delete [] m_entries;
 }
 
 bool
@@ -117,7 +122,8 @@ DirectoryMemory::lookup(Addr address)
 
     uint64_t idx = mapAddressToLocalIdx(address);
     assert(idx < m_num_entries);
-    return m_entries[idx];
+    const auto &page = m_pages[idx >> m_page_bits];
+    return page ? page->entries[idx & (m_page_entries - 1)] : NULL;
 }
 
 AbstractCacheEntry*
@@ -129,8 +135,19 @@ DirectoryMemory::allocate(Addr address, AbstractCacheEntry *entry)
 
     idx = mapAddressToLocalIdx(address);
     assert(idx < m_num_entries);
+    auto &page = m_pages[idx >> m_page_bits];
+    if (!page) {
+        page.reset(new Page(m_page_entries));
+        m_num_used_pages++;
+    }
+
+    AbstractCacheEntry *&slot = page->entries[idx & (m_page_entries - 1)];
+    if (slot == NULL) {
+        m_num_used_entries++;
+    }
     entry->changePermission(AccessPermission_Read_Only);
-    m_entries[idx] = entry;
+    entry->m_Address = address;
+    slot = entry;
 
     return entry;
 }
@@ -146,6 +163,24 @@ DirectoryMemory::recordRequestType(DirectoryRequestType requestType) {
             DirectoryRequestType_to_string(requestType));
 }
 
+void
+DirectoryMemory::regStats()
+{
+    SimObject::regStats();
+
+    m_entries_in_use
+        .scalar(m_num_used_entries)
+        .name(name() + ".entries_in_use")
+        .desc("Number of directory entries allocated")
+        ;
+
+    m_pages_in_use
+        .scalar(m_num_used_pages)
+        .name(name() + ".pages_in_use")
+        .desc("Number of pages of directory entries allocated")
+        ;
+}
+
 DirectoryMemory *
 RubyDirectoryMemoryParams::create()
 {
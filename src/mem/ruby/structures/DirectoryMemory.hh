@@ -42,15 +42,27 @@
 #define __MEM_RUBY_STRUCTURES_DIRECTORYMEMORY_HH__
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "base/addr_range.hh"
+#include "base/statistics.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/protocol/DirectoryRequestType.hh"
 #include "mem/ruby/slicc_interface/AbstractCacheEntry.hh"
 #include "params/RubyDirectoryMemory.hh"
 #include "sim/sim_object.hh"
 
+/**
+ * The directory entries are kept in pages of a fixed number of
+ * entries, which are only allocated when one of their entries is
+ * first allocated. The host memory used by the directory thus follows
+ * the footprint of the simulated workload rather than the size of the
+ * memory it covers, and untouched entries look up as NULL. Entries
+ * are never freed, as the protocols keep the directory state of every
+ * line they have seen.
+ */
 class DirectoryMemory : public SimObject
 {
   public:
@@ -79,23 +91,56 @@ class DirectoryMemory : public SimObject
     AbstractCacheEntry *lookup(Addr address);
     AbstractCacheEntry *allocate(Addr address, AbstractCacheEntry* new_entry);
 
+    /** Call f on every allocated entry, in address index order. */
+    template <typename F>
+    void
+    forEachEntry(F f) const
+    {
+        for (const auto &page : m_pages) {
+            if (!page)
+                continue;
+            for (AbstractCacheEntry *entry : page->entries) {
+                if (entry != NULL)
+                    f(entry);
+            }
+        }
+    }
+
     void print(std::ostream& out) const;
     void recordRequestType(DirectoryRequestType requestType);
 
+    void regStats() override;
+
   private:
     // Private copy constructor and assignment operator
     DirectoryMemory(const DirectoryMemory& obj);
     DirectoryMemory& operator=(const DirectoryMemory& obj);
 
   private:
+    /** A page of directory entries. */
+    struct Page
+    {
+        Page(uint64_t num_entries) : entries(num_entries, nullptr) {}
+
+        std::vector<AbstractCacheEntry *> entries;
+    };
+
     const std::string m_name;
-    AbstractCacheEntry **m_entries;
+    std::vector<std::unique_ptr<Page>> m_pages;
     // int m_size;  // # of memory module blocks this directory is
                     // responsible for
     uint64_t m_size_bytes;
     uint64_t m_size_bits;
     uint64_t m_num_entries;
 
+    const uint64_t m_page_entries;
+    const uint64_t m_page_bits;
+    uint64_t m_num_used_entries;
+    uint64_t m_num_used_pages;
+
+    Stats::Value m_entries_in_use;
+    Stats::Value m_pages_in_use;
+
     /**
      * The address range for which the directory responds. Normally
      * this is all possible memory addresses.
@@ -49,3 +49,7 @@ class RubyDirectoryMemory(SimObject):
     cxx_header = "mem/ruby/structures/DirectoryMemory.hh"
     addr_ranges = VectorParam.AddrRange(
         Parent.addr_ranges, "Address range this directory responds to")
+    # Entries are allocated in pages on first use, so that the host
+    # memory follows the touched footprint rather than the memory size
+    entries_per_page = Param.Unsigned(4096,
+        "Number of directory entries allocated at once")
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/system/CacheSnapshot.hh"
+
+#include <cstring>
+
+#include "base/logging.hh"
+#include "mem/ruby/structures/CacheMemory.hh"
+#include "mem/ruby/system/RubySystem.hh"
+
+using namespace std;
+
+/** Marks the start of a snapshot image ("RCSN") */
+static const uint32_t SnapshotMagic = 0x4e534352;
+static const uint32_t SnapshotVersion = 2;
+
+CacheSnapshot::CacheGeometry
+CacheSnapshot::CacheGeometry::of(const CacheMemory &cache)
+{
+    return { uint32_t(cache.getNumSets()), uint32_t(cache.getCacheAssoc()),
+             uint32_t(cache.getStartIndexBit()) };
+}
+
+CacheSnapshot::CacheSnapshot()
+    : m_image(NULL), m_size(0), m_capacity(0), m_pos(0),
+      m_entry_start(0), m_entry_end(0), m_num_entries(0)
+{
+}
+
+CacheSnapshot::CacheSnapshot(uint8_t *image, uint64_t size)
+    : m_image(image), m_size(size), m_capacity(size), m_pos(0),
+      m_entry_start(0), m_entry_end(0), m_num_entries(0)
+{
+}
+
+CacheSnapshot::~CacheSnapshot()
+{
+    delete [] m_image;
+}
+
+void
+CacheSnapshot::write(const void *src, uint64_t len)
+{
+    if (m_size + len > m_capacity) {
+        uint64_t capacity = max<uint64_t>(4096, m_capacity);
+        while (m_size + len > capacity)
+            capacity *= 2;
+
+        uint8_t *image = new (nothrow) uint8_t[capacity];
+        if (image == NULL) {
+            fatal("Unable to allocate cache snapshot of size %d\n", capacity);
+        }
+        if (m_image != NULL) {
+            memcpy(image, m_image, m_size);
+            delete [] m_image;
+        }
+        m_image = image;
+        m_capacity = capacity;
+    }
+
+    memcpy(m_image + m_size, src, len);
+    m_size += len;
+}
+
+void
+CacheSnapshot::read(void *dst, uint64_t len)
+{
+    if (m_pos + len > m_size) {
+        fatal("Cache snapshot is truncated at offset %d\n", m_pos);
+    }
+    memcpy(dst, m_image + m_pos, len);
+    m_pos += len;
+}
+
+void
+CacheSnapshot::writeHeader(uint32_t block_size_bytes,
+                           const vector<ControllerLayout> &cntrls)
+{
+    assert(m_size == 0);
+    writeScalar(SnapshotMagic);
+    writeScalar(SnapshotVersion);
+    writeScalar(block_size_bytes);
+    writeScalar<uint32_t>(cntrls.size());
+    for (const auto &cntrl : cntrls) {
+        writeScalar<uint32_t>(cntrl.name.size());
+        write(cntrl.name.data(), cntrl.name.size());
+        writeScalar<uint32_t>(cntrl.caches.size());
+        for (const auto &cache : cntrl.caches) {
+            writeScalar(cache.numSets);
+            writeScalar(cache.assoc);
+            writeScalar(cache.startIndexBit);
+        }
+    }
+}
+
+bool
+CacheSnapshot::readHeader(uint32_t block_size_bytes,
+                          const vector<ControllerLayout> &cntrls)
+{
+    m_pos = 0;
+    if (readScalar<uint32_t>() != SnapshotMagic ||
+        readScalar<uint32_t>() != SnapshotVersion) {
+        warn("Cache snapshot has an unknown format\n");
+        return false;
+    }
+
+    uint32_t snap_block_size = readScalar<uint32_t>();
+    if (snap_block_size != block_size_bytes) {
+        warn("Cache snapshot was taken with %d byte blocks, not %d\n",
+             snap_block_size, block_size_bytes);
+        return false;
+    }
+
+    uint32_t num_cntrls = readScalar<uint32_t>();
+    if (num_cntrls != cntrls.size()) {
+        warn("Cache snapshot was taken from %d controllers, not %d\n",
+             num_cntrls, cntrls.size());
+        return false;
+    }
+
+    for (const auto &cntrl : cntrls) {
+        string snap_name(readScalar<uint32_t>(), '\0');
+        read(&snap_name[0], snap_name.size());
+        if (snap_name != cntrl.name) {
+            warn("Cache snapshot controller %s does not match %s\n",
+                 snap_name, cntrl.name);
+            return false;
+        }
+
+        uint32_t num_caches = readScalar<uint32_t>();
+        if (num_caches != cntrl.caches.size()) {
+            warn("Cache snapshot has %d caches for %s, not %d\n",
+                 num_caches, cntrl.name, cntrl.caches.size());
+            return false;
+        }
+
+        for (uint32_t i = 0; i < num_caches; i++) {
+            const CacheGeometry &cache = cntrl.caches[i];
+            uint32_t num_sets = readScalar<uint32_t>();
+            uint32_t assoc = readScalar<uint32_t>();
+            uint32_t start_index_bit = readScalar<uint32_t>();
+            if (num_sets != cache.numSets || assoc != cache.assoc ||
+                start_index_bit != cache.startIndexBit) {
+                warn("Cache snapshot was taken with %d sets of %d ways "
+                     "indexed from bit %d in cache %d of %s, not %d sets "
+                     "of %d ways indexed from bit %d\n", num_sets, assoc,
+                     start_index_bit, i, cntrl.name, cache.numSets,
+                     cache.assoc, cache.startIndexBit);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+CacheSnapshot::beginEntry(int cntrl, int store, Addr addr)
+{
+    writeScalar<int32_t>(cntrl);
+    writeScalar<int32_t>(store);
+    writeScalar(addr);
+    m_entry_start = m_size;
+    writeScalar<uint32_t>(0);
+}
+
+void
+CacheSnapshot::endEntry()
+{
+    uint32_t len = m_size - m_entry_start - sizeof(uint32_t);
+    memcpy(m_image + m_entry_start, &len, sizeof(len));
+    m_num_entries++;
+}
+
+bool
+CacheSnapshot::nextEntry(int &cntrl, int &store, Addr &addr)
+{
+    if (m_pos == m_size)
+        return false;
+
+    cntrl = readScalar<int32_t>();
+    store = readScalar<int32_t>();
+    addr = readScalar<Addr>();
+    uint32_t len = readScalar<uint32_t>();
+    m_entry_end = m_pos + len;
+    m_num_entries++;
+    return true;
+}
+
+void
+CacheSnapshot::finishEntry()
+{
+    if (m_pos != m_entry_end) {
+        fatal("Cache snapshot entry ending at offset %d was restored up "
+              "to offset %d; was it taken with a different protocol?\n",
+              m_entry_end, m_pos);
+    }
+}
+
+uint8_t *
+CacheSnapshot::release(uint64_t &size)
+{
+    uint8_t *image = m_image;
+    size = m_size;
+    m_image = NULL;
+    m_size = m_capacity = m_pos = 0;
+    m_num_entries = 0;
+    return image;
+}
+
+void
+snapshotField(CacheSnapshot &snap, const Cycles &value)
+{
+    snap.writeScalar<uint64_t>(value);
+}
+
+void
+restoreField(CacheSnapshot &snap, Cycles &value)
+{
+    value = Cycles(snap.readScalar<uint64_t>());
+}
+
+void
+snapshotField(CacheSnapshot &snap, const DataBlock &value)
+{
+    int block_size = RubySystem::getBlockSizeBytes();
+    snap.write(value.getData(0, block_size), block_size);
+}
+
+void
+restoreField(CacheSnapshot &snap, DataBlock &value)
+{
+    int block_size = RubySystem::getBlockSizeBytes();
+    snap.read(value.getDataMod(0), block_size);
+}
+
+void
+snapshotField(CacheSnapshot &snap, const MachineID &value)
+{
+    snap.writeScalar<int32_t>(value.type);
+    snap.writeScalar<uint32_t>(value.num);
+}
+
+void
+restoreField(CacheSnapshot &snap, MachineID &value)
+{
+    value.type = (MachineType)snap.readScalar<int32_t>();
+    value.num = snap.readScalar<uint32_t>();
+}
+
+void
+snapshotField(CacheSnapshot &snap, const Set &value)
+{
+    snap.writeScalar<uint32_t>(value.getSize());
+    snap.writeScalar<uint32_t>(value.count());
+    for (NodeID node : value) {
+        snap.writeScalar<uint32_t>(node);
+    }
+}
+
+void
+restoreField(CacheSnapshot &snap, Set &value)
+{
+    value.setSize(snap.readScalar<uint32_t>());
+    value.clear();
+    for (uint32_t count = snap.readScalar<uint32_t>(); count > 0; count--) {
+        value.add(snap.readScalar<uint32_t>());
+    }
+}
+
+void
+snapshotField(CacheSnapshot &snap, const NetDest &value)
+{
+    for (int type = 0; type < MachineType_NUM; type++) {
+        snapshotField(snap, value.getNetDest((MachineType)type));
+    }
+}
+
+void
+restoreField(CacheSnapshot &snap, NetDest &value)
+{
+    for (int type = 0; type < MachineType_NUM; type++) {
+        Set set;
+        restoreField(snap, set);
+        value.setNetDest((MachineType)type, set);
+    }
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 Harvard University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_SYSTEM_CACHESNAPSHOT_HH__
+#define __MEM_RUBY_SYSTEM_CACHESNAPSHOT_HH__
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/DataBlock.hh"
+#include "mem/ruby/common/MachineID.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/common/Set.hh"
+
+class CacheMemory;
+
+/**
+ * A binary image of the entries of all cache and directory memories
+ * of a Ruby system, taken when a checkpoint is written.
+ *
+ * Unlike the trace kept by the CacheRecorder, which only knows whether
+ * a block was readable or writable and has to replay requests through
+ * the protocol to rebuild the caches, the snapshot holds every field
+ * of every entry, including protocol states and sharer lists. The
+ * SLICC generated controllers write their entries with
+ * AbstractController::snapshotCacheState() and read them back with
+ * AbstractController::installCacheEntry(), so restoring is a single
+ * pass over the image without simulating any coherence transactions.
+ *
+ * The image starts with a header naming the block size, the controllers
+ * it was taken from and the geometry of their caches, followed by one
+ * record per entry. A
+ * record consists of the controller index, the memory the entry lives
+ * in, the block address, and the length and bytes of the entry fields.
+ */
+class CacheSnapshot
+{
+  public:
+    /** Store index used for the DirectoryMemory of a controller. */
+    static const int DirectoryStore = -1;
+
+    /** The layout of a cache, which decides where its entries go. */
+    struct CacheGeometry
+    {
+        uint32_t numSets;
+        uint32_t assoc;
+        uint32_t startIndexBit;
+
+        static CacheGeometry of(const CacheMemory &cache);
+    };
+
+    /** A controller and the geometry of its caches, in store order. */
+    struct ControllerLayout
+    {
+        std::string name;
+        std::vector<CacheGeometry> caches;
+    };
+
+    /** Create an empty snapshot to record into. */
+    CacheSnapshot();
+
+    /**
+     * Create a snapshot to restore from, taking ownership of an image
+     * allocated with new[].
+     */
+    CacheSnapshot(uint8_t *image, uint64_t size);
+
+    ~CacheSnapshot();
+
+    /** Write the header of a new image. */
+    void writeHeader(uint32_t block_size_bytes,
+                     const std::vector<ControllerLayout> &cntrls);
+
+    /**
+     * Read the header of the image and check that it was taken from
+     * a system with the given block size and controllers, whose caches
+     * have the same geometry. Entries are installed in the set and way
+     * they were saved from, so caches of any other size would not have
+     * room for them.
+     *
+     * @return false if the image cannot be restored into this system.
+     */
+    bool readHeader(uint32_t block_size_bytes,
+                    const std::vector<ControllerLayout> &cntrls);
+
+    /** Start a record, to be followed by the entry fields. */
+    void beginEntry(int cntrl, int store, Addr addr);
+
+    /** Finish the record started by the last beginEntry(). */
+    void endEntry();
+
+    /**
+     * Move to the next record of the image.
+     *
+     * @return false once all records have been read.
+     */
+    bool nextEntry(int &cntrl, int &store, Addr &addr);
+
+    /**
+     * Check that the fields of the current record have been read
+     * completely by the controller that installed it.
+     */
+    void finishEntry();
+
+    /**
+     * Hand the image over to the caller, as an array allocated with
+     * new[], and clear the snapshot.
+     */
+    uint8_t *release(uint64_t &size);
+
+    void write(const void *src, uint64_t len);
+    void read(void *dst, uint64_t len);
+
+    template <typename T>
+    void
+    writeScalar(const T &value)
+    {
+        write(&value, sizeof(value));
+    }
+
+    template <typename T>
+    T
+    readScalar()
+    {
+        T value;
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    uint64_t numEntries() const { return m_num_entries; }
+
+  private:
+    // Private copy constructor and assignment operator
+    CacheSnapshot(const CacheSnapshot& obj);
+    CacheSnapshot& operator=(const CacheSnapshot& obj);
+
+    uint8_t *m_image;
+    uint64_t m_size;
+    uint64_t m_capacity;
+    /** Read position in the image */
+    uint64_t m_pos;
+    /** Offset of the length of the record being written */
+    uint64_t m_entry_start;
+    /** End of the record being read */
+    uint64_t m_entry_end;
+    uint64_t m_num_entries;
+};
+
+/**
+ * Overloads used by the generated controllers to write and read the
+ * data members of cache and directory entries. SLICC only captures
+ * entry types whose members all have one of these types.
+ * @{
+ */
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value ||
+                        std::is_enum<T>::value>::type
+snapshotField(CacheSnapshot &snap, const T &value)
+{
+    snap.writeScalar(value);
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value ||
+                        std::is_enum<T>::value>::type
+restoreField(CacheSnapshot &snap, T &value)
+{
+    value = snap.readScalar<T>();
+}
+
+void snapshotField(CacheSnapshot &snap, const Cycles &value);
+void restoreField(CacheSnapshot &snap, Cycles &value);
+void snapshotField(CacheSnapshot &snap, const DataBlock &value);
+void restoreField(CacheSnapshot &snap, DataBlock &value);
+void snapshotField(CacheSnapshot &snap, const MachineID &value);
+void restoreField(CacheSnapshot &snap, MachineID &value);
+void snapshotField(CacheSnapshot &snap, const Set &value);
+void restoreField(CacheSnapshot &snap, Set &value);
+void snapshotField(CacheSnapshot &snap, const NetDest &value);
+void restoreField(CacheSnapshot &snap, NetDest &value);
+/** @} */
+
+#endif // __MEM_RUBY_SYSTEM_CACHESNAPSHOT_HH__
@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <list>
 
@@ -40,6 +41,7 @@
 #include "debug/RubySystem.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/network/Network.hh"
+#include "mem/ruby/slicc_interface/AbstractCacheEntry.hh"
 #include "mem/simple_mem.hh"
 #include "sim/eventq.hh"
 #include "sim/simulate.hh"
@@ -58,7 +60,10 @@ bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params *p)
     : ClockedObject(p), m_access_backing_store(p->access_backing_store),
-      m_cache_recorder(NULL)
+      m_use_cache_snapshot(p->cache_snapshot),
+      m_transition_sample_period(p->transition_sample_period),
+      m_cache_recorder(NULL),
+      m_cache_snapshot(NULL)
 {
     m_randomization = p->randomization;
 
@@ -98,6 +103,20 @@ RubySystem::~RubySystem()
     delete m_profiler;
 }
 
+void
+RubySystem::regStats()
+{
+    ClockedObject::regStats();
+
+    // The hot line tables are shared by all controllers, which can't
+    // update them from several threads.
+    fatal_if(m_profiler->getHotLines() && isPartitioned(),
+             "Ruby hot line profiling requires all Ruby controllers on "
+             "the event queue of the RubySystem.\n");
+
+    m_profiler->regStats(name());
+}
+
 void
 RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
                               uint64_t cache_trace_size,
@@ -131,9 +150,183 @@ RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
                                          sequencer_map, block_size_bytes);
 }
 
+void
+RubySystem::makeCacheSnapshot()
+{
+    delete m_cache_snapshot;
+    m_cache_snapshot = new CacheSnapshot();
+    m_cache_snapshot->writeHeader(getBlockSizeBytes(), snapshotLayout());
+
+    for (int cntrl = 0; cntrl < m_abs_cntrl_vec.size(); cntrl++) {
+        if (!m_abs_cntrl_vec[cntrl]->snapshotCacheState(cntrl,
+                                                        *m_cache_snapshot)) {
+            warn("%s cannot be saved in a cache snapshot, only recording "
+                 "the cache trace\n", m_abs_cntrl_vec[cntrl]->name());
+            delete m_cache_snapshot;
+            m_cache_snapshot = NULL;
+            return;
+        }
+    }
+
+    DPRINTF(RubyCacheTrace, "Cache snapshot holds %d entries\n",
+            m_cache_snapshot->numEntries());
+}
+
+bool
+RubySystem::restoreCacheSnapshot()
+{
+    if (m_cache_snapshot == NULL) {
+        return false;
+    }
+
+    if (!m_cache_snapshot->readHeader(getBlockSizeBytes(),
+                                      snapshotLayout())) {
+        warn("Replaying the cache trace instead of restoring the cache "
+             "snapshot\n");
+        return false;
+    }
+
+    DPRINTF(RubyCacheTrace, "Restoring cache snapshot\n");
+    vector<pair<int, AbstractCacheEntry *>> cache_entries;
+    vector<pair<int, AbstractCacheEntry *>> dir_entries;
+    int cntrl;
+    int store;
+    Addr addr;
+    while (m_cache_snapshot->nextEntry(cntrl, store, addr)) {
+        fatal_if(cntrl < 0 || cntrl >= m_abs_cntrl_vec.size(),
+                 "Cache snapshot entry for unknown controller %d\n", cntrl);
+        AbstractCacheEntry *entry =
+            m_abs_cntrl_vec[cntrl]->installCacheEntry(store, addr,
+                                                      *m_cache_snapshot);
+        m_cache_snapshot->finishEntry();
+
+        if (store != CacheSnapshot::DirectoryStore) {
+            cache_entries.emplace_back(cntrl, entry);
+        } else {
+            dir_entries.emplace_back(cntrl, entry);
+        }
+    }
+
+    checkCacheCoherence(cache_entries, dir_entries);
+
+    DPRINTF(RubyCacheTrace, "Restored %d snapshot entries\n",
+            m_cache_snapshot->numEntries());
+    return true;
+}
+
+void
+RubySystem::checkCacheCoherence(
+    vector<pair<int, AbstractCacheEntry *>> &entries,
+    const vector<pair<int, AbstractCacheEntry *>> &dir_entries) const
+{
+    // Group the entries by block
+    auto by_addr = [](const pair<int, AbstractCacheEntry *> &a,
+                      const pair<int, AbstractCacheEntry *> &b) {
+        return a.second->m_Address < b.second->m_Address;
+    };
+    sort(entries.begin(), entries.end(), by_addr);
+
+    auto group = entries.begin();
+    while (group != entries.end()) {
+        Addr addr = group->second->m_Address;
+        AbstractCacheEntry *writer = NULL;
+        AbstractCacheEntry *reader = NULL;
+        int writer_cntrl = -1;
+        int reader_cntrl = -1;
+
+        auto it = group;
+        for (; it != entries.end() && it->second->m_Address == addr; ++it) {
+            AbstractCacheEntry *entry = it->second;
+            AccessPermission perm = entry->getPermission();
+            if (perm == AccessPermission_Read_Write) {
+                fatal_if(writer != NULL, "Cache snapshot gives both %s and "
+                         "%s write permission for block %#x\n",
+                         m_abs_cntrl_vec[writer_cntrl]->name(),
+                         m_abs_cntrl_vec[it->first]->name(), addr);
+                writer = entry;
+                writer_cntrl = it->first;
+            } else if (perm == AccessPermission_Read_Only) {
+                fatal_if(reader != NULL &&
+                         !reader->getDataBlk().equal(entry->getDataBlk()),
+                         "Cache snapshot has different data for block %#x "
+                         "in %s and %s\n", addr,
+                         m_abs_cntrl_vec[reader_cntrl]->name(),
+                         m_abs_cntrl_vec[it->first]->name());
+                reader = entry;
+                reader_cntrl = it->first;
+            }
+        }
+
+        fatal_if(writer != NULL && reader != NULL, "Cache snapshot lets %s "
+                 "read block %#x while %s may write it\n",
+                 m_abs_cntrl_vec[reader_cntrl]->name(), addr,
+                 m_abs_cntrl_vec[writer_cntrl]->name());
+        group = it;
+    }
+
+    // The directory has to agree with the caches: it may only consider
+    // memory up to date if no cache can write the block, and it may only
+    // have handed the block out if some cache holds it.
+    for (const auto &dir_entry : dir_entries) {
+        Addr addr = dir_entry.second->m_Address;
+        AccessPermission dir_perm = dir_entry.second->getPermission();
+        int writer_cntrl = -1;
+        int holder_cntrl = -1;
+
+        auto range = equal_range(entries.begin(), entries.end(),
+                                 dir_entry, by_addr);
+        for (auto it = range.first; it != range.second; ++it) {
+            AccessPermission perm = it->second->getPermission();
+            if (perm == AccessPermission_Read_Write) {
+                writer_cntrl = it->first;
+            }
+            if (perm != AccessPermission_Invalid &&
+                perm != AccessPermission_NotPresent) {
+                holder_cntrl = it->first;
+            }
+        }
+
+        if (dir_perm == AccessPermission_Read_Write ||
+            dir_perm == AccessPermission_Read_Only) {
+            fatal_if(writer_cntrl >= 0, "Cache snapshot lets %s read block "
+                     "%#x from memory while %s may write it\n",
+                     m_abs_cntrl_vec[dir_entry.first]->name(), addr,
+                     m_abs_cntrl_vec[writer_cntrl]->name());
+        } else if (dir_perm == AccessPermission_Invalid ||
+                   dir_perm == AccessPermission_Maybe_Stale) {
+            fatal_if(holder_cntrl < 0, "Cache snapshot has %s hand out "
+                     "block %#x, but no cache holds it\n",
+                     m_abs_cntrl_vec[dir_entry.first]->name(), addr);
+        }
+    }
+}
+
+vector<CacheSnapshot::ControllerLayout>
+RubySystem::snapshotLayout() const
+{
+    vector<CacheSnapshot::ControllerLayout> layout;
+    for (auto cntrl : m_abs_cntrl_vec) {
+        layout.push_back({cntrl->name(), cntrl->snapshotCacheGeometry()});
+    }
+    return layout;
+}
+
+bool
+RubySystem::isPartitioned() const
+{
+    for (auto cntrl : m_abs_cntrl_vec) {
+        if (cntrl->eventQueue() != eventq)
+            return true;
+    }
+    return false;
+}
+
 void
 RubySystem::memWriteback()
 {
+    fatal_if(isPartitioned(), "Ruby cache cooldown requires all Ruby "
+             "controllers on the event queue of the RubySystem.\n");
+
     m_cooldown_enabled = true;
 
     // Make the trace so we know what to write back.
@@ -144,6 +337,12 @@ RubySystem::memWriteback()
     }
     DPRINTF(RubyCacheTrace, "Cache Trace Complete\n");
 
+    // The snapshot is taken before the caches are flushed, so that it
+    // captures the state the checkpoint is restored to.
+    if (m_use_cache_snapshot) {
+        makeCacheSnapshot();
+    }
+
     // save the current tick value
     Tick curtick_original = curTick();
     DPRINTF(RubyCacheTrace, "Recording current tick %ld\n", curtick_original);
@@ -257,6 +456,19 @@ RubySystem::serialize(CheckpointOut &cp) const
 
     SERIALIZE_SCALAR(cache_trace_file);
     SERIALIZE_SCALAR(cache_trace_size);
+
+    // The snapshot goes next to the trace, which stays the fallback for
+    // systems the snapshot cannot be restored into.
+    if (m_cache_snapshot != NULL) {
+        uint64_t cache_snapshot_size;
+        uint8_t *snapshot = m_cache_snapshot->release(cache_snapshot_size);
+        string cache_snapshot_file = name() + ".snapshot.gz";
+        writeCompressedTrace(snapshot, cache_snapshot_file,
+                             cache_snapshot_size);
+
+        SERIALIZE_SCALAR(cache_snapshot_file);
+        SERIALIZE_SCALAR(cache_snapshot_size);
+    }
 }
 
 void
@@ -268,6 +480,8 @@ RubySystem::drainResume()
         delete m_cache_recorder;
         m_cache_recorder = NULL;
     }
+    delete m_cache_snapshot;
+    m_cache_snapshot = NULL;
 }
 
 void
@@ -326,6 +540,19 @@ RubySystem::unserialize(CheckpointIn &cp)
 
     // Create the cache recorder that will hang around until startup.
     makeCacheRecorder(uncompressed_trace, cache_trace_size, block_size_bytes);
+
+    string cache_snapshot_file;
+    if (m_use_cache_snapshot && UNSERIALIZE_OPT_SCALAR(cache_snapshot_file)) {
+        uint8_t *snapshot = NULL;
+        uint64_t cache_snapshot_size = 0;
+
+        UNSERIALIZE_SCALAR(cache_snapshot_size);
+        readCompressedTrace(cp.cptDir + "/" + cache_snapshot_file, snapshot,
+                            cache_snapshot_size);
+
+        delete m_cache_snapshot;
+        m_cache_snapshot = new CacheSnapshot(snapshot, cache_snapshot_size);
+    }
 }
 
 void
@@ -347,8 +574,16 @@ RubySystem::startup()
     // simulation starts. And then one also needs to hope that the time
     // Ruby finishes restoring the state is less than the time when the
     // state was checkpointed.
+    //
+    // If the checkpoint holds a cache snapshot, the cache and directory
+    // entries are installed directly instead, without simulating anything.
+
+    if (m_warmup_enabled && restoreCacheSnapshot()) {
+        DPRINTF(RubyCacheTrace, "Restored ruby caches from snapshot\n");
+    } else if (m_warmup_enabled) {
+        fatal_if(isPartitioned(), "Ruby cache warmup requires all Ruby "
+                 "controllers on the event queue of the RubySystem.\n");
 
-    if (m_warmup_enabled) {
         DPRINTF(RubyCacheTrace, "Starting ruby cache warmup\n");
         // save the current tick value
         Tick curtick_original = curTick();
@@ -362,18 +597,22 @@ RubySystem::startup()
         enqueueRubyEvent(curTick());
         simulate();
 
+        // Restore eventq head
+        eventq->replaceHead(eventq_head);
+        // Restore curTick and Ruby System's clock
+        setCurTick(curtick_original);
+        resetClock();
+    }
+
+    if (m_warmup_enabled) {
         delete m_cache_recorder;
         m_cache_recorder = NULL;
+        delete m_cache_snapshot;
+        m_cache_snapshot = NULL;
         m_systems_to_warmup--;
         if (m_systems_to_warmup == 0) {
             m_warmup_enabled = false;
         }
-
-        // Restore eventq head
-        eventq->replaceHead(eventq_head);
-        // Restore curTick and Ruby System's clock
-        setCurTick(curtick_original);
-        resetClock();
     }
 
     resetStats();
@@ -395,9 +634,51 @@ RubySystem::resetStats()
     m_start_cycle = curCycle();
 }
 
+namespace {
+
+/**
+ * Stop the threads simulating the other event queues for the lifetime
+ * of the object, so that a functional access can look at controllers
+ * and message buffers that are simulated in parallel. Every thread
+ * holds the lock of its queue while servicing an event, so taking all
+ * of them waits for the events in flight to finish. The lock of the
+ * current queue is released first and all locks are taken in the same
+ * order, which keeps two threads doing functional accesses at the same
+ * time from deadlocking. Does nothing unless simulating in parallel.
+ */
+class ScopedQuiesce
+{
+  public:
+    ScopedQuiesce(bool partitioned)
+        : current(partitioned && inParallelMode ? curEventQueue() : nullptr)
+    {
+        if (!current)
+            return;
+        current->unlock();
+        for (uint32_t i = 0; i < numMainEventQueues; ++i)
+            mainEventQueue[i]->lock();
+    }
+
+    ~ScopedQuiesce()
+    {
+        if (!current)
+            return;
+        for (uint32_t i = numMainEventQueues; i > 0; --i)
+            mainEventQueue[i - 1]->unlock();
+        current->lock();
+    }
+
+  private:
+    EventQueue *current;
+};
+
+} // anonymous namespace
+
 bool
 RubySystem::functionalRead(PacketPtr pkt)
 {
+    ScopedQuiesce quiesce(isPartitioned());
+
     Addr address(pkt->getAddr());
     Addr line_address = makeLineAddress(address);
 
@@ -483,10 +764,13 @@ RubySystem::functionalRead(PacketPtr pkt)
 // The function searches through all the buffers that exist in different
 // cache, directory and memory controllers, and in the network components
 // and writes the data portion of those that hold the address specified
-// in the packet.
+// in the packet. When the controllers are simulated by several threads,
+// those are stopped for the access.
 bool
 RubySystem::functionalWrite(PacketPtr pkt)
 {
+    ScopedQuiesce quiesce(isPartitioned());
+
     Addr addr(pkt->getAddr());
     Addr line_addr = makeLineAddress(addr);
     AccessPermission access_perm = AccessPermission_NotPresent;
@@ -41,6 +41,7 @@
 #include "mem/ruby/profiler/Profiler.hh"
 #include "mem/ruby/slicc_interface/AbstractController.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
+#include "mem/ruby/system/CacheSnapshot.hh"
 #include "params/RubySystem.hh"
 #include "sim/clocked_object.hh"
 
@@ -65,6 +66,11 @@ class RubySystem : public ClockedObject
     SimpleMemory *getPhysMem() { return m_phys_mem; }
     Cycles getStartCycle() { return m_start_cycle; }
     bool getAccessBackingStore() { return m_access_backing_store; }
+    unsigned int
+    getTransitionSamplePeriod() const
+    {
+        return m_transition_sample_period;
+    }
 
     // Public Methods
     Profiler*
@@ -74,10 +80,7 @@ class RubySystem : public ClockedObject
         return m_profiler;
     }
 
-    void regStats() override {
-        ClockedObject::regStats();
-        m_profiler->regStats(name());
-    }
+    void regStats() override;
     void collateStats() { m_profiler->collateStats(); }
     void resetStats() override;
 
@@ -94,6 +97,13 @@ class RubySystem : public ClockedObject
     void registerAbstractController(AbstractController*);
 
     bool eventQueueEmpty() { return eventq->empty(); }
+
+    /**
+     * Check if the controllers of this system are spread over several
+     * event queues, i.e., simulated by different threads.
+     */
+    bool isPartitioned() const;
+
     void enqueueRubyEvent(Tick tick)
     {
         auto e = new EventFunctionWrapper(
@@ -109,6 +119,31 @@ class RubySystem : public ClockedObject
     void makeCacheRecorder(uint8_t *uncompressed_trace,
                            uint64_t cache_trace_size,
                            uint64_t block_size_bytes);
+    void makeCacheSnapshot();
+
+    /**
+     * Install the entries of the cache snapshot read from a checkpoint
+     * into the caches and directories.
+     *
+     * @return false if there is no snapshot, or it does not match this
+     * system, in which case the cache trace has to be replayed.
+     */
+    bool restoreCacheSnapshot();
+
+    /**
+     * Check that the restored cache entries give every block either a
+     * single writable copy or only read-only copies with the same data,
+     * and that the directory entries agree with them: a directory that
+     * considers memory up to date has no cache with a writable copy, and
+     * one that handed the block out has a cache holding it.
+     */
+    void checkCacheCoherence(
+        std::vector<std::pair<int, AbstractCacheEntry *>> &entries,
+        const std::vector<std::pair<int, AbstractCacheEntry *>> &dir_entries)
+        const;
+
+    // The controllers and cache geometries a snapshot has to match
+    std::vector<CacheSnapshot::ControllerLayout> snapshotLayout() const;
 
     static void readCompressedTrace(std::string filename,
                                     uint8_t *&raw_data,
@@ -129,6 +164,8 @@ class RubySystem : public ClockedObject
     static bool m_cooldown_enabled;
     SimpleMemory *m_phys_mem;
     const bool m_access_backing_store;
+    const bool m_use_cache_snapshot;
+    const unsigned int m_transition_sample_period;
 
     Network* m_network;
     std::vector<AbstractController *> m_abs_cntrl_vec;
@@ -137,6 +174,7 @@ class RubySystem : public ClockedObject
   public:
     Profiler* m_profiler;
     CacheRecorder* m_cache_recorder;
+    CacheSnapshot* m_cache_snapshot;
     std::vector<std::map<uint32_t, AbstractController *> > m_abstract_controls;
 };
 
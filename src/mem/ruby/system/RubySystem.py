@@ -48,8 +48,21 @@ class RubySystem(ClockedObject):
     access_backing_store = Param.Bool(False, "Use phys_mem as the functional \
         store and only use ruby for timing.")
 
+    cache_snapshot = Param.Bool(False, "Save the entries of all caches and \
+        directories in checkpoints, and restore them directly instead of \
+        replaying the cache trace through the protocol.")
+
+    # Measuring every transition would perturb the simulator too much,
+    # so only every Nth one is timed and the sum is scaled up by N. The
+    # period is the same for all controllers, so that the host times of
+    # different controllers add up.
+    transition_sample_period = Param.Unsigned(0, "Measure the host time \
+        of every Nth protocol transition of each controller (0 disables)")
+
     # Profiler related configuration variables
     hot_lines = Param.Bool(False, "")
+    hot_lines_entries = Param.Unsigned(1024, "Number of addresses each \
+        table of the address profiler keeps track of")
     all_instructions = Param.Bool(False, "")
     num_of_sequencers = Param.Int("")
     number_of_virtual_networks = Param.Unsigned("")
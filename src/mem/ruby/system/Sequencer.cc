@@ -296,6 +296,14 @@ Sequencer::recordMissLatency(SequencerRequest* srequest, bool llscSuccess,
             m_hitTypeMachLatencyHist[type][respondingMach]->sample(total_lat);
         }
     }
+
+    Profiler *profiler = m_ruby_system->getProfiler();
+    if (isExternalHit && profiler->getHotLines()) {
+        const Request *req = srequest->pkt->req.get();
+        profiler->profileHotLineMiss(m_controller->getMachineID(),
+            makeLineAddress(srequest->pkt->getAddr()),
+            req->hasPC() ? req->getPC() : 0, type, respondingMach);
+    }
 }
 
 void
@@ -672,13 +680,12 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
 
     // check if the packet has data as for example prefetch and flush
     // requests do not
-    std::shared_ptr<RubyRequest> msg =
-        std::make_shared<RubyRequest>(clockEdge(), pkt->getAddr(),
-                                      pkt->isFlush() ?
-                                      nullptr : pkt->getPtr<uint8_t>(),
-                                      pkt->getSize(), pc, secondary_type,
-                                      RubyAccessMode_Supervisor, pkt,
-                                      PrefetchBit_No, proc_id, core_id);
+    RefCountingPtr<RubyRequest> msg =
+        new RubyRequest(clockEdge(), pkt->getAddr(),
+                        pkt->isFlush() ? nullptr : pkt->getPtr<uint8_t>(),
+                        pkt->getSize(), pc, secondary_type,
+                        RubyAccessMode_Supervisor, pkt,
+                        PrefetchBit_No, proc_id, core_id);
 
     DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %#x %s\n",
             curTick(), m_version, "Seq", "Begin", "", "",
@@ -59,6 +59,7 @@ class InPortDeclAST(DeclAST):
 
         type = self.queue_type.type
         self.pairs["buffer_expr"] = self.var_expr
+        self.pairs["buffer_type"] = queue_type
         in_port = Var(self.symtab, self.ident, self.location, type, str(code),
                       self.pairs, machine)
         symtab.newSymbol(in_port)
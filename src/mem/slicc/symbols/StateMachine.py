@@ -53,6 +53,12 @@ python_class_map = {
                     "Cycles":"Cycles",
                    }
 
+# Types of entry fields, besides enumerations, that snapshotField() and
+# restoreField() in mem/ruby/system/CacheSnapshot.hh know how to save
+snapshot_field_types = ("bool", "int", "uint32_t", "uint64_t", "NodeID",
+                        "Addr", "Tick", "Cycles", "DataBlock", "MachineID",
+                        "Set", "NetDest")
+
 class StateMachine(Symbol):
     def __init__(self, symtab, ident, location, pairs, config_parameters):
         super(StateMachine, self).__init__(symtab, ident, location, pairs)
@@ -92,6 +98,7 @@ class StateMachine(Symbol):
         self.objects = []
         self.TBEType   = None
         self.EntryType = None
+        self.OtherEntryTypes = []
         self.debug_flags = set()
         self.debug_flags.add('RubyGenerated')
         self.debug_flags.add('RubySlicc')
@@ -157,7 +164,8 @@ class StateMachine(Symbol):
 
         elif "interface" in type and "AbstractCacheEntry" == type["interface"]:
             if "main" in type and "false" == type["main"].lower():
-                pass # this isn't the EntryType
+                # this isn't the EntryType
+                self.OtherEntryTypes.append(type)
             else:
                 if self.EntryType != None:
                     self.error("Multiple AbstractCacheEntry types in a " \
@@ -194,6 +202,56 @@ class StateMachine(Symbol):
                 action.warning(error_msg)
         self.table = table
 
+    def snapshotMembers(self, type):
+        '''Return the data members of an entry type that a cache snapshot
+        has to save, or None if any of them has a type it cannot save'''
+        members = []
+        for dm in type.data_members.values():
+            if "abstract" in dm:
+                continue
+            if not dm.type.isEnumeration and \
+               dm.type.ident not in snapshot_field_types:
+                return None
+            members.append(dm)
+        return members
+
+    def snapshotStores(self):
+        '''Return a (store, param, entry type) tuple for each cache and
+        directory memory of the machine, or None if the state of the
+        machine cannot be captured in a cache snapshot'''
+        stores = []
+        num_caches = 0
+        for param in self.config_parameters:
+            type_ident = param.type_ast.type.ident
+            if type_ident == "CacheMemory":
+                store = str(num_caches)
+                num_caches += 1
+                entry_type = self.EntryType
+            elif type_ident == "DirectoryMemory":
+                store = "CacheSnapshot::DirectoryStore"
+                if store in [ s for s, p, t in stores ]:
+                    return None
+                entry_type = None
+                for type in self.OtherEntryTypes:
+                    if type.c_ident == "%s_Entry" % self.ident:
+                        entry_type = type
+            elif type_ident == "PerfectCacheMemory":
+                return None
+            else:
+                continue
+
+            if entry_type is None or self.snapshotMembers(entry_type) is None:
+                return None
+            stores.append((store, param, entry_type))
+
+        # Entries held by memories that are not parameters have no store
+        for var in self.objects:
+            if var.type.ident in ("CacheMemory", "DirectoryMemory",
+                                  "PerfectCacheMemory"):
+                return None
+
+        return stores
+
     # determine the port->msg buffer mappings
     def getBufferMaps(self, ident):
         msg_bufs = []
@@ -209,6 +267,17 @@ class StateMachine(Symbol):
                 in_msg_bufs[buf_name].append(port)
         return port_to_buf_map, in_msg_bufs, msg_bufs
 
+    def pendingSlot(self, port, port_to_buf_map, msg_bufs):
+        '''Bit of the port's buffer in the pending mask, None if the port
+        has to be looked at on every wakeup'''
+        if port.pairs["buffer_type"].ident != "MessageBuffer":
+            return None
+        # The mask has 64 bits, any ports beyond are polled
+        slot = port_to_buf_map[port]
+        if slot >= 64:
+            return None
+        return slot
+
     def writeCodeFiles(self, path, includes):
         self.printControllerPython(path)
         self.printControllerHH(path)
@@ -309,6 +378,10 @@ class $c_ident : public AbstractController
     void collateStats();
 
     void recordCacheTrace(int cntrl, CacheRecorder* tr);
+    bool snapshotCacheState(int cntrl, CacheSnapshot &snap);
+    AbstractCacheEntry *installCacheEntry(int store, Addr addr,
+                                          CacheSnapshot &snap);
+    std::vector<CacheSnapshot::CacheGeometry> snapshotCacheGeometry() const;
     Sequencer* getCPUSequencer() const;
     GPUCoalescer* getGPUCoalescer() const;
 
@@ -316,9 +389,9 @@ class $c_ident : public AbstractController
 
     void countTransition(${ident}_State state, ${ident}_Event event);
     void possibleTransition(${ident}_State state, ${ident}_Event event);
-    uint64_t getEventCount(${ident}_Event event);
     bool isPossible(${ident}_State state, ${ident}_Event event);
-    uint64_t getTransitionCount(${ident}_State state, ${ident}_Event event);
+    uint64_t getTransitionHostTime(${ident}_State state,
+                                   ${ident}_Event event);
 
 private:
 ''')
@@ -364,12 +437,15 @@ TransitionResult doTransitionWorker(${ident}_Event event,
         code('''
                                     Addr addr);
 
-int m_counters[${ident}_State_NUM][${ident}_Event_NUM];
-int m_event_counters[${ident}_Event_NUM];
 bool m_possible[${ident}_State_NUM][${ident}_Event_NUM];
-
-static std::vector<Stats::Vector *> eventVec;
-static std::vector<std::vector<Stats::Vector *> > transVec;
+// Host nanoseconds of the sampled transitions
+uint64_t m_host_ns[${ident}_State_NUM][${ident}_Event_NUM];
+
+// Counted as the transitions happen, by controllers that may run in
+// different simulation threads
+static std::vector<Stats::ShardedVector *> eventVec;
+static std::vector<std::vector<Stats::ShardedVector *> > transVec;
+static std::vector<std::vector<Stats::Vector *> > hostTimeVec;
 static int m_num_controllers;
 
 // Internal functions
@@ -499,8 +575,9 @@ ${c_ident}Params::create()
 }
 
 int $c_ident::m_num_controllers = 0;
-std::vector<Stats::Vector *>  $c_ident::eventVec;
-std::vector<std::vector<Stats::Vector *> >  $c_ident::transVec;
+std::vector<Stats::ShardedVector *>  $c_ident::eventVec;
+std::vector<std::vector<Stats::ShardedVector *> >  $c_ident::transVec;
+std::vector<std::vector<Stats::Vector *> >  $c_ident::hostTimeVec;
 
 // for adding information to the protocol debug trace
 stringstream ${ident}_transitionComment;
@@ -548,12 +625,9 @@ if (m_${{param.ident}}_ptr != NULL) {
 for (int state = 0; state < ${ident}_State_NUM; state++) {
     for (int event = 0; event < ${ident}_Event_NUM; event++) {
         m_possible[state][event] = false;
-        m_counters[state][event] = 0;
+        m_host_ns[state][event] = 0;
     }
 }
-for (int event = 0; event < ${ident}_Event_NUM; event++) {
-    m_event_counters[event] = 0;
-}
 ''')
         code.dedent()
         code('''
@@ -641,9 +715,15 @@ $c_ident::init()
             code('${{prefetcher.code}}.setController(this);')
 
         code()
+        port_to_buf_map, in_msg_bufs, msg_bufs = self.getBufferMaps(ident)
         for port in self.in_ports:
-            # Set the queue consumers
-            code('${{port.code}}.setConsumer(this);')
+            # Set the queue consumers, giving each buffer its bit in the
+            # pending mask that wakeup() looks at
+            slot = self.pendingSlot(port, port_to_buf_map, msg_bufs)
+            if slot is None:
+                code('${{port.code}}.setConsumer(this);')
+            else:
+                code('${{port.code}}.setConsumer(this, $slot);')
 
         # Initialize the transition profiling
         code()
@@ -743,7 +823,7 @@ $c_ident::regStats()
     if (m_version == 0) {
         for (${ident}_Event event = ${ident}_Event_FIRST;
              event < ${ident}_Event_NUM; ++event) {
-            Stats::Vector *t = new Stats::Vector();
+            Stats::ShardedVector *t = new Stats::ShardedVector();
             t->init(m_num_controllers);
             t->name(params()->ruby_system->name() + ".${c_ident}." +
                 ${ident}_Event_to_string(event));
@@ -756,12 +836,12 @@ $c_ident::regStats()
         for (${ident}_State state = ${ident}_State_FIRST;
              state < ${ident}_State_NUM; ++state) {
 
-            transVec.push_back(std::vector<Stats::Vector *>());
+            transVec.push_back(std::vector<Stats::ShardedVector *>());
 
             for (${ident}_Event event = ${ident}_Event_FIRST;
                  event < ${ident}_Event_NUM; ++event) {
 
-                Stats::Vector *t = new Stats::Vector();
+                Stats::ShardedVector *t = new Stats::ShardedVector();
                 t->init(m_num_controllers);
                 t->name(params()->ruby_system->name() + ".${c_ident}." +
                         ${ident}_State_to_string(state) +
@@ -772,23 +852,42 @@ $c_ident::regStats()
                 transVec[state].push_back(t);
             }
         }
+
+        // The sample period is set for the whole RubySystem, so this
+        // controller samples if and only if all the others do
+        if (m_transition_sample_period == 0)
+            return;
+
+        for (${ident}_State state = ${ident}_State_FIRST;
+             state < ${ident}_State_NUM; ++state) {
+
+            hostTimeVec.push_back(std::vector<Stats::Vector *>());
+
+            for (${ident}_Event event = ${ident}_Event_FIRST;
+                 event < ${ident}_Event_NUM; ++event) {
+
+                Stats::Vector *t = new Stats::Vector();
+                t->init(m_num_controllers);
+                t->name(params()->ruby_system->name() + ".${c_ident}." +
+                        ${ident}_State_to_string(state) +
+                        "." + ${ident}_Event_to_string(event) +
+                        ".host_ns");
+                t->desc("Estimated host nanoseconds spent in the "
+                        "transition");
+
+                t->flags(Stats::pdf | Stats::total | Stats::oneline |
+                         Stats::nozero);
+                hostTimeVec[state].push_back(t);
+            }
+        }
     }
 }
 
 void
 $c_ident::collateStats()
 {
-    for (${ident}_Event event = ${ident}_Event_FIRST;
-         event < ${ident}_Event_NUM; ++event) {
-        for (unsigned int i = 0; i < m_num_controllers; ++i) {
-            RubySystem *rs = params()->ruby_system;
-            std::map<uint32_t, AbstractController *>::iterator it =
-                     rs->m_abstract_controls[MachineType_${ident}].find(i);
-            assert(it != rs->m_abstract_controls[MachineType_${ident}].end());
-            (*eventVec[event])[i] =
-                (($c_ident *)(*it).second)->getEventCount(event);
-        }
-    }
+    if (hostTimeVec.empty())
+        return;
 
     for (${ident}_State state = ${ident}_State_FIRST;
          state < ${ident}_State_NUM; ++state) {
@@ -801,8 +900,9 @@ $c_ident::collateStats()
                 std::map<uint32_t, AbstractController *>::iterator it =
                          rs->m_abstract_controls[MachineType_${ident}].find(i);
                 assert(it != rs->m_abstract_controls[MachineType_${ident}].end());
-                (*transVec[state][event])[i] =
-                    (($c_ident *)(*it).second)->getTransitionCount(state, event);
+                (*hostTimeVec[state][event])[i] =
+                    (($c_ident *)(*it).second)->getTransitionHostTime(state,
+                                                                      event);
             }
         }
     }
@@ -812,8 +912,8 @@ void
 $c_ident::countTransition(${ident}_State state, ${ident}_Event event)
 {
     assert(m_possible[state][event]);
-    m_counters[state][event]++;
-    m_event_counters[event]++;
+    (*transVec[state][event])[m_version]++;
+    (*eventVec[event])[m_version]++;
 }
 void
 $c_ident::possibleTransition(${ident}_State state,
@@ -822,12 +922,6 @@ $c_ident::possibleTransition(${ident}_State state,
     m_possible[state][event] = true;
 }
 
-uint64_t
-$c_ident::getEventCount(${ident}_Event event)
-{
-    return m_event_counters[event];
-}
-
 bool
 $c_ident::isPossible(${ident}_State state, ${ident}_Event event)
 {
@@ -835,10 +929,10 @@ $c_ident::isPossible(${ident}_State state, ${ident}_Event event)
 }
 
 uint64_t
-$c_ident::getTransitionCount(${ident}_State state,
-                             ${ident}_Event event)
+$c_ident::getTransitionHostTime(${ident}_State state,
+                                ${ident}_Event event)
 {
-    return m_counters[state][event];
+    return m_host_ns[state][event] * m_transition_sample_period;
 }
 
 int
@@ -869,14 +963,10 @@ void $c_ident::resetStats()
 {
     for (int state = 0; state < ${ident}_State_NUM; state++) {
         for (int event = 0; event < ${ident}_Event_NUM; event++) {
-            m_counters[state][event] = 0;
+            m_host_ns[state][event] = 0;
         }
     }
 
-    for (int event = 0; event < ${ident}_Event_NUM; event++) {
-        m_event_counters[event] = 0;
-    }
-
     AbstractController::resetStats();
 }
 ''')
@@ -933,6 +1023,163 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
         code.dedent()
         code('''
 }
+''')
+
+        #
+        # Save and install the entries of all caches and directories for
+        # cache snapshots.
+        #
+        stores = self.snapshotStores()
+        if stores is None:
+            code('''
+
+bool
+$c_ident::snapshotCacheState(int cntrl, CacheSnapshot &snap)
+{
+    return false;
+}
+
+AbstractCacheEntry *
+$c_ident::installCacheEntry(int store, Addr addr, CacheSnapshot &snap)
+{
+    panic("%s: entries cannot be restored from a cache snapshot\\n",
+          name());
+}
+
+std::vector<CacheSnapshot::CacheGeometry>
+$c_ident::snapshotCacheGeometry() const
+{
+    return {};
+}
+''')
+        else:
+            entry_types = []
+            for store, param, entry_type in stores:
+                if entry_type not in entry_types:
+                    entry_types.append(entry_type)
+
+            for entry_type in entry_types:
+                members = self.snapshotMembers(entry_type)
+                code('''
+
+static void
+snapshotEntry(CacheSnapshot &snap, const ${{entry_type.c_ident}} &entry)
+{
+''')
+                code.indent()
+                for dm in members:
+                    code('snapshotField(snap, entry.m_${{dm.ident}});')
+                code.dedent()
+                code('''
+}
+
+static void
+restoreEntry(CacheSnapshot &snap, ${{entry_type.c_ident}} &entry)
+{
+''')
+                code.indent()
+                for dm in members:
+                    code('restoreField(snap, entry.m_${{dm.ident}});')
+                code.dedent()
+                code('}')
+
+            code('''
+
+std::vector<CacheSnapshot::CacheGeometry>
+$c_ident::snapshotCacheGeometry() const
+{
+    std::vector<CacheSnapshot::CacheGeometry> caches;
+''')
+            code.indent()
+            for store, param, entry_type in stores:
+                if param.type_ast.type.ident == "CacheMemory":
+                    code('''
+caches.push_back(
+    CacheSnapshot::CacheGeometry::of(*m_${{param.ident}}_ptr));
+''')
+            code.dedent()
+            code('''
+    return caches;
+}
+
+bool
+$c_ident::snapshotCacheState(int cntrl, CacheSnapshot &snap)
+{
+''')
+            code.indent()
+            for store, param, entry_type in stores:
+                code('''
+m_${{param.ident}}_ptr->forEachEntry([&](AbstractCacheEntry *entry) {
+    snap.beginEntry(cntrl, $store, entry->m_Address);
+    snapshotEntry(snap,
+                  *static_cast<${{entry_type.c_ident}} *>(entry));
+    snap.endEntry();
+});
+''')
+            code.dedent()
+            code('''
+    return true;
+}
+
+AbstractCacheEntry *
+$c_ident::installCacheEntry(int store, Addr addr, CacheSnapshot &snap)
+{
+    switch (store) {
+''')
+            code.indent()
+            for store, param, entry_type in stores:
+                # Install the entry, then derive its access permission
+                # from its state the way doTransition() does.
+                state_args = []
+                if self.TBEType != None:
+                    state_args.append("nullptr")
+                perm_args = []
+                if self.EntryType != None:
+                    if entry_type == self.EntryType:
+                        state_args.append("entry")
+                        perm_args.append("entry")
+                    else:
+                        state_args.append("nullptr")
+                        perm_args.append("nullptr")
+                state_args = ", ".join(state_args + ["addr"])
+                perm_args = ", ".join(perm_args + ["addr", "state"])
+
+                if param.type_ast.type.ident == "CacheMemory":
+                    code('''
+  case $store: {
+    if (!m_${{param.ident}}_ptr->cacheAvail(addr)) {
+        fatal("%s: no room for snapshot entry %#x in %s\\n", name(),
+              addr, m_${{param.ident}}_ptr->name());
+    }
+''')
+                else:
+                    code('''
+  case $store: {
+    if (!m_${{param.ident}}_ptr->isPresent(addr)) {
+        fatal("%s: snapshot entry %#x is outside of %s\\n", name(),
+              addr, m_${{param.ident}}_ptr->name());
+    }
+''')
+                code('''
+    ${{entry_type.c_ident}} *entry = new ${{entry_type.c_ident}};
+    restoreEntry(snap, *entry);
+    m_${{param.ident}}_ptr->allocate(addr, entry);
+    ${ident}_State state = getState($state_args);
+    setAccessPermission($perm_args);
+    return entry;
+  }
+''')
+            code('''
+  default:
+    panic("%s: snapshot entry for unknown store %d\\n", name(), store);
+''')
+            code.dedent()
+            code('''
+    }
+}
+''')
+
+        code('''
 
 // Actions
 ''')
@@ -1106,9 +1353,16 @@ ${ident}_Controller::wakeup()
 
         # InPorts
         #
+        # Ports whose buffer holds no messages have nothing to do, so
+        # they are skipped based on the pending mask the buffers set.
+        #
         for port in self.in_ports:
             code.indent()
             code('// ${ident}InPort $port')
+            slot = self.pendingSlot(port, port_to_buf_map, msg_bufs)
+            if slot is not None:
+                code('if (m_pending_buffers & (1ULL << $slot)) {')
+                code.indent()
             if "rank" in port.pairs:
                 code('m_cur_in_port = ${{port.pairs["rank"]}};')
             else:
@@ -1125,6 +1379,9 @@ ${ident}_Controller::wakeup()
                 rejected[${{port_to_buf_map[port]}}]++;
             }
 ''')
+            if slot is not None:
+                code.dedent()
+                code('}')
             code.dedent()
             code('')
 
@@ -1148,6 +1405,18 @@ ${ident}_Controller::wakeup()
                   Cycles(1));
         }
 ''')
+        code()
+        code('        // Forget the buffers that have been drained')
+        slots = set()
+        for port in self.in_ports:
+            slot = self.pendingSlot(port, port_to_buf_map, msg_bufs)
+            if slot is None or slot in slots:
+                continue
+            slots.add(slot)
+            buf_name = msg_bufs[slot]
+            code('''
+        if (${{buf_name}}->isEmpty())
+            m_pending_buffers &= ~(1ULL << $slot);''')
         code('''
         break;
     }
@@ -1167,6 +1436,7 @@ ${ident}_Controller::wakeup()
 // ${ident}: ${{self.short}}
 
 #include <cassert>
+#include <chrono>
 
 #include "base/logging.hh"
 #include "base/trace.hh"
@@ -1216,6 +1486,11 @@ DPRINTF(RubyGenerated, "%s, Time: %lld, state: %s, event: %s, addr: %#x\\n",
         *this, curCycle(), ${ident}_State_to_string(state),
         ${ident}_Event_to_string(event), addr);
 
+const bool sampled = sampleTransition();
+std::chrono::steady_clock::time_point start;
+if (sampled)
+    start = std::chrono::steady_clock::now();
+
 TransitionResult result =
 ''')
         if self.TBEType != None and self.EntryType != None:
@@ -1235,6 +1510,11 @@ if (result == TransitionResult_Valid) {
     DPRINTF(RubyGenerated, "next_state: %s\\n",
             ${ident}_State_to_string(next_state));
     countTransition(state, event);
+    if (sampled) {
+        m_host_ns[state][event] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    }
 
     DPRINTFR(ProtocolTrace, "%15d %3s %10s%20s %6s>%-6s %#x %s\\n",
              curTick(), m_version, "${ident}",
@@ -44,6 +44,7 @@
 
 #include "mem/snoop_filter.hh"
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/SnoopFilter.hh"
@@ -51,15 +52,113 @@
 
 const int SnoopFilter::SNOOP_MASK_SIZE;
 
-void
+SnoopFilter::SnoopFilter(const SnoopFilterParams *p)
+    : SimObject(p), reqLookupResult(cachedLocations.end()),
+      linesize(p->system->cacheLineSize()), lookupLatency(p->lookup_latency),
+      maxEntryCount(p->max_capacity / p->system->cacheLineSize()),
+      assoc(p->assoc), numSets(p->assoc ? p->entries / p->assoc : 0),
+      replacementPolicy(p->replacement_policy)
+{
+    if (p->entries == 0) {
+        fatal_if(replacementPolicy, "%s: an unbounded snoop filter can't "
+                 "have a replacement policy\n", name());
+        return;
+    }
+
+    fatal_if(assoc == 0 || p->entries % assoc != 0,
+             "%s: %d entries can't be divided in ways of %d\n", name(),
+             p->entries, assoc);
+    fatal_if(!isPowerOf2(numSets), "%s: # of sets must be a power of 2, "
+             "got %d\n", name(), numSets);
+    fatal_if(!replacementPolicy, "%s: a bounded snoop filter needs a "
+             "replacement policy\n", name());
+    // Lines with requests in flight are never evicted, so the victim
+    // is chosen among a subset of the set
+    fatal_if(!replacementPolicy->canRankCandidates(), "%s: the replacement "
+             "policy can't choose among a subset of the ways\n", name());
+
+    ways.resize(p->entries);
+    for (unsigned set = 0; set < numSets; set++) {
+        for (unsigned way = 0; way < assoc; way++) {
+            Way& entry = ways[set * assoc + way];
+            entry.setPosition(set, way);
+            entry.replacementData = replacementPolicy->instantiateEntry();
+        }
+    }
+}
+
+bool
 SnoopFilter::eraseIfNullEntry(SnoopFilterCache::iterator& sf_it)
 {
     SnoopItem& sf_item = sf_it->second;
     if ((sf_item.requested | sf_item.holder).none()) {
+        if (sf_item.way) {
+            sf_item.way->item = nullptr;
+            replacementPolicy->invalidate(sf_item.way->replacementData);
+        }
         cachedLocations.erase(sf_it);
         DPRINTF(SnoopFilter, "%s:   Removed SF entry.\n",
                 __func__);
+        return true;
     }
+    return false;
+}
+
+void
+SnoopFilter::allocateWay(SnoopFilterCache::iterator& sf_it)
+{
+    const unsigned set = (sf_it->first / linesize) & (numSets - 1);
+    Way* const first = &ways[set * assoc];
+
+    Way* victim = nullptr;
+    ReplacementCandidates candidates;
+    for (Way* way = first; way != first + assoc; way++) {
+        if (!way->item) {
+            victim = way;
+            break;
+        }
+        if (way->item->requested.none()) {
+            candidates.push_back(way);
+        }
+    }
+
+    if (!victim) {
+        if (candidates.empty()) {
+            // every line of the set has a request in flight
+            DPRINTF(SnoopFilter, "%s:   no entry for %#x in set %d\n",
+                    __func__, sf_it->first, set);
+            overflows++;
+            return;
+        }
+
+        victim = static_cast<Way*>(replacementPolicy->getVictim(candidates));
+        const SnoopItem& evicted = *victim->item;
+        DPRINTF(SnoopFilter, "%s:   evicting %#x SF value %x.%x\n",
+                __func__, victim->lineAddr, evicted.requested,
+                evicted.holder);
+
+        pendingBackInvalidations.push_back(BackInvalidation{
+            victim->lineAddr & ~Addr(LineSecure),
+            bool(victim->lineAddr & LineSecure),
+            maskToPortList(evicted.holder)});
+        evictions++;
+        backInvalidations += evicted.holder.count();
+
+        cachedLocations.erase(victim->lineAddr);
+    }
+
+    victim->lineAddr = sf_it->first;
+    victim->item = &sf_it->second;
+    sf_it->second.way = victim;
+    replacementPolicy->reset(victim->replacementData);
+}
+
+std::vector<SnoopFilter::BackInvalidation>
+SnoopFilter::takeBackInvalidations()
+{
+    std::vector<BackInvalidation> res;
+    res.swap(pendingBackInvalidations);
+    return res;
 }
 
 std::pair<SnoopFilter::SnoopList, Cycles>
@@ -81,8 +180,10 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const SlavePort& slave_port)
 
     // If the snoop filter has no entry, and we should not allocate,
     // do not create a new snoop filter entry, simply return a NULL
-    // portlist.
-    if (!is_hit && !allocate)
+    // portlist. A bounded filter may have back-invalidated the line
+    // of an eviction that was already on its way, and there is
+    // nothing left to track for it.
+    if (!is_hit && (!allocate || (cpkt->isEviction() && isBounded())))
         return snoopDown(lookupLatency);
 
     // If no hit in snoop filter create a new element and update iterator
@@ -176,7 +277,15 @@ SnoopFilter::finishRequest(bool will_retry, Addr addr, bool is_secure)
                     __func__,  retry_item.requested, retry_item.holder);
         }
 
-        eraseIfNullEntry(reqLookupResult.it);
+        if (!eraseIfNullEntry(reqLookupResult.it) && isBounded() &&
+            !will_retry) {
+            Way* way = reqLookupResult.it->second.way;
+            if (way) {
+                replacementPolicy->touch(way->replacementData);
+            } else {
+                allocateWay(reqLookupResult.it);
+            }
+        }
     }
 }
 
@@ -419,6 +528,20 @@ SnoopFilter::regStats()
         .name(name() + ".hit_multi_snoops")
         .desc("Number of snoops hitting in the snoop filter with multiple "\
               "(>1) holders of the requested data.");
+
+    evictions
+        .name(name() + ".evictions")
+        .desc("Number of lines evicted from a bounded snoop filter.");
+
+    backInvalidations
+        .name(name() + ".back_invalidations")
+        .desc("Number of back-invalidation snoops sent to the holders of "\
+              "evicted lines.");
+
+    overflows
+        .name(name() + ".overflows")
+        .desc("Number of lines left untracked as all the entries of their "\
+              "set had requests in flight.");
 }
 
 SnoopFilter *
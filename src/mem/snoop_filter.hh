@@ -48,7 +48,10 @@
 #include <bitset>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "mem/cache/replacement_policies/base.hh"
+#include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/packet.hh"
 #include "mem/port.hh"
 #include "mem/qport.hh"
@@ -84,6 +87,12 @@
  *     upper cache dropped a line, making the snoop filter pessimistic for now
  * (4) ordering: there is no single point of order in the system.  Instead,
  *     requesting MSHRs track order between local requests and remote snoops
+ *
+ * By default the filter is unbounded. When given a number of entries
+ * it is organised as a set-associative structure instead, and making
+ * room for a new line evicts an entry chosen by a replacement
+ * policy. The caches holding the evicted line are then sent a
+ * back-invalidation by the crossbar, see takeBackInvalidations().
  */
 class SnoopFilter : public SimObject {
   public:
@@ -93,12 +102,20 @@ class SnoopFilter : public SimObject {
 
     typedef std::vector<QueuedSlavePort*> SnoopList;
 
-    SnoopFilter (const SnoopFilterParams *p) :
-        SimObject(p), reqLookupResult(cachedLocations.end()),
-        linesize(p->system->cacheLineSize()), lookupLatency(p->lookup_latency),
-        maxEntryCount(p->max_capacity / p->system->cacheLineSize())
-    {
-    }
+    /**
+     * A line evicted from a bounded snoop filter, which has to be
+     * invalidated in the caches that held it.
+     */
+    struct BackInvalidation {
+        /** Line address. */
+        Addr addr;
+        /** Whether the line is in the secure memory space. */
+        bool isSecure;
+        /** Slave ports leading to the holders of the line. */
+        SnoopList ports;
+    };
+
+    SnoopFilter(const SnoopFilterParams *p);
 
     /**
      * Init a new snoop filter and tell it about all the slave ports
@@ -197,6 +214,24 @@ class SnoopFilter : public SimObject {
      */
     void updateResponse(const Packet *cpkt, const SlavePort& slave_port);
 
+    /**
+     * Check for lines evicted by the last request, which the crossbar
+     * must back-invalidate.
+     *
+     * @return True if there are back-invalidations to send.
+     */
+    bool hasBackInvalidations() const
+    {
+        return !pendingBackInvalidations.empty();
+    }
+
+    /**
+     * Hand the pending back-invalidations over to the crossbar.
+     *
+     * @return The lines to invalidate and the ports to snoop for each.
+     */
+    std::vector<BackInvalidation> takeBackInvalidations();
+
     virtual void regStats();
 
   protected:
@@ -207,6 +242,8 @@ class SnoopFilter : public SimObject {
      */
     typedef std::bitset<SNOOP_MASK_SIZE> SnoopMask;
 
+    struct Way;
+
     /**
     * Per cache line item tracking a bitmask of SlavePorts who have an
     * outstanding request to this line (requested) or already share a
@@ -215,7 +252,20 @@ class SnoopFilter : public SimObject {
     struct SnoopItem {
         SnoopMask requested;
         SnoopMask holder;
+        /** Entry of a bounded filter tracking the line, if any. */
+        Way* way = nullptr;
+    };
+
+    /**
+     * An entry of a bounded snoop filter.
+     */
+    struct Way : public ReplaceableEntry {
+        /** Line address, including the status bits. */
+        Addr lineAddr = 0;
+        /** Item tracked by this entry, nullptr if the entry is free. */
+        SnoopItem* item = nullptr;
     };
+
     /**
      * HashMap of SnoopItems indexed by line address
      */
@@ -255,9 +305,26 @@ class SnoopFilter : public SimObject {
   private:
 
     /**
-     * Removes snoop filter items which have no requesters and no holders.
+     * Removes snoop filter items which have no requesters and no
+     * holders, releasing their entry in a bounded filter.
+     *
+     * @return True if the item was removed.
      */
-    void eraseIfNullEntry(SnoopFilterCache::iterator& sf_it);
+    bool eraseIfNullEntry(SnoopFilterCache::iterator& sf_it);
+
+    /**
+     * Find an entry for an item of a bounded filter, evicting the line
+     * of another entry of the set if there is no free one. The holders
+     * of the evicted line are queued for back-invalidation. Entries
+     * with a request in flight are never evicted, and if none of the
+     * set can be evicted the item is left untracked.
+     *
+     * @param sf_it Item that needs an entry.
+     */
+    void allocateWay(SnoopFilterCache::iterator& sf_it);
+
+    /** Whether the number of tracked lines is bounded. */
+    bool isBounded() const { return !ways.empty(); }
 
     /** Simple hash set of cached addresses. */
     SnoopFilterCache cachedLocations;
@@ -303,6 +370,17 @@ class SnoopFilter : public SimObject {
     /** Max capacity in terms of cache blocks tracked, for sanity checking */
     const unsigned maxEntryCount;
 
+    /** Associativity of a bounded filter. */
+    const unsigned assoc;
+    /** Number of sets of a bounded filter. */
+    const unsigned numSets;
+    /** Replacement policy of a bounded filter. */
+    BaseReplacementPolicy *replacementPolicy;
+    /** Entries of a bounded filter, empty if the filter is unbounded. */
+    std::vector<Way> ways;
+    /** Evicted lines waiting to be sent by the crossbar. */
+    std::vector<BackInvalidation> pendingBackInvalidations;
+
     /**
      * Use the lower bits of the address to keep track of the line status
      */
@@ -319,6 +397,10 @@ class SnoopFilter : public SimObject {
     Stats::Scalar totSnoops;
     Stats::Scalar hitSingleSnoops;
     Stats::Scalar hitMultiSnoops;
+
+    Stats::Scalar evictions;
+    Stats::Scalar backInvalidations;
+    Stats::Scalar overflows;
 };
 
 inline SnoopFilter::SnoopMask
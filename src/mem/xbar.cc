@@ -241,6 +241,30 @@ BaseXBar::Layer<SrcType, DstType>::failedTiming(SrcType* src_port,
     occupyLayer(busy_time);
 }
 
+template <typename SrcType, typename DstType>
+void
+BaseXBar::Layer<SrcType, DstType>::reserveTiming(Cycles cycles)
+{
+    if (state != BUSY) {
+        // a port that is retrying will find the layer busy and wait
+        // for its turn again
+        state = BUSY;
+        occupyLayer(xbar.clockEdge(cycles));
+        return;
+    }
+
+    // the layer should not be between a successful tryTiming and the
+    // corresponding succeededTiming or failedTiming
+    assert(releaseEvent.scheduled());
+
+    const Tick duration = xbar.cyclesToTicks(cycles);
+    xbar.reschedule(releaseEvent, releaseEvent.when() + duration);
+    occupancy += duration;
+
+    DPRINTF(BaseXBar, "The crossbar layer is now busy until tick %d\n",
+            releaseEvent.when());
+}
+
 template <typename SrcType, typename DstType>
 void
 BaseXBar::Layer<SrcType, DstType>::releaseLayer()
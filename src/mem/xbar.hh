@@ -151,6 +151,16 @@ class BaseXBar : public ClockedObject
          */
         void failedTiming(SrcType* src_port, Tick busy_time);
 
+        /**
+         * Occupy the layer with a transfer initiated by the crossbar
+         * itself, which can neither be refused nor retried. If the
+         * layer is busy, the transfer follows the current one, and
+         * the ports waiting for the layer are retried after both.
+         *
+         * @param cycles Number of cycles the transfer takes
+         */
+        void reserveTiming(Cycles cycles);
+
         void occupyLayer(Tick until);
 
         /**
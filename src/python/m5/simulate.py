@@ -68,6 +68,7 @@ _memory_modes = {
     "atomic" : objects.params.atomic,
     "timing" : objects.params.timing,
     "atomic_noncaching" : objects.params.atomic_noncaching,
+    "atomic_warming" : objects.params.atomic_warming,
     }
 
 _drain_manager = _m5.drain.DrainManager.instance()
@@ -309,6 +310,10 @@ def switchCpus(system, cpuList, verbose=True):
         if memory_mode == objects.params.atomic_noncaching:
             memWriteback(system)
             memInvalidate(system)
+        # Caches keep their blocks when warming, but memory needs to
+        # be up to date as it is the only copy written while warming.
+        elif memory_mode == objects.params.atomic_warming:
+            memWriteback(system)
 
         _changeMemoryMode(system, memory_mode)
 
@@ -371,6 +376,93 @@ def fork(simout="%(parent)s.f%(fork_seq)i"):
 
     return pid
 
+def preloadCheckpoint(ckpt_dir):
+    """Read a checkpoint ahead of instantiating the simulator.
+
+    The checkpoint file is parsed and all memory images are loaded
+    into host memory. A later instantiate() from the same checkpoint
+    uses them instead of reading the checkpoint again. This includes
+    processes forked after the call, e.g., using forkJobs(), which
+    share the loaded memory copy-on-write.
+
+    Arguments:
+      ckpt_dir -- Checkpoint directory.
+    """
+    _m5.core.preloadCheckpoint(ckpt_dir)
+
+def forkJobs(jobs, max_parallel=1, simout="%(parent)s/%(job)s"):
+    """Run a set of jobs in forked copies of the simulator.
+
+    This function must be called before instantiate(). The calling
+    process becomes a job server that forks a child for every job and
+    waits for it to complete, running at most max_parallel children
+    at the same time. Each child gets its output files redirected to a
+    new output directory and returns from this function with the name
+    of its job. The server exits once all jobs have completed, with an
+    error code if any of them failed.
+
+    Combined with preloadCheckpoint(), this allows a set of
+    simulations with different configurations to restore the same
+    checkpoint while reading it only once.
+
+    Output file formatting dictionary:
+      parent -- Path to the parent process's output directory.
+      job -- Name of the job.
+      pid -- PID of the child process.
+
+    Arguments:
+      jobs -- List of job names.
+
+    Keyword Arguments:
+      max_parallel -- Maximum number of jobs running at the same time.
+      simout -- New simulation output directory.
+
+    Return Value:
+      Name of the job to run in the child process.
+    """
+    from m5 import options
+
+    root = objects.Root.getInstance()
+    if root and root._ccObject:
+        raise RuntimeError("Jobs must be forked before instantiate()")
+
+    running = {}
+    failed = []
+
+    def wait_job():
+        pid, status = os.wait()
+        job = running.pop(pid)
+        if status != 0:
+            failed.append(job)
+        print("Job %s finished with status %d (%d running, %d failed)" % \
+              (job, status, len(running), len(failed)))
+
+    for job in jobs:
+        while len(running) >= max(max_parallel, 1):
+            wait_job()
+
+        sys.stdout.flush()
+        sys.stderr.flush()
+        pid = os.fork()
+        if pid == 0:
+            parent = options.outdir
+            options.outdir = simout % {
+                    "parent" : parent,
+                    "job" : job,
+                    "pid" : os.getpid(),
+                    }
+            _m5.core.setOutputDir(options.outdir)
+            return job
+
+        running[pid] = job
+
+    while running:
+        wait_job()
+
+    if failed:
+        print("Failed jobs: %s" % ", ".join(failed), file=sys.stderr)
+    sys.exit(1 if failed else 0)
+
 from _m5.core import disableAllListeners, listenersDisabled
 from _m5.core import listenersLoopbackOnly
 from _m5.core import curTick
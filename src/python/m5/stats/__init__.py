@@ -196,6 +196,34 @@ def _hdf5Factory(fn, chunking=10, desc=True, formulas=True):
 
     return _m5.stats.initHDF5(fn, chunking, desc, formulas)
 
+@_url_factory([ "delta", ])
+def _deltaFactory(fn, keyframes=64):
+    """Output stats in an append-only, delta-encoded binary format.
+
+    Only the stats whose values changed since the previous dump are
+    written, which keeps long runs with frequent periodic stat dumps
+    small. The output consists of the data file, an index (fn.idx)
+    with one fixed-size entry per dump, and a list of stat names
+    (fn.names). util/delta_stats.py reconstructs individual dumps.
+
+    A full keyframe is written every 'keyframes' dumps, which bounds
+    the number of records that have to be replayed to reconstruct a
+    dump. Setting it to 0 only writes the first dump in full.
+
+    Known limitations:
+      * Stat prerequisites are ignored, all displayed stats are stored.
+      * No support for forking.
+
+    Parameters:
+      * keyframes (unsigned): Dumps between full keyframes (default: 64)
+
+    Example:
+      delta://stats.delta?keyframes=16
+
+    """
+
+    return _m5.stats.initDelta(fn, keyframes)
+
 def addStatVisitor(url):
     """Add a stat visitor specified using a URL string
 
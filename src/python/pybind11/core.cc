@@ -58,6 +58,7 @@
 #include "base/random.hh"
 #include "base/socket.hh"
 #include "base/types.hh"
+#include "mem/physical.hh"
 #include "sim/core.hh"
 #include "sim/drain.hh"
 #include "sim/serialize.hh"
@@ -282,6 +283,11 @@ pybind_init_core(py::module &m_native)
         .def("getCheckpoint", [](const std::string &cpt_dir) {
             return new CheckpointIn(cpt_dir, pybindSimObjectResolver);
         })
+        .def("preloadCheckpoint", [](const std::string &cpt_dir) {
+            CheckpointIn::preload(cpt_dir);
+            CheckpointIn cp(cpt_dir, pybindSimObjectResolver);
+            PhysicalMemory::preloadStores(cp);
+        })
 
         ;
 
@@ -47,6 +47,7 @@
 #include "pybind11/stl.h"
 
 #include "base/statistics.hh"
+#include "base/stats/delta.hh"
 #include "base/stats/text.hh"
 #include "base/stats/sql.hh"
 #if USE_HDF5
@@ -88,6 +89,7 @@ pybind_init_stats(py::module &m_native)
 #if USE_HDF5
         .def("initHDF5", &Stats::initHDF5)
 #endif
+        .def("initDelta", &Stats::initDelta)
         .def("registerPythonStatsHandlers",
              &Stats::registerPythonStatsHandlers)
         .def("schedStatEvent", &Stats::schedStatEvent)
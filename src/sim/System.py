@@ -49,7 +49,7 @@ from m5.objects.DVFSHandler import *
 from m5.objects.SimpleMemory import *
 
 class MemoryMode(Enum): vals = ['invalid', 'atomic', 'timing',
-                                'atomic_noncaching']
+                                'atomic_noncaching', 'atomic_warming']
 
 class System(SimObject):
     type = 'System'
@@ -76,6 +76,26 @@ class System(SimObject):
     mmap_using_noreserve = Param.Bool(False, "mmap the backing store " \
                                           "without reserving swap")
 
+    # Memory images in checkpoints are normally written as a single
+    # gzip stream. The chunked format splits them into blocks that are
+    # compressed and restored in parallel, skips all-zero blocks, and
+    # maps uncompressed blocks straight into the backing store so that
+    # they are only read when the simulated system touches them. Only
+    # blocks stored uncompressed are mapped lazily, deflated blocks are
+    # always inflated in full on restore.
+    checkpoint_mem_chunked = Param.Bool(False, "Write memory checkpoints " \
+                                            "in the chunked format")
+    checkpoint_mem_block_size = Param.MemorySize('1MB', "Block size of " \
+                                                     "chunked memory " \
+                                                     "checkpoints")
+    checkpoint_mem_compression = Param.Int(1, "zlib level of chunked " \
+                                               "memory checkpoints " \
+                                               "(0 = uncompressed, lazily " \
+                                               "mapped on restore)")
+    checkpoint_mem_threads = Param.Unsigned(0, "Host threads used for " \
+                                                "chunked memory checkpoints " \
+                                                "(0 = all host cores)")
+
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
     # I/O bridge or cache
@@ -281,6 +281,13 @@ class ProbePointArg : public ProbePoint
                         listeners.end());
     }
 
+    /**
+     * @brief checks whether any ProbeListener is attached, so that call
+     *        sites can skip building arguments nobody will look at.
+     * @return true if the notify list is not empty.
+     */
+    bool hasListeners() const { return !listeners.empty(); }
+
     /**
      * @brief called at the ProbePoint call site, passes arg to each listener.
      * @param arg the argument to pass to each listener.
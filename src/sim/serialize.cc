@@ -270,9 +270,20 @@ CheckpointIn::dir()
     return currentDirectory;
 }
 
+IniFile *CheckpointIn::preloadedDb = nullptr;
+string CheckpointIn::preloadedDir;
+
 CheckpointIn::CheckpointIn(const string &cpt_dir, SimObjectResolver &resolver)
-    : db(new IniFile), objNameResolver(resolver), cptDir(setDir(cpt_dir))
+    : db(nullptr), ownsDb(true), objNameResolver(resolver),
+      cptDir(setDir(cpt_dir))
 {
+    if (preloadedDb && preloadedDir == cptDir) {
+        db = preloadedDb;
+        ownsDb = false;
+        return;
+    }
+
+    db = new IniFile;
     string filename = cptDir + "/" + CheckpointIn::baseFilename;
     if (!db->load(filename)) {
         fatal("Can't load checkpoint file '%s'\n", filename);
@@ -281,7 +292,26 @@ CheckpointIn::CheckpointIn(const string &cpt_dir, SimObjectResolver &resolver)
 
 CheckpointIn::~CheckpointIn()
 {
-    delete db;
+    if (ownsDb)
+        delete db;
+}
+
+void
+CheckpointIn::preload(const string &cpt_dir)
+{
+    const string dir = setDir(cpt_dir);
+    if (preloadedDb && preloadedDir == dir)
+        return;
+
+    IniFile *ini = new IniFile;
+    string filename = dir + "/" + CheckpointIn::baseFilename;
+    if (!ini->load(filename)) {
+        fatal("Can't load checkpoint file '%s'\n", filename);
+    }
+
+    // Earlier CheckpointIn objects may still refer to the old file
+    preloadedDb = ini;
+    preloadedDir = dir;
 }
 
 bool
@@ -315,6 +345,12 @@ CheckpointIn::sectionExists(const string &section)
     return db->sectionExists(section);
 }
 
+void
+CheckpointIn::getSectionNames(vector<string> &list) const
+{
+    db->getSectionNames(list);
+}
+
 void
 objParamIn(CheckpointIn &cp, const string &name, SimObject * &param)
 {
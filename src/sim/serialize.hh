@@ -75,14 +75,29 @@ class CheckpointIn
 
     IniFile *db;
 
+    /** Is db owned by this object or shared with preload()? */
+    bool ownsDb;
+
     SimObjectResolver &objNameResolver;
 
+    /** Checkpoint parsed ahead of time by preload(). */
+    static IniFile *preloadedDb;
+    static std::string preloadedDir;
+
   public:
     CheckpointIn(const std::string &cpt_dir, SimObjectResolver &resolver);
     ~CheckpointIn();
 
     const std::string cptDir;
 
+    /**
+     * Parse the checkpoint in cpt_dir ahead of time. Every
+     * CheckpointIn created for the same directory afterwards,
+     * including those in processes forked after this call, shares
+     * the parsed checkpoint instead of reading it again.
+     */
+    static void preload(const std::string &cpt_dir);
+
     bool find(const std::string &section, const std::string &entry,
               std::string &value);
 
@@ -92,6 +107,7 @@ class CheckpointIn
 
     bool entryExists(const std::string &section, const std::string &entry);
     bool sectionExists(const std::string &section);
+    void getSectionNames(std::vector<std::string> &list) const;
 
     // The following static functions have to do with checkpoint
     // creation rather than restoration.  This class makes a handy
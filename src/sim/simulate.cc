@@ -38,6 +38,7 @@
 
 #include "base/logging.hh"
 #include "base/pollevent.hh"
+#include "base/statistics.hh"
 #include "base/types.hh"
 #include "sim/async.hh"
 #include "sim/eventq_impl.hh"
@@ -64,8 +65,12 @@ Event *doSimLoop(EventQueue *);
  * repeated until the simulation terminates.
  */
 static void
-thread_loop(EventQueue *queue)
+thread_loop(EventQueue *queue, uint32_t index)
 {
+    // Sharded stats are updated in the shard of the event queue this
+    // thread is simulating.
+    Stats::curShard = index;
+
     while (true) {
         threadBarrier->wait();
         doSimLoop(queue);
@@ -91,11 +96,16 @@ simulate(Tick num_cycles)
     if (!threads_initialized) {
         threadBarrier = new Barrier(numMainEventQueues);
 
+        // All stats have been created at this point, give sharded
+        // stats a private shard for every simulation thread.
+        Stats::setNumShards(numMainEventQueues);
+
         // the main thread (the one we're currently running on)
         // handles queue 0, so we only need to allocate new threads
         // for queues 1..N-1.  We'll call these the "subordinate" threads.
         for (uint32_t i = 1; i < numMainEventQueues; i++) {
-            threads.push_back(new std::thread(thread_loop, mainEventQueue[i]));
+            threads.push_back(
+                new std::thread(thread_loop, mainEventQueue[i], i));
         }
 
         threads_initialized = true;
@@ -133,15 +133,19 @@ class System : public SimObject, public PCEventScope
     /**
      * Is the system in atomic mode?
      *
-     * There are currently two different atomic memory modes:
-     * 'atomic', which supports caches; and 'atomic_noncaching', which
-     * bypasses caches. The latter is used by hardware virtualized
-     * CPUs. SimObjects are expected to use Port::sendAtomic() and
-     * Port::recvAtomic() when accessing memory in this mode.
+     * There are currently three different atomic memory modes:
+     * 'atomic', which supports caches; 'atomic_noncaching', which
+     * bypasses caches; and 'atomic_warming', which bypasses caches
+     * but lets them track the accessed addresses. The second is used
+     * by hardware virtualized CPUs, the last one to warm caches while
+     * fast-forwarding. SimObjects are expected to use
+     * Port::sendAtomic() and Port::recvAtomic() when accessing
+     * memory in this mode.
      */
     bool isAtomicMode() const {
         return memoryMode == Enums::atomic ||
-            memoryMode == Enums::atomic_noncaching;
+            memoryMode == Enums::atomic_noncaching ||
+            memoryMode == Enums::atomic_warming;
     }
 
     /**
@@ -161,7 +165,22 @@ class System : public SimObject, public PCEventScope
      * accesses, which is required for hardware virtualization.
      */
     bool bypassCaches() const {
-        return memoryMode == Enums::atomic_noncaching;
+        return memoryMode == Enums::atomic_noncaching ||
+            memoryMode == Enums::atomic_warming;
+    }
+
+    /**
+     * Should caches be functionally warmed?
+     *
+     * In this mode, caches are bypassed like in 'atomic_noncaching'
+     * mode, but the first-level caches feed the address of every
+     * access through a packet-less path that updates tags,
+     * replacement and coherence state in the whole cache
+     * hierarchy. Cache contents are refreshed from memory when
+     * leaving this mode.
+     */
+    bool isWarmingMode() const {
+        return memoryMode == Enums::atomic_warming;
     }
     /** @} */
 
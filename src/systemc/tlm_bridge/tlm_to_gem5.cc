@@ -89,7 +89,7 @@ payload2packet(MasterID masterId, tlm::tlm_generic_payload &trans)
     }
 
     Request::Flags flags;
-    auto req = std::make_shared<Request>(
+    auto req = Request::create(
         trans.get_address(), trans.get_data_length(), flags, masterId);
 
     /*
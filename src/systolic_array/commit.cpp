@@ -177,7 +177,7 @@ void Commit::localSpadCallback(PacketPtr pkt) {
                      accel.dataType);
     }
     // Send the write request.
-    auto req = std::make_shared<Request>(
+    auto req = Request::create(
         pkt->getAddr(), pkt->getSize(), 0, localSpadMasterId);
     req->setContext(accel.getContextId());
     PacketPtr pkt = new Packet(req, MemCmd::WriteReq);
@@ -209,7 +209,7 @@ void Commit::queueCommitRequest(int start, int elemsToWrite) {
   if (accel.accumResults) {
     // If we need to accumulate results, read the previous results first.
     auto req =
-        std::make_shared<Request>(addr, reqSize, 0, localSpadMasterId);
+        Request::create(addr, reqSize, 0, localSpadMasterId);
     req->setContext(accel.getContextId());
     pkt = new Packet(req, MemCmd::ReadReq);
     pkt->allocate();
@@ -224,7 +224,7 @@ void Commit::queueCommitRequest(int start, int elemsToWrite) {
     // Directly write to the scratchpad if we don't need to accumulate the
     // results.
     auto req =
-        std::make_shared<Request>(addr, reqSize, 0, localSpadMasterId);
+        Request::create(addr, reqSize, 0, localSpadMasterId);
     req->setContext(accel.getContextId());
     pkt = new Packet(req, MemCmd::WriteReq);
     pkt->dataDynamic(data);
@@ -52,7 +52,7 @@ void Fetch::fetch() {
     DPRINTF(SystolicFetch, "Constructed a line for halo regions.\n");
   } else {
     auto req =
-        std::make_shared<Request>(addr, accel.lineSize, 0, localSpadMasterId);
+        Request::create(addr, accel.lineSize, 0, localSpadMasterId);
     req->setContext(accel.getContextId());
     PacketPtr pkt = new Packet(req, MemCmd::ReadReq);
     pkt->allocate();
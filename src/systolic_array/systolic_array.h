@@ -197,7 +197,7 @@ class SystolicArray : public Gem5Datapath {
     for (int i = 0; i < size; i++)
       data[i] = 0x13;
     auto req =
-        std::make_shared<Request>(finish_flag, size, flags, cacheMasterId);
+        Request::create(finish_flag, size, flags, cacheMasterId);
     req->setContext(context_id);  // Only needed for prefetching.
     MemCmd::Command cmd = MemCmd::WriteReq;
     PacketPtr pkt = new Packet(req, cmd);
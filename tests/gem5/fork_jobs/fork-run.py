@@ -0,0 +1,95 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Take a checkpoint, then restore it in the jobs of the --fork-jobs
+# file through Simulation.forkJobs() without giving --checkpoint-dir,
+# so that the checkpoint is only found in the output directory of the
+# process that preloaded it. Every job checks that it restored that
+# checkpoint with its own options and prints what it restored.
+
+from __future__ import print_function
+
+import optparse
+import os
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common import Options
+from common import Simulation
+
+parser = optparse.OptionParser()
+Options.addCommonOptions(parser)
+(options, args) = parser.parse_args()
+
+clocks = { 'slow' : '1GHz', 'fast' : '2GHz' }
+
+def build(options):
+    system = System(physmem = SimpleMemory(range = AddrRange('32MB')),
+                    membus = SystemXBar(),
+                    mem_ranges = [ AddrRange('32MB') ])
+    system.voltage_domain = VoltageDomain()
+    system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                       voltage_domain = system.voltage_domain)
+    system.system_port = system.membus.slave
+    system.physmem.port = system.membus.master
+    return Root(full_system = False, system = system)
+
+# The sweep looks for the checkpoint in its own output directory
+stage = m5.forkJobs([ 'checkpoint', 'sweep' ])
+sweep_dir = os.path.join(os.path.dirname(m5.options.outdir), 'sweep')
+
+if stage == 'checkpoint':
+    build(options)
+    m5.instantiate()
+    m5.simulate(1000000)
+    m5.checkpoint(os.path.join(sweep_dir, 'cpt.%d' % m5.curTick()))
+    sys.exit(0)
+
+# Only returns in the jobs
+(options, args) = Simulation.forkJobs(parser, options)
+job = os.path.basename(m5.options.outdir)
+
+if options.checkpoint_dir != sweep_dir:
+    print('%s: looking for checkpoints in %s instead of %s' %
+          (job, options.checkpoint_dir, sweep_dir))
+    sys.exit(1)
+
+cpt_starttick, checkpoint_dir = \
+    Simulation.findCptDir(options, options.checkpoint_dir, None)
+
+build(options)
+m5.instantiate(checkpoint_dir)
+
+if m5.curTick() != cpt_starttick or options.sys_clock != clocks[job]:
+    print('%s: restored tick %d at %s, expected tick %d at %s' %
+          (job, m5.curTick(), options.sys_clock, cpt_starttick, clocks[job]))
+    sys.exit(1)
+
+print('%s: restored %s at tick %d with clock %s' %
+      (job, os.path.basename(checkpoint_dir), m5.curTick(), options.sys_clock))
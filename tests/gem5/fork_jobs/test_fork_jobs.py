@@ -0,0 +1,43 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Restore a checkpoint in jobs forked by Simulation.forkJobs() without
+--checkpoint-dir, which have to find the checkpoint preloaded in the
+output directory of their parent.
+'''
+from testlib import *
+
+gem5_verify_config(
+    name='fork_jobs_default_checkpoint_dir',
+    verifiers=tuple(verifier.MatchRegex(
+        r'^%s: restored cpt\.1000000 at tick 1000000 with clock %s$' %
+        (job, clock)) for job, clock in (('slow', '1GHz'), ('fast', '2GHz'))),
+    config=joinpath(getcwd(), 'fork-run.py'),
+    config_args=[ '--checkpoint-restore=1',
+                  '--fork-jobs=' + joinpath(getcwd(), 'jobs.txt') ],
+    valid_isas=(constants.null_tag,),
+)
@@ -0,0 +1,107 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Read one range of lines through the Ruby caches, dump the statistics,
+# read another range and dump them again. Each dump writes the hot lines
+# of its window and starts a new one, so the first window may only list
+# lines of the first range and the second one lines of the second.
+
+from __future__ import print_function
+
+import optparse
+import os
+import re
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common import Options
+from ruby import Ruby
+
+first, second = (0x0, 0xfff), (0x10000, 0x10fff)
+
+parser = optparse.OptionParser()
+Options.addNoISAOptions(parser)
+Ruby.define_options(parser)
+(options, args) = parser.parse_args([ '--num-cpus=1', '--ruby-hot-lines' ])
+
+cpus = [ PyTrafficGen() ]
+
+system = System(cpu = cpus,
+                clk_domain = SrcClockDomain(clock = options.sys_clock),
+                mem_ranges = [ AddrRange(options.mem_size) ])
+
+Ruby.create_system(options, False, system)
+
+system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
+system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                   voltage_domain = system.voltage_domain)
+system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
+                                        voltage_domain = system.voltage_domain)
+
+cpus[0].port = system.ruby._cpu_ports[0].slave
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+m5.instantiate()
+
+# Idle between the ranges, so that no miss of the first range completes
+# after the first dump
+window = 20000000
+tgen = cpus[0]
+tgen.start([ tgen.createLinear(window // 2, first[0], first[1], 64,
+                               1000, 1000, 100, 0),
+             tgen.createIdle(window),
+             tgen.createLinear(window // 2, second[0], second[1], 64,
+                               1000, 1000, 100, 0),
+             tgen.createIdle(window) ])
+
+for i in range(2):
+    m5.simulate(window)
+    m5.stats.dump()
+
+with open(os.path.join(m5.options.outdir,
+                       'system.ruby.hot_lines.txt')) as f:
+    windows = re.split(r'-+ Begin Hot Lines \d+ .*\n', f.read())[1:]
+
+if len(windows) != 2:
+    print('Expected 2 hot line windows, got %d' % len(windows))
+    sys.exit(1)
+
+for lines, (low, high) in zip(windows, [ first, second ]):
+    addrs = [ int(a) for a in re.findall(r'^block_address \| \S+ % \d+ \d+ '
+                                         r'\| (\d+) ', lines, re.M) ]
+    if not addrs:
+        print('No hot lines in a window')
+        sys.exit(1)
+    for addr in addrs:
+        if addr < low or addr > high:
+            print('Hot line %#x outside of the window range %#x-%#x' %
+                  (addr, low, high))
+            sys.exit(1)
@@ -0,0 +1,159 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Run the same Ruby system with all controllers on one event queue, and
+# twice with the CPUs and L1 controllers spread over two event queues.
+# Messages between the queues are handed over at quantum boundaries in a
+# fixed order, so the two partitioned runs have to end up with the same
+# statistics. Each generator only touches its own lines, so the requests
+# it makes and the hits and misses of its L1 can't depend on how the
+# controllers are spread over the event queues either.
+
+from __future__ import print_function
+
+import optparse
+import os
+import re
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common import Options
+from ruby import Ruby
+
+jobs = [ 'single', 'partitioned', 'partitioned-again' ]
+
+# The jobs run one after the other, as they all dump into the statistics
+# file of the parent, and the last one compares them.
+job = m5.forkJobs(jobs, max_parallel = 1)
+parent_dir = os.path.dirname(m5.options.outdir)
+job_stats = 'job-stats.txt'
+
+parser = optparse.OptionParser()
+Options.addNoISAOptions(parser)
+Ruby.define_options(parser)
+
+partitions = 1 if job == 'single' else 2
+(options, args) = parser.parse_args([ '--num-cpus=4',
+                                      '--l1d_size=2kB',
+                                      '--ruby-partitions=%d' % partitions ])
+
+cpus = [ PyTrafficGen() for i in range(options.num_cpus) ]
+
+system = System(cpu = cpus,
+                clk_domain = SrcClockDomain(clock = options.sys_clock),
+                mem_ranges = [ AddrRange(options.mem_size) ])
+
+Ruby.create_system(options, False, system)
+
+system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
+system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                   voltage_domain = system.voltage_domain)
+system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
+                                        voltage_domain = system.voltage_domain)
+
+for cpu, seq in zip(cpus, system.ruby._cpu_ports):
+    cpu.port = seq.slave
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+Ruby.partition_system(options, system, root)
+
+m5.instantiate()
+
+# Every generator reads and then writes its own 8kB, which doesn't fit
+# its L1. The fixed periods are long enough for the sequencers to never
+# push back, and the final idle time lets the last requests complete.
+phase = 5000000
+for i, cpu in enumerate(cpus):
+    start = i * 0x10000
+    cpu.start([ cpu.createLinear(phase, start, start + 8191, 64,
+                                 20000, 20000, 100, 0),
+                cpu.createLinear(phase, start, start + 8191, 64,
+                                 20000, 20000, 0, 0),
+                cpu.createIdle(phase) ])
+
+m5.simulate(3 * phase)
+m5.stats.dump()
+
+def read_blocks():
+    with open(os.path.join(parent_dir, m5.options.stats_file)) as f:
+        return re.split(r'-+ Begin Simulation Statistics -+\n', f.read())[1:]
+
+def parse_stats(block):
+    stats = {}
+    for line in block.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and not line.startswith('-'):
+            stats[fields[0]] = fields[1]
+    return stats
+
+# The dump of this job is the last one in the statistics file so far
+with open(os.path.join(m5.options.outdir, job_stats), 'w') as f:
+    f.write(read_blocks()[-1])
+
+if job != jobs[-1]:
+    sys.exit(0)
+
+runs = {}
+for name in jobs:
+    with open(os.path.join(parent_dir, name, job_stats)) as f:
+        runs[name] = parse_stats(f.read())
+
+# Everything but the host time and memory has to match between the
+# partitioned runs
+first, second = runs['partitioned'], runs['partitioned-again']
+differ = sorted(name for name in set(first) | set(second)
+                if 'host' not in name and first.get(name) != second.get(name))
+if differ:
+    print('The partitioned runs differ in %d statistics, e.g.:' % len(differ))
+    for name in differ[:10]:
+        print('  %s: %s != %s' % (name, first.get(name), second.get(name)))
+    sys.exit(1)
+
+expected = []
+for i in range(options.num_cpus):
+    expected += [ 'system.cpu%d.%s' % (i, stat) for stat in
+                  ('numPackets', 'numRetries', 'totalReads', 'totalWrites',
+                   'bytesRead', 'bytesWritten') ]
+    expected += [ 'system.ruby.l1_cntrl%d.L1Dcache.%s' % (i, stat) for stat in
+                  ('demand_hits', 'demand_misses') ]
+
+single = runs['single']
+for name in expected:
+    if name not in single or name not in first:
+        print('Statistic %s is missing' % name)
+        sys.exit(1)
+    if single[name] != first[name]:
+        print('%s is %s with one event queue and %s with two' %
+              (name, single[name], first[name]))
+        sys.exit(1)
+
+if int(float(single['system.cpu0.numPackets'])) == 0:
+    print('The generators made no requests')
+    sys.exit(1)
@@ -0,0 +1,137 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Let two traffic generators share lines through the Ruby caches, take a
+# checkpoint holding a cache snapshot, and restore it in a second run.
+# Restoring installs the snapshot entries and checks that the caches and
+# directories agree on a legal state, which is fatal if they don't. The
+# second run then checkpoints again, and the entries it saves, with their
+# states and data, have to be the ones it restored. A third run restores
+# the checkpoint into larger caches, which the snapshot doesn't fit, and
+# has to fall back to replaying the cache trace.
+
+from __future__ import print_function
+
+import gzip
+import optparse
+import os
+import re
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common import Options
+from ruby import Ruby
+
+jobs = [ 'checkpoint', 'restore', 'resize' ]
+
+# The jobs run one after the other, so the later ones find the checkpoint
+# in the output directory of the first job.
+job = m5.forkJobs(jobs, max_parallel = 1)
+checkpoint_dir = os.path.join(os.path.dirname(m5.options.outdir),
+                              jobs[0], 'cpt')
+snapshot_file = 'system.ruby.snapshot.gz'
+
+def read_snapshot(cpt_dir):
+    with gzip.open(os.path.join(cpt_dir, snapshot_file), 'rb') as f:
+        return f.read()
+
+parser = optparse.OptionParser()
+Options.addNoISAOptions(parser)
+Ruby.define_options(parser)
+
+# Small caches, so that the generators also cause evictions
+l1d_size = '4kB' if job == 'resize' else '2kB'
+(options, args) = parser.parse_args([ '--num-cpus=2',
+                                      '--l1d_size=' + l1d_size,
+                                      '--ruby-cache-snapshot' ])
+
+cpus = [ PyTrafficGen() for i in range(options.num_cpus) ]
+
+system = System(cpu = cpus,
+                clk_domain = SrcClockDomain(clock = options.sys_clock),
+                mem_ranges = [ AddrRange(options.mem_size) ])
+
+Ruby.create_system(options, False, system)
+
+system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
+system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                   voltage_domain = system.voltage_domain)
+system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
+                                        voltage_domain = system.voltage_domain)
+
+for cpu, seq in zip(cpus, system.ruby._cpu_ports):
+    cpu.port = seq.slave
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+if job == 'checkpoint':
+    m5.instantiate()
+
+    # Reads and writes to the same 8kB from both generators
+    for cpu in cpus:
+        cpu.start([ cpu.createLinear(10000000, 0, 8191, 64, 1000, 1000,
+                                     50, 0) ])
+
+    m5.simulate(10000000)
+    m5.checkpoint(checkpoint_dir)
+
+    if not os.path.exists(os.path.join(checkpoint_dir, snapshot_file)):
+        print('The checkpoint holds no cache snapshot')
+        sys.exit(1)
+else:
+    tracing = m5.defines.TRACING_ON
+    if tracing:
+        m5.debug.flags['RubyCacheTrace'].enable()
+        m5.trace.output('restore.trace')
+
+    m5.instantiate(checkpoint_dir)
+
+    # The generators aren't started, so the caches keep what was restored
+    m5.simulate(1000000)
+
+    if tracing:
+        with open(os.path.join(m5.options.outdir, 'restore.trace')) as f:
+            restored = re.search(r'Restored (\d+) snapshot entries', f.read())
+        if job == 'restore' and (not restored or int(restored.group(1)) == 0):
+            print('The caches were not restored from the snapshot')
+            sys.exit(1)
+        if job == 'resize' and restored:
+            print('The snapshot was restored into caches of another size')
+            sys.exit(1)
+
+    if job == 'restore':
+        # The snapshot lists the entries of every controller in set and
+        # way order, so the same states and data give the same image.
+        restore_dir = os.path.join(m5.options.outdir, 'cpt')
+        m5.checkpoint(restore_dir)
+        if read_snapshot(restore_dir) != read_snapshot(checkpoint_dir):
+            print('The restored cache entries differ from the checkpointed '
+                  'ones')
+            sys.exit(1)
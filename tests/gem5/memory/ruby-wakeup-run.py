@@ -0,0 +1,117 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Run the Ruby random tester on tiny caches with random message delays.
+# The controllers only look at the in_ports whose buffers marked
+# themselves pending, so a message that doesn't mark its buffer, e.g.,
+# one woken up after a stall, is never handled and the tester reports a
+# deadlock. The run also samples the host time of the transitions, which
+# has to be reported for every type of controller that made any.
+
+from __future__ import print_function
+
+import optparse
+import os
+import re
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common import Options
+from ruby import Ruby
+
+parser = optparse.OptionParser()
+Options.addNoISAOptions(parser)
+Ruby.define_options(parser)
+(options, args) = parser.parse_args([ '--num-cpus=4' ])
+
+# Small caches cause races between requests and writebacks, which the
+# protocols resolve by stalling messages
+options.l1d_size = '256B'
+options.l1i_size = '256B'
+options.l2_size = '512B'
+options.l3_size = '1kB'
+options.l1d_assoc = 2
+options.l1i_assoc = 2
+options.l2_assoc = 2
+options.l3_assoc = 2
+
+tester = RubyTester(checks_to_complete = 2000, wakeup_frequency = 10)
+
+system = System(cpu = tester, mem_ranges = [ AddrRange(options.mem_size) ])
+system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
+system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                   voltage_domain = system.voltage_domain)
+
+Ruby.create_system(options, False, system)
+
+system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
+                                        voltage_domain = system.voltage_domain)
+system.ruby.randomization = True
+system.ruby.transition_sample_period = 7
+
+tester.num_cpus = len(system.ruby._cpu_ports)
+for ruby_port in system.ruby._cpu_ports:
+    if ruby_port.support_data_reqs and ruby_port.support_inst_reqs:
+        tester.cpuInstDataPort = ruby_port.slave
+    elif ruby_port.support_data_reqs:
+        tester.cpuDataPort = ruby_port.slave
+    elif ruby_port.support_inst_reqs:
+        tester.cpuInstPort = ruby_port.slave
+    ruby_port.no_retry_on_stall = True
+    ruby_port.using_ruby_tester = True
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+m5.instantiate()
+
+exit_event = m5.simulate()
+if exit_event.getCause() != 'Ruby Tester completed':
+    print('The tester did not complete: %s' % exit_event.getCause())
+    sys.exit(1)
+
+m5.stats.dump()
+
+with open(os.path.join(m5.options.outdir, m5.options.stats_file)) as f:
+    stats = f.read()
+
+# <Controller>.<State>.<Event> counts the transitions of a type of
+# controller and <Controller>.<State>.<Event>.host_ns their host time
+name = r'^system\.ruby\.(\w+_Controller)\.\w+\.\w+'
+transitions = set(re.findall(name + r'\s', stats, re.M))
+sampled = set(re.findall(name + r'\.host_ns\s', stats, re.M))
+
+if not transitions:
+    print('No transitions were counted')
+    sys.exit(1)
+
+for cntrl in sorted(transitions - sampled):
+    print('No host time was sampled for the transitions of %s' % cntrl)
+if transitions != sampled:
+    sys.exit(1)
@@ -0,0 +1,101 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Share a line between two caches behind a snoop filter that tracks two
+# lines, bring two more lines into a third cache, and check that making
+# room for the last one back-invalidates the shared line in both of its
+# holders, and only in them.
+
+from __future__ import print_function
+
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common.Caches import *
+
+shared, other, last = 0x1000, 0x2000, 0x3000
+
+# The generators read a single line each after idling for the given
+# time, so that the lines are brought in one after the other
+reads = [ [ (0, shared) ],
+          [ (10000000, shared) ],
+          [ (20000000, other), (10000000, last) ] ]
+
+tgens = [ PyTrafficGen() for r in reads ]
+
+system = System(tgen = tgens,
+                physmem = SimpleMemory(),
+                membus = SystemXBar())
+system.voltage_domain = VoltageDomain()
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain = system.voltage_domain)
+
+# A single set of two entries, so that the shared line, being the
+# least recently allocated, is the one evicted for the last line
+system.toL2Bus = L2XBar(snoop_filter = SnoopFilter(
+    entries = 2, assoc = 2, replacement_policy = LRURP()))
+system.l2c = L2Cache(size = '16kB', assoc = 4)
+system.l2c.cpu_side = system.toL2Bus.master
+system.l2c.mem_side = system.membus.slave
+
+for tgen in tgens:
+    tgen.l1c = L1Cache(size = '2kB', assoc = 2)
+    tgen.l1c.cpu_side = tgen.port
+    tgen.l1c.mem_side = system.toL2Bus.slave
+
+system.system_port = system.membus.slave
+system.physmem.port = system.membus.master
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+m5.instantiate()
+
+def trace(tgen, tgen_reads):
+    for idle, addr in tgen_reads:
+        yield tgen.createIdle(idle)
+        yield tgen.createLinear(1000000, addr, addr + 63, 64, 1000, 1000,
+                                100, 64)
+
+for tgen, tgen_reads in zip(tgens, reads):
+    tgen.start(trace(tgen, tgen_reads))
+
+m5.simulate(50000000)
+
+def holds(tgen, addr):
+    return any(int(line.split()[0], 0) == addr
+               for line in tgen.l1c.tagState().splitlines())
+
+expected = [ [], [], [ other, last ] ]
+for tgen, lines in zip(tgens, expected):
+    for addr in [ shared, other, last ]:
+        if holds(tgen, addr) != (addr in lines):
+            print('%s %s %#x' % (tgen.l1c.path(),
+                  'holds' if addr not in lines else 'lost', addr))
+            sys.exit(1)
@@ -67,3 +67,24 @@ gem5_verify_config(
     config_args = [],
     valid_isas=(constants.null_tag,),
 )
+
+# These configs check the state they end up in themselves and return
+# non-zero if it is wrong, so they need no verifiers
+self_checking_configs = [
+        ('warming_tags', 'warming-run.py'),
+        ('snoop_filter_back_invalidation', 'snoop-filter-run.py'),
+        ('ruby_cache_snapshot', 'ruby-snapshot-run.py'),
+        ('ruby_hot_lines_windows', 'ruby-hot-lines-run.py'),
+        ('ruby_partitions_match', 'ruby-partitions-run.py'),
+        ('ruby_pending_wakeups', 'ruby-wakeup-run.py'),
+        ('trace_player_replay', 'trace-player-run.py'),
+        ]
+
+for name, config in self_checking_configs:
+    gem5_verify_config(
+        name=name,
+        verifiers=(),
+        config=joinpath(getcwd(), config),
+        config_args = [],
+        valid_isas=(constants.null_tag,),
+        )
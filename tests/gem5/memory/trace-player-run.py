@@ -0,0 +1,143 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Record a packet trace of a traffic generator with a MemTraceProbe, and
+# replay it with the TracePlayer into two caches, one holding all the
+# lines of the trace and one holding half of them. The generator reads
+# 16kB line by line, writes them and reads them again, so the replay has
+# to find 512 reads and 256 writes. The large cache only misses on the
+# first reads, while the small one misses on every access.
+
+from __future__ import print_function
+
+import os
+import re
+import sys
+
+import m5
+from m5.objects import *
+
+if not hasattr(m5.objects, 'TracePlayer'):
+    m5.fatal("protobuf required for the trace player test")
+
+jobs = [ 'record', 'replay' ]
+
+# The replay needs the trace of the first job, and reads its statistics
+# from the file of the parent that both jobs dump into
+job = m5.forkJobs(jobs, max_parallel = 1)
+parent_dir = os.path.dirname(m5.options.outdir)
+trace_file = os.path.join(parent_dir, jobs[0], 'accesses.trc.gz')
+
+line_size = 64
+region = 16384
+lines = region // line_size
+phase = 1000000
+
+clk_domain = SrcClockDomain(clock = '1GHz', voltage_domain = VoltageDomain())
+
+if job == 'record':
+    system = System(cpu = PyTrafficGen(), physmem = SimpleMemory(),
+                    membus = IOXBar(width = 16), clk_domain = clk_domain)
+
+    system.monitor = CommMonitor()
+    system.monitor.trace = MemTraceProbe(trace_file = 'accesses.trc.gz')
+
+    system.cpu.port = system.monitor.slave
+    system.monitor.master = system.membus.slave
+    system.system_port = system.membus.slave
+    system.physmem.port = system.membus.master
+
+    root = Root(full_system = False, system = system)
+    root.system.mem_mode = 'timing'
+
+    m5.instantiate()
+
+    tgen = system.cpu
+    tgen.start([ tgen.createLinear(phase, 0, region - 1, line_size,
+                                   1000, 1000, read_percent, region)
+                 for read_percent in (100, 0, 100) ])
+    m5.simulate(3 * phase + 1)
+    sys.exit(0)
+
+def make_memory():
+    return SimpleMemory(null = True, in_addr_map = False,
+                        conf_table_reported = False)
+
+system = System(mem_mode = 'atomic', clk_domain = clk_domain)
+system.player = TracePlayer(trace_file = trace_file)
+
+system.large = Cache(size = '32kB', assoc = 8, tag_latency = 1,
+                     data_latency = 1, response_latency = 1, mshrs = 16,
+                     tgts_per_mshr = 8)
+system.small = Cache(size = '8kB', assoc = 2, tag_latency = 1,
+                     data_latency = 1, response_latency = 1, mshrs = 16,
+                     tgts_per_mshr = 8)
+system.large_mem = make_memory()
+system.small_mem = make_memory()
+system.player.port = system.large.cpu_side
+system.player.port = system.small.cpu_side
+system.large.mem_side = system.large_mem.port
+system.small.mem_side = system.small_mem.port
+
+system.sysmem = make_memory()
+system.system_port = system.sysmem.port
+
+root = Root(full_system = False, system = system)
+
+m5.instantiate()
+
+exit_event = m5.simulate()
+if exit_event.getCause() != 'end of trace reached':
+    print('The replay ended early: %s' % exit_event.getCause())
+    sys.exit(1)
+
+m5.stats.dump()
+
+# The dump of this job is the last one in the statistics file
+with open(os.path.join(parent_dir, m5.options.stats_file)) as f:
+    block = re.split(r'-+ Begin Simulation Statistics -+\n', f.read())[-1]
+stats = {}
+for line in block.splitlines():
+    fields = line.split()
+    if len(fields) >= 2:
+        stats[fields[0]] = fields[1]
+
+expected = {
+    'system.player.num_reads' : 2 * lines,
+    'system.player.num_writes' : lines,
+    'system.large.overall_accesses::total' : 3 * lines,
+    'system.large.overall_misses::total' : lines,
+    'system.small.overall_accesses::total' : 3 * lines,
+    'system.small.overall_misses::total' : 3 * lines,
+}
+
+for name, value in sorted(expected.items()):
+    if name not in stats:
+        print('Statistic %s is missing' % name)
+        sys.exit(1)
+    if int(float(stats[name])) != value:
+        print('%s is %s instead of %d' % (name, stats[name], value))
+        sys.exit(1)
@@ -0,0 +1,111 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+# Run the same memory test traffic through a two-level cache hierarchy
+# once in the atomic memory mode and once in the atomic_warming mode,
+# and check that functional warming leaves every cache with the same
+# blocks in the same coherence states as atomic accesses do.
+
+from __future__ import print_function
+
+import os
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+from common.Caches import *
+
+nb_cores = 4
+modes = [ 'atomic', 'atomic_warming' ]
+
+# Each job runs in a forked copy of the simulator with its own output
+# directory. They run one after the other, so the last one can compare
+# its state with the one of the first.
+mode = m5.forkJobs(modes, max_parallel = 1)
+
+# Small caches so that the traffic causes evictions at both levels
+cpus = [ MemTest(max_loads = 2e4, progress_interval = 0,
+                 percent_functional = 0, percent_uncacheable = 0)
+         for i in range(nb_cores) ]
+
+system = System(cpu = cpus,
+                physmem = SimpleMemory(),
+                membus = SystemXBar())
+system.voltage_domain = VoltageDomain()
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain = system.voltage_domain)
+
+system.toL2Bus = L2XBar()
+system.l2c = L2Cache(size = '16kB', assoc = 4)
+system.l2c.cpu_side = system.toL2Bus.master
+system.l2c.mem_side = system.membus.slave
+
+for cpu in cpus:
+    cpu.l1c = L1Cache(size = '2kB', assoc = 2)
+    cpu.l1c.cpu_side = cpu.port
+    cpu.l1c.mem_side = system.toL2Bus.slave
+    cpu.l1c.warm_downstream = system.l2c
+
+system.system_port = system.membus.slave
+system.physmem.port = system.membus.master
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = mode
+
+m5.instantiate()
+exit_event = m5.simulate()
+if exit_event.getCause() != 'maximum number of loads reached':
+    print('Unexpected exit: %s' % exit_event.getCause())
+    sys.exit(1)
+
+caches = [ system.l2c ] + [ cpu.l1c for cpu in cpus ]
+state = ''.join('%s\n%s' % (cache.path(), cache.tagState())
+                for cache in caches)
+
+state_file = 'tags.txt'
+with open(os.path.join(m5.options.outdir, state_file), 'w') as f:
+    f.write(state)
+
+if mode == modes[-1]:
+    reference = os.path.join(os.path.dirname(m5.options.outdir),
+                             modes[0], state_file)
+    with open(reference) as f:
+        expected = f.read()
+
+    if state.count('\n') <= len(caches):
+        print('No blocks were warmed')
+        sys.exit(1)
+
+    if state != expected:
+        for got, want in zip(state.splitlines(), expected.splitlines()):
+            if got != want:
+                print('Warmed state %r, atomic state %r' % (got, want))
+                break
+        print('Functional warming and atomic accesses disagree')
+        sys.exit(1)
@@ -0,0 +1,138 @@
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Dump the stats of a small memory test system into stats.txt and a
+# delta-encoded file with a short keyframe interval, then reconstruct
+# the dumps from the delta file out of order and compare every scalar
+# with the text output.
+
+from __future__ import print_function
+
+import math
+import os
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath('../../../configs/')
+m5.util.addToPath('../../../util/')
+from common.Caches import *
+import delta_stats
+
+num_dumps = 11
+keyframes = 4
+
+cpus = [ MemTest(max_loads = 1e9, progress_interval = 0)
+         for i in range(2) ]
+
+system = System(cpu = cpus,
+                physmem = SimpleMemory(),
+                membus = SystemXBar())
+system.voltage_domain = VoltageDomain()
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain = system.voltage_domain)
+
+for cpu in cpus:
+    cpu.l1c = L1Cache(size = '32kB', assoc = 4)
+    cpu.l1c.cpu_side = cpu.port
+    cpu.l1c.mem_side = system.membus.slave
+
+system.system_port = system.membus.slave
+system.physmem.port = system.membus.master
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+delta_file = os.path.join(m5.options.outdir, 'stats.delta')
+m5.stats.addStatVisitor('delta://stats.delta?keyframes=%d' % keyframes)
+
+m5.instantiate()
+for i in range(num_dumps):
+    m5.simulate(100000)
+    m5.stats.dump()
+
+def text_dumps(path):
+    """Scalar values of every dump in a stats.txt file"""
+
+    dumps = []
+    current = None
+    with open(path) as f:
+        for line in f:
+            if line.startswith('---------- Begin'):
+                current = {}
+            elif line.startswith('---------- End'):
+                dumps.append(current)
+                current = None
+            elif current is not None:
+                fields = line.split()
+                if len(fields) < 2 or '::' in fields[0]:
+                    continue
+                try:
+                    current[fields[0]] = float(fields[1])
+                except ValueError:
+                    pass
+    return dumps
+
+def close(a, b):
+    return abs(a - b) <= 1e-5 * max(1.0, abs(a), abs(b))
+
+expected = text_dumps(os.path.join(m5.options.outdir, 'stats.txt'))
+stats = delta_stats.DeltaStats(delta_file)
+
+if len(stats) != num_dumps or len(expected) != num_dumps:
+    print('Expected %d dumps, found %d in the delta file and %d in '
+          'stats.txt' % (num_dumps, len(stats), len(expected)))
+    sys.exit(1)
+
+# Records between keyframes must only hold the stats that changed.
+for d in range(num_dumps):
+    if stats.is_keyframe(d) != (d % keyframes == 0):
+        print('Dump %d has the wrong keyframe flag' % d)
+        sys.exit(1)
+    if not stats.is_keyframe(d) and \
+       stats.num_entries(d) >= stats.num_entries(0):
+        print('Dump %d stores %d series, as many as a keyframe' %
+              (d, stats.num_entries(d)))
+        sys.exit(1)
+
+# Visit the dumps out of order, so both replays from a keyframe and
+# incremental steps from the previously reconstructed dump are used.
+order = [ 7, 2, 3, 10, 0, 5, 6, 9, 1, 4, 8 ]
+for d in order:
+    named = stats.named(d)
+    compared = 0
+    for name, value in expected[d].items():
+        if name not in named or math.isnan(value) or math.isinf(value):
+            continue
+        if not close(value, named[name]):
+            print('Dump %d: %s is %r in the delta file, %r in stats.txt' %
+                  (d, name, named[name], value))
+            sys.exit(1)
+        compared += 1
+    if compared < 10:
+        print('Dump %d: only %d stats could be compared' % (d, compared))
+        sys.exit(1)
@@ -0,0 +1,225 @@
+#!/usr/bin/env python2.7
+
+# Copyright (c) 2020 Harvard University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Reader for the delta-encoded stat files written by the delta://
+# stat output (src/base/stats/delta.cc).
+#
+# The module can either be imported to access individual dumps from
+# Python, or run as a script to print a dump in a format similar to
+# stats.txt:
+#
+#   delta_stats.py m5out/stats.delta            # last dump
+#   delta_stats.py m5out/stats.delta -d 12      # dump 12
+#   delta_stats.py m5out/stats.delta --list     # dump ticks
+
+from __future__ import print_function
+
+import argparse
+import struct
+import sys
+
+FILE_MAGIC = 0x544c4453
+FILE_VERSION = 1
+RECORD_MAGIC = 0x504d5544
+KEYFRAME_FLAG = 0x1
+
+_file_header = struct.Struct("<II")
+_index_header = struct.Struct("<IIII")
+_index_entry = struct.Struct("<QQQII")
+_record_header = struct.Struct("<IIQQI")
+_u32 = struct.Struct("<I")
+_entry_header = struct.Struct("<II")
+
+class Series(object):
+    """Description of a series of values from the names file"""
+
+    def __init__(self, id, kind, name, labels):
+        self.id = id
+        self.kind = kind
+        self.name = name
+        self.labels = labels
+
+    def label(self, i):
+        if i < len(self.labels):
+            return self.labels[i]
+        elif self.kind == "dist":
+            return "bucket%d" % (i - len(self.labels))
+        else:
+            return str(i)
+
+class DeltaStats(object):
+    """Random access to the dumps of a delta-encoded stat file"""
+
+    def __init__(self, path):
+        self.path = path
+
+        self._data = open(path, "rb")
+        magic, version = _file_header.unpack(
+            self._data.read(_file_header.size))
+        self._check(magic, version, path)
+
+        with open(path + ".idx", "rb") as f:
+            magic, version, self.keyframe_interval, _ = \
+                _index_header.unpack(f.read(_index_header.size))
+            self._check(magic, version, path + ".idx")
+            raw = f.read()
+        # Ignore a trailing partial entry from a run that was killed
+        # while writing the index.
+        count = len(raw) // _index_entry.size
+        self._index = [ _index_entry.unpack_from(raw, i * _index_entry.size)
+                        for i in range(count) ]
+
+        self.series = {}
+        with open(path + ".names", "r") as f:
+            for line in f:
+                fields = line.rstrip("\n").split("\t")
+                if len(fields) < 3:
+                    continue
+                s = Series(int(fields[0]), fields[1], fields[2], fields[3:])
+                self.series[s.id] = s
+
+        self._cache = None
+
+    @staticmethod
+    def _check(magic, version, path):
+        if magic != FILE_MAGIC:
+            raise IOError("%s: not a delta stat file" % path)
+        if version != FILE_VERSION:
+            raise IOError("%s: unsupported version %d" % (path, version))
+
+    def close(self):
+        self._data.close()
+
+    def __len__(self):
+        return len(self._index)
+
+    def tick(self, dump):
+        return self._index[dump][1]
+
+    def is_keyframe(self, dump):
+        return bool(self._index[dump][4] & KEYFRAME_FLAG)
+
+    def num_entries(self, dump):
+        """Number of series stored in the record of a dump"""
+        return self._index[dump][3]
+
+    def _read_record(self, dump):
+        offset = self._index[dump][0]
+        self._data.seek(offset)
+        magic, flags, number, tick, desc_len = _record_header.unpack(
+            self._data.read(_record_header.size))
+        if magic != RECORD_MAGIC or number != dump:
+            raise IOError("%s: corrupt record for dump %d" % (
+                self.path, dump))
+        desc = self._data.read(desc_len).decode("utf-8", "replace")
+        count, = _u32.unpack(self._data.read(_u32.size))
+
+        entries = []
+        for i in range(count):
+            sid, n = _entry_header.unpack(
+                self._data.read(_entry_header.size))
+            values = struct.unpack("<%dd" % n, self._data.read(8 * n))
+            entries.append((sid, values))
+        return desc, entries
+
+    def dump(self, dump):
+        """Reconstruct a dump.
+
+        Returns a dictionary mapping series ids to tuples of values.
+        Consecutive dumps are reconstructed incrementally, otherwise
+        the records are replayed from the closest keyframe.
+
+        """
+
+        if dump < 0:
+            dump += len(self)
+        if dump < 0 or dump >= len(self):
+            raise IndexError("dump %d out of range" % dump)
+
+        keyframe = self._index[dump][2]
+        if self._cache is not None and keyframe <= self._cache[0] <= dump:
+            first = self._cache[0] + 1
+            values = self._cache[1]
+        else:
+            first = keyframe
+            values = {}
+
+        for d in range(first, dump + 1):
+            _, entries = self._read_record(d)
+            if self.is_keyframe(d):
+                values = {}
+            values.update(entries)
+
+        self._cache = (dump, values)
+        return dict(values)
+
+    def desc(self, dump):
+        return self._read_record(dump)[0]
+
+    def named(self, dump):
+        """Reconstruct a dump keyed by stat and element names"""
+
+        result = {}
+        for sid, values in self.dump(dump).items():
+            s = self.series[sid]
+            if s.kind == "scalar":
+                result[s.name] = values[0]
+            else:
+                for i, v in enumerate(values):
+                    result["%s::%s" % (s.name, s.label(i))] = v
+        return result
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Print dumps from a delta-encoded gem5 stat file")
+    parser.add_argument("file", help="Delta stat file (e.g., stats.delta)")
+    parser.add_argument("-d", "--dump", type=int, default=-1,
+                        help="Dump to print, negative values count from "
+                        "the end (default: last dump)")
+    parser.add_argument("--list", action="store_true",
+                        help="List the dumps in the file")
+    args = parser.parse_args()
+
+    stats = DeltaStats(args.file)
+    if len(stats) == 0:
+        print("%s: no dumps" % args.file, file=sys.stderr)
+        sys.exit(1)
+
+    if args.list:
+        for d in range(len(stats)):
+            print("%d\t%d\t%s" % (d, stats.tick(d),
+                                  "keyframe" if stats.is_keyframe(d) else ""))
+        return
+
+    dump = args.dump if args.dump >= 0 else args.dump + len(stats)
+    print("---------- Dump %d, tick %d ----------" % (dump, stats.tick(dump)))
+    for name, value in sorted(stats.named(dump).items()):
+        print("%-50s %s" % (name, repr(value)))
+
+if __name__ == "__main__":
+    main()